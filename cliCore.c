@@ -14,6 +14,154 @@
  *
  *  Date      Who       Description
  *  --------  -------   -------------------------------------------------------
+ *  10/18/26  AW         cliCheckArgs() checks the options of the argument
+ *                       schema, e.g. watch -n <ms>, before the arguments.
+ *  10/18/26  AW         cliTokenizeCmdLine() rejects a quoted token that is
+ *                       followed by another character than a delimiter, e.g.
+ *                       "abc"def, with CLI_STATUS_NO_QUOTES instead of
+ *                       splitting it into two tokens.
+ *  10/18/26  AW         The command dispatch index is allocated at init for
+ *                       the registered commands, the smallest power of two
+ *                       of buckets keeping the load at most 3/4, instead of
+ *                       a fixed 512 buckets.
+ *  10/18/26  AW         cliCoreInit() initializes the session contexts.
+ *  10/18/26  AW         The session pool size and CLI_EXEC_SESSION_MAX are
+ *                       checked against the 32 bits of their masks at
+ *                       compile time. The maximum connect and close times
+ *                       are updated with compare and swap.
+ *  10/18/26  AW         cliCloseSession() gives the session slot back last,
+ *                       once the session context is released.
+ *  10/18/26  AW         Added cliRegisterReadOnlyTable(). A session in read
+ *                       only mode, e.g. a watch, only calls the handlers
+ *                       registered as read-only.
+ *  10/18/26  AW         cliErrorHandler() checks the status range and the
+ *                       table entry instead of a switch over every status.
+ *                       The error list is checked for duplicate status
+ *                       values at compile time.
+ *  10/18/26  AW         Each session slot has a semaphore the session thread
+ *                       signals when it returns. cliCloseSession() waits on
+ *                       it once, also for a session without context,
+ *                       instead of polling.
+ *  10/18/26  AW         cliExecToBuffer() runs on a static session instead of
+ *                       one on the stack of the caller, and only runs the
+ *                       commands whose output can be captured.
+ *  10/18/26  AW         cliCloseSession() deletes the input reader thread of
+ *                       the session. cliErrorHandler() looks the status up
+ *                       with a switch built from CLI_ERROR_LIST, so
+ *                       CLI_STATUS_CANCELLED is checked at compile time not
+ *                       to share its value with a status of cliCore.h.
+ *  10/18/26  AW         Added cliRegisterCaptureTable() and cliCmdCaptureSafe(),
+ *                       the commands whose output can be captured away from
+ *                       the session file handle.
+ *  10/18/26  AW         TAB completes the commands of the session command list
+ *                       instead of the core command list.
+ *  10/18/26  AW         The error table is built from CLI_ERROR_LIST, which
+ *                       is also checked at compile time to have one entry for
+ *                       every CLI_STATUS.
+ *  10/18/26  AW         A session without a session context gets its command
+ *                       arguments checked too, instead of the command failing
+ *                       with CLI_STATUS_INSUFF_MEM, see cliArgValue(). Added
+ *                       ArgCountStatus to the argument schema.
+ *  10/18/26  AW         The parse functions report the tokenizer status, e.g.
+ *                       a missing closing quote, through cliErrorHandler().
+ *                       cliSplitCmdLine() and cliSplitJob() use the quote
+ *                       rule of the tokenizer, see cliQuotedTokenEnd().
+ *  10/18/26  AW         cliRegisterCommandTable() keeps only the pointer to
+ *                       the table on the core list. The table commands are
+ *                       merged into the dispatch index without a command
+ *                       node, and cliRegisterCommand() no longer takes its
+ *                       nodes from a static pool. The help lists the core
+ *                       commands from the sorted index.
+ *  10/18/26  AW         The session thread sets a completion flag in the
+ *                       session context when its entry function returns.
+ *                       cliCloseSession() waits for it in 1 ms steps instead
+ *                       of checking the thread state every 20 ms, and asks
+ *                       the running command to stop with a cancel request.
+ *                       The close count and time are kept with the session
+ *                       pool statistics.
+ *  10/18/26  AW         The thread objects and stacks of the sessions are
+ *                       reserved once by cliCoreInit(). cliCreateSessionEx()
+ *                       takes a free slot of the pool instead of allocating
+ *                       them, and cliCloseSession() gives it back.
+ *                       Added cliSessionPoolStats().
+ *  10/18/26  AW         Added CLI_STATUS_CANCELLED, returned by a command
+ *                       stopped by Ctrl-C. The cancel request of the session
+ *                       is cleared before each command, and a cancelled
+ *                       command ends its command batch.
+ *  10/18/26  AW         Added cliExecToBuffer(), which runs a command line
+ *                       on a session without thread, stack or file record
+ *                       and returns its output in a buffer. The help goes
+ *                       through the session output buffer, so it can be
+ *                       captured and filtered.
+ *  10/18/26  AW         A command may be followed by the output filters
+ *                       "| grep <text>", "| head [n]" and "| count"
+ *                       (iecCliPipe.c). head stops the command once it has
+ *                       its lines.
+ *  10/18/26  AW         A command ending with '&' is run as a background job
+ *                       (iecCliJob.c) and the prompt comes back at once. The
+ *                       jobs of a session are killed when it is closed.
+ *                       The session context keeps the status of the last
+ *                       command.
+ *  10/18/26  AW         cliParseCmd() runs a batch of commands separated by
+ *                       ';' back to back with one output flush at the end.
+ *                       The batch stops at the first failing command if
+ *                       the session asks for it (iecBatch stop).
+ *  10/18/26  AW         cliGetString() reads the session input in blocks
+ *                       through the input queue (iecCliIn.c) and flushes
+ *                       the echo only when the queue is empty. The rest of
+ *                       a pasted block stays queued for the next commands.
+ *  10/18/26  AW         TAB completes the arguments too, through the argument
+ *                       schemas, subcommand trees and completion callbacks.
+ *                       The word is completed to the longest common prefix
+ *                       of the candidates and the typed line is kept when
+ *                       they are listed. Command names are completed by
+ *                       binary search in a sorted name array built with the
+ *                       dispatch index.
+ *  10/18/26  AW         With IEC_CLI_HISTORY_FLASH_REGION the commands are
+ *                       also logged to flash. Up arrow continues past the
+ *                       session history into the commands of the previous
+ *                       boots, loaded on first use.
+ *  10/18/26  AW         Added the reverse history search (Ctrl-R) to
+ *                       cliGetString().
+ *  10/18/26  AW         Each session has its own command history in its
+ *                       session context, or all sessions share a lock-free
+ *                       history with IEC_CLI_HISTORY_SHARED. Removed the
+ *                       process wide sCliCmdHistory.
+ *  10/18/26  AW         History recall keeps a per session cursor holding
+ *                       the sequence number of the recalled command and
+ *                       looks the command up by index instead of walking
+ *                       the history.
+ *  10/18/26  AW         The command history is a ring in a fixed arena
+ *                       (iecCliHistory.c), no longer a malloc'ed list.
+ *  10/18/26  AW         cliGetString() edits the line with the per session
+ *                       line editor (iecCliEditor.c), which decodes the
+ *                       VT100 key sequences and supports left, right,
+ *                       Home, End, Delete and mid-line editing. Removed the
+ *                       shared arrow key state of iecCliArrowHandle().
+ *  10/18/26  AW         In TLV output mode cliErrorHandler() sends a status
+ *                       record instead of the error message.
+ *  10/18/26  AW         Echo, prompt and error messages go through the
+ *                       session output buffer (iecCliOut.c), which is
+ *                       flushed at the prompt, before reading input and at
+ *                       the end of each command.
+ *  10/18/26  AW         Replaced the status switch of cliErrorHandler() with
+ *                       a const table indexed by CLI_STATUS that holds the
+ *                       message, severity and print syntax flag. Statuses
+ *                       missing from the switch printed an empty message.
+ *  10/18/26  AW         Added subcommand trees. Commands with a subcommand
+ *                       tree are dispatched through the tree and help lists
+ *                       their subcommands.
+ *  10/18/26  AW         Added command argument schemas. Arguments of a
+ *                       command with a schema are checked and converted by
+ *                       cliCheckArgs() before the handler is called.
+ *  10/18/26  AW         Replaced strtok() in the parse functions with the
+ *                       reentrant cliTokenizeCmdLine() which supports quoted
+ *                       tokens. Sessions get a session context.
+ *  10/18/26  AW         Command nodes are taken from a static pool, added
+ *                       cliRegisterCommandTable() and sorted the core command
+ *                       list by name.
+ *  10/18/26  AW         Added a frozen hash index over the core command list,
+ *                       used by cliParseCmd() and cliInBandParseCmd().
  *  07/10/18  XQJ        Added the registration of iec and arbok commands.
  *                       Added the feature to autocomplete the input command.
  *  09/28/16  EJF        SCGCQ01190364: Modified the structure "errorString"
@@ -242,6 +390,13 @@
 #include "fwTraceDebug.h"
 #include "arbokCli.h"
 #include "iecCli.h"
+#include "iecCliCore.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliJob.h"
+#include "iecCliPipe.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
 
 
 /* Time in milliseconds for which the maximum telnet/SSH connections exceeded
@@ -249,6 +404,11 @@
  */
 #define MAX_SESSION_EXCEEDED_MSG_DISPLAY_MS (2000)
 
+/* Time cliCloseSession() waits for the session thread to return before it
+ * terminates the thread, in ms.
+ */
+#define CLI_CLOSE_TIMEOUT_MS        (200)
+
 
 /* Help command info */
 static const PU8 sCmdHelp = "help";
@@ -264,17 +424,21 @@ static const PU8 sHlpHelp = "    CLI Help                help [Command]\r\n"
                             "                                - opt1|opt2|opt3 means literally specify\r\n"
                             "                                   \"opt1\",\"opt2\", or \"opt3\"\r\n"
                             "                                - X1 X2 ... means a variable number\r\n"
-                            "                                  of arguments\r\n\n";
+                            "                                  of arguments\r\n"
+                            "                                - cmd | grep <text> | head [n] | count\r\n"
+                            "                                  filters the output of cmd\r\n\n";
 static const PU8 sPtrHelpHeader = "    Test                    Command";
 
 static const PU8 sPtrCliCmdNotFound = " \r\n\nInvalid Command. Use help command for CLI"
                                         " Command Help.\r\n";
 
+static const PU8 sPtrCliPrompt = "\r\n cmd >";
+
 /* This object holds all common CLI commands registered with CLI core */
 static CLI_CMD_LIST sCliCmdList;
 
-/*This object holds all history command valid by input correct command.*/
-static CLI_CMD_HISTORY sCliCmdHistory;
+/* Node of the help command of sCliCmdList */
+static CLI_CMD_NODE sCliHelpCmdNode;
 
 /* These structures hold the session information and the command table for the
  * fault handler CLI interface.
@@ -283,106 +447,547 @@ static CLI_SESSION_INFO     sCliFwFaultSessionInfo;
 /* Flag to avoid multiple initialization of CLI Core */
 static BOOL sCliCoreInitialized = FALSE;
 
-static const char *errorString[] =
-{
-    {""},                                                       //CLI_STATUS_SUCCESS
-    {"Invalid Command Syntax!"},                                //CLI_STATUS_INVALID_SYNTAX
-    {"Invalid Write Type!"},                                    //CLI_STATUS_INVALID_WRT_TYPE
-    {"Invalid Address!"},                                       //CLI_STATUS_INVALID_ADDRESS
-    {"Invalid High SAS Address!"},                              //CLI_STATUS_INVALID_HIGH_SAS_ADD
-    {"Invalid Low SAS Address!"},                               //CLI_STATUS_INVALID_LOW_SAS_ADD
-    {"Valid options are 'on' and 'off'"},                       //CLI_STATUS_INVALID_OPTION
-    {"Invalid Parameter!"},                                     //CLI_STATUS_INVALID_PARAMETER
-    {"Invalid Memory Length!"},                                 //CLI_STATUS_INVALID_MEM_LEN
-    {"Invalid Allocation Length!"},                             //CLI_STATUS_INVALID_ALL_LEN
-    {"Data Overflow. Valid Range is 00 to FF."},                //CLI_STATUS_DATA_OVERFLOW_8
-    {"Data Overflow. Valid Range is 0000 to FFFF."},            //CLI_STATUS_DATA_OVERFLOW_16
-    {"Data Overflow. Valid Range is 00000000 to FFFFFFFF."},    //CLI_STATUS_DATA_OVERFLOW_32
-    {"Invalid Write data!"},                                    //CLI_STATUS_INVALID_WRT_DATA
-    {"Failed - Thread Get Info Error."},                        //CLI_STATUS_THREAD_ERROR
-    {"Failed to read configuration page."},                     //CLI_STATUS_READ_CFG_ERR
-    {"Invalid Page Id."},                                       //CLI_STATUS_INVALID_PAGE_ID
-    {"Invalid Region Number."},                                 //CLI_STATUS_INVALID_REGION
-    {"Erase flash region failed"},                              //CLI_STATUS_ERASE_FAILED
-    {"Invalid Erase Parameter!"},                               //CLI_STATUS_INVALID_ERASE_PARAM
-    {"Failed to read Mfg config Version page 0xFF0F."},         //CLI_STATUS_RD_MFG_FAILED
-    {"Error reading log."},                                     //CLI_STATUS_RD_LOG_ERROR
-    {"Invalid String length."},                                 //CLI_STATUS_INVALID_STRING
-    {"Error quotes around string not found."},                  //CLI_STATUS_NO_QUOTES
-    {"Error adding log."},                                      //CLI_STATUS_LOG_ADD_ERR
-    {"Error clearing log."},                                    //CLI_STATUS_CLR_LOG_ERR
-    {"Error reading trace."},                                   //CLI_STATUS_TRACE_ERR
-    {"Error clearing trace."},                                  //CLI_STATUS_CLEAR_TRACE_ERR
-    {"Please provide a hex number."},                           //CLI_STATUS_ENTER_HEX
-    {"Invalid severity!  Valid severity range is (0-3)."},      //CLI_STATUS_TRACE_VALID_RANGE
-    {"Failed to write config page."},                           //CLI_STATUS_WRT_FAILED
-    {"Invalid Tracemask."},                                     //CLI_STATUS_INVALID_TRCMASK
-    {"Invalid Subsystem."},                                     //CLI_STATUS_INVALID_SUBSYSTEM
-    {"Invalid Byte Number!"},                                   //CLI_STATUS_BYTE_ERR
-    {"Invalid Channel!"},                                       //CLI_STATUS_INVALID_CHANNEL
-    {"Invalid source phy number!"},                             //CLI_STATUS_INVALID_SRC_PHY
-    {"Invalid receive destination phy number."},                //CLI_STATUS_INVALID_RX_PHY
-    {"Invalid transmit destination phy number."},               //CLI_STATUS_INVALID_TX_PHY
-    {"mirror enable/disable failed"},                           //CLI_STATUS_MIR_EN_DISEN_FAIL
-    {"Invalid mirror phy."},                                    //CLI_STATUS_INVALID_MIR_PHY
-    {"Insufficient Memory, can not continue"},                  //CLI_STATUS_INSUFF_MEM
-    {"Ethernet compliance test command only on UART."},         //CLI_STATUS_UART_ONLY
-    {"Ethernet compliance test already disabled"},              //CLI_STATUS_ETC_DIABLED
-    {"Failed to disable Ethernet compliance test."},            //CLI_STATUS_ETC_DISABLE_FAIL
-    {"Incorrect Timeout Value"},                                //CLI_STATUS_INVALID_TIMEOUT
-    {"Invalid Mode Value"},                                     //CLI_STATUS_INVALID_MODE
-    {"Invalid Interface"},                                      //CLI_STATUS_INVALID_INTERFACE
-    {"This expander does not have any configured SGX devices attached"},    //CLI_STATUS_NO_SGX_DEVICES
-    {"Invalid Port"},                                           //CLI_STATUS_INVALID_PORT
-    {"Command Length too long!"},                               //CLI_STATUS_CMD_LEN
-    {"Report General failed, could not get status."},           //CLI_STATUS_RPT_GEN_FAILED
-    {"Invalid Connection Rate."},                               //CLI_STATUS_INVALID_CON_RATE
-    {"Xmodem Transfer Failed"},                                 //CLI_STATUS_XFER_FAILED
-    {"Invalid File Length."},                                   //CLI_STATUS_INVALID_FILE_LEN
-    {"Invalid Function Request."},                              //CLI_STATUS_INVALID_FUNC_REQ
-    {"Invalid Buffer ID."},                                     //CLI_STATUS_INVALID_BUF_ID
-    {"Error Creating Thread."},                                 //CLI_STATUS_CREATE_THRD_FAILED
-    {"Error while accessing Flash details."},                   //CLI_STATUS_FLASH_ERROR
-    {"Flash device not present."},                              //CLI_STATUS_NO_FLASH
-    {"SourceZoneGroup must be less than or equal to 0xFF."},    //CLI_STATUS_SRC_GROUP_ERR
-    {"Invalid SEEPROM data."},                                  //CLI_STATUS_INVALID_SEPRM_DATA
-    {"Error reading SEEPROM."},                                 //CLI_STATUS_RD_SEPRM_ERROR
-    {"Invalid Number of Parameters!"},                          //CLI_STATUS_INVALID_PARAM_NUM
-    {"Illegal Argument!"},                                      //CLI_STATUS_ILLEGAL_ARG
-                                                                //CLI_STATUS_ILLEGAL_RESET_ARG
-    {"Illegal Argument!\r\n"\
-                            "\r\nReset Usage:  reset (issues softreset)"\
-                            "\r\n              reset watchdog (issues watchdog reset)"},
-                                                                //CLI_STATUS_INVALID_PKT_SIZE
-    {"Invalid Packet Size, "\
-     "Provide packet size greater than or equal to 60 and less then or equal to 1024"},
-    {"Invalid Delay, Provide delay in milliseconds"},           //CLI_STATUS_INVALID_DELAY_ARG
-    {"Invalid Pattern, Provide pattern in a dword"},            //CLI_STATUS_INVALID_PATTERN_ARG
-    {"Invalid parameter given to Sgpio Read Request."},         //CLI_STATUS_INVALID_PARAM_SGPIO
-    {"Memory Download Failed"},                                 //CLI_STATUS_MEM_DL_FAILED
-    {"Memory Upload Failed"},                                   //CLI_STATUS_MEM_UL_FAILED
-    {"Firmware Download Failed"},                               //CLI_STATUS_FW_DL_FAILED
-    {"Firmware Upload Failed"},                                 //CLI_STATUS_FW_UL_FAILED
-    {"Invalid Buffer Offset"},                                  //CLI_STATUS_INVALID_BUF_OFFSET
-    {"Invalid Memory address"},                                 //CLI_STATUS_INVALID_MEM_ADDRESS
-    {"Invalid Filename Parameter"},                             //CLI_STATUS_INVALID_FILENAME
-    {"Invalid IP Address"},                                     //CLI_STATUS_INVALID_IP_ADDRESS
-    {"Invalid File Size"},                                      //CLI_STATUS_INVALID_FILE_SIZE
-    {"Invalid Test Mode - must be int"},                        //CLI_STATUS_INVALID_PHYTEST_MODE
-    {"Invalid Pattern - only 0,6,9,10,12,13 are supported"},    //CLI_STATUS_INVALID_PHYTEST_PATTERN
-    {"Invalid Connection Rate - "\
-     "must be 0(3G), 1(6G) or 2(12G)"},                         //CLI_STATUS_INVALID_PHYTEST_RATE
-    {"Invalid Duration - must be greater than 0"},              //CLI_STATUS_INVALID_PHYTEST_DURATION
-    {"Invalid Phymask"},                                        //CLI_STATUS_INVALID_PHYTEST_PHYMASK
-    {"Failed to allocate memory for the command"},              //CLI_STATUS_MALLOC_FAILED
-    {"Command Syntax:"},                                        //CLI_STATUS_SYNTAX
-    {"Invalid Firmware Image"},                                 //CLI_STATUS_INVALID_FW_IMAGE
-    {"Command Failed!"},                                        //CLI_STATUS_FAILED
-    {"Info not available"},                                     //CLI_STATUS_INFO_NOT_AVAILABLE
-    {""}                                                        //CLI_STATUS_ERROR_PRINTED
+/* Compile time check: the bucket count is a power of two, and a bucket
+ * fits the U16 entries of the sorted bucket list.
+ */
+typedef char CLI_CMD_INDEX_SIZE_MAX_CHECK[
+    ((CLI_CMD_INDEX_SIZE_MAX >= 2) && (CLI_CMD_INDEX_SIZE_MAX <= 65536) &&
+     ((CLI_CMD_INDEX_SIZE_MAX & (CLI_CMD_INDEX_SIZE_MAX - 1)) == 0)) ? 1 : -1];
+
+/* FNV-1a 32 bit hash parameters used for the command dispatch index */
+#define CLI_CMD_HASH_OFFSET_BASIS   (0x811C9DC5)
+#define CLI_CMD_HASH_PRIME          (0x01000193)
+
+/* Command dispatch index entry flags */
+#define CLI_CMD_INDEX_FLAG_INBAND_BLOCKED   (0x0001)
+
+/* Separator of the commands of a command batch */
+#define CLI_CMD_SEPARATOR           (';')
+
+/* Last character of a command run as a background job */
+#define CLI_CMD_JOB_SUFFIX          ('&')
+
+/* Output buffer of a cliExecToBuffer() session */
+typedef struct _CLI_EXEC_BUFFER
+{
+    PU8     PtrBuffer;
+    U32     Size;
+    /* Length of the output so far, including the part that did not fit */
+    U32     Length;
+} CLI_EXEC_BUFFER, *PTR_CLI_EXEC_BUFFER;
+
+typedef struct _CLI_CMD_INDEX_ENTRY
+{
+    /* The command is a node of the core command list, registered by
+     * cliRegisterCommand(), or an entry of a command table registered by
+     * cliRegisterCommandTable(). The other pointer is NULL. Both are NULL
+     * if the bucket is empty.
+     */
+    PTR_CLI_CMD_NODE    PtrCmdNode;
+    const CLI_CMD_INFO *PtrCmdInfo;
+    /* Upper bits of the command name hash, checked before the string compare */
+    U16                 HashTag;
+    /* CLI_CMD_INDEX_FLAG_xxx */
+    U16                 Flags;
+    /* Argument schema of the command, NULL if it has none */
+    const CLI_ARG_SCHEMA *PtrArgSchema;
+} CLI_CMD_INDEX_ENTRY, *PTR_CLI_CMD_INDEX_ENTRY;
+
+/* Open addressed (linear probing) index over the core commands: the nodes
+ * of sCliCmdList and the registered command tables. It is allocated and
+ * built once at the end of cliCoreInit() and is read only afterwards, so the
+ * session threads can use it without locking. sCliCmdIndexSize buckets, a
+ * power of two.
+ */
+static PTR_CLI_CMD_INDEX_ENTRY sCliCmdIndex = NULL;
+static U32 sCliCmdIndexSize = 0;
+static BOOL sCliCmdIndexBuilt = FALSE;
+
+/* Head of sCliCmdList when cliCoreInit() was done. A session command list
+ * reaching this node goes on with the core commands, in the index. The
+ * command lists that do not reach it (fault console) are walked.
+ */
+static PTR_CLI_CMD_NODE sPtrCliCmdCoreHead = NULL;
+
+/* Buckets of the index sorted by command name, without the shadowed
+ * duplicates. The help lists the core commands in this order, and the
+ * command name completion of cliGetString() finds the commands starting
+ * with a prefix by binary search. Allocated with the index, one entry per
+ * registered command.
+ */
+static U16 *sCliCmdSorted = NULL;
+static U16 sCliCmdSortedCount = 0;
+
+/* Name of the command of a bucket of the index, and of the command at a
+ * position of sCliCmdSorted
+ */
+#define CLI_CMD_INDEX_NAME(Bucket)                                  \
+    ((sCliCmdIndex[Bucket].PtrCmdNode != NULL) ?                    \
+     (const U8 *)sCliCmdIndex[Bucket].PtrCmdNode->Command :         \
+     (const U8 *)sCliCmdIndex[Bucket].PtrCmdInfo->PtrCmdName)
+
+#define CLI_CMD_SORTED_NAME(Position)   CLI_CMD_INDEX_NAME(sCliCmdSorted[Position])
+
+/* Command tables registered on sCliCmdList by cliRegisterCommandTable().
+ * Only the pointers to the read only tables are kept, the commands have no
+ * node and are found through the index.
+ */
+static const CLI_CMD_INFO * const *sPtrCliCmdTable[CLI_CMD_TABLE_MAX];
+static U16 sCliCmdTableSize[CLI_CMD_TABLE_MAX];
+static U16 sCliCmdTableCount = 0;
+
+/* Command node of the commands found in a command table, for the sessions
+ * without context. Only the in-band session has none, and it runs one
+ * command at a time.
+ */
+static CLI_CMD_NODE sCliInBandCmdNode;
+
+/* Argument schemas registered by cliRegisterArgSchemaTable() */
+static const CLI_ARG_SCHEMA *sPtrCliArgSchema[CLI_ARG_SCHEMA_MAX];
+static U16 sCliArgSchemaCount = 0;
+
+/* Command tables registered by cliRegisterCaptureTable() */
+static const CLI_CMD_INFO * const *sPtrCliCaptureTable[CLI_CAPTURE_TABLE_MAX];
+static U16 sCliCaptureTableSize[CLI_CAPTURE_TABLE_MAX];
+static U16 sCliCaptureTableCount = 0;
+
+/* Handler tables registered by cliRegisterReadOnlyTable() */
+static const PTR_CLI_SUBCMD_HANDLER *sPtrCliReadOnlyTable[CLI_READ_ONLY_TABLE_MAX];
+static U16 sCliReadOnlyTableSize[CLI_READ_ONLY_TABLE_MAX];
+static U16 sCliReadOnlyTableCount = 0;
+
+/* Thread object and stack of a session, reserved by cliCoreInit(). The
+ * semaphore is signalled by the session thread when it returns.
+ */
+typedef struct _CLI_SESSION_SLOT
+{
+    HALI_OS_HANDLE      ThreadHandle;
+    HALI_OS_HANDLE      DoneSemHandle;
+    void               *PtrStack;
+} CLI_SESSION_SLOT, *PTR_CLI_SESSION_SLOT;
+
+static CLI_SESSION_SLOT sCliSessionSlot[CLI_SESSION_POOL_SIZE];
 
+/* Bit n is set while slot n is free. Taken and given back with atomic
+ * operations, sessions are created and closed from several server threads.
+ */
+static volatile U32 sCliSessionSlotFree = 0;
+
+/* Compile time check: the free mask of the session slots and the busy mask
+ * of the cliExecToBuffer() sessions have one bit per entry.
+ */
+typedef char CLI_SESSION_POOL_SIZE_CHECK[
+    ((CLI_SESSION_POOL_SIZE >= 1) && (CLI_SESSION_POOL_SIZE <= 32) &&
+     (CLI_SESSION_POOL_SIZE <= IEC_CLI_MAX_SESSIONS)) ? 1 : -1];
+
+typedef char CLI_EXEC_SESSION_MAX_CHECK[
+    ((CLI_EXEC_SESSION_MAX >= 1) && (CLI_EXEC_SESSION_MAX <= 32)) ? 1 : -1];
+
+static CLI_SESSION_POOL_STATS sCliSessionPoolStats;
+
+/* Sessions of cliExecToBuffer(). Bit n is set while session n is in use. */
+static CLI_SESSION_INFO sCliExecSession[CLI_EXEC_SESSION_MAX];
+static volatile U32 sCliExecSessionBusy = 0;
+
+/* Severity of a command return status */
+typedef enum _CLI_ERR_SEVERITY
+{
+    /* Success, or the command already printed its error */
+    CLI_ERR_SEVERITY_NONE = 0,
+    /* Invalid command line, the user can correct it and retry */
+    CLI_ERR_SEVERITY_USAGE,
+    /* The command was valid but failed */
+    CLI_ERR_SEVERITY_FAILURE
+} CLI_ERR_SEVERITY;
+
+typedef struct _CLI_ERROR_ENTRY
+{
+    /* Message printed by cliErrorHandler(), NULL for a missing entry */
+    const char         *PtrMessage;
+    /* CLI_ERR_SEVERITY, kept in a byte so an entry is two words */
+    U8                  Severity;
+    /* Print the one line help of the command after the message */
+    U8                  PrintSyntax;
+} CLI_ERROR_ENTRY;
+
+/* Message, severity and print syntax flag of each CLI_STATUS. The list
+ * builds the error table, indexed by the status, and the compile time check
+ * below. cliErrorHandler() only does a table lookup, so adding a status means
+ * adding its entry here.
+ */
+#define CLI_ERROR_LIST(Entry)                                                  \
+    Entry( CLI_STATUS_SUCCESS,                                                 \
+           "",                                                                 \
+           CLI_ERR_SEVERITY_NONE, FALSE )                                      \
+    Entry( CLI_STATUS_INVALID_SYNTAX,                                          \
+           "Invalid Command Syntax!",                                          \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_WRT_TYPE,                                        \
+           "Invalid Write Type!",                                              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_ADDRESS,                                         \
+           "Invalid Address!",                                                 \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_HIGH_SAS_ADD,                                    \
+           "Invalid High SAS Address!",                                        \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_LOW_SAS_ADD,                                     \
+           "Invalid Low SAS Address!",                                         \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_OPTION,                                          \
+           "Valid options are 'on' and 'off'",                                 \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PARAMETER,                                       \
+           "Invalid Parameter!",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_MEM_LEN,                                         \
+           "Invalid Memory Length!",                                           \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_ALL_LEN,                                         \
+           "Invalid Allocation Length!",                                       \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_DATA_OVERFLOW_8,                                         \
+           "Data Overflow. Valid Range is 00 to FF.",                          \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_DATA_OVERFLOW_16,                                        \
+           "Data Overflow. Valid Range is 0000 to FFFF.",                      \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_DATA_OVERFLOW_32,                                        \
+           "Data Overflow. Valid Range is 00000000 to FFFFFFFF.",              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_WRT_DATA,                                        \
+           "Invalid Write data!",                                              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_THREAD_ERROR,                                            \
+           "Failed - Thread Get Info Error.",                                  \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_READ_CFG_ERR,                                            \
+           "Failed to read configuration page.",                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PG_ID,                                           \
+           "Invalid Page Id.",                                                 \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_REGION,                                          \
+           "Invalid Region Number.",                                           \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_ERASE_FAILED,                                            \
+           "Erase flash region failed",                                        \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_ERASE_PARAM,                                     \
+           "Invalid Erase Parameter!",                                         \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_RD_MFG_FAILED,                                           \
+           "Failed to read Mfg config Version page 0xFF0F.",                   \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_RD_LOG_ERROR,                                            \
+           "Error reading log.",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_STRING,                                          \
+           "Invalid String length.",                                           \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_NO_QUOTES,                                               \
+           "Error quotes around string not found.",                            \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_LOG_ADD_ERR,                                             \
+           "Error adding log.",                                                \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_CLR_LOG_ERR,                                             \
+           "Error clearing log.",                                              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_TRACE_ERR,                                               \
+           "Error reading trace.",                                             \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_CLEAR_TRACE_ERR,                                         \
+           "Error clearing trace.",                                            \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_ENTER_HEX,                                               \
+           "Please provide a hex number.",                                     \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_TRACE_VALID_RANGE,                                       \
+           "Invalid severity!  Valid severity range is (0-3).",                \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_WRT_FAILED,                                              \
+           "Failed to write config page.",                                     \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_TRCMASK,                                         \
+           "Invalid Tracemask.",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_SUBSYSTEM,                                       \
+           "Invalid Subsystem.",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_BYTE_ERR,                                                \
+           "Invalid Byte Number!",                                             \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_CHANNEL,                                         \
+           "Invalid Channel!",                                                 \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_SRC_PHY,                                         \
+           "Invalid source phy number!",                                       \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_INVALID_RX_PHY,                                          \
+           "Invalid receive destination phy number.",                          \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_INVALID_TX_PHY,                                          \
+           "Invalid transmit destination phy number.",                         \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_MIR_EN_DISEN_FAIL,                                       \
+           "mirror enable/disable failed",                                     \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_MIR_PHY,                                         \
+           "Invalid mirror phy.",                                              \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_INSUFF_MEM,                                              \
+           "Insufficient Memory, can not continue",                            \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_UART_ONLY,                                               \
+           "Ethernet compliance test command only on UART.",                   \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_ETC_DIABLED,                                             \
+           "Ethernet compliance test already disabled",                        \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_ETC_DISABLE_FAIL,                                        \
+           "Failed to disable Ethernet compliance test.",                      \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_TIMEOUT,                                         \
+           "Incorrect Timeout Value",                                          \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_MODE,                                            \
+           "Invalid Mode Value",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_INTERFACE,                                       \
+           "Invalid Interface",                                                \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_NO_SGX_DEVICES,                                          \
+           "This expander does not have any configured SGX devices attached",  \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_PORT,                                            \
+           "Invalid Port",                                                     \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_CMD_LEN,                                                 \
+           "Command Length too long!",                                         \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_RPT_GEN_FAILED,                                          \
+           "Report General failed, could not get status.",                     \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_CON_RATE,                                        \
+           "Invalid Connection Rate.",                                         \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_XFER_FAILED,                                             \
+           "Xmodem Transfer Failed",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_FILE_LEN,                                        \
+           "Invalid File Length.",                                             \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_FUNC_REQ,                                        \
+           "Invalid Function Request.",                                        \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_BUF_ID,                                          \
+           "Invalid Buffer ID.",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_CREATE_THRD_FAILED,                                      \
+           "Error Creating Thread.",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_FLASH_ERROR,                                             \
+           "Error while accessing Flash details.",                             \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_NO_FLASH,                                                \
+           "Flash device not present.",                                        \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_SRC_GROUP_ERR,                                           \
+           "SourceZoneGroup must be less than or equal to 0xFF.",              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_SEPRM_DATA,                                      \
+           "Invalid SEEPROM data.",                                            \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_RD_SEPRM_ERROR,                                          \
+           "Error reading SEEPROM.",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_PARAM_NUM,                                       \
+           "Invalid Number of Parameters!",                                    \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_ILLEGAL_ARG,                                             \
+           "Illegal Argument!",                                                \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_ILLEGAL_RESET_ARG,                                       \
+           "Illegal Argument!\r\n"                                             \
+           "\r\nReset Usage:  reset (issues softreset)"                        \
+           "\r\n              reset watchdog (issues watchdog reset)",         \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_INVALID_PKT_SIZE,                                        \
+           "Invalid Packet Size, "                                             \
+           "Provide packet size greater than or equal to 60 "                  \
+           "and less then or equal to 1024",                                 \
+           CLI_ERR_SEVERITY_USAGE, FALSE )                                     \
+    Entry( CLI_STATUS_INVALID_DELAY_ARG,                                       \
+           "Invalid Delay, Provide delay in milliseconds",                     \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PATTERN_ARG,                                     \
+           "Invalid Pattern, Provide pattern in a dword",                      \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PARAM_SGPIO,                                     \
+           "Invalid parameter given to Sgpio Read Request.",                   \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_MEM_DL_FAILED,                                           \
+           "Memory Download Failed",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_MEM_UL_FAILED,                                           \
+           "Memory Upload Failed",                                             \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_FW_DL_FAILED,                                            \
+           "Firmware Download Failed",                                         \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_FW_UL_FAILED,                                            \
+           "Firmware Upload Failed",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INVALID_BUF_OFFSET,                                      \
+           "Invalid Buffer Offset",                                            \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_MEM_ADDRESS,                                     \
+           "Invalid Memory address",                                           \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_FILENAME,                                        \
+           "Invalid Filename Parameter",                                       \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_IP_ADDRESS,                                      \
+           "Invalid IP Address",                                               \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_FILE_SIZE,                                       \
+           "Invalid File Size",                                                \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PHYTEST_MODE,                                    \
+           "Invalid Test Mode - must be int",                                  \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PHYTEST_PATTERN,                                 \
+           "Invalid Pattern - only 0,6,9,10,12,13 are supported",              \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PHYTEST_RATE,                                    \
+           "Invalid Connection Rate - "                                        \
+           "must be 0(3G), 1(6G) or 2(12G)",                                   \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PHYTEST_DURATION,                                \
+           "Invalid Duration - must be greater than 0",                        \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_PHYTEST_PHYMASK,                                 \
+           "Invalid Phymask",                                                  \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_MALLOC_FAILED,                                           \
+           "Failed to allocate memory for the command",                        \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_SYNTAX,                                                  \
+           "Command Syntax:",                                                  \
+           CLI_ERR_SEVERITY_USAGE, TRUE )                                      \
+    Entry( CLI_STATUS_INVALID_FW_IMAGE,                                        \
+           "Invalid Firmware Image",                                           \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_FAILED,                                                  \
+           "Command Failed!",                                                  \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_INFO_NOT_AVAILABLE,                                      \
+           "Info not available",                                               \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )                                   \
+    Entry( CLI_STATUS_ERROR_PRINTED,                                           \
+           "",                                                                 \
+           CLI_ERR_SEVERITY_NONE, FALSE )                                      \
+    Entry( CLI_STATUS_CANCELLED,                                               \
+           "Command Cancelled",                                                \
+           CLI_ERR_SEVERITY_FAILURE, FALSE )
+
+#define CLI_ERROR_TABLE_ENTRY(Status, Message, Severity, PrintSyntax)          \
+    [Status] = { Message, Severity, PrintSyntax },
+
+static const CLI_ERROR_ENTRY sCliErrorTable[] =
+{
+    CLI_ERROR_LIST(CLI_ERROR_TABLE_ENTRY)
+};
+
+/* One enumerator per entry of the list. A status listed twice does not
+ * compile, so the list has CLI_ERROR_LIST_COUNT different statuses.
+ */
+#define CLI_ERROR_LIST_ENUM(Status, Message, Severity, PrintSyntax)            \
+    CLI_ERROR_LIST_##Status,
+
+enum
+{
+    CLI_ERROR_LIST(CLI_ERROR_LIST_ENUM)
+    CLI_ERROR_LIST_COUNT
 };
 
+/* Compile time check: the table ends with the last CLI_STATUS value,
+ * CLI_STATUS_CANCELLED, and the list has as many different statuses as the
+ * table has entries, so every status has an entry with a message.
+ */
+typedef char CLI_ERROR_TABLE_SIZE_CHECK[
+    ((sizeof(sCliErrorTable) / sizeof(sCliErrorTable[0]))
+        == (CLI_STATUS_CANCELLED + 1)) ? 1 : -1];
+
+typedef char CLI_ERROR_TABLE_ENTRY_CHECK[
+    (CLI_ERROR_LIST_COUNT == (CLI_STATUS_CANCELLED + 1)) ? 1 : -1];
+
+/* CLI_STATUS_CANCELLED is not in the CLI_STATUS enum of cliCore.h. It must
+ * follow its last status and fit the status byte of a TLV record.
+ */
+typedef char CLI_STATUS_CANCELLED_CHECK[
+    ((CLI_STATUS_CANCELLED > CLI_STATUS_ERROR_PRINTED) &&
+     (CLI_STATUS_CANCELLED <= 0xFF)) ? 1 : -1];
+
+/* Bit map of the status values of the list, one 64 bit word per 64 values.
+ * The values must set every bit from 0 to CLI_STATUS_CANCELLED: with
+ * CLI_ERROR_LIST_COUNT entries, two statuses of the same value (e.g. a status
+ * added to cliCore.h after CLI_STATUS_ERROR_PRINTED) leave a bit clear and
+ * do not compile.
+ */
+#define CLI_ERROR_LIST_BIT(Status, Word)                                       \
+    ((((U32)(Status) >> 6) == (Word)) ? (1ULL << ((U32)(Status) & 63U)) : 0ULL)
+#define CLI_ERROR_LIST_BIT_0(Status, Message, Severity, PrintSyntax)           \
+    | CLI_ERROR_LIST_BIT(Status, 0)
+#define CLI_ERROR_LIST_BIT_1(Status, Message, Severity, PrintSyntax)           \
+    | CLI_ERROR_LIST_BIT(Status, 1)
+#define CLI_ERROR_LIST_BIT_2(Status, Message, Severity, PrintSyntax)           \
+    | CLI_ERROR_LIST_BIT(Status, 2)
+#define CLI_ERROR_LIST_BIT_3(Status, Message, Severity, PrintSyntax)           \
+    | CLI_ERROR_LIST_BIT(Status, 3)
+
+/* Bits of word Word for the values 0 to CLI_STATUS_CANCELLED */
+#define CLI_ERROR_LIST_WORD(Word)                                              \
+    (((U32)CLI_STATUS_CANCELLED >= ((Word) * 64U) + 63U) ? ~0ULL :            \
+     ((U32)CLI_STATUS_CANCELLED < ((Word) * 64U)) ? 0ULL :                    \
+     ((2ULL << ((U32)CLI_STATUS_CANCELLED - ((Word) * 64U))) - 1ULL))
+
+typedef char CLI_ERROR_LIST_VALUE_CHECK[
+    (((0ULL CLI_ERROR_LIST(CLI_ERROR_LIST_BIT_0)) == CLI_ERROR_LIST_WORD(0)) &&
+     ((0ULL CLI_ERROR_LIST(CLI_ERROR_LIST_BIT_1)) == CLI_ERROR_LIST_WORD(1)) &&
+     ((0ULL CLI_ERROR_LIST(CLI_ERROR_LIST_BIT_2)) == CLI_ERROR_LIST_WORD(2)) &&
+     ((0ULL CLI_ERROR_LIST(CLI_ERROR_LIST_BIT_3)) == CLI_ERROR_LIST_WORD(3)))
+        ? 1 : -1];
+
+/* Reverse history search (Ctrl-R) state of cliGetString() */
+typedef struct _CLI_HISTORY_SEARCH
+{
+    BOOL    Active;
+    /* The query does not match any command, Match is the last match */
+    BOOL    Failed;
+    U16     QueryLength;
+    /* Sequence number of the command in Match, 0 if none */
+    U32     MatchSeq;
+    U8      Query[CLI_MAX_CMD_LINE_LENGTH];
+    U8      Match[CLI_MAX_CMD_LINE_LENGTH];
+} CLI_HISTORY_SEARCH, *PTR_CLI_HISTORY_SEARCH;
+
+/* TAB completion state of cliGetString() */
+typedef struct _CLI_COMPLETION
+{
+    /* Word being completed, not NUL terminated */
+    const U8   *PtrWord;
+    U16         WordLength;
+    /* Number of candidates starting with the word */
+    U16         Count;
+    /* Longest common prefix of the candidates */
+    U16         CommonLength;
+    U8          Common[CLI_MAX_CMD_LINE_LENGTH];
+    /* Candidates are listed to this file instead of collected, NULL if not */
+    FILE       *PtrListFileHandle;
+} CLI_COMPLETION, *PTR_CLI_COMPLETION;
+
 /* This list holds all cli commands not supported by the in-band cli. */
 static const CLI_CMD_INFO *sPtrUnSupportedCliCmdList[] = {
                                                         /* CLI - Upload/Download */
@@ -411,6 +1016,84 @@ extern BOOL cliUartInitSession(void);
  */
 static CLI_STATUS cliPrintFirstHelpMsg( PTR_CLI_SESSION_INFO PtrSessionInfo );
 
+static CLI_STATUS cliTokenizeCmdLine( PU8 String,
+                                      PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                      U32 *PtrTokenCount );
+
+static void cliSortCmdList( PTR_CLI_CMD_LIST PtrCliCmdList );
+
+static void cliBuildCmdIndex( PTR_CLI_CMD_LIST PtrCliCmdList );
+
+static BOOL cliCmdIsCore( PTR_CLI_CMD_NODE PtrCmdNode );
+
+static PTR_CLI_CMD_NODE cliCmdNodeBuf( PTR_CLI_SESSION_INFO PtrSessionInfo );
+
+static PTR_CLI_CMD_NODE cliFindCommand( PTR_CLI_CMD_LIST PtrCliCmdList,
+                                        const U8 *PtrCmdName,
+                                        PTR_CLI_CMD_NODE PtrCmdNodeBuf,
+                                        BOOL *PtrInBandBlocked,
+                                        const CLI_ARG_SCHEMA **PtrPtrArgSchema );
+
+static const CLI_ARG_SCHEMA *cliFindArgSchema( const U8 *PtrCmdName );
+
+static BOOL cliConvertArg( const CLI_ARG_SPEC *PtrArgSpec,
+                           const U8 *PtrToken,
+                           U32 TokenLength,
+                           U32 *PtrValue );
+
+static const CLI_SUBCMD_NODE *cliFindSubCmd( const CLI_SUBCMD_NODE *PtrNode,
+                                             const U8 *PtrToken );
+
+static U32 cliTokenLength( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                           PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                           U32 TokenIndex );
+
+static CLI_STATUS cliWalkSubCmdTree( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                     PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                                     U32 *PtrArgValue,
+                                     const CLI_SUBCMD_NODE *PtrRoot,
+                                     PTR_CLI_SUBCMD_HANDLER *PtrFptrHandler );
+
+static BOOL cliCheckSubCmdTree( const CLI_SUBCMD_NODE *PtrNode, U32 Depth );
+
+static void cliPrintSubCmdTree( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                const CLI_SUBCMD_NODE *PtrNode,
+                                PU8 PtrPath,
+                                U32 PathLength );
+
+static CLI_STATUS cliCheckArgs( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                const CLI_ARG_SCHEMA *PtrArgSchema,
+                                U32 *PtrArgValue,
+                                PTR_CLI_SUBCMD_HANDLER *PtrFptrHandler );
+
+static CLI_STATUS cliExecCmd( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                              const CLI_ARG_SCHEMA *PtrArgSchema,
+                              const U8 *PtrPipeStages );
+
+static PU8 cliSplitCmdLine( PU8 String, U8 Separator );
+
+static BOOL cliSplitJob( PU8 String );
+
+static PU8 cliQuotedTokenEnd( PU8 PtrQuote );
+
+static BOOL cliParseOneCmd( PU8 String,
+                            PTR_CLI_SESSION_INFO PtrSessionInfo,
+                            CLI_STATUS *PtrStatus );
+
+static void cliExecCapture( void *PtrArg, const U8 *PtrData, U32 Length );
+
+static void cliSessionPoolInit( void );
+
+static PTR_CLI_SESSION_SLOT cliSessionSlotTake( void );
+
+static void cliSessionSlotGive( const void *PtrStack );
+
+static void cliSessionStatsMax( U32 *PtrMaxTicks, U32 Ticks );
+
+static PTR_CLI_SESSION_SLOT cliSessionSlotFind( const void *PtrStack );
+
+static void cliSessionThread( U32 ThreadInput );
+
 
 /**
  * @Name: cliCoreInit()
@@ -432,10 +1115,15 @@ void cliCoreInit( void )
     /* Make sure that CLI core is initialized ONLY ONCE */
     if( sCliCoreInitialized == FALSE )
     {
-        sCliCmdList.CliCommandCount = 0;
-        sCliCmdList.PtrCliCmdListHead = NULL;
-        /* Register help command - Help command is registered from core itself */
-        cliRegisterCommand(( PU8 )sCmdHelp, ( PU8 )sHlpHelp, cliPrintHelp, &sCliCmdList);
+        /* Register help command - Help command is registered from core itself.
+         * Its node is static, the core command list is never empty.
+         */
+        sCliHelpCmdNode.Command      = ( PU8 )sCmdHelp;
+        sCliHelpCmdNode.OneLineHelp  = ( PU8 )sHlpHelp;
+        sCliHelpCmdNode.PtrToFunCall = cliPrintHelp;
+        sCliHelpCmdNode.PtrNext      = NULL;
+        sCliCmdList.CliCommandCount = 1;
+        sCliCmdList.PtrCliCmdListHead = &sCliHelpCmdNode;
 
         /* Initialize and Register Debug/Release/OEM specific CLI commands */
         cliReleaseInit(&sCliCmdList);
@@ -445,6 +1133,22 @@ void cliCoreInit( void )
         /* Register IEC and Starmie specific CLI commands. */
         iecCliInit(&sCliCmdList);
         arbokCliInit(&sCliCmdList);
+
+        /* All core commands are registered, sort them by name for the help
+         * listing and freeze the dispatch index.
+         */
+        cliSortCmdList(&sCliCmdList);
+        cliBuildCmdIndex(&sCliCmdList);
+        sPtrCliCmdCoreHead = sCliCmdList.PtrCliCmdListHead;
+
+        /* Mark the input reader objects of the session contexts as not
+         * reserved yet
+         */
+        iecCliSessionInit();
+
+        /* Reserve the thread objects and stacks of the sessions */
+        cliSessionPoolInit();
+
         /* Mark CLI core as initialized */
         sCliCoreInitialized = TRUE;
 
@@ -534,21 +1238,29 @@ BOOL cliCreateSessionEx( PTR_CLI_SESSION_INFO PtrCliSessionInfo,
     HALI_OS_STATUS  retCliStat = HALI_OS_NO_MEMORY;
         
     PTR_CLI_CMD_PROMPT fptrCommandPrompt;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    PTR_CLI_SESSION_SLOT ptrSlot;
+    U32 startTicks;
+    U32 connectTicks;
 
-    /* Allocate space for the CLI session thread object */
-    PtrCliSessionInfo->CliThreadHandle = haliOSAllocateObject(HALI_MEMORY_ID_IMEM,
-                                            HALI_OS_THREAD);
+    startTicks = iecCliOutGetTicks();
 
-    if( PtrCliSessionInfo->CliThreadHandle == HALI_OS_INVALID_HANDLE )
+    /* Take the thread object and the stack of the session from the pool */
+    ptrSlot = cliSessionSlotTake();
+    if( ptrSlot == NULL )
     {
+        __sync_fetch_and_add(&sCliSessionPoolStats.NoSlot, 1);
         return FALSE;
     }
-    /* Allocate space for the stack */
-    if( (PtrCliSessionInfo->PtrCliThreadStack = malloc(CLI_THREAD_STACK_SIZE))
-        == NULL )
+    PtrCliSessionInfo->CliThreadHandle = ptrSlot->ThreadHandle;
+    PtrCliSessionInfo->PtrCliThreadStack = ptrSlot->PtrStack;
+
+    /* Allocate the session context */
+    ptrCtx = iecCliSessionCtxAlloc(PtrCliSessionInfo);
+    if( ptrCtx == NULL )
     {
-        /* Release thread handle object */
-        haliOsReleaseObject(PtrCliSessionInfo->CliThreadHandle);
+        /* Give the slot back */
+        cliSessionSlotGive(ptrSlot->PtrStack);
         return FALSE;
     }
     /* Initialize CLI session .*/
@@ -587,10 +1299,15 @@ BOOL cliCreateSessionEx( PTR_CLI_SESSION_INFO PtrCliSessionInfo,
     /* Determine cli thread entry function to use when creating thread. */
     fptrCommandPrompt = (FptrCmdPrompt) ? FptrCmdPrompt : cliCommandPrompt;
 
+    /* The thread calls it through cliSessionThread(), which tells
+     * cliCloseSession() when it has returned.
+     */
+    ptrCtx->FptrThreadEntry = fptrCommandPrompt;
+
     /* Create a new thread to handle this new CLI session */
     retCliStat = haliOsThreadCreate(PtrCliSessionInfo->CliThreadHandle,
                                             (U8*)PtrCliSessionName, /* CLI session thread name */
-                                            fptrCommandPrompt,     /* thread function*/
+                                            cliSessionThread,      /* thread function*/
                                             (U32)PtrCliSessionInfo, /* input param */
                                             PtrCliSessionInfo->PtrCliThreadStack, /* stack */
                                             CLI_THREAD_STACK_SIZE,
@@ -607,15 +1324,18 @@ BOOL cliCreateSessionEx( PTR_CLI_SESSION_INFO PtrCliSessionInfo,
                         FW_TRACE_MASK_GENERAL,
                         retCliStat );
 
-        
-        cliFreeList(&sCliCmdHistory);
-        
-        /* Release thread handle object */
-        haliOsReleaseObject(PtrCliSessionInfo->CliThreadHandle);
-        /* Free stack */
-        free(PtrCliSessionInfo->PtrCliThreadStack);
+
+        /* Give the slot back */
+        cliSessionSlotGive(ptrSlot->PtrStack);
+        /* Release the session context */
+        iecCliSessionCtxFree(PtrCliSessionInfo);
         return FALSE;
     }
+
+    connectTicks = iecCliOutGetTicks() - startTicks;
+    __sync_fetch_and_add(&sCliSessionPoolStats.Connects, 1);
+    sCliSessionPoolStats.LastConnectTicks = connectTicks;
+    cliSessionStatsMax(&sCliSessionPoolStats.MaxConnectTicks, connectTicks);
     return TRUE;
 }
 
@@ -632,7 +1352,8 @@ BOOL cliCreateSessionEx( PTR_CLI_SESSION_INFO PtrCliSessionInfo,
  *                structure.
  *
  * @return - Returns status of command parsing i.e.
- *          TRUE - Command parsed successfully.
+ *          TRUE - Command parsed successfully, or the command line could
+ *                 not be split and the error was reported.
  *          FALSE - Command parsing failed.
  *
  * @note Parsing will fail if the executing command is part of
@@ -641,113 +1362,243 @@ BOOL cliCreateSessionEx( PTR_CLI_SESSION_INFO PtrCliSessionInfo,
  *****************************************************************************/
 BOOL cliInBandParseCmd( PU8 PtrString, PTR_CLI_SESSION_INFO PtrSessionInfo )
 {
-    /* Counters for looping, token count & token length resp.*/
-    U32     loopCount, tkCount, tkLen;
-    PU8     ptrToken = NULL;
-    CLI_STATUS      retStatus;
-    U32 counter = 0;
-    U16 cmdCount = 0;
+    /* Token count */
+    U32     tkCount;
+    CLI_STATUS tkStatus;
+    BOOL    inBandBlocked = FALSE;
+    const CLI_ARG_SCHEMA *ptrArgSchema = NULL;
 
     tkCount = 0;
-    tkLen = 0;
+    PtrSessionInfo->PtrCurCommand = NULL;
 
-    /* Initialize the Command Param array with null string */
-    for( loopCount = 0 ; loopCount < CLI_MAX_NUM_OF_TOKENS; loopCount++ )
+    /* Separate out the tokens in the command line input.*/
+    tkStatus = cliTokenizeCmdLine( PtrString, PtrSessionInfo, &tkCount );
+    if( (tkStatus == CLI_STATUS_SUCCESS) && (tkCount == 0) )
     {
-        PtrSessionInfo->PtrCmdParams[loopCount] = NULL;
+        return FALSE;
     }
 
-    /* Separate out the tokens in the command line input.*/
-    ptrToken = (PU8)strtok( (char *)PtrString, CLI_CMD_DELIMS );
-
-    while( ptrToken != NULL )
+    /*
+     * Look up the command. The lookup also tells whether the command is in
+     * the unsupported in-band command list.
+     */
+    if( tkCount != 0 )
+    {
+        PtrSessionInfo->PtrCurCommand = cliFindCommand( &PtrSessionInfo->CliCmdList,
+                                                        PtrSessionInfo->PtrCmdParams[0],
+                                                        cliCmdNodeBuf( PtrSessionInfo ),
+                                                        &inBandBlocked,
+                                                        &ptrArgSchema );
+    }
+    if( inBandBlocked == TRUE )
     {
-        tkLen = strlen((const char*)ptrToken);
+        /*
+         * Exceptions to the unsupported list are added here.
+         */
 
-        if( tkLen >= CLI_MAX_TOKEN_LENGTH || tkCount == CLI_MAX_NUM_OF_TOKENS )
+        /* memstat command is allowed but only if the user does not
+         * require the user to provide additional input during command
+         * execution.  The memstat command requires additional input
+         * whenever its spawns an additional thread to output memstat
+         * info on an interval for a specific handle.  This occurs when
+         * the commands token count is greater than one.
+         */
+        if( (strncmp( (const char *)PtrSessionInfo->PtrCmdParams[0],
+                     (const char *)gCliCmdMemstat.PtrCmdName,
+                     CLI_MAX_TOKEN_LENGTH) != 0 ) ||
+            ( tkCount >= 2 ) )
         {
-            /*
-             * if token length is bigger than maximum token buffer
-             * then it will return error.
-             */
+            /* Do not allow command to be executed. */
+            PtrSessionInfo->PtrCurCommand = NULL;
             return FALSE;
         }
+    }
 
-        PtrSessionInfo->PtrCmdParams[tkCount] = (PU8)ptrToken;
-        tkCount++;
-
-        ptrToken = (PU8)strtok( NULL, CLI_CMD_DELIMS );
+    if( tkStatus != CLI_STATUS_SUCCESS )
+    {
+        /* The syntax is shown if the command was found */
+        cliErrorHandler( tkStatus, PtrSessionInfo );
+        iecCliOutFlush( &(PtrSessionInfo->OutFileHandle) );
+        return TRUE;
     }
 
-    /* Number of unsupported commands */
-    cmdCount = sizeof(sPtrUnSupportedCliCmdList)/sizeof(sPtrUnSupportedCliCmdList[0]);
+    if( PtrSessionInfo->PtrCurCommand != NULL )
+    {
+        PtrSessionInfo->TokenInCmdRcd = tkCount;
 
+        /* Check the arguments and call the command handler */
+        cliExecCmd( PtrSessionInfo, ptrArgSchema, NULL );
+
+        /* Write the output of the command before the next prompt. */
+        iecCliOutFlush( &(PtrSessionInfo->OutFileHandle) );
+    }
     /*
-     * Traverse through unsupported command list to determine if this command
-     * can be executed.
+     * Parser status. True - Command found in command database,
+     * False - command not found.
      */
-    for( counter = 0; counter < cmdCount; counter++ )
+    return (PtrSessionInfo->PtrCurCommand != NULL);
+}
+
+/**
+ * @Name:   cliExecCapture()
+ *
+ * @Description: This function is the output sink of a cliExecToBuffer()
+ *               session. It copies the output to the caller buffer, as
+ *               much as fits, and counts all of it.
+ *
+ * @param PtrArg - Output buffer.
+ *
+ * @param PtrData - Output of the command.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void cliExecCapture( void *PtrArg, const U8 *PtrData, U32 Length )
+{
+    PTR_CLI_EXEC_BUFFER ptrExecBuffer = (PTR_CLI_EXEC_BUFFER)PtrArg;
+    U32     chunk = 0;
+
+    /* Keep room for the terminator */
+    if( ptrExecBuffer->Length + 1 < ptrExecBuffer->Size )
     {
-        /* If we find a positive match we will return failed status. */
-        if( strncmp((char *)sPtrUnSupportedCliCmdList[counter]->PtrCmdName,
-            (const char *)(PtrSessionInfo->PtrCmdParams[0]),
-            CLI_MAX_TOKEN_LENGTH ) == 0 )
+        chunk = ptrExecBuffer->Size - 1 - ptrExecBuffer->Length;
+        if( chunk > Length )
         {
-            /*
-             * Exceptions to the unsupported list are added here.
-             */
-
-            /* memstat command is allowed but only if the user does not
-             * require the user to provide additional input during command
-             * execution.  The memstat command requires additional input
-             * whenever its spawns an additional thread to output memstat
-             * info on an interval for a specific handle.  This occurs when
-             * the commands token count is greater than one.
-             */
-            if( (strncmp( (const char *)PtrSessionInfo->PtrCmdParams[0],
-                         (const char *)gCliCmdMemstat.PtrCmdName,
-                         CLI_MAX_TOKEN_LENGTH) == 0 ) &&
-                ( tkCount < 2 ) )
-            {
-                break;
-            }
-            else
-            {
-                /* Do not allow command to be executed. */
-                return FALSE;
-            }
+            chunk = Length;
         }
+
+        memcpy( &ptrExecBuffer->PtrBuffer[ptrExecBuffer->Length], PtrData, chunk );
+        ptrExecBuffer->PtrBuffer[ptrExecBuffer->Length + chunk] = '\0';
     }
 
-    /*
-     * Traverse through CLI command linked list to find a matching command string
-     */
-    for( PtrSessionInfo->PtrCurCommand = PtrSessionInfo->CliCmdList.PtrCliCmdListHead;
-         PtrSessionInfo->PtrCurCommand != NULL;
-         PtrSessionInfo->PtrCurCommand = PtrSessionInfo->PtrCurCommand->PtrNext )
+    ptrExecBuffer->Length += Length;
+}
+
+/**
+ * @Name:   cliExecToBuffer()
+ *
+ * @Description: This function runs a command line, like one typed at the
+ *               prompt, and returns its output in a buffer. It lets
+ *               firmware code reuse the cli commands, e.g. to collect
+ *               health data periodically.
+ *               The command runs in the calling thread, on one of
+ *               CLI_EXEC_SESSION_MAX static sessions: no thread, stack or
+ *               file record is created, only a session context is claimed.
+ *               The caller's stack only needs room for the command handler.
+ *               The session uses the core command list, has no input, and
+ *               its output goes to the buffer through the output sink. Its
+ *               file handle is not a file of the file layer, so only the
+ *               commands whose output can be captured run, see
+ *               cliCmdCaptureSafe(); the others fail with
+ *               CLI_STATUS_INVALID_FUNC_REQ. Command batches and pipes are
+ *               supported, background jobs are not.
+ *
+ * @param PtrCmdLine - Command line.
+ *
+ * @param PtrBuffer - Returns the output, always terminated if Size is not 0.
+ *
+ * @param Size - Size of the buffer. The output that does not fit is
+ *               dropped.
+ *
+ * @param PtrLength - Returns the length of the whole output, more than
+ *               Size - 1 if it was cut. May be NULL.
+ *
+ * @return - Status of the command, of the last one of a batch,
+ *           CLI_STATUS_FAILED if the command is not found,
+ *           CLI_STATUS_CMD_LEN if the command line is too long,
+ *           CLI_STATUS_INSUFF_MEM if no session or session context is free.
+ *
+ *****************************************************************************/
+CLI_STATUS cliExecToBuffer( const U8 *PtrCmdLine,
+                            PU8 PtrBuffer,
+                            U32 Size,
+                            U32 *PtrLength )
+{
+    PTR_CLI_SESSION_INFO ptrSessionInfo = NULL;
+    CLI_EXEC_BUFFER execBuffer;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    CLI_STATUS retStatus;
+    U32 index;
+
+    if( Size > 0 )
     {
-        if( strncmp((char *)(PtrSessionInfo->PtrCurCommand->Command),
-                    (const char *)PtrSessionInfo->PtrCmdParams[0],
-                    CLI_MAX_TOKEN_LENGTH) == 0 )
-        {
-            PtrSessionInfo->TokenInCmdRcd = tkCount;
+        PtrBuffer[0] = '\0';
+    }
+    if( PtrLength != NULL )
+    {
+        *PtrLength = 0;
+    }
 
-            /* Check whether Pointer to function is NULL. */
-            if( PtrSessionInfo->PtrCurCommand->PtrToFunCall != NULL )
-            {
-                /* Call Corresponding callback function. */
-                retStatus = PtrSessionInfo->PtrCurCommand->PtrToFunCall(PtrSessionInfo);
-                cliErrorHandler( retStatus, PtrSessionInfo );
-            }
+    if( strlen( (const char *)PtrCmdLine ) >= CLI_MAX_CMD_LINE_LENGTH )
+    {
+        return CLI_STATUS_CMD_LEN;
+    }
+
+    /* Like an empty line at the prompt */
+    if( PtrCmdLine[strspn((const char *)PtrCmdLine, CLI_CMD_DELIMS)] == '\0' )
+    {
+        return CLI_STATUS_SUCCESS;
+    }
 
+    for( index = 0; index < CLI_EXEC_SESSION_MAX; index++ )
+    {
+        if( (__sync_fetch_and_or(&sCliExecSessionBusy, (1U << index)) &
+             (1U << index)) == 0 )
+        {
+            ptrSessionInfo = &sCliExecSession[index];
             break;
         }
     }
-    /*
-     * Parser status. True - Command found in command database,
-     * False - command not found.
-     */
-    return (PtrSessionInfo->PtrCurCommand != NULL);
+
+    if( ptrSessionInfo == NULL )
+    {
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    memset( ptrSessionInfo, 0, sizeof(*ptrSessionInfo) );
+    ptrSessionInfo->CliCmdList = sCliCmdList;
+    ptrSessionInfo->SessionActive = TRUE;
+
+    ptrCtx = iecCliSessionCtxAlloc( ptrSessionInfo );
+    if( ptrCtx == NULL )
+    {
+        __sync_fetch_and_and(&sCliExecSessionBusy, ~(1U << index));
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    execBuffer.PtrBuffer = PtrBuffer;
+    execBuffer.Size = Size;
+    execBuffer.Length = 0;
+
+    ptrCtx->NoInput = TRUE;
+    ptrCtx->NoFile = TRUE;
+    iecCliOutSetSink( &(ptrSessionInfo->OutFileHandle), cliExecCapture, &execBuffer );
+
+    strcpy( (char *)ptrSessionInfo->inputString, (const char *)PtrCmdLine );
+
+    /* Not set by a batch of empty commands, e.g. ";" */
+    ptrCtx->LastStatus = CLI_STATUS_SUCCESS;
+
+    if( cliParseCmd( ptrSessionInfo->inputString, ptrSessionInfo ) == TRUE )
+    {
+        retStatus = ptrCtx->LastStatus;
+    }
+    else
+    {
+        iecCliOutPuts( (const char *)sPtrCliCmdNotFound, &(ptrSessionInfo->OutFileHandle) );
+        iecCliOutFlush( &(ptrSessionInfo->OutFileHandle) );
+        retStatus = CLI_STATUS_FAILED;
+    }
+
+    iecCliSessionCtxFree( ptrSessionInfo );
+    __sync_fetch_and_and(&sCliExecSessionBusy, ~(1U << index));
+
+    if( PtrLength != NULL )
+    {
+        *PtrLength = execBuffer.Length;
+    }
+
+    return retStatus;
 }
 
 /**
@@ -791,8 +1642,9 @@ void cliInBandCommandPrompt( U32 ThreadInput )
                 if( cliInBandParseCmd(ptrSessionInfo->inputString, ptrSessionInfo)
                         == FALSE )
                 {
-                    fprintf(&(ptrSessionInfo->OutFileHandle), \
-                            (const char*)sPtrCliCmdNotFound);
+                    iecCliOutPuts((const char*)sPtrCliCmdNotFound,
+                                  &(ptrSessionInfo->OutFileHandle));
+                    iecCliOutFlush(&(ptrSessionInfo->OutFileHandle));
                 }
 
                 /* Cli has completed execution of command. */
@@ -815,7 +1667,9 @@ void cliInBandCommandPrompt( U32 ThreadInput )
  *
  * @Description: This function closes the CLI session.
  *              CLI session thread is deleted and releases all resources
- *              attached with the CLI session
+ *              attached with the CLI session. The thread of a pool slot
+ *              is given up to CLI_CLOSE_TIMEOUT_MS to return before it is
+ *              terminated.
  * @param PtrCliSessionInfo - Pointer to the CLI Session Information structure
  *
  * @Note This function returns if CLI thread deletion fails without
@@ -823,57 +1677,49 @@ void cliInBandCommandPrompt( U32 ThreadInput )
  *****************************************************************************/
 void cliCloseSession( PTR_CLI_SESSION_INFO PtrCliSessionInfo )
 {
-    HALI_OS_THREAD_STATE thrdState;
-    U8 loopCount = 0x0;
-
-    /* Set session active flag to false and wait till the cli thread returns */
-    PtrCliSessionInfo->SessionActive = FALSE;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    PTR_CLI_SESSION_SLOT ptrSlot;
+    U32 startTicks;
+    U32 closeTicks;
 
-    haliOsThreadInfoGet(PtrCliSessionInfo->CliThreadHandle,
-                        NULL,
-                        &thrdState,
-                        NULL,
-                        NULL,
-                        NULL,
-                        NULL,
-                        NULL,
-                        NULL);
+    startTicks = iecCliOutGetTicks();
+    ptrCtx = iecCliSessionCtxGet(PtrCliSessionInfo);
+    ptrSlot = cliSessionSlotFind(PtrCliSessionInfo->PtrCliThreadStack);
 
-    /* Wait till the thread is in completed state or max wait time
-       exceeds. The maximum wait time is 200 ms otherwise we will forcefully
-       terminate & delete the thread.
+    /* Set session active flag to false and wait till the cli thread returns.
 
        We wait here so that the thread serving the client will complete
        gracefully. Earlier the client thread used to get terminated abruptly by
        server thread. This abrupt termination used to create problem if the
        serving client thread is in between of some transfer, thus creating packet
        loss situation.
-       E.g., if telnet client thread is transmitting on socket and abruptly the
-       connection is closed by other entity. We used to delete the thread without
-       waiting for it to complete its current task.
        We need to make sure that the thread comes out of the current task
        (specially when in tight loop). This is accomplished with the help of
-       SessionActive flag. Also, we need to make sure that the thread comes out
-       of any wait/sleep state. Our client threads are waiting on semaphore
+       SessionActive flag, and the cancel request stops the commands that
+       check CLI_CANCELLED(). Also, we need to make sure that the thread comes
+       out of any wait/sleep state. Our client threads are waiting on semaphore
        for receive input. When server receives any disconnect, it fills the
        receive buffer with end of session byte (HALI_EOF), so that the thread
-       function returns and thread is in completed state. */
+       function returns.
+
+       cliSessionThread() signals the semaphore of the slot once the thread
+       function has returned, so the wait ends as soon as it does. The thread
+       is terminated if it does not return within CLI_CLOSE_TIMEOUT_MS. */
+    PtrCliSessionInfo->SessionActive = FALSE;
+
+    if( ptrCtx != NULL )
+    {
+        ptrCtx->CancelRequest = TRUE;
+    }
 
-    while( thrdState != HALI_OS_THREAD_STATE_COMPLETED
-           && thrdState != HALI_OS_THREAD_STATE_TERMINATED
-           && loopCount < 10 )
+    if( ptrSlot != NULL )
     {
-        haliOsThreadSleep(20);
-        haliOsThreadInfoGet(PtrCliSessionInfo->CliThreadHandle,
-                            NULL,
-                            &thrdState,
-                            NULL,
-                            NULL,
-                            NULL,
-                            NULL,
-                            NULL,
-                            NULL);
-        loopCount++;
+        if( haliOsSemaphoreGet( ptrSlot->DoneSemHandle,
+                                ( CLI_CLOSE_TIMEOUT_MS * 1000 ) /
+                                haliOsGetMicrosecPerTick() ) != HALI_OS_SUCCESS )
+        {
+            __sync_fetch_and_add(&sCliSessionPoolStats.Terminated, 1);
+        }
     }
 
     /* Terminate the thread. */
@@ -882,62 +1728,314 @@ void cliCloseSession( PTR_CLI_SESSION_INFO PtrCliSessionInfo )
     /* Delete the thread which was serving this CLI Sesstion */
     haliOsThreadDelete(PtrCliSessionInfo->CliThreadHandle);
 
-    /* Release the Object handle for this particular thread */
-    haliOsReleaseObject(PtrCliSessionInfo->CliThreadHandle);
+    /* The jobs of the session have nobody left to show their output to */
+    iecCliJobKillAll(PtrCliSessionInfo);
 
-    /* Free the stack memory for this deleted thread */
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+    /* Write the commands still batched for the persistent history */
+    cliHistoryFlashSync();
+#endif
+
+    /* The input reader thread may still wait for input */
+    iecCliInClose(&(PtrCliSessionInfo->OutFileHandle));
+
+    /* Release the session context */
+    iecCliSessionCtxFree(PtrCliSessionInfo);
+
+    /* Give the thread object and the stack back to the pool, the thread
+     * object is created again by the next session taking the slot. This
+     * comes last: a new session may reuse the session information at once.
+     */
     if( PtrCliSessionInfo->PtrCliThreadStack )
     {
-        free(PtrCliSessionInfo->PtrCliThreadStack);
+        cliSessionSlotGive(PtrCliSessionInfo->PtrCliThreadStack);
     }
+
+    closeTicks = iecCliOutGetTicks() - startTicks;
+    __sync_fetch_and_add(&sCliSessionPoolStats.Closes, 1);
+    sCliSessionPoolStats.LastCloseTicks = closeTicks;
+    cliSessionStatsMax(&sCliSessionPoolStats.MaxCloseTicks, closeTicks);
 }
 
 
 /**
- * @Name:   cliReleaseInit()
+ * @Name:   cliSessionThread()
  *
- * @Description: This function is exported weakly. Default weak implementation
- *               does nothing. This WEAK function can be overridden by
- *               redefining the function to initialize and register release
- *               build specific CLI commands.
- *              Invoked by cliCoreInit() function
+ * @Description: Thread function of the cli sessions. Calls the thread entry
+ *               of the session, then signals the semaphore of its slot to
+ *               tell cliCloseSession() that the thread has returned.
  *
- * @param PtrCliCmdList - Pointer to the CLI Command List
- *               structure.
+ * @param ThreadInput - Pointer to the CLI Session Information structure
  *
  *****************************************************************************/
-WEAK void cliReleaseInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+static void cliSessionThread( U32 ThreadInput )
 {
+    PTR_CLI_SESSION_INFO ptrSessionInfo;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    PTR_CLI_SESSION_SLOT ptrSlot;
+
+    ptrSessionInfo = (PTR_CLI_SESSION_INFO)ThreadInput;
+    ptrSlot = cliSessionSlotFind(ptrSessionInfo->PtrCliThreadStack);
+
+    ptrCtx = iecCliSessionCtxGet(ptrSessionInfo);
+    if( ptrCtx != NULL )
+    {
+        ptrCtx->FptrThreadEntry(ThreadInput);
+    }
+
+    /* The session must not be touched after this, it is being closed */
+    if( ptrSlot != NULL )
+    {
+        haliOsSemaphorePut(ptrSlot->DoneSemHandle);
+    }
 }
 
 
 /**
- * @Name:   cliDebugInit()
- *
- * @Description: This function is exported weakly. Default weak implementation
- *               does nothing. This WEAK function can be overridden by
- *               redefining the function to initialize and register debug
- *               build specific CLI commands.
- *              Invoked by cliCoreInit() function
+ * @Name:   cliSessionPoolInit()
  *
- * @param PtrCliCmdList - Pointer to the CLI Command List
- *               structure.
+ * @Description: Reserves the thread object, the semaphore and the stack of
+ *               each session slot. Called once by cliCoreInit(). The pool
+ *               keeps the slots reserved so far if the memory runs out, the
+ *               sessions beyond them are refused.
  *
  *****************************************************************************/
-WEAK void cliDebugInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+static void cliSessionPoolInit( void )
 {
-}
+    HALI_OS_HANDLE threadHandle;
+    HALI_OS_HANDLE semHandle;
+    void *ptrStack;
+    U32 index;
+    U32 freeMask = 0;
 
-
-/**
- * @Name:   oemCliInit()
- *
- * @Description: This function is exported weakly. Default weak implementation
- *               does nothing. This WEAK function can be overridden by
- *               redefining the function to initialize and register OEM
- *               specific CLI commands.
- *              Invoked by cliCoreInit() function
- *
+    for( index = 0; index < CLI_SESSION_POOL_SIZE; index++ )
+    {
+        threadHandle = haliOSAllocateObject(HALI_MEMORY_ID_IMEM, HALI_OS_THREAD);
+        if( threadHandle == HALI_OS_INVALID_HANDLE )
+        {
+            break;
+        }
+        semHandle = haliOSAllocateObject(HALI_MEMORY_ID_IMEM, HALI_OS_SEMAPHORE);
+        if( semHandle == HALI_OS_INVALID_HANDLE )
+        {
+            haliOsReleaseObject(threadHandle);
+            break;
+        }
+        if( haliOsSemaphoreCreate(semHandle, (U8 *)"CLI Done", 0) != HALI_OS_SUCCESS )
+        {
+            haliOsReleaseObject(semHandle);
+            haliOsReleaseObject(threadHandle);
+            break;
+        }
+        if( (ptrStack = malloc(CLI_THREAD_STACK_SIZE)) == NULL )
+        {
+            haliOsSemaphoreDelete(semHandle);
+            haliOsReleaseObject(semHandle);
+            haliOsReleaseObject(threadHandle);
+            break;
+        }
+        sCliSessionSlot[index].ThreadHandle = threadHandle;
+        sCliSessionSlot[index].DoneSemHandle = semHandle;
+        sCliSessionSlot[index].PtrStack = ptrStack;
+        freeMask |= (1U << index);
+    }
+
+    memset(&sCliSessionPoolStats, 0, sizeof(sCliSessionPoolStats));
+    sCliSessionPoolStats.Slots = index;
+    sCliSessionSlotFree = freeMask;
+}
+
+
+/**
+ * @Name:   cliSessionSlotTake()
+ *
+ * @Description: Takes the lowest free session slot. A signal left on its
+ *               semaphore by a thread that returned after its close timed
+ *               out is dropped.
+ *
+ * @return  Pointer to the slot, NULL if none is free
+ *
+ *****************************************************************************/
+static PTR_CLI_SESSION_SLOT cliSessionSlotTake( void )
+{
+    U32 freeMask;
+    U32 index;
+
+    do
+    {
+        freeMask = sCliSessionSlotFree;
+        if( freeMask == 0 )
+        {
+            return NULL;
+        }
+        index = (U32)__builtin_ctz(freeMask);
+    } while( !__sync_bool_compare_and_swap(&sCliSessionSlotFree,
+                                           freeMask,
+                                           freeMask & ~(1U << index)) );
+
+    while( haliOsSemaphoreGet( sCliSessionSlot[index].DoneSemHandle,
+                               HALI_OS_NO_WAIT ) == HALI_OS_SUCCESS )
+    {
+    }
+
+    return &sCliSessionSlot[index];
+}
+
+
+/**
+ * @Name:   cliSessionSlotGive()
+ *
+ * @Description: Gives a session slot back to the pool. The slot is found
+ *               by its stack, a stack that is not from the pool is ignored.
+ *
+ * @param PtrStack - Stack of the session
+ *
+ *****************************************************************************/
+static void cliSessionSlotGive( const void *PtrStack )
+{
+    PTR_CLI_SESSION_SLOT ptrSlot;
+
+    ptrSlot = cliSessionSlotFind(PtrStack);
+    if( ptrSlot != NULL )
+    {
+        __sync_fetch_and_or(&sCliSessionSlotFree,
+                            1U << (U32)(ptrSlot - sCliSessionSlot));
+    }
+}
+
+
+/**
+ * @Name:   cliSessionSlotFind()
+ *
+ * @Description: Finds a session slot by its stack.
+ *
+ * @param PtrStack - Stack of the session
+ *
+ * @return  Pointer to the slot, NULL if the stack is not from the pool
+ *
+ *****************************************************************************/
+static PTR_CLI_SESSION_SLOT cliSessionSlotFind( const void *PtrStack )
+{
+    U32 index;
+
+    if( PtrStack == NULL )
+    {
+        return NULL;
+    }
+
+    for( index = 0; index < sCliSessionPoolStats.Slots; index++ )
+    {
+        if( sCliSessionSlot[index].PtrStack == PtrStack )
+        {
+            return &sCliSessionSlot[index];
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @Name:   cliSessionStatsMax()
+ *
+ * @Description: Raises a maximum time of the session statistics. Sessions
+ *               are created and closed from several server threads, so the
+ *               maximum is replaced with compare and swap.
+ *
+ * @param PtrMaxTicks - Maximum time, in OS ticks
+ *
+ * @param Ticks - New time, in OS ticks
+ *
+ *****************************************************************************/
+static void cliSessionStatsMax( U32 *PtrMaxTicks, U32 Ticks )
+{
+    U32 maxTicks;
+
+    do
+    {
+        maxTicks = *(volatile U32 *)PtrMaxTicks;
+        if( Ticks <= maxTicks )
+        {
+            return;
+        }
+    } while( !__sync_bool_compare_and_swap(PtrMaxTicks, maxTicks, Ticks) );
+}
+
+
+/**
+ * @Name:   cliSessionPoolStats()
+ *
+ * @Description: Returns the statistics of the session slot pool.
+ *
+ * @param PtrStats - Filled with the statistics
+ *
+ * @param Clear - TRUE to clear the counters and the connect times after
+ *                reading them
+ *
+ *****************************************************************************/
+void cliSessionPoolStats( PTR_CLI_SESSION_POOL_STATS PtrStats, BOOL Clear )
+{
+    *PtrStats = sCliSessionPoolStats;
+    PtrStats->FreeSlots = (U32)__builtin_popcount(sCliSessionSlotFree);
+
+    if( Clear )
+    {
+        sCliSessionPoolStats.Connects = 0;
+        sCliSessionPoolStats.NoSlot = 0;
+        sCliSessionPoolStats.LastConnectTicks = 0;
+        sCliSessionPoolStats.MaxConnectTicks = 0;
+        sCliSessionPoolStats.Closes = 0;
+        sCliSessionPoolStats.Terminated = 0;
+        sCliSessionPoolStats.LastCloseTicks = 0;
+        sCliSessionPoolStats.MaxCloseTicks = 0;
+    }
+}
+
+
+/**
+ * @Name:   cliReleaseInit()
+ *
+ * @Description: This function is exported weakly. Default weak implementation
+ *               does nothing. This WEAK function can be overridden by
+ *               redefining the function to initialize and register release
+ *               build specific CLI commands.
+ *              Invoked by cliCoreInit() function
+ *
+ * @param PtrCliCmdList - Pointer to the CLI Command List
+ *               structure.
+ *
+ *****************************************************************************/
+WEAK void cliReleaseInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+{
+}
+
+
+/**
+ * @Name:   cliDebugInit()
+ *
+ * @Description: This function is exported weakly. Default weak implementation
+ *               does nothing. This WEAK function can be overridden by
+ *               redefining the function to initialize and register debug
+ *               build specific CLI commands.
+ *              Invoked by cliCoreInit() function
+ *
+ * @param PtrCliCmdList - Pointer to the CLI Command List
+ *               structure.
+ *
+ *****************************************************************************/
+WEAK void cliDebugInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+{
+}
+
+
+/**
+ * @Name:   oemCliInit()
+ *
+ * @Description: This function is exported weakly. Default weak implementation
+ *               does nothing. This WEAK function can be overridden by
+ *               redefining the function to initialize and register OEM
+ *               specific CLI commands.
+ *              Invoked by cliCoreInit() function
+ *
  * @param PtrCliCmdList - Pointer to the CLI Command List
  *               structure.
  *
@@ -986,6 +2084,9 @@ PTR_CLI_SESSION_INFO cliFwFaultConsoleInit( void )
         ptrSessionInfo->fptrDisplyHelp = cliPrintFirstHelpMsg;
         ptrSessionInfo->SessionActive = TRUE;
 
+        /* The fault console still parses without a context */
+        iecCliSessionCtxAlloc(ptrSessionInfo);
+
         /* Register help command - Help command is registered from core itself */
         cliRegisterCommand(( PU8 )sCmdHelp, ( PU8 )sHlpHelp,
                             cliPrintHelp, &ptrSessionInfo->CliCmdList);
@@ -1078,7 +2179,14 @@ void cliCommandPrompt( U32 ThreadInput )
     /* While session is active */
     while( ptrSessionInfo->SessionActive == TRUE )
     {
-        fprintf(&(ptrSessionInfo->OutFileHandle), "\r\n cmd >");
+        iecCliOutPuts((const char *)sPtrCliPrompt, &(ptrSessionInfo->OutFileHandle));
+        /* With queued input, e.g. a pasted block, the prompt goes out with
+         * the echo of the next command.
+         */
+        if( iecCliInPending(&(ptrSessionInfo->OutFileHandle)) == 0 )
+        {
+            iecCliOutFlush(&(ptrSessionInfo->OutFileHandle));
+        }
         /* Clear the choice array which hold the cli command input. */
         memset(ptrSessionInfo->inputString, 0, CLI_MAX_CMD_LINE_LENGTH);
 
@@ -1086,7 +2194,7 @@ void cliCommandPrompt( U32 ThreadInput )
         ptrSessionInfo->fptrGetCommandString( ptrSessionInfo->inputString, \
                                               &(ptrSessionInfo->OutFileHandle));
         
-        fflush( &(ptrSessionInfo->OutFileHandle) ); /* make sure newline is echoed */
+        iecCliOutFlush( &(ptrSessionInfo->OutFileHandle) ); /* make sure newline is echoed */
 
         /* check if command is not empty or CR or EOF then process it. */
         /* EOF is treated as end of CLI session and we don't want to process it.*/
@@ -1113,6 +2221,8 @@ void cliCommandPrompt( U32 ThreadInput )
  *
  * @Description: This function registers the command string, the help string
  *               and the Command Handler function into CLI command list.
+ *               The command gets a heap allocated node, the modules with a
+ *               command table use cliRegisterCommandTable() instead.
  *
  * @param PtrCmdName - Command name string
  *
@@ -1154,379 +2264,2877 @@ CLI_STATUS cliRegisterCommand( PU8 PtrCmdName, PU8 PtrOneLineHelp,
 
 
 /**
- * @Name:   cliParseCmd()
+ * @Name:   cliRegisterCommandTable()
  *
- * @Description: This function parses the command line input and
- *             calls the corresponding command handler function
- *             if parsing is done successfully.
+ * @Description: This function registers a whole table of commands into CLI
+ *               command list. Modules call it from their init function with
+ *               their read only CLI_CMD_INFO table instead of registering the
+ *               commands one by one.
+ *               On the core command list, before cliCoreInit() is done, only
+ *               the pointer to the table is kept: the commands are merged in
+ *               the dispatch index and use no memory of their own. On any
+ *               other list, or once the table slots are used up, each
+ *               command is registered with cliRegisterCommand().
  *
- * @param String - Command line input command.
+ * @param PtrCmdTable - Table of pointers to the command info structures.
+ *               Must stay valid, it is not copied.
  *
- * @param PtrSessionInfo - Pointer to the CLI session information
- *                structure.
+ * @param CmdCount - Number of entries in PtrCmdTable.
  *
- * @return - Returns status of command parsing i.e.
- *          TRUE - Command parsed successfully.
- *          FALSE - Command parsing failed.
+ * @param PtrCliCmdList - Pointer to CLI command List
+ *               structure.
+ *
+ * @return - Status of Command registration - Pass/Fail.
  *
  *****************************************************************************/
-BOOL cliParseCmd( PU8 String, PTR_CLI_SESSION_INFO PtrSessionInfo )
+CLI_STATUS cliRegisterCommandTable( const CLI_CMD_INFO * const *PtrCmdTable,
+                                    U16 CmdCount,
+                                    PTR_CLI_CMD_LIST PtrCliCmdList )
 {
-    /* Counters for looping, token count & token length resp.*/
-    U32     loopCount, tkCount, tkLen;
-    PU8     ptrToken = NULL;
-    CLI_STATUS      retStatus;
-
-    tkCount = 0;
-    tkLen = 0;
+    U16 index;
+    CLI_STATUS status;
 
-    /* Initialize the Command Param array with null string */
-    for( loopCount = 0 ; loopCount < CLI_MAX_NUM_OF_TOKENS; loopCount++ )
+    if( (PtrCliCmdList == &sCliCmdList) &&
+        (sCliCoreInitialized == FALSE) &&
+        (sCliCmdTableCount < CLI_CMD_TABLE_MAX) )
     {
-        PtrSessionInfo->PtrCmdParams[loopCount] = NULL;
-    }
+        sPtrCliCmdTable[sCliCmdTableCount] = PtrCmdTable;
+        sCliCmdTableSize[sCliCmdTableCount] = CmdCount;
+        sCliCmdTableCount++;
 
-    /* Separate out the tokens in the command line input.*/
-    ptrToken = (PU8)strtok( (char *)String, CLI_CMD_DELIMS );
+        return CLI_STATUS_SUCCESS;
+    }
 
-    while( ptrToken != NULL )
+    for( index = 0; index < CmdCount; index++ )
     {
-        tkLen = strlen((const char*)ptrToken);
-
-        if( tkLen >= CLI_MAX_TOKEN_LENGTH || tkCount == CLI_MAX_NUM_OF_TOKENS )
+        status = cliRegisterCommand( PtrCmdTable[index]->PtrCmdName,
+                                     PtrCmdTable[index]->PtrOneLineHelp,
+                                     PtrCmdTable[index]->PtrToFunCall,
+                                     PtrCliCmdList );
+        if( status != CLI_STATUS_SUCCESS )
         {
-            /*
-             * if token length is bigger than maximum token buffer
-             * then it will return error.
-             */
-            return FALSE;
+            return status;
         }
-
-        PtrSessionInfo->PtrCmdParams[tkCount] = (PU8)ptrToken;
-        tkCount++;
-
-        ptrToken = (PU8)strtok( NULL, CLI_CMD_DELIMS );
     }
 
-    /*
-     * Traverse through CLI command linked list to find a matching command string
-     */
+    return CLI_STATUS_SUCCESS;
+}
 
-    for( PtrSessionInfo->PtrCurCommand = PtrSessionInfo->CliCmdList.PtrCliCmdListHead;
-         PtrSessionInfo->PtrCurCommand != NULL;
-         PtrSessionInfo->PtrCurCommand = PtrSessionInfo->PtrCurCommand->PtrNext )
+/**
+ * @Name:   cliRegisterArgSchemaTable()
+ *
+ * @Description: This function registers a table of command argument schemas.
+ *               It must be called from the module init function invoked by
+ *               cliCoreInit(), before the dispatch index is built.
+ *
+ * @param PtrSchemaTable - Table of pointers to the argument schemas.
+ *
+ * @param SchemaCount - Number of entries in PtrSchemaTable.
+ *
+ * @return - CLI_STATUS_SUCCESS.
+ *           CLI_STATUS_INSUFF_MEM if more than CLI_ARG_SCHEMA_MAX schemas are
+ *           registered.
+ *           CLI_STATUS_INVALID_PARAMETER if a subcommand tree is not sorted.
+ *           The schemas in front of the failing one stay registered.
+ *
+ *****************************************************************************/
+CLI_STATUS cliRegisterArgSchemaTable( const CLI_ARG_SCHEMA * const *PtrSchemaTable,
+                                      U16 SchemaCount )
+{
+    U16 index;
+
+    for( index = 0; index < SchemaCount; index++ )
     {
+        if( sCliArgSchemaCount >= CLI_ARG_SCHEMA_MAX )
+        {
+            return CLI_STATUS_INSUFF_MEM;
+        }
 
-        if( strncmp((char *)(PtrSessionInfo->PtrCurCommand->Command),
-                    (const char *)PtrSessionInfo->PtrCmdParams[0],
-                    CLI_MAX_TOKEN_LENGTH) == 0 )
+        if( (PtrSchemaTable[index]->PtrSubCmdTree != NULL) &&
+            (cliCheckSubCmdTree(PtrSchemaTable[index]->PtrSubCmdTree, 0) == FALSE) )
         {
-            PtrSessionInfo->TokenInCmdRcd = tkCount;
-            /* Check whether Pointer to function is NULL. */
-            if( PtrSessionInfo->PtrCurCommand->PtrToFunCall != NULL )
-            {
-                /* Call Corresponding callback function. */
-                retStatus = PtrSessionInfo->PtrCurCommand->PtrToFunCall(PtrSessionInfo);
-                cliErrorHandler( retStatus, PtrSessionInfo );
-            }
-            break;
+            return CLI_STATUS_INVALID_PARAMETER;
         }
+
+        sPtrCliArgSchema[sCliArgSchemaCount++] = PtrSchemaTable[index];
     }
-    /*
-     * Parser status. True - Command found in command database,
-     * False - command not found.
-     */
-    return (PtrSessionInfo->PtrCurCommand != NULL);
-}
 
+    return CLI_STATUS_SUCCESS;
+}
 
 /**
+ * @Name:   cliRegisterCaptureTable()
  *
- * @Name:   cliPrintFirstHelpMsg()
+ * @Description: This function registers a table of commands that write
+ *               their output only through CLI_PRINTF() and the iecCliOut
+ *               functions, never with fprintf() or fflush() on the session
+ *               file handle. Only these commands run where the output is
+ *               captured away from a real file handle: in a background job
+ *               and in cliExecToBuffer().
  *
- * @Description: This function displays the first single line help message at the
- *               start of a new CLI session.
+ * @param PtrCmdTable - Table of pointers to the command info structures.
+ *               Must stay valid, it is not copied.
  *
- * @param PtrSessionInfo - Pointer to the CLI session information
- *                structure.
+ * @param CmdCount - Number of entries in PtrCmdTable.
+ *
+ * @return - CLI_STATUS_SUCCESS.
+ *           CLI_STATUS_INSUFF_MEM if more than CLI_CAPTURE_TABLE_MAX tables
+ *           are registered.
  *
  *****************************************************************************/
-static CLI_STATUS cliPrintFirstHelpMsg( PTR_CLI_SESSION_INFO PtrSessionInfo )
+CLI_STATUS cliRegisterCaptureTable( const CLI_CMD_INFO * const *PtrCmdTable,
+                                    U16 CmdCount )
 {
-    /* Display Initial Help for User. */
-    fprintf(&(PtrSessionInfo->OutFileHandle),
-        "\r\n\n Enter 'help' to display a list of commands");
+    if( sCliCaptureTableCount >= CLI_CAPTURE_TABLE_MAX )
+    {
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    sPtrCliCaptureTable[sCliCaptureTableCount] = PtrCmdTable;
+    sCliCaptureTableSize[sCliCaptureTableCount] = CmdCount;
+    sCliCaptureTableCount++;
 
     return CLI_STATUS_SUCCESS;
 }
 
-
 /**
+ * @Name:   cliCmdCaptureSafe()
  *
- * @Name:   cliPrintHelp()
- *
- * @Description: This function displays CLI help. It displays
- *             command name and syntax for command.
- *
- * @param PtrSessionInfo - Pointer to the CLI session information
- *                structure.
+ * @Description: This function tells if the output of a command can be
+ *               captured, i.e. if its handler is help or is registered with
+ *               cliRegisterCaptureTable().
  *
- * @Note: This function displays help string of the specified command. All registered
- *  commands help strings are displayed if no command is specified as cmd parameter
+ * @param PtrCmdNode - Command node of the command.
  *
- * @return result of command execution.
+ * @return - TRUE if the command can run with its output captured.
  *
  *****************************************************************************/
-CLI_STATUS cliPrintHelp( PTR_CLI_SESSION_INFO PtrSessionInfo )
+BOOL cliCmdCaptureSafe( PTR_CLI_CMD_NODE PtrCmdNode )
 {
-    PTR_CLI_CMD_NODE PtrCmdNode = PtrSessionInfo->CliCmdList.PtrCliCmdListHead;
-
-    /* Display the help Menu. */
-    fprintf(&(PtrSessionInfo->OutFileHandle),"\r\n\n%s\r\n\n%s\r\n\n%s\r\n\n",
-                gPtrCliPrintHeader,sPtrHelpHeader,gPtrCliPrintHeader);
+    U16 table;
+    U16 index;
 
-    /* Print help string of all registred command if no argument is passed */
-    if( PtrSessionInfo->PtrCmdParams[1] == NULL )
+    if( PtrCmdNode->PtrToFunCall == cliPrintHelp )
     {
-        for( ; PtrCmdNode ; PtrCmdNode = PtrCmdNode->PtrNext )
-        {
-            fprintf( &(PtrSessionInfo->OutFileHandle),
-            (const char *)(PtrCmdNode->OneLineHelp) );
-        }
+        return TRUE;
     }
-    else
+
+    for( table = 0; table < sCliCaptureTableCount; table++ )
     {
-        for( ; PtrCmdNode ; PtrCmdNode = PtrCmdNode->PtrNext )
+        for( index = 0; index < sCliCaptureTableSize[table]; index++ )
         {
-            if( strncmp((char *)(PtrCmdNode->Command),
-                        (const char *)PtrSessionInfo->PtrCmdParams[1],
-                        CLI_MAX_TOKEN_LENGTH) == 0 )
+            if( sPtrCliCaptureTable[table][index]->PtrToFunCall ==
+                PtrCmdNode->PtrToFunCall )
             {
-                fprintf( &(PtrSessionInfo->OutFileHandle),
-                     (const char *)(PtrCmdNode->OneLineHelp) );
-                break;
+                return TRUE;
             }
         }
-
-        /* Print error msg is the specified command not found */
-        if( !PtrCmdNode )
-            fprintf(&(PtrSessionInfo->OutFileHandle), (const char*)sPtrCliCmdNotFound);
     }
 
-    fprintf(&(PtrSessionInfo->OutFileHandle),"\r\n\n%s", gPtrCliPrintHeader);
-
-    return CLI_STATUS_SUCCESS;
+    return FALSE;
 }
 
 /**
- * @Name:   cliGetString()
+ * @Name:   cliRegisterReadOnlyTable()
  *
- * @Description: This function reads user input string using getchar
- *            function. This is the default function used by
- *            CLI core to read input string.
+ * @Description: This function registers a table of command and subcommand
+ *               handlers that only read the state of the device, whatever
+ *               their arguments. A session in read only mode, e.g. the
+ *               command line run again and again by watch, calls only these
+ *               handlers.
  *
- * @param  PtrInputBuff - memory pointer to store user input string
+ * @param PtrHandlerTable - Table of handlers. Must stay valid, it is not
+ *               copied.
  *
- * @param PtrOutFileHandle File Handle pointer
+ * @param HandlerCount - Number of entries in PtrHandlerTable.
  *
- * @return result of command execution.
+ * @return - CLI_STATUS_SUCCESS.
+ *           CLI_STATUS_INSUFF_MEM if more than CLI_READ_ONLY_TABLE_MAX tables
+ *           are registered.
  *
  *****************************************************************************/
-void cliGetString( PU8 PtrInputBuff, FILE *PtrOutFileHandle )
+CLI_STATUS cliRegisterReadOnlyTable( const PTR_CLI_SUBCMD_HANDLER *PtrHandlerTable,
+                                     U16 HandlerCount )
 {
-    S32     userInput;
-    U32     indexCounter = 0;
-    BOOL    spaceInput = FALSE;
-    static U8 counter = 0;
-
-    PTR_CLI_CMD_HISTORY historyNode = &sCliCmdHistory;
-    U8 keyTimes = 0;
-    BOOL arrowFlag = FALSE;
-    char* lastResult = NULL;
-    U8 maxLength = 0;
-    
-    
-    do
+    if( sCliReadOnlyTableCount >= CLI_READ_ONLY_TABLE_MAX )
     {
-        /* Read User Input - one char at a time. */
-        userInput = fgetc(PtrOutFileHandle);   
-        if( ((indexCounter == 0) && (userInput == CLI_BACKSPACE)) )
-        {
-            /* Do not echo backspace when command is empty. */
-            continue;
-        }
-        else if( userInput == HALI_EOF )
-        {
-            PtrInputBuff[0] = (U8)userInput;
-            break;
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    sPtrCliReadOnlyTable[sCliReadOnlyTableCount] = PtrHandlerTable;
+    sCliReadOnlyTableSize[sCliReadOnlyTableCount] = HandlerCount;
+    sCliReadOnlyTableCount++;
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   cliHandlerReadOnly()
+ *
+ * @Description: This function tells if a handler only reads the state of
+ *               the device, i.e. if it is help or is registered with
+ *               cliRegisterReadOnlyTable().
+ *
+ * @param FptrHandler - Command or subcommand handler.
+ *
+ * @return - TRUE if the handler is read-only.
+ *
+ *****************************************************************************/
+BOOL cliHandlerReadOnly( PTR_CLI_SUBCMD_HANDLER FptrHandler )
+{
+    U16 table;
+    U16 index;
+
+    if( FptrHandler == cliPrintHelp )
+    {
+        return TRUE;
+    }
+
+    for( table = 0; table < sCliReadOnlyTableCount; table++ )
+    {
+        for( index = 0; index < sCliReadOnlyTableSize[table]; index++ )
+        {
+            if( sPtrCliReadOnlyTable[table][index] == FptrHandler )
+            {
+                return TRUE;
+            }
+        }
+    }
+
+    return FALSE;
+}
+
+
+/**
+ * @Name:   cliSortCmdList()
+ *
+ * @Description: This function sorts the CLI command list by command name,
+ *               using an in place bottom up merge sort. The sort is stable,
+ *               so of two commands with the same name the one found first
+ *               by the list walk stays first.
+ *
+ * @param PtrCliCmdList - Pointer to CLI command List
+ *               structure.
+ *
+ *****************************************************************************/
+static void cliSortCmdList( PTR_CLI_CMD_LIST PtrCliCmdList )
+{
+    PTR_CLI_CMD_NODE ptrLeft;
+    PTR_CLI_CMD_NODE ptrRight;
+    PTR_CLI_CMD_NODE ptrRest;
+    PTR_CLI_CMD_NODE ptrTail;
+    PTR_CLI_CMD_NODE ptrNode;
+    U32 runLength;
+    U32 leftCount;
+    U32 rightCount;
+    U32 mergeCount;
+
+    for( runLength = 1; ; runLength *= 2 )
+    {
+        ptrRest = PtrCliCmdList->PtrCliCmdListHead;
+        PtrCliCmdList->PtrCliCmdListHead = NULL;
+        ptrTail = NULL;
+        mergeCount = 0;
+
+        while( ptrRest != NULL )
+        {
+            mergeCount++;
+
+            /* Split off the left run */
+            ptrLeft = ptrRest;
+            for( leftCount = 0;
+                 (leftCount < runLength) && (ptrRest != NULL);
+                 leftCount++ )
+            {
+                ptrRest = ptrRest->PtrNext;
+            }
+
+            /* Split off the right run */
+            ptrRight = ptrRest;
+            for( rightCount = 0;
+                 (rightCount < runLength) && (ptrRest != NULL);
+                 rightCount++ )
+            {
+                ptrRest = ptrRest->PtrNext;
+            }
+
+            /* Merge both runs to the tail of the sorted list */
+            while( (leftCount > 0) || (rightCount > 0) )
+            {
+                if( (rightCount == 0) ||
+                    ((leftCount > 0) &&
+                     (strncmp((const char *)ptrLeft->Command,
+                              (const char *)ptrRight->Command,
+                              CLI_MAX_TOKEN_LENGTH) <= 0)) )
+                {
+                    ptrNode = ptrLeft;
+                    ptrLeft = ptrLeft->PtrNext;
+                    leftCount--;
+                }
+                else
+                {
+                    ptrNode = ptrRight;
+                    ptrRight = ptrRight->PtrNext;
+                    rightCount--;
+                }
+
+                if( ptrTail == NULL )
+                {
+                    PtrCliCmdList->PtrCliCmdListHead = ptrNode;
+                }
+                else
+                {
+                    ptrTail->PtrNext = ptrNode;
+                }
+                ptrTail = ptrNode;
+            }
+        }
+
+        if( ptrTail != NULL )
+        {
+            ptrTail->PtrNext = NULL;
+        }
+
+        /* Done once a pass needed only a single merge */
+        if( mergeCount <= 1 )
+        {
+            break;
+        }
+    }
+}
+
+
+/**
+ * @Name:   cliParseCmd()
+ *
+ * @Description: This function parses the command line input and
+ *             calls the corresponding command handler function
+ *             if parsing is done successfully.
+ *             A line with several commands separated by ';' is run as a
+ *             batch: the commands run back to back and the output is
+ *             flushed once at the end. A command not found is reported in
+ *             place. If the session context asks for it, the batch stops at
+ *             the first command that does not return CLI_STATUS_SUCCESS.
+ *             A command cancelled with Ctrl-C always ends the batch.
+ *
+ * @param String - Command line input command.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @return - Returns status of command parsing i.e.
+ *          TRUE - Command parsed successfully, always for a batch.
+ *          FALSE - Command parsing failed.
+ *
+ *****************************************************************************/
+BOOL cliParseCmd( PU8 String, PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    CLI_STATUS retStatus;
+    PU8     ptrCmd = String;
+    PU8     ptrNext;
+    BOOL    found;
+
+    ptrNext = cliSplitCmdLine( ptrCmd, CLI_CMD_SEPARATOR );
+    if( ptrNext == NULL )
+    {
+        found = cliParseOneCmd( String, PtrSessionInfo, &retStatus );
+
+        /* Write the output of the command before the next prompt. */
+        iecCliOutFlush( &(PtrSessionInfo->OutFileHandle) );
+
+        return found;
+    }
+
+    ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+
+    for( ; ; )
+    {
+        /* Skip empty commands, e.g. after a trailing ';' */
+        if( ptrCmd[strspn((const char *)ptrCmd, CLI_CMD_DELIMS)] != '\0' )
+        {
+            if( cliParseOneCmd( ptrCmd, PtrSessionInfo, &retStatus ) == FALSE )
+            {
+                iecCliOutPuts( (const char *)sPtrCliCmdNotFound,
+                               &(PtrSessionInfo->OutFileHandle) );
+                retStatus = CLI_STATUS_FAILED;
+            }
+
+            /* Ctrl-C stops the whole batch */
+            if( retStatus == CLI_STATUS_CANCELLED )
+            {
+                break;
+            }
+
+            if( (retStatus != CLI_STATUS_SUCCESS) &&
+                (ptrCtx != NULL) && (ptrCtx->BatchStopOnError == TRUE) )
+            {
+                break;
+            }
+        }
+
+        if( ptrNext == NULL )
+        {
+            break;
+        }
+
+        ptrCmd = ptrNext;
+        ptrNext = cliSplitCmdLine( ptrCmd, CLI_CMD_SEPARATOR );
+    }
+
+    /* Write the output of the whole batch before the next prompt. */
+    iecCliOutFlush( &(PtrSessionInfo->OutFileHandle) );
+
+    return TRUE;
+}
+
+
+/**
+ * @Name:   cliSplitCmdLine()
+ *
+ * @Description: This function terminates the command line at its first
+ *               separator, e.g. the ';' after the first command of a
+ *               command batch or the '|' before the pipe stages of a
+ *               command. A separator in a quoted token is part of the
+ *               token, see cliQuotedTokenEnd().
+ *
+ * @param String - Command line input.
+ *
+ * @param Separator - Separator character.
+ *
+ * @return - Start of the text after the separator, NULL if the line has no
+ *           separator.
+ *
+ *****************************************************************************/
+static PU8 cliSplitCmdLine( PU8 String, U8 Separator )
+{
+    BOOL    tokenStart = TRUE;
+
+    for( ; *String != '\0'; String++ )
+    {
+        if( (*String == '"') && (tokenStart == TRUE) )
+        {
+            /* A token follows the closing quote right away */
+            String = cliQuotedTokenEnd( String );
+            if( *String == '\0' )
+            {
+                /* The tokenizer reports the missing quote */
+                break;
+            }
+        }
+        else if( *String == Separator )
+        {
+            *String = '\0';
+            return String + 1;
+        }
+        else
+        {
+            tokenStart = (strchr(CLI_CMD_DELIMS, *String) != NULL);
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @Name:   cliSplitJob()
+ *
+ * @Description: This function removes the '&' ending a command to run as a
+ *               background job. A '&' in a quoted token is part of the
+ *               token, see cliQuotedTokenEnd().
+ *
+ * @param String - Command line input command.
+ *
+ * @return - TRUE if the command is to run as a background job.
+ *
+ *****************************************************************************/
+static BOOL cliSplitJob( PU8 String )
+{
+    PU8     ptrChar;
+    PU8     ptrLast = NULL;
+    BOOL    tokenStart = TRUE;
+
+    for( ptrChar = String; *ptrChar != '\0'; ptrChar++ )
+    {
+        if( (*ptrChar == '"') && (tokenStart == TRUE) )
+        {
+            ptrChar = cliQuotedTokenEnd( ptrChar );
+            if( *ptrChar == '\0' )
+            {
+                /* The tokenizer reports the missing quote */
+                return FALSE;
+            }
+
+            /* The closing quote ends the line unless a token follows */
+            ptrLast = ptrChar;
+        }
+        else if( strchr(CLI_CMD_DELIMS, *ptrChar) == NULL )
+        {
+            ptrLast = ptrChar;
+            tokenStart = FALSE;
+        }
+        else
+        {
+            tokenStart = TRUE;
+        }
+    }
+
+    if( (ptrLast == NULL) || (*ptrLast != CLI_CMD_JOB_SUFFIX) )
+    {
+        return FALSE;
+    }
+
+    /* Also drop the delimiters before the '&' */
+    do
+    {
+        *ptrLast-- = '\0';
+    } while( (ptrLast >= String) && (strchr(CLI_CMD_DELIMS, *ptrLast) != NULL) );
+
+    return TRUE;
+}
+
+
+/**
+ * @Name:   cliParseOneCmd()
+ *
+ * @Description: This function parses one command and calls the
+ *             corresponding command handler function if parsing is done
+ *             successfully. The output is not flushed.
+ *             A command ending with '&' is started as a background job
+ *             instead, see iecCliJob.c. The output of a command followed
+ *             by '|' goes through the pipe stages, see iecCliPipe.c.
+ *
+ * @param String - Command line input command.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrStatus - Returns the status of the command handler, or the
+ *                status of the tokenizer if the command line could not be
+ *                split, CLI_STATUS_SUCCESS if the command was not found.
+ *
+ * @return - TRUE - Command found in command database, or the command line
+ *                  could not be split and the error was reported.
+ *           FALSE - Command parsing failed.
+ *
+ *****************************************************************************/
+static BOOL cliParseOneCmd( PU8 String,
+                            PTR_CLI_SESSION_INFO PtrSessionInfo,
+                            CLI_STATUS *PtrStatus )
+{
+    /* Token count */
+    U32     tkCount;
+    CLI_STATUS tkStatus;
+    const CLI_ARG_SCHEMA *ptrArgSchema = NULL;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+    /* Command line of a background job, the tokenizer splits String */
+    U8      jobCmd[CLI_MAX_CMD_LINE_LENGTH];
+    PU8     ptrPipeStages;
+    BOOL    job;
+
+    tkCount = 0;
+    *PtrStatus = CLI_STATUS_SUCCESS;
+    PtrSessionInfo->PtrCurCommand = NULL;
+
+    job = cliSplitJob( String );
+    if( job == TRUE )
+    {
+        strncpy( (char *)jobCmd,
+                 (const char *)&String[strspn((const char *)String, CLI_CMD_DELIMS)],
+                 sizeof(jobCmd) - 1 );
+        jobCmd[sizeof(jobCmd) - 1] = '\0';
+    }
+
+    /* The job runs the pipe stages too */
+    ptrPipeStages = cliSplitCmdLine( String, IEC_CLI_PIPE_SEPARATOR );
+
+    /* Separate out the tokens in the command line input.*/
+    tkStatus = cliTokenizeCmdLine( String, PtrSessionInfo, &tkCount );
+    if( (tkStatus == CLI_STATUS_SUCCESS) && (tkCount == 0) )
+    {
+        return FALSE;
+    }
+
+    /*
+     * Find the matching command through the dispatch index
+     */
+    if( tkCount != 0 )
+    {
+        PtrSessionInfo->PtrCurCommand = cliFindCommand( &PtrSessionInfo->CliCmdList,
+                                                        PtrSessionInfo->PtrCmdParams[0],
+                                                        cliCmdNodeBuf( PtrSessionInfo ),
+                                                        NULL,
+                                                        &ptrArgSchema );
+    }
+
+    if( tkStatus != CLI_STATUS_SUCCESS )
+    {
+        /* Nothing is run, the syntax is shown if the command was found */
+        *PtrStatus = tkStatus;
+        cliErrorHandler( tkStatus, PtrSessionInfo );
+
+        if( ptrCtx != NULL )
+        {
+            ptrCtx->LastStatus = tkStatus;
+        }
+        return TRUE;
+    }
+
+    if( (PtrSessionInfo->PtrCurCommand != NULL) &&
+        ( (job == TRUE) || ((ptrCtx != NULL) && (ptrCtx->NoFile == TRUE)) ) &&
+        (cliCmdCaptureSafe( PtrSessionInfo->PtrCurCommand ) == FALSE) )
+    {
+        /* The command may write to the session file handle directly, which
+         * a job or a cliExecToBuffer() session does not have.
+         */
+        *PtrStatus = CLI_STATUS_INVALID_FUNC_REQ;
+        cliErrorHandler( *PtrStatus, PtrSessionInfo );
+    }
+    else if( (PtrSessionInfo->PtrCurCommand != NULL) && (job == TRUE) )
+    {
+        /* The job checks the arguments when it runs the command */
+        *PtrStatus = iecCliJobStart( PtrSessionInfo, jobCmd );
+        if( *PtrStatus != CLI_STATUS_SUCCESS )
+        {
+            cliErrorHandler( *PtrStatus, PtrSessionInfo );
+        }
+    }
+    else if( PtrSessionInfo->PtrCurCommand != NULL )
+    {
+        PtrSessionInfo->TokenInCmdRcd = tkCount;
+
+        /* Check the arguments and call the command handler */
+        *PtrStatus = cliExecCmd( PtrSessionInfo, ptrArgSchema, ptrPipeStages );
+    }
+
+    if( (ptrCtx != NULL) && (PtrSessionInfo->PtrCurCommand != NULL) )
+    {
+        ptrCtx->LastStatus = *PtrStatus;
+    }
+    /*
+     * Parser status. True - Command found in command database,
+     * False - command not found.
+     */
+    return (PtrSessionInfo->PtrCurCommand != NULL);
+}
+
+
+/**
+ * @Name:   cliTokenizeCmdLine()
+ *
+ * @Description: This function splits the command line into tokens and sets
+ *               the command param array of the session. It is reentrant, so
+ *               all session threads can parse at the same time. The line is
+ *               scanned once. A token in double quotes may contain
+ *               delimiters, the quotes are not part of the token. The
+ *               closing quote must end the token, "abc"def is an error.
+ *               The buffer is only written to terminate tokens that are not
+ *               already followed by the end of the line.
+ *
+ * @param String - Command line input command.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure. The token spans are recorded in its session
+ *                context, if it has one.
+ *
+ * @param PtrTokenCount - Returns the number of tokens, on an error the number
+ *                of tokens split before the bad one.
+ *
+ * @return - CLI_STATUS_SUCCESS if the line was split successfully.
+ *           CLI_STATUS_NO_QUOTES if a closing quote is missing or is not
+ *           followed by a delimiter or the end of the line.
+ *           CLI_STATUS_INVALID_STRING if a token is too long.
+ *           CLI_STATUS_INVALID_PARAM_NUM if there are too many tokens.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliTokenizeCmdLine( PU8 String,
+                                      PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                      U32 *PtrTokenCount )
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+    CLI_STATUS retStatus = CLI_STATUS_SUCCESS;
+    PU8     ptrChar = String;
+    PU8     ptrToken;
+    U32     tkCount = 0;
+    U32     tkLen;
+    U32     loopCount;
+
+    /* Initialize the Command Param array with null string */
+    for( loopCount = 0 ; loopCount < CLI_MAX_NUM_OF_TOKENS; loopCount++ )
+    {
+        PtrSessionInfo->PtrCmdParams[loopCount] = NULL;
+    }
+
+    *PtrTokenCount = 0;
+
+    for( ; ; )
+    {
+        /* Skip delimiters in front of the token */
+        ptrChar += strspn( (const char *)ptrChar, CLI_CMD_DELIMS );
+
+        if( *ptrChar == '\0' )
+        {
+            break;
+        }
+
+        if( tkCount == CLI_MAX_NUM_OF_TOKENS )
+        {
+            retStatus = CLI_STATUS_INVALID_PARAM_NUM;
+            break;
+        }
+
+        if( *ptrChar == '"' )
+        {
+            /* Quoted token, runs up to the closing quote */
+            ptrToken = ptrChar + 1;
+            ptrChar = cliQuotedTokenEnd( ptrChar );
+
+            if( *ptrChar != '"' )
+            {
+                retStatus = CLI_STATUS_NO_QUOTES;
+                break;
+            }
+
+            /* The closing quote ends the token, "abc"def is not one token */
+            if( (ptrChar[1] != '\0') &&
+                (strchr( CLI_CMD_DELIMS, ptrChar[1] ) == NULL) )
+            {
+                retStatus = CLI_STATUS_NO_QUOTES;
+                break;
+            }
+        }
+        else
+        {
+            ptrToken = ptrChar;
+            ptrChar += strcspn( (const char *)ptrChar, CLI_CMD_DELIMS );
+        }
+
+        tkLen = (U32)(ptrChar - ptrToken);
+
+        /*
+         * if token length is bigger than maximum token buffer
+         * then it will return error.
+         */
+        if( tkLen >= CLI_MAX_TOKEN_LENGTH )
+        {
+            retStatus = CLI_STATUS_INVALID_STRING;
+            break;
+        }
+
+        /* Terminate the token unless the line ends here */
+        if( *ptrChar != '\0' )
+        {
+            *ptrChar++ = '\0';
+        }
+
+        PtrSessionInfo->PtrCmdParams[tkCount] = ptrToken;
+
+        if( ptrCtx != NULL )
+        {
+            ptrCtx->TokenSpan[tkCount].Offset = (U16)(ptrToken - String);
+            ptrCtx->TokenSpan[tkCount].Length = (U16)tkLen;
+        }
+
+        tkCount++;
+    }
+
+    if( ptrCtx != NULL )
+    {
+        ptrCtx->TokenCount = tkCount;
+    }
+
+    *PtrTokenCount = tkCount;
+
+    return retStatus;
+}
+
+
+/**
+ * @Name:   cliQuotedTokenEnd()
+ *
+ * @Description: This function finds the end of a quoted token. A double
+ *               quote only starts a quoted token at the start of a token,
+ *               a quote inside a token is a normal character. The
+ *               tokenizer, cliSplitCmdLine() and cliSplitJob() share this
+ *               rule, so a separator is only ignored where the tokenizer
+ *               puts it in a token.
+ *
+ * @param PtrQuote - Opening quote of the token.
+ *
+ * @return - The closing quote, or the end of the line if there is none.
+ *
+ *****************************************************************************/
+static PU8 cliQuotedTokenEnd( PU8 PtrQuote )
+{
+    PU8     ptrChar = PtrQuote + 1;
+
+    while( (*ptrChar != '\0') && (*ptrChar != '"') )
+    {
+        ptrChar++;
+    }
+
+    return ptrChar;
+}
+
+
+/**
+ * @Name:   cliCmdHash()
+ *
+ * @Description: This function calculates the FNV-1a hash of a command name.
+ *               At most CLI_MAX_TOKEN_LENGTH characters are hashed, matching
+ *               the strncmp() length used to compare command names.
+ *
+ * @param PtrCmdName - Command name string.
+ *
+ * @return - 32 bit hash of the command name.
+ *
+ *****************************************************************************/
+static U32 cliCmdHash( const U8 *PtrCmdName )
+{
+    U32 hash = CLI_CMD_HASH_OFFSET_BASIS;
+    U32 index;
+
+    for( index = 0;
+         (index < CLI_MAX_TOKEN_LENGTH) && (PtrCmdName[index] != '\0');
+         index++ )
+    {
+        hash ^= PtrCmdName[index];
+        hash *= CLI_CMD_HASH_PRIME;
+    }
+
+    return hash;
+}
+
+
+/**
+ * @Name:   cliCmdIndexLookup()
+ *
+ * @Description: This function finds a command name in the dispatch index.
+ *
+ * @param PtrCmdName - Command name string.
+ *
+ * @return - Bucket of the command, -1 if the command is not in the index.
+ *
+ *****************************************************************************/
+static S32 cliCmdIndexLookup( const U8 *PtrCmdName )
+{
+    U32 hash;
+    U32 bucket;
+
+    hash = cliCmdHash( PtrCmdName );
+
+    for( bucket = hash & (sCliCmdIndexSize - 1);
+         (sCliCmdIndex[bucket].PtrCmdNode != NULL) ||
+         (sCliCmdIndex[bucket].PtrCmdInfo != NULL);
+         bucket = (bucket + 1) & (sCliCmdIndexSize - 1) )
+    {
+        if( (sCliCmdIndex[bucket].HashTag == (U16)(hash >> 16)) &&
+            (strncmp((const char *)CLI_CMD_INDEX_NAME(bucket),
+                     (const char *)PtrCmdName,
+                     CLI_MAX_TOKEN_LENGTH) == 0) )
+        {
+            return (S32)bucket;
+        }
+    }
+
+    return -1;
+}
+
+
+/**
+ * @Name:   cliCmdIndexAdd()
+ *
+ * @Description: This function adds a command to the dispatch index, unless
+ *               a command with the same name was added before.
+ *
+ * @param PtrCmdName - Command name string.
+ *
+ * @param PtrCmdNode - Command node, NULL for a command table entry.
+ *
+ * @param PtrCmdInfo - Command table entry, NULL for a command node.
+ *
+ *****************************************************************************/
+static void cliCmdIndexAdd( const U8 *PtrCmdName,
+                            PTR_CLI_CMD_NODE PtrCmdNode,
+                            const CLI_CMD_INFO *PtrCmdInfo )
+{
+    U32 hash;
+    U32 bucket;
+
+    hash = cliCmdHash( PtrCmdName );
+
+    for( bucket = hash & (sCliCmdIndexSize - 1);
+         (sCliCmdIndex[bucket].PtrCmdNode != NULL) ||
+         (sCliCmdIndex[bucket].PtrCmdInfo != NULL);
+         bucket = (bucket + 1) & (sCliCmdIndexSize - 1) )
+    {
+        if( strncmp((const char *)CLI_CMD_INDEX_NAME(bucket),
+                    (const char *)PtrCmdName,
+                    CLI_MAX_TOKEN_LENGTH) == 0 )
+        {
+            /* Shadowed by a command added earlier */
+            return;
+        }
+    }
+
+    sCliCmdIndex[bucket].PtrCmdNode = PtrCmdNode;
+    sCliCmdIndex[bucket].PtrCmdInfo = PtrCmdInfo;
+    sCliCmdIndex[bucket].HashTag    = (U16)(hash >> 16);
+    sCliCmdSorted[sCliCmdSortedCount++] = (U16)bucket;
+}
+
+
+/**
+ * @Name:   cliBuildCmdIndex()
+ *
+ * @Description: This function builds the frozen command dispatch index from
+ *               the given command list and the registered command tables.
+ *               The nodes of the list are added first, in list order, then
+ *               the tables, the last registered first. So when a name is
+ *               registered twice the command registered one by one wins over
+ *               the table entry, and otherwise the one registered last wins,
+ *               as before. Commands of the unsupported in-band command list
+ *               are flagged in the index. The index gets the smallest
+ *               power of two of buckets that keeps its load at most 3/4.
+ *
+ * @param PtrCliCmdList - Pointer to the CLI command list to index.
+ *
+ * @note If the commands need more than CLI_CMD_INDEX_SIZE_MAX buckets, or
+ *       the index cannot be allocated, the index is not built and
+ *       cliFindCommand() walks the list and the tables.
+ *
+ *****************************************************************************/
+static void cliBuildCmdIndex( PTR_CLI_CMD_LIST PtrCliCmdList )
+{
+    PTR_CLI_CMD_NODE ptrCmdNode;
+    const CLI_CMD_INFO *ptrCmdInfo;
+    S32 bucket;
+    U32 counter;
+    U32 cmdCount;
+    U32 indexSize;
+    U16 table;
+    U16 index;
+    U16 sorted;
+    U16 sortBucket;
+
+    sCliCmdIndexBuilt = FALSE;
+    sCliCmdSortedCount = 0;
+
+    cmdCount = PtrCliCmdList->CliCommandCount;
+    for( table = 0; table < sCliCmdTableCount; table++ )
+    {
+        cmdCount += sCliCmdTableSize[table];
+    }
+
+    for( indexSize = 2; (cmdCount * 4) > (indexSize * 3); indexSize <<= 1 )
+    {
+        if( indexSize >= CLI_CMD_INDEX_SIZE_MAX )
+        {
+            return;
+        }
+    }
+
+    free( sCliCmdIndex );
+    free( sCliCmdSorted );
+    sCliCmdIndex = malloc( indexSize * sizeof(CLI_CMD_INDEX_ENTRY) );
+    sCliCmdSorted = malloc( cmdCount * sizeof(U16) );
+    if( (sCliCmdIndex == NULL) || (sCliCmdSorted == NULL) )
+    {
+        free( sCliCmdIndex );
+        free( sCliCmdSorted );
+        sCliCmdIndex = NULL;
+        sCliCmdSorted = NULL;
+        return;
+    }
+
+    sCliCmdIndexSize = indexSize;
+    memset( sCliCmdIndex, 0, indexSize * sizeof(CLI_CMD_INDEX_ENTRY) );
+
+    for( ptrCmdNode = PtrCliCmdList->PtrCliCmdListHead;
+         ptrCmdNode != NULL;
+         ptrCmdNode = ptrCmdNode->PtrNext )
+    {
+        cliCmdIndexAdd( ptrCmdNode->Command, ptrCmdNode, NULL );
+    }
+
+    for( table = sCliCmdTableCount; table > 0; table-- )
+    {
+        for( index = 0; index < sCliCmdTableSize[table - 1]; index++ )
+        {
+            ptrCmdInfo = sPtrCliCmdTable[table - 1][index];
+            cliCmdIndexAdd( ptrCmdInfo->PtrCmdName, NULL, ptrCmdInfo );
+        }
+    }
+
+    /* Sort the buckets by name. The list is sorted already and the tables
+     * mostly are, an insertion sort has little to move.
+     */
+    for( sorted = 1; sorted < sCliCmdSortedCount; sorted++ )
+    {
+        sortBucket = sCliCmdSorted[sorted];
+
+        for( index = sorted;
+             (index > 0) &&
+             (strncmp((const char *)CLI_CMD_SORTED_NAME(index - 1),
+                      (const char *)CLI_CMD_INDEX_NAME(sortBucket),
+                      CLI_MAX_TOKEN_LENGTH) > 0);
+             index-- )
+        {
+            sCliCmdSorted[index] = sCliCmdSorted[index - 1];
+        }
+        sCliCmdSorted[index] = sortBucket;
+    }
+
+    /* Flag the commands that cannot be executed from the in-band CLI */
+    cmdCount = sizeof(sPtrUnSupportedCliCmdList)/sizeof(sPtrUnSupportedCliCmdList[0]);
+
+    for( counter = 0; counter < cmdCount; counter++ )
+    {
+        bucket = cliCmdIndexLookup( sPtrUnSupportedCliCmdList[counter]->PtrCmdName );
+        if( bucket >= 0 )
+        {
+            sCliCmdIndex[bucket].Flags |= CLI_CMD_INDEX_FLAG_INBAND_BLOCKED;
+        }
+    }
+
+    /* Attach the argument schemas to their commands */
+    for( counter = 0; counter < sCliArgSchemaCount; counter++ )
+    {
+        bucket = cliCmdIndexLookup( sPtrCliArgSchema[counter]->PtrCmdInfo->PtrCmdName );
+        if( bucket >= 0 )
+        {
+            sCliCmdIndex[bucket].PtrArgSchema = sPtrCliArgSchema[counter];
+        }
+    }
+
+    sCliCmdIndexBuilt = TRUE;
+}
+
+
+/**
+ * @Name:   cliCmdIsCore()
+ *
+ * @Description: This function tells whether a command list goes on with
+ *               the core commands from the given node on. The session
+ *               command lists are the core command list, possibly with
+ *               commands of the session in front of it.
+ *
+ * @param PtrCmdNode - Node of a command list, NULL at its end.
+ *
+ * @return - TRUE if the core commands start at PtrCmdNode.
+ *
+ *****************************************************************************/
+static BOOL cliCmdIsCore( PTR_CLI_CMD_NODE PtrCmdNode )
+{
+    return( (sCliCoreInitialized == TRUE) && (PtrCmdNode == sPtrCliCmdCoreHead) );
+}
+
+
+/**
+ * @Name:   cliCmdInfoNode()
+ *
+ * @Description: This function fills a command node for a command table
+ *               entry. The commands of the tables have no node of their
+ *               own, the node is what PtrCurCommand of the session points
+ *               to while the command runs.
+ *
+ * @param PtrCmdInfo - Command table entry.
+ *
+ * @param PtrCmdNodeBuf - Node to fill.
+ *
+ * @return - PtrCmdNodeBuf.
+ *
+ *****************************************************************************/
+static PTR_CLI_CMD_NODE cliCmdInfoNode( const CLI_CMD_INFO *PtrCmdInfo,
+                                        PTR_CLI_CMD_NODE PtrCmdNodeBuf )
+{
+    PtrCmdNodeBuf->Command      = PtrCmdInfo->PtrCmdName;
+    PtrCmdNodeBuf->OneLineHelp  = PtrCmdInfo->PtrOneLineHelp;
+    PtrCmdNodeBuf->PtrToFunCall = PtrCmdInfo->PtrToFunCall;
+    PtrCmdNodeBuf->PtrNext      = NULL;
+
+    return PtrCmdNodeBuf;
+}
+
+
+/**
+ * @Name:   cliCmdIndexNode()
+ *
+ * @Description: This function returns the command node of a bucket of the
+ *               dispatch index.
+ *
+ * @param Bucket - Bucket of the index, not empty.
+ *
+ * @param PtrCmdNodeBuf - Node filled for a command table entry.
+ *
+ * @return - Node of the command.
+ *
+ *****************************************************************************/
+static PTR_CLI_CMD_NODE cliCmdIndexNode( U32 Bucket, PTR_CLI_CMD_NODE PtrCmdNodeBuf )
+{
+    if( sCliCmdIndex[Bucket].PtrCmdNode != NULL )
+    {
+        return sCliCmdIndex[Bucket].PtrCmdNode;
+    }
+
+    return cliCmdInfoNode( sCliCmdIndex[Bucket].PtrCmdInfo, PtrCmdNodeBuf );
+}
+
+
+/**
+ * @Name:   cliCmdNodeBuf()
+ *
+ * @Description: This function returns the node used for the commands of
+ *               the command tables run by a session.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @return - Command node of the session context, or the one of the in-band
+ *           session for a session without context.
+ *
+ *****************************************************************************/
+static PTR_CLI_CMD_NODE cliCmdNodeBuf( PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+
+    return( (ptrCtx != NULL) ? &ptrCtx->CmdNode : &sCliInBandCmdNode );
+}
+
+
+/**
+ * @Name:   cliFindCommand()
+ *
+ * @Description: This function finds the command registered under the given
+ *               name. The commands of the list in front of the core commands
+ *               are searched first, then the core commands through the
+ *               frozen dispatch index. A list without the core commands
+ *               (fault console) is walked.
+ *
+ * @param PtrCliCmdList - Pointer to the CLI command list to search.
+ *
+ * @param PtrCmdName - Command name string.
+ *
+ * @param PtrCmdNodeBuf - Node filled for a command of a command table.
+ *
+ * @param PtrInBandBlocked - Set to TRUE if the command is not supported by
+ *                the in-band CLI. Can be NULL.
+ *
+ * @param PtrPtrArgSchema - Returns the argument schema of the command, NULL
+ *                if it has none. Can be NULL.
+ *
+ * @return - Pointer to the command node, NULL if the command is not found.
+ *
+ *****************************************************************************/
+static PTR_CLI_CMD_NODE cliFindCommand( PTR_CLI_CMD_LIST PtrCliCmdList,
+                                        const U8 *PtrCmdName,
+                                        PTR_CLI_CMD_NODE PtrCmdNodeBuf,
+                                        BOOL *PtrInBandBlocked,
+                                        const CLI_ARG_SCHEMA **PtrPtrArgSchema )
+{
+    PTR_CLI_CMD_NODE ptrCmdNode;
+    S32 bucket;
+    U32 counter;
+    U32 cmdCount;
+    U16 table;
+    U16 index;
+
+    if( PtrInBandBlocked != NULL )
+    {
+        *PtrInBandBlocked = FALSE;
+    }
+
+    if( PtrPtrArgSchema != NULL )
+    {
+        *PtrPtrArgSchema = NULL;
+    }
+
+    /* Commands of the session in front of the core commands */
+    for( ptrCmdNode = PtrCliCmdList->PtrCliCmdListHead;
+         (ptrCmdNode != NULL) && (cliCmdIsCore(ptrCmdNode) == FALSE);
+         ptrCmdNode = ptrCmdNode->PtrNext )
+    {
+        if( strncmp((const char *)ptrCmdNode->Command,
+                    (const char *)PtrCmdName,
+                    CLI_MAX_TOKEN_LENGTH) == 0 )
+        {
+            break;
+        }
+    }
+
+    if( (cliCmdIsCore(ptrCmdNode) == TRUE) && (sCliCmdIndexBuilt == TRUE) )
+    {
+        bucket = cliCmdIndexLookup( PtrCmdName );
+        if( bucket < 0 )
+        {
+            return NULL;
+        }
+
+        if( PtrInBandBlocked != NULL )
+        {
+            *PtrInBandBlocked = ((sCliCmdIndex[bucket].Flags &
+                                  CLI_CMD_INDEX_FLAG_INBAND_BLOCKED) != 0);
+        }
+        if( PtrPtrArgSchema != NULL )
+        {
+            *PtrPtrArgSchema = sCliCmdIndex[bucket].PtrArgSchema;
+        }
+
+        return cliCmdIndexNode( (U32)bucket, PtrCmdNodeBuf );
+    }
+
+    if( cliCmdIsCore(ptrCmdNode) == TRUE )
+    {
+        /* No index, walk the core list and the tables */
+        for( ; ptrCmdNode != NULL; ptrCmdNode = ptrCmdNode->PtrNext )
+        {
+            if( strncmp((const char *)ptrCmdNode->Command,
+                        (const char *)PtrCmdName,
+                        CLI_MAX_TOKEN_LENGTH) == 0 )
+            {
+                break;
+            }
+        }
+
+        for( table = sCliCmdTableCount; (ptrCmdNode == NULL) && (table > 0); table-- )
+        {
+            for( index = 0; index < sCliCmdTableSize[table - 1]; index++ )
+            {
+                if( strncmp((const char *)sPtrCliCmdTable[table - 1][index]->PtrCmdName,
+                            (const char *)PtrCmdName,
+                            CLI_MAX_TOKEN_LENGTH) == 0 )
+                {
+                    ptrCmdNode = cliCmdInfoNode( sPtrCliCmdTable[table - 1][index],
+                                                 PtrCmdNodeBuf );
+                    break;
+                }
+            }
+        }
+    }
+
+    if( ptrCmdNode == NULL )
+    {
+        return NULL;
+    }
+
+    /* Not indexed, check the unsupported in-band list and the schemas */
+    if( PtrInBandBlocked != NULL )
+    {
+        cmdCount = sizeof(sPtrUnSupportedCliCmdList)/sizeof(sPtrUnSupportedCliCmdList[0]);
+
+        for( counter = 0; counter < cmdCount; counter++ )
+        {
+            if( strncmp((const char *)sPtrUnSupportedCliCmdList[counter]->PtrCmdName,
+                        (const char *)PtrCmdName,
+                        CLI_MAX_TOKEN_LENGTH) == 0 )
+            {
+                *PtrInBandBlocked = TRUE;
+                break;
+            }
+        }
+    }
+
+    if( PtrPtrArgSchema != NULL )
+    {
+        *PtrPtrArgSchema = cliFindArgSchema( PtrCmdName );
+    }
+
+    return ptrCmdNode;
+}
+
+
+/**
+ * @Name:   cliFindArgSchema()
+ *
+ * @Description: This function finds the argument schema registered for the
+ *               given command name. Used for the command lists that are not
+ *               indexed.
+ *
+ * @param PtrCmdName - Command name string.
+ *
+ * @return - Pointer to the argument schema, NULL if the command has none.
+ *
+ *****************************************************************************/
+static const CLI_ARG_SCHEMA *cliFindArgSchema( const U8 *PtrCmdName )
+{
+    U16 counter;
+
+    for( counter = 0; counter < sCliArgSchemaCount; counter++ )
+    {
+        if( strncmp((const char *)sPtrCliArgSchema[counter]->PtrCmdInfo->PtrCmdName,
+                    (const char *)PtrCmdName,
+                    CLI_MAX_TOKEN_LENGTH) == 0 )
+        {
+            return sPtrCliArgSchema[counter];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @Name:   cliParseU32()
+ *
+ * @Description: This function converts a string to an unsigned 32 bit value.
+ *               The whole string must be a number, no sign, white space or
+ *               trailing characters are accepted and overflow is detected.
+ *
+ * @param PtrString - String to convert.
+ *
+ * @param Radix - 10 for decimal, 16 for hexadecimal with or without 0x,
+ *                0 for hexadecimal with 0x and decimal otherwise.
+ *
+ * @param PtrValue - Returns the converted value.
+ *
+ * @return - TRUE if the string was converted, FALSE otherwise.
+ *
+ *****************************************************************************/
+BOOL cliParseU32( const U8 *PtrString, U32 Radix, U32 *PtrValue )
+{
+    U32 value = 0;
+    U32 digit;
+    U8  ch;
+
+    if( (PtrString[0] == '0') && ((PtrString[1] | 0x20) == 'x') &&
+        (Radix != 10) )
+    {
+        PtrString += 2;
+        Radix = 16;
+    }
+    else if( Radix == 0 )
+    {
+        Radix = 10;
+    }
+
+    if( *PtrString == '\0' )
+    {
+        return FALSE;
+    }
+
+    while( (ch = *PtrString++) != '\0' )
+    {
+        if( (ch >= '0') && (ch <= '9') )
+        {
+            digit = ch - '0';
+        }
+        else if( (Radix == 16) && ((ch | 0x20) >= 'a') && ((ch | 0x20) <= 'f') )
+        {
+            digit = (ch | 0x20) - 'a' + 10;
+        }
+        else
+        {
+            return FALSE;
+        }
+
+        /* Overflow check */
+        if( value > ((0xFFFFFFFF - digit) / Radix) )
+        {
+            return FALSE;
+        }
+
+        value = (value * Radix) + digit;
+    }
+
+    *PtrValue = value;
+
+    return TRUE;
+}
+
+
+/**
+ * @Name:   cliConvertArg()
+ *
+ * @Description: This function checks one argument against its description
+ *               and converts it.
+ *
+ * @param PtrArgSpec - Description of the argument.
+ *
+ * @param PtrToken - Argument string.
+ *
+ * @param TokenLength - Number of characters in the argument string.
+ *
+ * @param PtrValue - Returns the converted value. For a keyword it is the
+ *                index of the keyword, for a string it is 0.
+ *
+ * @return - TRUE if the argument is valid, FALSE otherwise.
+ *
+ *****************************************************************************/
+static BOOL cliConvertArg( const CLI_ARG_SPEC *PtrArgSpec,
+                           const U8 *PtrToken,
+                           U32 TokenLength,
+                           U32 *PtrValue )
+{
+    const char * const *ptrKeyword;
+    U32 value = 0;
+    BOOL valid;
+
+    switch( PtrArgSpec->Type )
+    {
+        case CLI_ARG_TYPE_DEC:
+            valid = cliParseU32( PtrToken, 10, &value );
+            break;
+
+        case CLI_ARG_TYPE_HEX:
+            valid = cliParseU32( PtrToken, 16, &value );
+            break;
+
+        case CLI_ARG_TYPE_NUM:
+            valid = cliParseU32( PtrToken, 0, &value );
+            break;
+
+        case CLI_ARG_TYPE_KEYWORD:
+            valid = FALSE;
+            for( ptrKeyword = PtrArgSpec->PtrKeywords;
+                 *ptrKeyword != NULL;
+                 ptrKeyword++, value++ )
+            {
+                if( strcmp(*ptrKeyword, (const char *)PtrToken) == 0 )
+                {
+                    valid = TRUE;
+                    break;
+                }
+            }
+            break;
+
+        case CLI_ARG_TYPE_STRING:
+            valid = ( (PtrArgSpec->Max == 0) || (TokenLength < PtrArgSpec->Max) );
+            break;
+
+        default:
+            valid = FALSE;
+            break;
+    }
+
+    /* Range check of the numbers */
+    if( (valid == TRUE) &&
+        (PtrArgSpec->Type <= CLI_ARG_TYPE_NUM) &&
+        ((value < PtrArgSpec->Min) || (value > PtrArgSpec->Max)) )
+    {
+        valid = FALSE;
+    }
+
+    *PtrValue = value;
+
+    return valid;
+}
+
+
+/**
+ * @Name:   cliFindSubCmd()
+ *
+ * @Description: This function finds the keyword child of a subcommand node
+ *               matching the token. The keyword children are sorted, so a
+ *               binary search is used.
+ *
+ * @param PtrNode - Subcommand node.
+ *
+ * @param PtrToken - Command line token.
+ *
+ * @return - Pointer to the matching child, NULL if no keyword matches.
+ *
+ *****************************************************************************/
+static const CLI_SUBCMD_NODE *cliFindSubCmd( const CLI_SUBCMD_NODE *PtrNode,
+                                             const U8 *PtrToken )
+{
+    S32 low = 0;
+    S32 high = (S32)PtrNode->ChildCount - 1;
+    S32 middle;
+    S32 result;
+
+    while( low <= high )
+    {
+        middle = (low + high) / 2;
+        result = strcmp( PtrNode->PtrChildren[middle].PtrKeyword,
+                         (const char *)PtrToken );
+
+        if( result == 0 )
+        {
+            return &PtrNode->PtrChildren[middle];
+        }
+        else if( result < 0 )
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @Name:   cliTokenLength()
+ *
+ * @Description: This function returns the length of a command line token,
+ *               from the token spans of the session context if the session
+ *               has one.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrCtx - Session context of the session, NULL if it has none.
+ *
+ * @param TokenIndex - Index of the token in PtrCmdParams.
+ *
+ * @return - Number of characters of the token.
+ *
+ *****************************************************************************/
+static U32 cliTokenLength( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                           PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                           U32 TokenIndex )
+{
+    if( PtrCtx != NULL )
+    {
+        return PtrCtx->TokenSpan[TokenIndex].Length;
+    }
+
+    return (U32)strlen( (const char *)PtrSessionInfo->PtrCmdParams[TokenIndex] );
+}
+
+
+/**
+ * @Name:   cliWalkSubCmdTree()
+ *
+ * @Description: This function follows the command line tokens through the
+ *               subcommand tree and stores the keyword values and converted
+ *               values by token index.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrCtx - Session context of the session, NULL if it has none.
+ *
+ * @param PtrArgValue - Returns the values, CLI_MAX_NUM_OF_TOKENS entries.
+ *
+ * @param PtrRoot - Root of the subcommand tree.
+ *
+ * @param PtrFptrHandler - Returns the handler of the subcommand.
+ *
+ * @return - CLI_STATUS_SUCCESS if the subcommand was found.
+ *           CLI_STATUS_INVALID_PARAM_NUM if there are too few or too many
+ *           tokens.
+ *           CLI_STATUS_INVALID_PARAMETER if a token matches no child.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliWalkSubCmdTree( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                     PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                                     U32 *PtrArgValue,
+                                     const CLI_SUBCMD_NODE *PtrRoot,
+                                     PTR_CLI_SUBCMD_HANDLER *PtrFptrHandler )
+{
+    const CLI_SUBCMD_NODE *ptrNode = PtrRoot;
+    const CLI_SUBCMD_NODE *ptrChild;
+    const U8 *ptrToken;
+    U32 tkIndex;
+    U32 value;
+
+    for( tkIndex = 1; tkIndex < PtrSessionInfo->TokenInCmdRcd; tkIndex++ )
+    {
+        if( (ptrNode->ChildCount == 0) && (ptrNode->PtrValueChild == NULL) )
+        {
+            return CLI_STATUS_INVALID_PARAM_NUM;
+        }
+
+        ptrToken = PtrSessionInfo->PtrCmdParams[tkIndex];
+        ptrChild = cliFindSubCmd( ptrNode, ptrToken );
+
+        if( ptrChild != NULL )
+        {
+            value = ptrChild->Value;
+        }
+        else if( (ptrNode->PtrValueChild != NULL) &&
+                 (cliConvertArg(ptrNode->PtrValueChild->PtrValueSpec,
+                                ptrToken,
+                                cliTokenLength(PtrSessionInfo, PtrCtx, tkIndex),
+                                &value) == TRUE) )
+        {
+            ptrChild = ptrNode->PtrValueChild;
+        }
+        else
+        {
+            return CLI_STATUS_INVALID_PARAMETER;
+        }
+
+        PtrArgValue[tkIndex] = value;
+        ptrNode = ptrChild;
+    }
+
+    if( ptrNode->PtrToFunCall == NULL )
+    {
+        return CLI_STATUS_INVALID_PARAM_NUM;
+    }
+
+    *PtrFptrHandler = ptrNode->PtrToFunCall;
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ * @Name:   cliCheckSubCmdTree()
+ *
+ * @Description: This function checks that the keyword children of all the
+ *               nodes of a subcommand tree are sorted and unique, which the
+ *               binary search of cliFindSubCmd() relies on.
+ *
+ * @param PtrNode - Subcommand node.
+ *
+ * @param Depth - Depth of the node in the tree, 0 for the root.
+ *
+ * @return - TRUE if the tree is valid, FALSE otherwise.
+ *
+ *****************************************************************************/
+static BOOL cliCheckSubCmdTree( const CLI_SUBCMD_NODE *PtrNode, U32 Depth )
+{
+    U8 index;
+
+    /* Every level uses one token */
+    if( Depth >= CLI_MAX_NUM_OF_TOKENS )
+    {
+        return FALSE;
+    }
+
+    for( index = 0; index < PtrNode->ChildCount; index++ )
+    {
+        if( (index > 0) &&
+            (strcmp(PtrNode->PtrChildren[index - 1].PtrKeyword,
+                    PtrNode->PtrChildren[index].PtrKeyword) >= 0) )
+        {
+            return FALSE;
+        }
+
+        if( cliCheckSubCmdTree(&PtrNode->PtrChildren[index], Depth + 1) == FALSE )
+        {
+            return FALSE;
+        }
+    }
+
+    if( PtrNode->PtrValueChild != NULL )
+    {
+        if( (PtrNode->PtrValueChild->PtrValueSpec == NULL) ||
+            (cliCheckSubCmdTree(PtrNode->PtrValueChild, Depth + 1) == FALSE) )
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+
+/**
+ * @Name:   cliPrintSubCmdTree()
+ *
+ * @Description: This function prints one line for every complete subcommand
+ *               of a subcommand tree, e.g. "iecGPIO <gpio> set dir in".
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrNode - Subcommand node.
+ *
+ * @param PtrPath - Buffer holding the words leading to PtrNode.
+ *
+ * @param PathLength - Number of characters in PtrPath.
+ *
+ *****************************************************************************/
+static void cliPrintSubCmdTree( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                const CLI_SUBCMD_NODE *PtrNode,
+                                PU8 PtrPath,
+                                U32 PathLength )
+{
+    U32 length;
+    U8 index;
+
+    length = strlen( PtrNode->PtrKeyword );
+
+    /* Keep the path within the command line length */
+    if( (PathLength + length + 2) > CLI_MAX_CMD_LINE_LENGTH )
+    {
+        return;
+    }
+
+    if( PathLength > 0 )
+    {
+        PtrPath[PathLength++] = ' ';
+    }
+    memcpy( &PtrPath[PathLength], PtrNode->PtrKeyword, length );
+    PathLength += length;
+    PtrPath[PathLength] = '\0';
+
+    if( PtrNode->PtrToFunCall != NULL )
+    {
+        iecCliOutPrintf( &(PtrSessionInfo->OutFileHandle), "      %s\r\n", PtrPath );
+    }
+
+    for( index = 0; index < PtrNode->ChildCount; index++ )
+    {
+        cliPrintSubCmdTree( PtrSessionInfo, &PtrNode->PtrChildren[index],
+                            PtrPath, PathLength );
+    }
+
+    if( PtrNode->PtrValueChild != NULL )
+    {
+        cliPrintSubCmdTree( PtrSessionInfo, PtrNode->PtrValueChild,
+                            PtrPath, PathLength );
+    }
+}
+
+
+/**
+ * @Name:   cliCheckArgs()
+ *
+ * @Description: This function checks the command arguments against the
+ *               argument schema of the command and stores the converted
+ *               values by token index. The options are checked first, the
+ *               first token that is not an option name starts the
+ *               arguments. For a command with a subcommand tree, the tree
+ *               selects the handler to call.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrArgSchema - Argument schema of the command.
+ *
+ * @param PtrArgValue - Returns the values, CLI_MAX_NUM_OF_TOKENS entries.
+ *                The values of the session context, see CLI_ARG_VALUE().
+ *
+ * @param PtrFptrHandler - Returns the handler to call. It is left unchanged
+ *                for a command without a subcommand tree.
+ *
+ * @return - CLI_STATUS_SUCCESS if all arguments are valid.
+ *           The ArgCountStatus of the schema, by default
+ *           CLI_STATUS_INVALID_PARAM_NUM, if the number of arguments is wrong.
+ *           CLI_STATUS_INVALID_PARAMETER if an argument is not valid.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliCheckArgs( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                const CLI_ARG_SCHEMA *PtrArgSchema,
+                                U32 *PtrArgValue,
+                                PTR_CLI_SUBCMD_HANDLER *PtrFptrHandler )
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+    CLI_STATUS countStatus = (PtrArgSchema->ArgCountStatus != CLI_STATUS_SUCCESS) ?
+                             PtrArgSchema->ArgCountStatus : CLI_STATUS_INVALID_PARAM_NUM;
+    U32 argCount = PtrSessionInfo->TokenInCmdRcd - 1;
+    U32 argIndex = 1;
+    U32 firstArg;
+    U8  optIndex;
+
+    memset( PtrArgValue, 0, CLI_MAX_NUM_OF_TOKENS * sizeof(U32) );
+
+    if( PtrArgSchema->PtrSubCmdTree != NULL )
+    {
+        return cliWalkSubCmdTree( PtrSessionInfo, ptrCtx, PtrArgValue,
+                                  PtrArgSchema->PtrSubCmdTree,
+                                  PtrFptrHandler );
+    }
+
+    while( argIndex <= argCount )
+    {
+        for( optIndex = 0; optIndex < PtrArgSchema->OptionCount; optIndex++ )
+        {
+            if( strcmp( PtrArgSchema->PtrOptions[optIndex].PtrName,
+                        (const char *)PtrSessionInfo->PtrCmdParams[argIndex] ) == 0 )
+            {
+                break;
+            }
+        }
+
+        if( optIndex == PtrArgSchema->OptionCount )
+        {
+            break;
+        }
+
+        if( argIndex == argCount )
+        {
+            return countStatus;
+        }
+
+        if( cliConvertArg( &PtrArgSchema->PtrOptions[optIndex].ValueSpec,
+                           PtrSessionInfo->PtrCmdParams[argIndex + 1],
+                           cliTokenLength( PtrSessionInfo, ptrCtx, argIndex + 1 ),
+                           &PtrArgValue[argIndex + 1] ) == FALSE )
+        {
+            return CLI_STATUS_INVALID_PARAMETER;
+        }
+
+        PtrArgValue[argIndex] = optIndex + 1;
+        argIndex += 2;
+    }
+
+    firstArg = argIndex;
+
+    if( ((argCount + 1 - firstArg) < PtrArgSchema->MinArgs) ||
+        ((argCount + 1 - firstArg) > PtrArgSchema->MaxArgs) )
+    {
+        return countStatus;
+    }
+
+    if( PtrArgSchema->PtrArgSpec == NULL )
+    {
+        return CLI_STATUS_SUCCESS;
+    }
+
+    for( ; argIndex <= argCount; argIndex++ )
+    {
+        if( cliConvertArg( &PtrArgSchema->PtrArgSpec[argIndex - firstArg],
+                           PtrSessionInfo->PtrCmdParams[argIndex],
+                           cliTokenLength( PtrSessionInfo, ptrCtx, argIndex ),
+                           &PtrArgValue[argIndex] ) == FALSE )
+        {
+            return CLI_STATUS_INVALID_PARAMETER;
+        }
+    }
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ * @Name:   cliArgValue()
+ *
+ * @Description: This function returns the converted value of an argument
+ *               of the current command, see CLI_ARG_VALUE(). The values are
+ *               kept in the session context. A session without a context
+ *               has no place to keep them, so the arguments, which were
+ *               checked before the handler was called, are converted again.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param Index - Token index of the argument.
+ *
+ * @return - Converted value, 0 if the argument is not present.
+ *
+ *****************************************************************************/
+U32 cliArgValue( PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Index )
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+    const CLI_ARG_SCHEMA *ptrArgSchema;
+    PTR_CLI_SUBCMD_HANDLER fptrHandler;
+    U32     argValue[CLI_MAX_NUM_OF_TOKENS];
+
+    if( ptrCtx != NULL )
+    {
+        return ptrCtx->ArgValue[Index];
+    }
+
+    ptrArgSchema = cliFindArgSchema( PtrSessionInfo->PtrCurCommand->Command );
+    if( (ptrArgSchema == NULL) ||
+        (cliCheckArgs( PtrSessionInfo, ptrArgSchema, argValue,
+                       &fptrHandler ) != CLI_STATUS_SUCCESS) )
+    {
+        return 0;
+    }
+
+    return argValue[Index];
+}
+
+
+/**
+ * @Name:   cliExecCmd()
+ *
+ * @Description: This function checks the arguments of the current command
+ *               of the session, if it has an argument schema, then calls
+ *               the command handler, or the subcommand handler, and reports
+ *               its status. The output of the handler goes through the pipe
+ *               stages if there are any; the status is reported after them.
+ *               A session in read only mode only calls the read-only
+ *               handlers, see cliHandlerReadOnly().
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrArgSchema - Argument schema of the command, NULL if it has none.
+ *
+ * @param PtrPipeStages - Pipe stage text after the '|', NULL for none.
+ *
+ * @return - Status of the argument check or of the handler. The output is
+ *           not flushed, the caller flushes it.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliExecCmd( PTR_CLI_SESSION_INFO PtrSessionInfo,
+                              const CLI_ARG_SCHEMA *PtrArgSchema,
+                              const U8 *PtrPipeStages )
+{
+    CLI_STATUS retStatus = CLI_STATUS_SUCCESS;
+    PTR_CLI_SUBCMD_HANDLER fptrHandler = PtrSessionInfo->PtrCurCommand->PtrToFunCall;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet( PtrSessionInfo );
+    PTR_IEC_CLI_PIPE ptrPipe = NULL;
+    /* Values of a session without a context, see cliArgValue() */
+    U32     argValue[CLI_MAX_NUM_OF_TOKENS];
+
+    /* Check whether Pointer to function is NULL. */
+    if( fptrHandler == NULL )
+    {
+        return CLI_STATUS_SUCCESS;
+    }
+
+    if( PtrArgSchema != NULL )
+    {
+        retStatus = cliCheckArgs( PtrSessionInfo, PtrArgSchema,
+                                  (ptrCtx != NULL) ? ptrCtx->ArgValue : argValue,
+                                  &fptrHandler );
+    }
+
+    /* The subcommand handler is known, e.g. iecGPIO shows but does not set */
+    if( (retStatus == CLI_STATUS_SUCCESS) && (ptrCtx != NULL) &&
+        (ptrCtx->ReadOnly == TRUE) && (cliHandlerReadOnly( fptrHandler ) == FALSE) )
+    {
+        ptrCtx->ReadOnlyRefused = TRUE;
+        retStatus = CLI_STATUS_INVALID_FUNC_REQ;
+    }
+
+    if( (retStatus == CLI_STATUS_SUCCESS) && (PtrPipeStages != NULL) )
+    {
+        retStatus = iecCliPipeStart( PtrSessionInfo, PtrPipeStages, &ptrPipe );
+    }
+
+    if( retStatus == CLI_STATUS_SUCCESS )
+    {
+        /* A Ctrl-C typed before the command does not stop it */
+        if( ptrCtx != NULL )
+        {
+            ptrCtx->CancelRequest = FALSE;
+        }
+
+        /* Call Corresponding callback function. */
+        retStatus = fptrHandler( PtrSessionInfo );
+
+        if( ptrPipe != NULL )
+        {
+            retStatus = iecCliPipeEnd( ptrPipe, retStatus );
+        }
+    }
+
+    cliErrorHandler( retStatus, PtrSessionInfo );
+
+    return retStatus;
+}
+
+
+/**
+ *
+ * @Name:   cliPrintFirstHelpMsg()
+ *
+ * @Description: This function displays the first single line help message at the
+ *               start of a new CLI session.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliPrintFirstHelpMsg( PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    /* Display Initial Help for User. */
+    fprintf(&(PtrSessionInfo->OutFileHandle),
+        "\r\n\n Enter 'help' to display a list of commands");
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ *
+ * @Name:   cliPrintHelp()
+ *
+ * @Description: This function displays CLI help. It displays
+ *             command name and syntax for command.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @Note: This function displays help string of the specified command. All registered
+ *  commands help strings are displayed if no command is specified as cmd parameter
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+CLI_STATUS cliPrintHelp( PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    PTR_CLI_CMD_NODE PtrCmdNode = PtrSessionInfo->CliCmdList.PtrCliCmdListHead;
+    CLI_CMD_NODE cmdNode;
+    const CLI_ARG_SCHEMA *ptrArgSchema;
+    U8 path[CLI_MAX_CMD_LINE_LENGTH];
+    U16 table;
+    U16 index;
+
+    /* Display the help Menu. */
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle),"\r\n\n%s\r\n\n%s\r\n\n%s\r\n\n",
+                gPtrCliPrintHeader,sPtrHelpHeader,gPtrCliPrintHeader);
+
+    /* Print help string of all registred command if no argument is passed */
+    if( PtrSessionInfo->PtrCmdParams[1] == NULL )
+    {
+        for( ; (PtrCmdNode != NULL) && (cliCmdIsCore(PtrCmdNode) == FALSE);
+             PtrCmdNode = PtrCmdNode->PtrNext )
+        {
+            iecCliOutPuts( (const char *)(PtrCmdNode->OneLineHelp),
+                           &(PtrSessionInfo->OutFileHandle) );
+        }
+
+        /* The core commands, sorted by the index */
+        if( (cliCmdIsCore(PtrCmdNode) == TRUE) && (sCliCmdIndexBuilt == TRUE) )
+        {
+            for( index = 0; index < sCliCmdSortedCount; index++ )
+            {
+                PtrCmdNode = cliCmdIndexNode( sCliCmdSorted[index], &cmdNode );
+                iecCliOutPuts( (const char *)(PtrCmdNode->OneLineHelp),
+                               &(PtrSessionInfo->OutFileHandle) );
+            }
+        }
+        else if( cliCmdIsCore(PtrCmdNode) == TRUE )
+        {
+            for( ; PtrCmdNode != NULL; PtrCmdNode = PtrCmdNode->PtrNext )
+            {
+                iecCliOutPuts( (const char *)(PtrCmdNode->OneLineHelp),
+                               &(PtrSessionInfo->OutFileHandle) );
+            }
+            for( table = 0; table < sCliCmdTableCount; table++ )
+            {
+                for( index = 0; index < sCliCmdTableSize[table]; index++ )
+                {
+                    iecCliOutPuts( (const char *)(sPtrCliCmdTable[table][index]->PtrOneLineHelp),
+                                   &(PtrSessionInfo->OutFileHandle) );
+                }
+            }
+        }
+    }
+    else
+    {
+        PtrCmdNode = cliFindCommand( &PtrSessionInfo->CliCmdList,
+                                     PtrSessionInfo->PtrCmdParams[1],
+                                     &cmdNode,
+                                     NULL,
+                                     &ptrArgSchema );
+        if( PtrCmdNode )
+        {
+            iecCliOutPuts( (const char *)(PtrCmdNode->OneLineHelp),
+                           &(PtrSessionInfo->OutFileHandle) );
+
+            /* List the subcommands generated from the subcommand tree */
+            if( (ptrArgSchema != NULL) && (ptrArgSchema->PtrSubCmdTree != NULL) )
+            {
+                iecCliOutPuts( "\r\n    Subcommands:\r\n", &(PtrSessionInfo->OutFileHandle) );
+                cliPrintSubCmdTree( PtrSessionInfo, ptrArgSchema->PtrSubCmdTree,
+                                    path, 0 );
+            }
+        }
+        else
+        {
+            /* Print error msg is the specified command not found */
+            iecCliOutPuts( (const char *)sPtrCliCmdNotFound, &(PtrSessionInfo->OutFileHandle) );
+        }
+    }
+
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle),"\r\n\n%s", gPtrCliPrintHeader);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   cliHistorySearchShow()
+ *
+ * @Description: This function shows the query and the match of the reverse
+ *               history search on the command line. The line editor only
+ *               redraws what changed since the last key.
+ *
+ * @param  PtrSearch - History search state.
+ *
+ * @param  PtrEditor - Line editor of the session.
+ *
+ * @param  PtrInputBuff - Command line buffer.
+ *
+ * @param  PtrOutFileHandle - File Handle pointer
+ *
+ *****************************************************************************/
+static void cliHistorySearchShow(PTR_CLI_HISTORY_SEARCH PtrSearch,
+                                 PTR_IEC_CLI_EDITOR PtrEditor,
+                                 PU8 PtrInputBuff,
+                                 FILE *PtrOutFileHandle)
+{
+    U8  display[CLI_MAX_CMD_LINE_LENGTH];
+    S32 length;
+
+    length = snprintf((char *)display, sizeof(display), "(%si-search)`%.*s': %s",
+                      PtrSearch->Failed ? "failed " : "",
+                      PtrSearch->QueryLength, PtrSearch->Query,
+                      PtrSearch->Match);
+    if (length >= (S32)sizeof(display))
+    {
+        length = sizeof(display) - 1;
+    }
+
+    iecCliEditorReplace(PtrEditor, PtrInputBuff, display, length,
+                        PtrOutFileHandle);
+}
+
+/**
+ * @Name:   cliHistorySearchKey()
+ *
+ * @Description: This function handles a key during the reverse history
+ *               search. Characters extend the query and Ctrl-R looks for an
+ *               older match, each key is bounded by the history search.
+ *               Ctrl-G aborts the search. Any other key puts the match on the
+ *               command line and is then handled as usual.
+ *
+ * @param  PtrSearch - History search state.
+ *
+ * @param  Key - Key decoded from the input.
+ *
+ * @param  Char - Character for IEC_CLI_KEY_CHAR.
+ *
+ * @param  PtrEditor - Line editor of the session.
+ *
+ * @param  PtrHistory - Command history of the session.
+ *
+ * @param  PtrInputBuff - Command line buffer.
+ *
+ * @param  PtrOutFileHandle - File Handle pointer
+ *
+ * @return key still to handle, IEC_CLI_KEY_NONE if the search used it.
+ *
+ *****************************************************************************/
+static IEC_CLI_KEY cliHistorySearchKey(PTR_CLI_HISTORY_SEARCH PtrSearch,
+                                       IEC_CLI_KEY Key,
+                                       U8 Char,
+                                       PTR_IEC_CLI_EDITOR PtrEditor,
+                                       PTR_CLI_CMD_HISTORY PtrHistory,
+                                       PU8 PtrInputBuff,
+                                       FILE *PtrOutFileHandle)
+{
+    U8  found[CLI_MAX_CMD_LINE_LENGTH];
+    U32 startSeq;
+    U32 matchSeq;
+
+    switch (Key)
+    {
+        case IEC_CLI_KEY_NONE:
+            return IEC_CLI_KEY_NONE;
+
+        case IEC_CLI_KEY_CHAR:
+            if (PtrSearch->QueryLength + 1 >= CLI_MAX_CMD_LINE_LENGTH)
+            {
+                return IEC_CLI_KEY_NONE;
+            }
+            PtrSearch->Query[PtrSearch->QueryLength++] = Char;
+            /* The current match is kept while it still contains the query */
+            startSeq = (PtrSearch->MatchSeq != 0) ?
+                       PtrSearch->MatchSeq : PtrHistory->Sequence;
+            break;
+
+        case IEC_CLI_KEY_BACKSPACE:
+            if (PtrSearch->QueryLength == 0)
+            {
+                return IEC_CLI_KEY_NONE;
+            }
+            PtrSearch->QueryLength--;
+            startSeq = PtrHistory->Sequence;
+            break;
+
+        case IEC_CLI_KEY_SEARCH:
+            if (PtrSearch->MatchSeq <= 1)
+            {
+                return IEC_CLI_KEY_NONE;
+            }
+            startSeq = PtrSearch->MatchSeq - 1;
+            break;
+
+        case IEC_CLI_KEY_CANCEL:
+            PtrSearch->Active = FALSE;
+            iecCliEditorReplace(PtrEditor, PtrInputBuff, (const U8 *)"", 0,
+                                PtrOutFileHandle);
+            return IEC_CLI_KEY_NONE;
+
+        default:
+            /* Accept the match */
+            PtrSearch->Active = FALSE;
+            iecCliEditorReplace(PtrEditor, PtrInputBuff, PtrSearch->Match,
+                                strlen((const char *)PtrSearch->Match),
+                                PtrOutFileHandle);
+            PtrEditor->HistorySeq = PtrSearch->MatchSeq;
+            return Key;
+    }
+
+    /* Ctrl-R skips older copies of the current match */
+    do
+    {
+        matchSeq = cliHistorySearch(PtrHistory, PtrSearch->Query,
+                                    PtrSearch->QueryLength, startSeq, found);
+        startSeq = matchSeq - 1;
+    } while ((Key == IEC_CLI_KEY_SEARCH) && (matchSeq > 1)
+             && (strcmp((const char *)found, (const char *)PtrSearch->Match) == 0));
+
+    if ((matchSeq != 0)
+        && ((Key != IEC_CLI_KEY_SEARCH)
+            || (strcmp((const char *)found, (const char *)PtrSearch->Match) != 0)))
+    {
+        memcpy(PtrSearch->Match, found, sizeof(found));
+        PtrSearch->MatchSeq = matchSeq;
+        PtrSearch->Failed = FALSE;
+    }
+    else if (PtrSearch->QueryLength == 0)
+    {
+        PtrSearch->MatchSeq = 0;
+        PtrSearch->Match[0] = '\0';
+        PtrSearch->Failed = FALSE;
+    }
+    else
+    {
+        /* Keep the last match, like the failed search of a shell */
+        PtrSearch->Failed = TRUE;
+    }
+
+    cliHistorySearchShow(PtrSearch, PtrEditor, PtrInputBuff, PtrOutFileHandle);
+
+    return IEC_CLI_KEY_NONE;
+}
+
+/**
+ * @Name:   cliCompletionAdd()
+ *
+ * @Description: This function adds a completion candidate. Candidates not
+ *               starting with the word being completed are ignored. The
+ *               common prefix of the candidates is kept, or the candidate
+ *               is listed when PtrListFileHandle is set.
+ *
+ * @param  PtrCompletion - Completion state.
+ *
+ * @param  PtrCandidate - Candidate.
+ *
+ *****************************************************************************/
+static void cliCompletionAdd(PTR_CLI_COMPLETION PtrCompletion,
+                             const char *PtrCandidate)
+{
+    U16 index;
+
+    if (strncmp(PtrCandidate, (const char *)PtrCompletion->PtrWord,
+                PtrCompletion->WordLength) != 0)
+    {
+        return;
+    }
+
+    if (PtrCompletion->PtrListFileHandle != NULL)
+    {
+        iecCliOutPuts("\r\n", PtrCompletion->PtrListFileHandle);
+        iecCliOutPuts(PtrCandidate, PtrCompletion->PtrListFileHandle);
+    }
+    else if (PtrCompletion->Count == 0)
+    {
+        for (index = 0;
+             (index < sizeof(PtrCompletion->Common)) && (PtrCandidate[index] != '\0');
+             index++)
+        {
+            PtrCompletion->Common[index] = PtrCandidate[index];
+        }
+        PtrCompletion->CommonLength = index;
+    }
+    else
+    {
+        for (index = 0;
+             (index < PtrCompletion->CommonLength) &&
+             (PtrCompletion->Common[index] == (U8)PtrCandidate[index]);
+             index++)
+        {
+        }
+        PtrCompletion->CommonLength = index;
+    }
+
+    PtrCompletion->Count++;
+}
+
+/**
+ * @Name:   cliCompleteCommand()
+ *
+ * @Description: This function adds the command names starting with the word
+ *               being completed. The names are found by binary search in
+ *               the sorted name array of the dispatch index, only the first
+ *               and last name of the range are compared for the common
+ *               prefix. The commands of the session in front of the core
+ *               commands, and a command list without them, are walked.
+ *
+ * @param  PtrCompletion - Completion state.
+ *
+ * @param  PtrCliCmdList - Command list of the session.
+ *
+ *****************************************************************************/
+static void cliCompleteCommand(PTR_CLI_COMPLETION PtrCompletion,
+                               PTR_CLI_CMD_LIST PtrCliCmdList)
+{
+    PTR_CLI_CMD_NODE ptrCmdNode;
+    U32 low;
+    U32 high;
+    U32 middle;
+    U32 first;
+    U16 count;
+
+    for (ptrCmdNode = PtrCliCmdList->PtrCliCmdListHead;
+         (ptrCmdNode != NULL) && (cliCmdIsCore(ptrCmdNode) == FALSE);
+         ptrCmdNode = ptrCmdNode->PtrNext)
+    {
+        cliCompletionAdd(PtrCompletion, (const char *)ptrCmdNode->Command);
+    }
+
+    if (cliCmdIsCore(ptrCmdNode) == FALSE)
+    {
+        return;
+    }
+
+    if (sCliCmdIndexBuilt == FALSE)
+    {
+        for ( ; ptrCmdNode != NULL; ptrCmdNode = ptrCmdNode->PtrNext)
+        {
+            cliCompletionAdd(PtrCompletion, (const char *)ptrCmdNode->Command);
+        }
+        for (first = 0; first < sCliCmdTableCount; first++)
+        {
+            for (middle = 0; middle < sCliCmdTableSize[first]; middle++)
+            {
+                cliCompletionAdd(PtrCompletion,
+                                 (const char *)sPtrCliCmdTable[first][middle]->PtrCmdName);
+            }
+        }
+        return;
+    }
+
+    /* First name not below the word */
+    low = 0;
+    high = sCliCmdSortedCount;
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (strncmp((const char *)CLI_CMD_SORTED_NAME(middle),
+                    (const char *)PtrCompletion->PtrWord,
+                    PtrCompletion->WordLength) < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    first = low;
+
+    /* First name past the names starting with the word */
+    high = sCliCmdSortedCount;
+    while (low < high)
+    {
+        middle = (low + high) / 2;
+        if (strncmp((const char *)CLI_CMD_SORTED_NAME(middle),
+                    (const char *)PtrCompletion->PtrWord,
+                    PtrCompletion->WordLength) <= 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == first)
+    {
+        return;
+    }
+
+    if (PtrCompletion->PtrListFileHandle != NULL)
+    {
+        for (middle = first; middle < low; middle++)
+        {
+            cliCompletionAdd(PtrCompletion,
+                             (const char *)CLI_CMD_SORTED_NAME(middle));
+        }
+        return;
+    }
+
+    /* The names are sorted, the common prefix of the range is the one of
+     * its first and last name.
+     */
+    count = PtrCompletion->Count;
+    cliCompletionAdd(PtrCompletion, (const char *)CLI_CMD_SORTED_NAME(first));
+    cliCompletionAdd(PtrCompletion, (const char *)CLI_CMD_SORTED_NAME(low - 1));
+    PtrCompletion->Count = count + (U16)(low - first);
+}
+
+/**
+ * @Name:   cliCompleteArgSpec()
+ *
+ * @Description: This function adds the keywords of a keyword argument and
+ *               the candidates of the completion callback of the argument.
+ *
+ * @param  PtrCompletion - Completion state.
+ *
+ * @param  PtrArgSpec - Argument description.
+ *
+ *****************************************************************************/
+static void cliCompleteArgSpec(PTR_CLI_COMPLETION PtrCompletion,
+                               const CLI_ARG_SPEC *PtrArgSpec)
+{
+    const char * const *ptrKeyword;
+    char candidate[CLI_MAX_CMD_LINE_LENGTH];
+    U32 cursor = 0;
+
+    if (PtrArgSpec->Type == CLI_ARG_TYPE_KEYWORD)
+    {
+        for (ptrKeyword = PtrArgSpec->PtrKeywords; *ptrKeyword != NULL; ptrKeyword++)
+        {
+            cliCompletionAdd(PtrCompletion, *ptrKeyword);
+        }
+    }
+
+    if (PtrArgSpec->PtrCompleter != NULL)
+    {
+        while (PtrArgSpec->PtrCompleter(&cursor, candidate, sizeof(candidate)))
+        {
+            cliCompletionAdd(PtrCompletion, candidate);
+        }
+    }
+}
+
+/**
+ * @Name:   cliCompleteWord()
+ *
+ * @Description: This function adds the candidates of the word being
+ *               completed. The first word is a command name. The words
+ *               before the argument being completed are followed through
+ *               the argument schema or the subcommand tree of the command,
+ *               so only the keywords and values valid at that position are
+ *               offered.
+ *
+ * @param  PtrCompletion - Completion state.
+ *
+ * @param  PtrLine - Command line.
+ *
+ * @param  PtrCliCmdList - Command list of the session.
+ *
+ *****************************************************************************/
+static void cliCompleteWord(PTR_CLI_COMPLETION PtrCompletion,
+                            const U8 *PtrLine,
+                            PTR_CLI_CMD_LIST PtrCliCmdList)
+{
+    const CLI_ARG_SCHEMA *ptrArgSchema;
+    const CLI_SUBCMD_NODE *ptrNode;
+    const CLI_SUBCMD_NODE *ptrChild;
+    CLI_CMD_NODE cmdNode;
+    const U8 *ptrEnd = PtrCompletion->PtrWord;
+    U8  token[CLI_MAX_CMD_LINE_LENGTH];
+    U32 tokenLength;
+    U32 argIndex;
+    U32 index;
+    U32 value;
+
+    /* Command name */
+    while ((PtrLine < ptrEnd) && (*PtrLine == CLI_SPACE))
+    {
+        PtrLine++;
+    }
+    if (PtrLine == ptrEnd)
+    {
+        cliCompleteCommand(PtrCompletion, PtrCliCmdList);
+        return;
+    }
+
+    for (tokenLength = 0; PtrLine[tokenLength] != CLI_SPACE; tokenLength++)
+    {
+        token[tokenLength] = PtrLine[tokenLength];
+    }
+    token[tokenLength] = '\0';
+    PtrLine += tokenLength;
+
+    if ((cliFindCommand(PtrCliCmdList, token, &cmdNode, NULL, &ptrArgSchema) == NULL) ||
+        (ptrArgSchema == NULL))
+    {
+        return;
+    }
+
+    ptrNode = ptrArgSchema->PtrSubCmdTree;
+
+    /* Arguments before the one being completed */
+    for (argIndex = 0; ; argIndex++)
+    {
+        while ((PtrLine < ptrEnd) && (*PtrLine == CLI_SPACE))
+        {
+            PtrLine++;
+        }
+        if (PtrLine == ptrEnd)
+        {
+            break;
+        }
+
+        for (tokenLength = 0; PtrLine[tokenLength] != CLI_SPACE; tokenLength++)
+        {
+            token[tokenLength] = PtrLine[tokenLength];
+        }
+        token[tokenLength] = '\0';
+        PtrLine += tokenLength;
+
+        if (ptrNode == NULL)
+        {
+            continue;
+        }
+
+        ptrChild = cliFindSubCmd(ptrNode, token);
+        if ((ptrChild == NULL) &&
+            (ptrNode->PtrValueChild != NULL) &&
+            (cliConvertArg(ptrNode->PtrValueChild->PtrValueSpec,
+                           token, tokenLength, &value) == TRUE))
+        {
+            ptrChild = ptrNode->PtrValueChild;
+        }
+        if (ptrChild == NULL)
+        {
+            /* Nothing valid follows an invalid token */
+            return;
+        }
+        ptrNode = ptrChild;
+    }
+
+    if (ptrNode == NULL)
+    {
+        if ((argIndex < ptrArgSchema->MaxArgs) && (ptrArgSchema->PtrArgSpec != NULL))
+        {
+            cliCompleteArgSpec(PtrCompletion, &ptrArgSchema->PtrArgSpec[argIndex]);
         }
-        else if (userInput == CLI_SPACE)
+        return;
+    }
+
+    /* The subcommand trees are small, the keyword children are scanned */
+    for (index = 0; index < ptrNode->ChildCount; index++)
+    {
+        cliCompletionAdd(PtrCompletion, ptrNode->PtrChildren[index].PtrKeyword);
+    }
+    if (ptrNode->PtrValueChild != NULL)
+    {
+        cliCompleteArgSpec(PtrCompletion, ptrNode->PtrValueChild->PtrValueSpec);
+    }
+}
+
+/**
+ * @Name:   cliComplete()
+ *
+ * @Description: This function completes the word before the cursor when TAB
+ *               is pressed at the end of the line. The word is extended to
+ *               the longest common prefix of the candidates, a single
+ *               candidate is completed with a space. When the word cannot be
+ *               extended and there are several candidates, they are listed
+ *               and the prompt and the line are shown again, the typed line
+ *               is kept.
+ *
+ * @param  PtrEditor - Line editor of the session.
+ *
+ * @param  PtrInputBuff - Command line buffer.
+ *
+ * @param  PtrCliCmdList - Command list of the session.
+ *
+ * @param  PtrOutFileHandle - File Handle pointer
+ *
+ *****************************************************************************/
+static void cliComplete(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrInputBuff,
+                        PTR_CLI_CMD_LIST PtrCliCmdList,
+                        FILE *PtrOutFileHandle)
+{
+    CLI_COMPLETION completion;
+    U16 start;
+    U16 index;
+
+    if (PtrEditor->Cursor != PtrEditor->Length)
+    {
+        return;
+    }
+
+    for (start = PtrEditor->Length;
+         (start > 0) && (PtrInputBuff[start - 1] != CLI_SPACE);
+         start--)
+    {
+    }
+
+    /* The words before the one being completed all end with a space */
+    memset(&completion, 0, sizeof(completion));
+    completion.PtrWord = &PtrInputBuff[start];
+    completion.WordLength = PtrEditor->Length - start;
+    cliCompleteWord(&completion, PtrInputBuff, PtrCliCmdList);
+
+    if ((completion.Count > 1) && (completion.CommonLength == completion.WordLength))
+    {
+        completion.PtrListFileHandle = PtrOutFileHandle;
+        cliCompleteWord(&completion, PtrInputBuff, PtrCliCmdList);
+
+        iecCliOutPuts((const char *)sPtrCliPrompt, PtrOutFileHandle);
+        iecCliOutWrite(PtrOutFileHandle, PtrInputBuff, PtrEditor->Length);
+    }
+
+    if ((completion.Count == 0) || (completion.PtrListFileHandle != NULL))
+    {
+        return;
+    }
+
+    for (index = completion.WordLength; index < completion.CommonLength; index++)
+    {
+        if (!iecCliEditorInsert(PtrEditor, PtrInputBuff,
+                                completion.Common[index], PtrOutFileHandle))
         {
-            spaceInput = TRUE;
+            return;
         }
+    }
+
+    if (completion.Count == 1)
+    {
+        iecCliEditorInsert(PtrEditor, PtrInputBuff, CLI_SPACE, PtrOutFileHandle);
+    }
+}
+
+/**
+ * @Name:   cliGetString()
+ *
+ * @Description: This function reads user input string using getchar
+ *            function. This is the default function used by
+ *            CLI core to read input string.
+ *            The line is edited with the line editor of the session
+ *            (iecCliEditor.c): cursor keys, Home, End, Delete and
+ *            mid-line insert and delete are supported. TAB
+ *            completes the command name or argument at the end of the
+ *            line.
+ *
+ * @param  PtrInputBuff - memory pointer to store user input string
+ *
+ * @param PtrOutFileHandle File Handle pointer
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+void cliGetString( PU8 PtrInputBuff, FILE *PtrOutFileHandle )
+{
+    S32     userInput;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+    IEC_CLI_EDITOR localEditor;
+    PTR_IEC_CLI_EDITOR ptrEditor;
+    PTR_CLI_CMD_LIST ptrCmdList;
+    PTR_CLI_CMD_HISTORY ptrHistory = iecCliSessionHistory(ptrCtx);
+    U8 historyLine[CLI_MAX_CMD_LINE_LENGTH];
+    U16 historyLength;
+    U32 historySeq;
+    CLI_HISTORY_SEARCH search;
+    IEC_CLI_KEY key;
+
+    /* Sessions without a context decode escape sequences one line at a time
+     * and complete the core commands only.
+     */
+    if (ptrCtx != NULL)
+    {
+        ptrEditor = &ptrCtx->Editor;
+        ptrCmdList = &ptrCtx->PtrSessionInfo->CliCmdList;
+    }
+    else
+    {
+        memset(&localEditor, 0, sizeof(localEditor));
+        ptrEditor = &localEditor;
+        ptrCmdList = &sCliCmdList;
+    }
+
+    iecCliEditorStart(ptrEditor);
+    PtrInputBuff[0] = '\0';
+    search.Active = FALSE;
 
-        /* Echo back the character received */
-        if (userInput == CLI_TAB
-            && !spaceInput)
+    for (;;)
+    {
+        /* Read User Input - one char at a time from the input queue, the
+         * echo is flushed when the queue runs empty.
+         */
+        userInput = iecCliInGetc(PtrOutFileHandle);
+        if( userInput == HALI_EOF )
         {
-            /* Don't echo the first tab */
+            PtrInputBuff[0] = (U8)userInput;
+            return;
         }
-        else
+
+        key = iecCliEditorDecode(ptrEditor, (U8)userInput);
+        if (search.Active)
         {
-            fputc(userInput, PtrOutFileHandle);
+            key = cliHistorySearchKey(&search, key, (U8)userInput, ptrEditor,
+                                      ptrHistory, PtrInputBuff,
+                                      PtrOutFileHandle);
         }
-        /* Read input from command line until user press Enter.*/
-        if( (userInput != CLI_CR) &&
-            (indexCounter < (CLI_MAX_CMD_LINE_LENGTH) )
-          )
+
+        switch (key)
         {
-            /* If input is Backspace, then clear last character read. */
-            if( (userInput == CLI_BACKSPACE) && (indexCounter > 0) )
-            {
-                indexCounter--;
-                PtrInputBuff[indexCounter] = '\0';
+            case IEC_CLI_KEY_CHAR:
+                if (!iecCliEditorInsert(ptrEditor, PtrInputBuff,
+                                        (U8)userInput, PtrOutFileHandle))
+                {
+                    /* Clear the command.*/
+                    PtrInputBuff[0] = '\0';
+                    iecCliOutPuts("\r\n\n Command too long.\r\n", PtrOutFileHandle);
+                    return;
+                }
+                break;
 
-                /* This will show the action of back space in user input program */
-                fputc(CLI_SPACE, PtrOutFileHandle);
-                fputc(CLI_BACKSPACE, PtrOutFileHandle);
-            }
+            case IEC_CLI_KEY_BACKSPACE:
+                iecCliEditorBackspace(ptrEditor, PtrInputBuff, PtrOutFileHandle);
+                break;
 
-            /* Added by XQJ 20180119 for commmand autocomplete. */
-            /* 
-            ** If input is TAB and no space has been inputed so far,
-            ** then try to autocomplete the command.
-            */
-            else if ((userInput == CLI_TAB) && !spaceInput)
-            {
-                char * result;
-                U8 count = iecCliSearchCommand((const char *)(PtrInputBuff),
-                                    indexCounter,
-                                    &result,
-                                    sCliCmdList);
-                if (count == 0)
+            case IEC_CLI_KEY_DELETE:
+                iecCliEditorDelete(ptrEditor, PtrInputBuff, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_LEFT:
+                if (ptrEditor->Cursor > 0)
+                {
+                    iecCliEditorMoveTo(ptrEditor, PtrInputBuff,
+                                       ptrEditor->Cursor - 1, PtrOutFileHandle);
+                }
+                break;
+
+            case IEC_CLI_KEY_RIGHT:
+                iecCliEditorMoveTo(ptrEditor, PtrInputBuff,
+                                   ptrEditor->Cursor + 1, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_HOME:
+                iecCliEditorMoveTo(ptrEditor, PtrInputBuff, 0, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_END:
+                iecCliEditorMoveTo(ptrEditor, PtrInputBuff,
+                                   ptrEditor->Length, PtrOutFileHandle);
+                break;
+
+            /* The history cursor of the session holds the sequence number
+             * of the recalled command, so commands added by other sessions
+             * meanwhile do not move it.
+             */
+            case IEC_CLI_KEY_UP:
+                if (ptrHistory == NULL)
                 {
-                    /* Invalid command, just continue. */
-                    continue;
-                }                    
-                else if ( count == 1)
+                    break;
+                }
+                historyLength = 0;
+                if (ptrEditor->FlashSeq == 0)
                 {
-                    /* Move cursor to the start. */
-                    while (indexCounter--)
+                    historySeq = (ptrEditor->HistorySeq == 0) ?
+                                 ptrHistory->Sequence : ptrEditor->HistorySeq - 1;
+                    historyLength = cliHistoryGet(ptrHistory, historySeq, historyLine);
+                    if (historyLength != 0)
                     {
-                        fputc('\b', PtrOutFileHandle);
+                        ptrEditor->HistorySeq = historySeq;
                     }
-
-                    fputs(result, PtrOutFileHandle);
-                    memcpy(PtrInputBuff, result, strlen(result));
-                    indexCounter = strlen(result);
-
-                    fputc(CLI_SPACE, PtrOutFileHandle);
-                    PtrInputBuff[indexCounter] = CLI_SPACE;
-                    indexCounter++;
-                    
-                    continue;
                 }
-                else
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+                /* Past the oldest session command, continue with the
+                 * commands of the previous boots, loaded on first use.
+                 */
+                if ((historyLength == 0) && (cliHistoryFlashLoad() != NULL))
                 {
-                    /* Print all the commands that are matched. */
-                    PTR_CLI_CMD_NODE PtrCmdNode  = sCliCmdList.PtrCliCmdListHead;
-                    
-                    for (; PtrCmdNode; PtrCmdNode = PtrCmdNode->PtrNext)
+                    historySeq = (ptrEditor->FlashSeq == 0) ?
+                                 cliHistoryFlashLoad()->Sequence :
+                                 ptrEditor->FlashSeq - 1;
+                    historyLength = cliHistoryGet(cliHistoryFlashLoad(),
+                                                  historySeq, historyLine);
+                    if (historyLength != 0)
                     {
-                        if( strncmp((char *)(PtrCmdNode->Command),
-                                    (char *)PtrInputBuff,
-                                    indexCounter) == 0 )
-                        {
-                            fputs("\r\n", PtrOutFileHandle);
-                            fputs((const char *)PtrCmdNode->Command,
-                                PtrOutFileHandle);
-                        }                   
+                        ptrEditor->FlashSeq = historySeq;
                     }
-                    PtrInputBuff[0] = '\0';
+                }
+#endif
+                if (historyLength == 0)
+                {
+                    /* Oldest command reached */
                     break;
                 }
-            }
-            /*if input character is arrow key*/
-            /* Adding here. */
-            else
-            {
-              
-              U8 keyCode = iecCliArrowHandle((U8)userInput);
-                /*encounter UP_KEY
-                *1.  indexCounter=0 in case of over max of command line length;
-                *2   search last command from list.
-                *3   print last command use fputs() before move start line;
-                *4.  copy command info ptrinputBuffer and indexCounter should
-                *    be length of command.
-                *    continue ; if key_up again command should be previous than
-                *    last command.
-                */  
-              switch(keyCode)
-              {
-                    case 2:
-                        arrowFlag = TRUE;
-                        keyTimes++;
-                        fputc('\n', PtrOutFileHandle);
-                        break;
-                    case 4:
-                        arrowFlag = TRUE;
-                        keyTimes--;
+                iecCliEditorReplace(ptrEditor, PtrInputBuff, historyLine,
+                                    historyLength, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_DOWN:
+                if (ptrHistory == NULL)
+                {
+                    break;
+                }
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+                if (ptrEditor->FlashSeq != 0)
+                {
+                    historySeq = ptrEditor->FlashSeq + 1;
+                    historyLength = cliHistoryGet(cliHistoryFlashLoad(),
+                                                  historySeq, historyLine);
+                    if (historyLength != 0)
+                    {
+                        ptrEditor->FlashSeq = historySeq;
+                        iecCliEditorReplace(ptrEditor, PtrInputBuff, historyLine,
+                                            historyLength, PtrOutFileHandle);
                         break;
-                    default:
-                        /* save user input.*/
-                        PtrInputBuff[indexCounter] = (U8)userInput;
-                        indexCounter++;
-                        arrowFlag = FALSE;
-                        break;                       
-               }   
-         if(arrowFlag)
-         {    
-            if(keyTimes <= counter)
-            {
-              // echo null if upkeys over max index of command list.
-              
-            }else
-            {
-                  keyTimes = counter;
-            }
-            
-            lastResult = cliSearchString(keyTimes, maxLength,
-                            sCliCmdHistory.PtrCliCmdListHead, PtrOutFileHandle);
-            fflush(PtrOutFileHandle);
-            PtrInputBuff[0] = '\0';
-            indexCounter = 0;
+                    }
+
+                    /* Back to the oldest session command recalled */
+                    ptrEditor->FlashSeq = 0;
+                    historySeq = ptrEditor->HistorySeq;
+                }
+                else
+#endif
+                if (ptrEditor->HistorySeq != 0)
+                {
+                    historySeq = ptrEditor->HistorySeq + 1;
+                }
+                else
+                {
+                    break;
+                }
+                historyLength = cliHistoryGet(ptrHistory, historySeq, historyLine);
+                if (historyLength == 0)
+                {
+                    /* Back to the empty line */
+                    historySeq = 0;
+                }
+                ptrEditor->HistorySeq = historySeq;
+                iecCliEditorReplace(ptrEditor, PtrInputBuff, historyLine,
+                                    historyLength, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_SEARCH:
+                if (ptrHistory == NULL)
+                {
+                    break;
+                }
+                search.Active = TRUE;
+                search.Failed = FALSE;
+                search.QueryLength = 0;
+                search.MatchSeq = 0;
+                search.Match[0] = '\0';
+                cliHistorySearchShow(&search, ptrEditor, PtrInputBuff,
+                                     PtrOutFileHandle);
+                break;
+
+            /* Added by XQJ 20180119 for commmand autocomplete. */
+            /*
+            ** If input is TAB at the end of a line, then try to
+            ** autocomplete the command name or the argument.
+            */
+            case IEC_CLI_KEY_TAB:
+                cliComplete(ptrEditor, PtrInputBuff, ptrCmdList, PtrOutFileHandle);
+                break;
+
+            case IEC_CLI_KEY_ENTER:
+                iecCliOutPutc(CLI_CR, PtrOutFileHandle);
+
+                /* Also copy into history list. */
+                if (ptrHistory != NULL)
+                {
+                    cliHistoryAdd(ptrHistory, PtrInputBuff);
+                }
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+                cliHistoryFlashAppend(PtrInputBuff);
+#endif
+                return;
+
+            default:
+                break;
         }
-     }
-   }
-            
- }while( (userInput != CLI_CR) && (indexCounter < CLI_MAX_CMD_LINE_LENGTH) );
-             
-    if(arrowFlag && lastResult != NULL)
-    {
-         
-        memcpy(PtrInputBuff, lastResult, strlen(lastResult));
-        indexCounter = strlen(lastResult);
-    }
-     /*also copy into history list.
-      * initialize heap of command line meanwhile insert command line;
-      * if input CL_CR , it must be ignore;
-      */ 
-    if(indexCounter >= 1 && arrowFlag == FALSE)
-    {   
-                 
-        if(historyNode)
-        {
-            counter++;
-            maxLength = (maxLength > indexCounter) ? maxLength : indexCounter;
-            cliInsertNode(counter, PtrInputBuff, &historyNode);
-         }
-    } 
-    if( indexCounter == (CLI_MAX_CMD_LINE_LENGTH))
-    {
-        /* Clear the command.*/
-        PtrInputBuff[0] = '\0';
-        fprintf(PtrOutFileHandle, \
-                "\r\n\n Command too long.\r\n");
     }
 }
 
@@ -1605,421 +5213,43 @@ CLI_STATUS cliMaxSessionsExceededHandler( PTR_CLI_SESSION_INFO PtrCliSessionInfo
  *****************************************************************************/
 void cliErrorHandler( CLI_STATUS retStatus, PTR_CLI_SESSION_INFO PtrCliSessionInfo )
 {
-     BOOL   syntax = FALSE; /* Flag to determine if syntax of command should be printed.*/
-     static const char *errMessage = "";
-
-
-     /*find what the return status of the command was.*/
-     switch( retStatus )
-     {
-     case CLI_STATUS_SUCCESS:
-            errMessage = errorString[CLI_STATUS_SUCCESS];
-            break;
-
-     case CLI_STATUS_FAILED:
-            errMessage = errorString[CLI_STATUS_FAILED];
-            break;
-
-     case CLI_STATUS_SYNTAX:
-            errMessage = errorString[CLI_STATUS_SYNTAX];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_WRT_TYPE:
-            errMessage = errorString[CLI_STATUS_INVALID_WRT_TYPE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_ADDRESS:
-            errMessage = errorString[CLI_STATUS_INVALID_ADDRESS];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_HIGH_SAS_ADD:
-            errMessage = errorString[CLI_STATUS_INVALID_HIGH_SAS_ADD];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_LOW_SAS_ADD:
-            errMessage = errorString[CLI_STATUS_INVALID_LOW_SAS_ADD];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_SYNTAX:
-            errMessage = errorString[CLI_STATUS_INVALID_SYNTAX];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PARAMETER:
-            errMessage = errorString[CLI_STATUS_INVALID_PARAMETER];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_MEM_LEN:
-            errMessage = errorString[CLI_STATUS_INVALID_MEM_LEN];
-            syntax = TRUE;
-            break;
-
-         case CLI_STATUS_INVALID_ALL_LEN:
-             errMessage = errorString[CLI_STATUS_INVALID_ALL_LEN];
-             syntax = TRUE;
-             break;
-
-        case CLI_STATUS_DATA_OVERFLOW_8:
-            errMessage = errorString[CLI_STATUS_DATA_OVERFLOW_8];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_DATA_OVERFLOW_16:
-            errMessage = errorString[CLI_STATUS_DATA_OVERFLOW_16];
-            syntax = TRUE;
-            break;
-        case CLI_STATUS_DATA_OVERFLOW_32:
-            errMessage = errorString[CLI_STATUS_DATA_OVERFLOW_32];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_WRT_DATA:
-            errMessage = errorString[CLI_STATUS_INVALID_WRT_DATA];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_THREAD_ERROR:
-            errMessage = errorString[CLI_STATUS_THREAD_ERROR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_READ_CFG_ERR:
-            errMessage = errorString[CLI_STATUS_READ_CFG_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PG_ID:
-            errMessage = errorString[CLI_STATUS_INVALID_PG_ID];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_REGION:
-            errMessage = errorString[CLI_STATUS_INVALID_REGION];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_ERASE_FAILED:
-            errMessage = errorString[CLI_STATUS_ERASE_FAILED];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_ERASE_PARAM:
-            errMessage = errorString[CLI_STATUS_INVALID_ERASE_PARAM];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_RD_MFG_FAILED:
-            errMessage = errorString[CLI_STATUS_RD_MFG_FAILED];
-            break;
-
-        case CLI_STATUS_RD_LOG_ERROR:
-            errMessage = errorString[CLI_STATUS_RD_LOG_ERROR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_STRING:
-            errMessage = errorString[CLI_STATUS_INVALID_STRING];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_NO_QUOTES:
-            errMessage = errorString[CLI_STATUS_NO_QUOTES];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_LOG_ADD_ERR:
-            errMessage = errorString[CLI_STATUS_LOG_ADD_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_CLR_LOG_ERR:
-            errMessage = errorString[CLI_STATUS_CLR_LOG_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_CLEAR_TRACE_ERR:
-            errMessage = errorString[CLI_STATUS_CLEAR_TRACE_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_ENTER_HEX:
-            errMessage = errorString[CLI_STATUS_ENTER_HEX];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_TRACE_ERR:
-            errMessage = errorString[CLI_STATUS_TRACE_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_TRACE_VALID_RANGE:
-            errMessage = errorString[CLI_STATUS_TRACE_VALID_RANGE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_WRT_FAILED:
-            errMessage = errorString[CLI_STATUS_WRT_FAILED];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_TRCMASK:
-            errMessage = errorString[CLI_STATUS_INVALID_TRCMASK];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_SUBSYSTEM:
-            errMessage = errorString[CLI_STATUS_INVALID_SUBSYSTEM];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_BYTE_ERR:
-            errMessage = errorString[CLI_STATUS_BYTE_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_CHANNEL:
-            errMessage = errorString[CLI_STATUS_INVALID_CHANNEL];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_MIR_EN_DISEN_FAIL:
-            errMessage = errorString[CLI_STATUS_MIR_EN_DISEN_FAIL];
-            break;
-
-        case CLI_STATUS_INVALID_RX_PHY:
-            errMessage = errorString[CLI_STATUS_INVALID_RX_PHY];
-            break;
-
-        case CLI_STATUS_INVALID_TX_PHY:
-            errMessage = errorString[CLI_STATUS_INVALID_TX_PHY];
-            break;
-
-        case CLI_STATUS_INVALID_SRC_PHY:
-            errMessage = errorString[CLI_STATUS_INVALID_SRC_PHY];
-            break;
-
-        case CLI_STATUS_INVALID_MIR_PHY:
-            errMessage = errorString[CLI_STATUS_INVALID_MIR_PHY];
-            break;
-
-        case CLI_STATUS_INSUFF_MEM:
-            errMessage = errorString[CLI_STATUS_INSUFF_MEM];
-            break;
-
-        case CLI_STATUS_UART_ONLY:
-            errMessage = errorString[CLI_STATUS_UART_ONLY];
-            break;
-
-        case CLI_STATUS_ETC_DIABLED:
-            errMessage = errorString[CLI_STATUS_ETC_DIABLED];
-            break;
-
-        case CLI_STATUS_ETC_DISABLE_FAIL:
-            errMessage = errorString[CLI_STATUS_ETC_DISABLE_FAIL];
-            break;
-
-        case CLI_STATUS_INVALID_TIMEOUT:
-            errMessage = errorString[CLI_STATUS_INVALID_TIMEOUT];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_MODE:
-            errMessage = errorString[CLI_STATUS_INVALID_MODE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_INTERFACE:
-            errMessage = errorString[CLI_STATUS_INVALID_INTERFACE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_NO_SGX_DEVICES:
-            errMessage = errorString[CLI_STATUS_NO_SGX_DEVICES];
-            break;
-
-        case CLI_STATUS_INVALID_PORT:
-            errMessage = errorString[CLI_STATUS_INVALID_PORT];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_CON_RATE:
-            errMessage = errorString[CLI_STATUS_INVALID_CON_RATE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_XFER_FAILED:
-            errMessage = errorString[CLI_STATUS_XFER_FAILED];
-            break;
-
-        case CLI_STATUS_INVALID_FILE_LEN:
-            errMessage = errorString[CLI_STATUS_INVALID_FILE_LEN];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_FUNC_REQ:
-            errMessage = errorString[CLI_STATUS_INVALID_FUNC_REQ];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_BUF_ID:
-            errMessage = errorString[CLI_STATUS_INVALID_BUF_ID];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_CREATE_THRD_FAILED:
-            errMessage = errorString[CLI_STATUS_CREATE_THRD_FAILED];
-            break;
-
-        case CLI_STATUS_FLASH_ERROR:
-            errMessage = errorString[CLI_STATUS_FLASH_ERROR];
-            break;
-
-        case CLI_STATUS_NO_FLASH:
-            errMessage = errorString[CLI_STATUS_NO_FLASH];
-            break;
-
-        case CLI_STATUS_SRC_GROUP_ERR:
-            errMessage = errorString[CLI_STATUS_SRC_GROUP_ERR];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_SEPRM_DATA:
-            errMessage = errorString[CLI_STATUS_INVALID_SEPRM_DATA];
-            break;
-
-        case CLI_STATUS_RD_SEPRM_ERROR:
-            errMessage = errorString[CLI_STATUS_RD_SEPRM_ERROR];
-            break;
-
-        case CLI_STATUS_INVALID_PARAM_NUM:
-            errMessage = errorString[CLI_STATUS_INVALID_PARAM_NUM];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_ILLEGAL_ARG:
-            errMessage = errorString[CLI_STATUS_ILLEGAL_ARG];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_ILLEGAL_RESET_ARG:
-            errMessage = errorString[CLI_STATUS_ILLEGAL_RESET_ARG];
-            break;
-
-        case CLI_STATUS_INVALID_PKT_SIZE:
-            errMessage = errorString[CLI_STATUS_INVALID_PKT_SIZE];
-            break;
-
-        case CLI_STATUS_INVALID_DELAY_ARG:
-            errMessage = errorString[CLI_STATUS_INVALID_DELAY_ARG];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PATTERN_ARG:
-            errMessage = errorString[CLI_STATUS_INVALID_PATTERN_ARG];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INFO_NOT_AVAILABLE:
-            errMessage = errorString[CLI_STATUS_INFO_NOT_AVAILABLE];
-            break;
-
-        case CLI_STATUS_ERROR_PRINTED:
-            errMessage = errorString[CLI_STATUS_ERROR_PRINTED];
-            break;
-
-        case CLI_STATUS_MEM_DL_FAILED:
-            errMessage = errorString[CLI_STATUS_MEM_DL_FAILED];
-            break;
-
-        case CLI_STATUS_MEM_UL_FAILED:
-            errMessage = errorString[CLI_STATUS_MEM_UL_FAILED];
-            break;
-
-        case CLI_STATUS_FW_DL_FAILED:
-            errMessage = errorString[CLI_STATUS_FW_DL_FAILED];
-            break;
-
-        case CLI_STATUS_FW_UL_FAILED:
-            errMessage = errorString[CLI_STATUS_FW_UL_FAILED];
-            break;
-
-        case CLI_STATUS_INVALID_BUF_OFFSET:
-            errMessage = errorString[CLI_STATUS_INVALID_BUF_OFFSET];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_MEM_ADDRESS:
-            errMessage = errorString[CLI_STATUS_INVALID_MEM_ADDRESS];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_FILENAME:
-            errMessage = errorString[CLI_STATUS_INVALID_FILENAME];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_IP_ADDRESS:
-            errMessage = errorString[CLI_STATUS_INVALID_IP_ADDRESS];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_FILE_SIZE:
-            errMessage = errorString[CLI_STATUS_INVALID_FILE_SIZE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PHYTEST_MODE:
-            errMessage = errorString[CLI_STATUS_INVALID_PHYTEST_MODE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PHYTEST_PATTERN:
-            errMessage = errorString[CLI_STATUS_INVALID_PHYTEST_PATTERN];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PHYTEST_RATE:
-            errMessage = errorString[CLI_STATUS_INVALID_PHYTEST_RATE];
-            syntax = TRUE;
-            break;
-
-        case CLI_STATUS_INVALID_PHYTEST_DURATION:
-            errMessage = errorString[CLI_STATUS_INVALID_PHYTEST_DURATION];
-            syntax = TRUE;
-            break;
+    const CLI_ERROR_ENTRY *ptrError;
 
-        case CLI_STATUS_INVALID_PHYTEST_PHYMASK:
-            errMessage = errorString[CLI_STATUS_INVALID_PHYTEST_PHYMASK];
-            syntax = TRUE;
-            break;
+    /* Look up the return status of the command. A status without an entry
+     * is reported as a generic failure rather than an empty message.
+     */
+    if ( ( (U32)retStatus > (U32)CLI_STATUS_CANCELLED ) ||
+         ( sCliErrorTable[retStatus].PtrMessage == NULL ) )
+    {
+        retStatus = CLI_STATUS_FAILED;
+    }
+    ptrError = &sCliErrorTable[retStatus];
 
-        case CLI_STATUS_MALLOC_FAILED:
-            errMessage = errorString[CLI_STATUS_MALLOC_FAILED];
-            break;
+    /* In TLV mode the host maps the status to its message itself. */
+    if ( iecCliOutTlvMode(&(PtrCliSessionInfo->OutFileHandle)) == TRUE )
+    {
+        IEC_CLI_TLV_STATUS_REC statusRec;
 
-        case CLI_STATUS_INVALID_FW_IMAGE:
-            errMessage = errorString[CLI_STATUS_INVALID_FW_IMAGE];
-            break;
+        statusRec.Status   = (U8)retStatus;
+        statusRec.Severity = ptrError->Severity;
 
-        default:
-            break;
+        iecCliOutTlv(&(PtrCliSessionInfo->OutFileHandle), IEC_CLI_TLV_STATUS,
+                     &statusRec, sizeof(statusRec));
+        return;
     }
 
     /*print required message from the command return.*/
-    fprintf(&(PtrCliSessionInfo->OutFileHandle), "\r\n%s\r\n", errMessage);
+    iecCliOutPrintf(&(PtrCliSessionInfo->OutFileHandle), "\r\n%s\r\n", ptrError->PtrMessage);
 
-    /*verify syntax of the command should be printed.*/
-    if ( syntax == TRUE )
+    /*verify syntax of the command should be printed, a command line that
+     * could not be split may not have a command.*/
+    if ( ( ptrError->PrintSyntax == TRUE ) &&
+         ( PtrCliSessionInfo->PtrCurCommand != NULL ) )
     {
         /*print one line help for command syntax in event of invalid command input.*/
-        fprintf(&(PtrCliSessionInfo->OutFileHandle), "\r\n%s\r\n%s\r\n",
-                errorString[CLI_STATUS_SYNTAX], PtrCliSessionInfo->PtrCurCommand->OneLineHelp);
+        iecCliOutPrintf(&(PtrCliSessionInfo->OutFileHandle), "\r\n%s\r\n%s\r\n",
+                sCliErrorTable[CLI_STATUS_SYNTAX].PtrMessage,
+                PtrCliSessionInfo->PtrCurCommand->OneLineHelp);
     }
 }
 
@@ -0,0 +1,745 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2019- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  cliCoreBench.c
+ *          Title:  Host benchmark of the cliCore.c hot paths
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Initial version, command dispatch.
+ *  10/18/26  AW    Added the startup heap and time.
+ *  10/18/26  AW    Added the tokenizer.
+ *  10/18/26  AW    Added the argument schema check.
+ *  10/18/26  AW    Added the command batch.
+ *  10/18/26  AW    Added the session close.
+ *
+ *
+ * Description
+ * ------------
+ *  Host benchmark of cliCore.c. Like cliCoreTest.c it includes cliCore.c to
+ *  reach the static functions and is linked with iecCli.c, the other CLI
+ *  sources and the host HAL shims, with -DHOSTTEST and -lpthread. Build it
+ *  with -O2 and without sanitizers for figures that mean something. It
+ *  prints one line per measurement and returns 0 unless something went
+ *  wrong.
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+** Include Files
+*/
+
+#include <time.h>
+#include <malloc.h>
+#include "cliCore.c"
+#include "iecCliWatch.h"
+
+#define CLI_BENCH_CMD_MAX       (320)
+#define CLI_BENCH_CMD_NAME_LEN  (16)
+#define CLI_BENCH_LOOKUPS       (2000000)
+#define CLI_BENCH_NODE_LOOPS    (10000)
+#define CLI_BENCH_TOKEN_LINES   (1000000)
+#define CLI_BENCH_ARG_CHECKS    (1000000)
+#define CLI_BENCH_MD_LENGTH_MAX (4096)
+#define CLI_BENCH_BATCH_CMDS    (100)
+#define CLI_BENCH_BATCH_LOOPS   (2000)
+#define CLI_BENCH_PROMPT        "\r\nCLI> "
+#define CLI_BENCH_CLOSE_CYCLES  (200)
+/* Input wait of the benchmark session thread, as a telnet session wakes up */
+#define CLI_BENCH_INPUT_WAIT_MS (2)
+
+static const U16 sCliBenchCmdCounts[] = { 16, 64, 128, CLI_BENCH_CMD_MAX };
+
+static char sCliBenchCmdName[CLI_BENCH_CMD_MAX][CLI_BENCH_CMD_NAME_LEN];
+static CLI_CMD_INFO sCliBenchCmdInfo[CLI_BENCH_CMD_MAX];
+static const CLI_CMD_INFO *sCliBenchCmdTable[CLI_BENCH_CMD_MAX];
+
+static const char *sCliBenchTokenLines[] =
+{
+    "help",
+    "md 0x20000000 64",
+    "iecLog \"multi word entry\" 3",
+    "watch -n 500 memstat",
+    "echo one two three four",
+};
+
+/* "md <hex address> <length>" and "watch -n <ms> <command>" */
+static const char *sCliBenchMdArgs[] = { "md", "0x20000000", "64" };
+static const char *sCliBenchWatchArgs[] = { "watch", "-n", "500", "memstat" };
+
+static const CLI_ARG_SPEC sCliBenchMdSpec[] =
+{
+    { CLI_ARG_TYPE_HEX, 0, 0xFFFFFFFF, NULL, NULL },
+    { CLI_ARG_TYPE_DEC, 1, CLI_BENCH_MD_LENGTH_MAX, NULL, NULL },
+};
+
+static const CLI_ARG_SCHEMA sCliBenchMdSchema =
+{
+    &sCliBenchCmdInfo[0], 2, 2, sCliBenchMdSpec, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS
+};
+
+extern const CLI_ARG_SCHEMA gCliArgWatch;
+
+static U32 sCliBenchSinkWrites;
+static U32 sCliBenchSinkBytes;
+
+static CLI_SESSION_INFO sCliBenchCloseSession;
+
+/**
+ * @Name:   cliBenchNow()
+ *
+ * @Description: This function reads the monotonic clock.
+ *
+ * @return - Time in nanoseconds.
+ *
+ *****************************************************************************/
+static double cliBenchNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((double)now.tv_sec * 1e9) + (double)now.tv_nsec;
+}
+
+/**
+ * @Name:   cliBenchHeapUsed()
+ *
+ * @Description: This function reads the bytes allocated from the heap.
+ *
+ * @return - Bytes in use.
+ *
+ *****************************************************************************/
+static size_t cliBenchHeapUsed(void)
+{
+    return mallinfo2().uordblks;
+}
+
+/**
+ * @Name:   cliBenchStartup()
+ *
+ * @Description: This function times cliCoreInit() and measures its heap
+ *               use, with the session stacks and the dispatch index apart.
+ *               As a baseline it registers the same core commands one node
+ *               each with cliRegisterCommand(), as the tables were before
+ *               they were kept by pointer. It must run before anything else
+ *               touches the core list.
+ *
+ * @return - Number of errors.
+ *
+ *****************************************************************************/
+static U32 cliBenchStartup(void)
+{
+    CLI_CMD_LIST    nodeList;
+    PTR_CLI_CMD_NODE ptrCmdNode;
+    size_t      heapStart;
+    size_t      initHeap;
+    size_t      nodeHeap = 0;
+    size_t      stackHeap;
+    size_t      indexHeap;
+    double      startTime;
+    double      initTime;
+    double      nodeTime;
+    U32         cmdCount;
+    U32         loopCount;
+    U16         table;
+    U16         index;
+
+    heapStart = cliBenchHeapUsed();
+    startTime = cliBenchNow();
+    cliCoreInit();
+    initTime = cliBenchNow() - startTime;
+    initHeap = cliBenchHeapUsed() - heapStart;
+
+    if (sCliCmdIndexBuilt == FALSE)
+    {
+        printf("startup: no dispatch index\n");
+        return 1;
+    }
+
+    cmdCount = sCliCmdList.CliCommandCount;
+    for (table = 0; table < sCliCmdTableCount; table++)
+    {
+        cmdCount += sCliCmdTableSize[table];
+    }
+    stackHeap = sCliSessionPoolStats.Slots * CLI_THREAD_STACK_SIZE;
+    indexHeap = (sCliCmdIndexSize * sizeof(CLI_CMD_INDEX_ENTRY)) + (cmdCount * sizeof(U16));
+
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_NODE_LOOPS; loopCount++)
+    {
+        memset(&nodeList, 0, sizeof(nodeList));
+        heapStart = cliBenchHeapUsed();
+
+        for (table = 0; table < sCliCmdTableCount; table++)
+        {
+            for (index = 0; index < sCliCmdTableSize[table]; index++)
+            {
+                cliRegisterCommand(sPtrCliCmdTable[table][index]->PtrCmdName,
+                                   sPtrCliCmdTable[table][index]->PtrOneLineHelp,
+                                   sPtrCliCmdTable[table][index]->PtrToFunCall,
+                                   &nodeList);
+            }
+        }
+
+        nodeHeap = cliBenchHeapUsed() - heapStart;
+
+        while ((ptrCmdNode = nodeList.PtrCliCmdListHead) != NULL)
+        {
+            nodeList.PtrCliCmdListHead = ptrCmdNode->PtrNext;
+            free(ptrCmdNode);
+        }
+    }
+    nodeTime = (cliBenchNow() - startTime) / CLI_BENCH_NODE_LOOPS;
+
+    printf("startup: cliCoreInit %.1f us for %u commands, heap %zu bytes "
+           "(%zu session stacks, %zu dispatch index, %zu other)\n",
+           initTime / 1000, cmdCount, initHeap, stackHeap, indexHeap,
+           initHeap - stackHeap - indexHeap);
+    printf("startup: one node per table command %.1f us, heap %zu bytes\n",
+           nodeTime / 1000, nodeHeap);
+
+    return 0;
+}
+
+/**
+ * @Name:   cliBenchStrtokTokenize()
+ *
+ * @Description: This function is the strtok() tokenizer of cliParseCmd()
+ *               before cliTokenizeCmdLine() replaced it, kept as the
+ *               baseline. It has no quoting and is not reentrant.
+ *
+ * @param String - Command line, modified in place.
+ *
+ * @param PtrSessionInfo - Receives the tokens.
+ *
+ * @return - Number of tokens, 0 if a token is too long or too many.
+ *
+ *****************************************************************************/
+static U32 cliBenchStrtokTokenize(PU8 String, PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PU8         ptrToken;
+    U32         tkCount = 0;
+    U32         loopCount;
+
+    for (loopCount = 0; loopCount < CLI_MAX_NUM_OF_TOKENS; loopCount++)
+    {
+        PtrSessionInfo->PtrCmdParams[loopCount] = NULL;
+    }
+
+    ptrToken = (PU8)strtok((char *)String, CLI_CMD_DELIMS);
+
+    while (ptrToken != NULL)
+    {
+        if ((strlen((const char *)ptrToken) >= CLI_MAX_TOKEN_LENGTH) ||
+            (tkCount == CLI_MAX_NUM_OF_TOKENS))
+        {
+            return 0;
+        }
+
+        PtrSessionInfo->PtrCmdParams[tkCount] = ptrToken;
+        tkCount++;
+
+        ptrToken = (PU8)strtok(NULL, CLI_CMD_DELIMS);
+    }
+
+    return tkCount;
+}
+
+/**
+ * @Name:   cliBenchTokenize()
+ *
+ * @Description: This function tokenizes CLI_BENCH_TOKEN_LINES lines, in
+ *               turn from sCliBenchTokenLines, with cliTokenizeCmdLine() and
+ *               with the strtok() baseline. Each line is copied first, as
+ *               the tokenizers write into it.
+ *
+ * @return - Number of lines that did not tokenize.
+ *
+ *****************************************************************************/
+static U32 cliBenchTokenize(void)
+{
+    CLI_SESSION_INFO sessionInfo;
+    U8          line[CLI_MAX_CMD_LINE_LENGTH];
+    double      startTime;
+    double      tokenTime;
+    double      strtokTime;
+    U32         lineCount = sizeof(sCliBenchTokenLines) / sizeof(sCliBenchTokenLines[0]);
+    U32         tkCount;
+    U32         loopCount;
+    U32         errors = 0;
+
+    memset(&sessionInfo, 0, sizeof(sessionInfo));
+
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_TOKEN_LINES; loopCount++)
+    {
+        strcpy((char *)line, sCliBenchTokenLines[loopCount % lineCount]);
+        if ((cliTokenizeCmdLine(line, &sessionInfo, &tkCount) != CLI_STATUS_SUCCESS) ||
+            (tkCount == 0))
+        {
+            errors++;
+        }
+    }
+    tokenTime = (cliBenchNow() - startTime) / CLI_BENCH_TOKEN_LINES;
+
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_TOKEN_LINES; loopCount++)
+    {
+        strcpy((char *)line, sCliBenchTokenLines[loopCount % lineCount]);
+        if (cliBenchStrtokTokenize(line, &sessionInfo) == 0)
+        {
+            errors++;
+        }
+    }
+    strtokTime = (cliBenchNow() - startTime) / CLI_BENCH_TOKEN_LINES;
+
+    printf("tokenize: cliTokenizeCmdLine %.1f ns/line, strtok baseline %.1f ns/line\n",
+           tokenTime, strtokTime);
+
+    return errors;
+}
+
+/**
+ * @Name:   cliBenchSetArgs()
+ *
+ * @Description: This function puts the tokens of a command line in the
+ *               session, as the tokenizer would.
+ *
+ * @param PtrSessionInfo - Session to fill.
+ *
+ * @param PtrPtrArgs - Tokens, the command name first.
+ *
+ * @param ArgCount - Number of tokens.
+ *
+ *****************************************************************************/
+static void cliBenchSetArgs(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                            const char **PtrPtrArgs, U32 ArgCount)
+{
+    U32         argIndex;
+
+    memset(PtrSessionInfo, 0, sizeof(*PtrSessionInfo));
+
+    for (argIndex = 0; argIndex < ArgCount; argIndex++)
+    {
+        PtrSessionInfo->PtrCmdParams[argIndex] = (PU8)PtrPtrArgs[argIndex];
+    }
+    PtrSessionInfo->TokenInCmdRcd = ArgCount;
+}
+
+/**
+ * @Name:   cliBenchArgs()
+ *
+ * @Description: This function checks the arguments of "md 0x20000000 64"
+ *               and "watch -n 500 memstat" CLI_BENCH_ARG_CHECKS times each,
+ *               with cliCheckArgs() and their schemas, and with the
+ *               sscanf("%x%c") / sscanf("%d%c") parsing and range checks
+ *               the handlers did before.
+ *
+ * @return - Number of failed checks.
+ *
+ *****************************************************************************/
+static U32 cliBenchArgs(void)
+{
+    CLI_SESSION_INFO mdSession;
+    CLI_SESSION_INFO watchSession;
+    PTR_CLI_SUBCMD_HANDLER fptrHandler = NULL;
+    U32         argValue[CLI_MAX_NUM_OF_TOKENS];
+    double      startTime;
+    double      schemaTime;
+    double      sscanfTime;
+    U32         loopCount;
+    U32         errors = 0;
+    U32         address;
+    int         value;
+    char        extra;
+
+    cliBenchSetArgs(&mdSession, sCliBenchMdArgs,
+                    sizeof(sCliBenchMdArgs) / sizeof(sCliBenchMdArgs[0]));
+    cliBenchSetArgs(&watchSession, sCliBenchWatchArgs,
+                    sizeof(sCliBenchWatchArgs) / sizeof(sCliBenchWatchArgs[0]));
+
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_ARG_CHECKS; loopCount++)
+    {
+        if ((cliCheckArgs(&mdSession, &sCliBenchMdSchema, argValue, &fptrHandler) != CLI_STATUS_SUCCESS) ||
+            (argValue[2] != 64))
+        {
+            errors++;
+        }
+        if ((cliCheckArgs(&watchSession, &gCliArgWatch, argValue, &fptrHandler) != CLI_STATUS_SUCCESS) ||
+            (argValue[2] != 500))
+        {
+            errors++;
+        }
+    }
+    schemaTime = (cliBenchNow() - startTime) / (2 * CLI_BENCH_ARG_CHECKS);
+
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_ARG_CHECKS; loopCount++)
+    {
+        if ((sscanf((const char *)mdSession.PtrCmdParams[1], "%x%c", &address, &extra) != 1) ||
+            (sscanf((const char *)mdSession.PtrCmdParams[2], "%d%c", &value, &extra) != 1) ||
+            (value < 1) || (value > CLI_BENCH_MD_LENGTH_MAX))
+        {
+            errors++;
+        }
+        if ((strcmp((const char *)watchSession.PtrCmdParams[1], "-n") != 0) ||
+            (sscanf((const char *)watchSession.PtrCmdParams[2], "%d%c", &value, &extra) != 1) ||
+            (value < IEC_CLI_WATCH_INTERVAL_MIN) || (value > IEC_CLI_WATCH_INTERVAL_MAX))
+        {
+            errors++;
+        }
+    }
+    sscanfTime = (cliBenchNow() - startTime) / (2 * CLI_BENCH_ARG_CHECKS);
+
+    printf("args: cliCheckArgs %.1f ns/command, sscanf baseline %.1f ns/command\n",
+           schemaTime, sscanfTime);
+
+    return errors;
+}
+
+/**
+ * @Name:   cliBenchSink()
+ *
+ * @Description: This function is the output sink of the batch session. It
+ *               counts the writes and drops the data.
+ *
+ * @param PtrArg - Not used.
+ *
+ * @param PtrData - Output data.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void cliBenchSink(void *PtrArg, const U8 *PtrData, U32 Length)
+{
+    sCliBenchSinkWrites++;
+    sCliBenchSinkBytes += Length;
+}
+
+/**
+ * @Name:   cliBenchBatchCmd()
+ *
+ * @Description: This function is the command run by the batch benchmark.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @return - CLI_STATUS_SUCCESS.
+ *
+ *****************************************************************************/
+static CLI_STATUS cliBenchBatchCmd(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    CLI_PRINTF("bench %u\r\n", CLI_ARGC);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   cliBenchBatch()
+ *
+ * @Description: This function runs CLI_BENCH_BATCH_CMDS commands, first as
+ *               separate lines, each after its prompt as the session loop
+ *               does, then as one ';' separated batch after one prompt. The
+ *               output goes to a sink that counts the writes. It needs the
+ *               core command list of cliCoreInit().
+ *
+ * @return - Number of errors.
+ *
+ *****************************************************************************/
+static U32 cliBenchBatch(void)
+{
+    CLI_SESSION_INFO sessionInfo;
+    U8          line[CLI_MAX_CMD_LINE_LENGTH];
+    char        batch[(CLI_BENCH_BATCH_CMDS * 8) + 1];
+    double      startTime;
+    double      lineTime;
+    double      batchTime;
+    U32         lineWrites;
+    U32         lineBytes;
+    U32         loopCount;
+    U32         cmdIdx;
+    U32         errors = 0;
+
+    memset(&sessionInfo, 0, sizeof(sessionInfo));
+    sessionInfo.CliCmdList = sCliCmdList;
+    if ((iecCliSessionCtxAlloc(&sessionInfo) == NULL) ||
+        (cliRegisterCommand((PU8)"bench", (PU8)"batch benchmark command",
+                            cliBenchBatchCmd, &sessionInfo.CliCmdList) != CLI_STATUS_SUCCESS))
+    {
+        printf("batch: no session\n");
+        return 1;
+    }
+    iecCliOutSetSink(&sessionInfo.OutFileHandle, cliBenchSink, NULL);
+
+    sCliBenchSinkWrites = 0;
+    sCliBenchSinkBytes = 0;
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_BATCH_LOOPS; loopCount++)
+    {
+        for (cmdIdx = 0; cmdIdx < CLI_BENCH_BATCH_CMDS; cmdIdx++)
+        {
+            iecCliOutPuts(CLI_BENCH_PROMPT, &sessionInfo.OutFileHandle);
+            iecCliOutFlush(&sessionInfo.OutFileHandle);
+
+            strcpy((char *)line, "bench 1");
+            if (cliParseCmd(line, &sessionInfo) == FALSE)
+            {
+                errors++;
+            }
+        }
+    }
+    lineTime = (cliBenchNow() - startTime) / CLI_BENCH_BATCH_LOOPS;
+    lineWrites = sCliBenchSinkWrites / CLI_BENCH_BATCH_LOOPS;
+    lineBytes = sCliBenchSinkBytes / CLI_BENCH_BATCH_LOOPS;
+
+    sCliBenchSinkWrites = 0;
+    sCliBenchSinkBytes = 0;
+    startTime = cliBenchNow();
+    for (loopCount = 0; loopCount < CLI_BENCH_BATCH_LOOPS; loopCount++)
+    {
+        iecCliOutPuts(CLI_BENCH_PROMPT, &sessionInfo.OutFileHandle);
+        iecCliOutFlush(&sessionInfo.OutFileHandle);
+
+        batch[0] = '\0';
+        for (cmdIdx = 0; cmdIdx < CLI_BENCH_BATCH_CMDS; cmdIdx++)
+        {
+            strcat(batch, "bench 1;");
+        }
+        if (cliParseCmd((PU8)batch, &sessionInfo) == FALSE)
+        {
+            errors++;
+        }
+    }
+    batchTime = (cliBenchNow() - startTime) / CLI_BENCH_BATCH_LOOPS;
+
+    printf("batch: %u commands as lines %.1f us, %u writes, %u bytes; "
+           "as one batch %.1f us, %u writes, %u bytes\n",
+           CLI_BENCH_BATCH_CMDS, lineTime / 1000, lineWrites, lineBytes,
+           batchTime / 1000, sCliBenchSinkWrites / CLI_BENCH_BATCH_LOOPS,
+           sCliBenchSinkBytes / CLI_BENCH_BATCH_LOOPS);
+
+    iecCliOutSetSink(&sessionInfo.OutFileHandle, NULL, NULL);
+    iecCliSessionCtxFree(&sessionInfo);
+    free(sessionInfo.CliCmdList.PtrCliCmdListHead);
+
+    return errors;
+}
+
+/**
+ * @Name:   cliBenchSessionThread()
+ *
+ * @Description: This function is the thread entry of the close benchmark
+ *               session. Like a session thread waiting for input, it wakes
+ *               up every CLI_BENCH_INPUT_WAIT_MS and returns once the
+ *               session is closed.
+ *
+ * @param Arg - Not used.
+ *
+ *****************************************************************************/
+static void cliBenchSessionThread(U32 Arg)
+{
+    while (sCliBenchCloseSession.SessionActive == TRUE)
+    {
+        haliOsThreadSleep(CLI_BENCH_INPUT_WAIT_MS);
+    }
+}
+
+/**
+ * @Name:   cliBenchHungThread()
+ *
+ * @Description: This function is the thread entry of a session that never
+ *               returns.
+ *
+ * @param Arg - Not used.
+ *
+ *****************************************************************************/
+static void cliBenchHungThread(U32 Arg)
+{
+    for (;;)
+    {
+        haliOsThreadSleep(1);
+    }
+}
+
+/**
+ * @Name:   cliBenchClose()
+ *
+ * @Description: This function creates and closes CLI_BENCH_CLOSE_CYCLES
+ *               sessions and times cliCloseSession(), then closes a session
+ *               whose thread never returns. It needs the session pool of
+ *               cliCoreInit() and HAL threads and semaphores.
+ *
+ * @return - Number of errors.
+ *
+ *****************************************************************************/
+static U32 cliBenchClose(void)
+{
+    CLI_SESSION_POOL_STATS poolStats;
+    double      startTime;
+    double      closeTime;
+    double      totalTime = 0;
+    double      maxTime = 0;
+    double      hungTime;
+    U32         loopCount;
+
+    cliSessionPoolStats(&poolStats, TRUE);
+
+    for (loopCount = 0; loopCount < CLI_BENCH_CLOSE_CYCLES; loopCount++)
+    {
+        memset(&sCliBenchCloseSession, 0, sizeof(sCliBenchCloseSession));
+        if (cliCreateSessionEx(&sCliBenchCloseSession, (const U8 *)"bench",
+                               cliBenchSessionThread, NULL, NULL) == FALSE)
+        {
+            printf("close: no session\n");
+            return 1;
+        }
+        haliOsThreadSleep(1);
+
+        startTime = cliBenchNow();
+        cliCloseSession(&sCliBenchCloseSession);
+        closeTime = cliBenchNow() - startTime;
+
+        totalTime += closeTime;
+        if (closeTime > maxTime)
+        {
+            maxTime = closeTime;
+        }
+    }
+
+    memset(&sCliBenchCloseSession, 0, sizeof(sCliBenchCloseSession));
+    if (cliCreateSessionEx(&sCliBenchCloseSession, (const U8 *)"hung",
+                           cliBenchHungThread, NULL, NULL) == FALSE)
+    {
+        printf("close: no session\n");
+        return 1;
+    }
+    startTime = cliBenchNow();
+    cliCloseSession(&sCliBenchCloseSession);
+    hungTime = cliBenchNow() - startTime;
+
+    cliSessionPoolStats(&poolStats, FALSE);
+
+    printf("close: average %.2f ms, max %.2f ms over %u closes, "
+           "hung thread %.1f ms, %u terminated\n",
+           totalTime / CLI_BENCH_CLOSE_CYCLES / 1e6, maxTime / 1e6,
+           CLI_BENCH_CLOSE_CYCLES, hungTime / 1e6, poolStats.Terminated);
+
+    return (poolStats.Terminated == 1) ? 0 : 1;
+}
+
+/**
+ * @Name:   cliBenchFind()
+ *
+ * @Description: This function looks up CLI_BENCH_LOOKUPS command names, in
+ *               turn from the first CmdCount benchmark commands.
+ *
+ * @param CmdCount - Number of registered benchmark commands.
+ *
+ * @param PtrErrors - Incremented for each command not found.
+ *
+ * @return - Nanoseconds per lookup.
+ *
+ *****************************************************************************/
+static double cliBenchFind(U16 CmdCount, U32 *PtrErrors)
+{
+    CLI_CMD_NODE cmdNodeBuf;
+    double      startTime;
+    U32         loopCount;
+
+    startTime = cliBenchNow();
+
+    for (loopCount = 0; loopCount < CLI_BENCH_LOOKUPS; loopCount++)
+    {
+        if (cliFindCommand(&sCliCmdList,
+                           (const U8 *)sCliBenchCmdName[loopCount % CmdCount],
+                           &cmdNodeBuf, NULL, NULL) == NULL)
+        {
+            (*PtrErrors)++;
+        }
+    }
+
+    return (cliBenchNow() - startTime) / CLI_BENCH_LOOKUPS;
+}
+
+/**
+ * @Name:   cliBenchDispatch()
+ *
+ * @Description: This function registers tables of 16 to CLI_BENCH_CMD_MAX
+ *               commands on the core command list and times cliFindCommand()
+ *               with the dispatch index and with the walk of the tables it
+ *               replaced. The index cost stays flat as the command count
+ *               grows, the walk grows with it.
+ *
+ * @return - Number of commands not found.
+ *
+ *****************************************************************************/
+static U32 cliBenchDispatch(void)
+{
+    double      indexTime;
+    double      walkTime;
+    U32         errors = 0;
+    U16         countIdx;
+    U16         cmdIdx;
+
+    for (cmdIdx = 0; cmdIdx < CLI_BENCH_CMD_MAX; cmdIdx++)
+    {
+        snprintf(sCliBenchCmdName[cmdIdx], CLI_BENCH_CMD_NAME_LEN, "bench%u", cmdIdx);
+        sCliBenchCmdInfo[cmdIdx].PtrCmdName = (PU8)sCliBenchCmdName[cmdIdx];
+        sCliBenchCmdInfo[cmdIdx].PtrOneLineHelp = (PU8)"benchmark command";
+        sCliBenchCmdTable[cmdIdx] = &sCliBenchCmdInfo[cmdIdx];
+    }
+
+    for (countIdx = 0; countIdx < sizeof(sCliBenchCmdCounts) / sizeof(sCliBenchCmdCounts[0]); countIdx++)
+    {
+        sCliCoreInitialized = FALSE;
+        sCliCmdTableCount = 0;
+        cliRegisterCommandTable(sCliBenchCmdTable, sCliBenchCmdCounts[countIdx], &sCliCmdList);
+        sCliCoreInitialized = TRUE;
+        sPtrCliCmdCoreHead = sCliCmdList.PtrCliCmdListHead;
+
+        cliBuildCmdIndex(&sCliCmdList);
+        if (sCliCmdIndexBuilt == FALSE)
+        {
+            printf("dispatch: no index for %u commands\n", sCliBenchCmdCounts[countIdx]);
+            errors++;
+            continue;
+        }
+        indexTime = cliBenchFind(sCliBenchCmdCounts[countIdx], &errors);
+
+        sCliCmdIndexBuilt = FALSE;
+        walkTime = cliBenchFind(sCliBenchCmdCounts[countIdx], &errors);
+        sCliCmdIndexBuilt = TRUE;
+
+        printf("dispatch: %4u commands, index %6.1f ns/lookup, list walk %7.1f ns/lookup\n",
+               sCliBenchCmdCounts[countIdx], indexTime, walkTime);
+    }
+
+    sCliCoreInitialized = FALSE;
+    sCliCmdTableCount = 0;
+
+    return errors;
+}
+
+int main(void)
+{
+    U32 errors;
+
+    errors = cliBenchStartup();
+    errors += cliBenchBatch();
+    errors += cliBenchClose();
+    errors += cliBenchDispatch();
+    errors += cliBenchTokenize();
+    errors += cliBenchArgs();
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,197 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2019- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  cliCoreTest.c
+ *          Title:  Host test of the cliCore.c tokenizer
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  Host test of cliTokenizeCmdLine(). It includes cliCore.c to reach the
+ *  static tokenizer and is linked with the other CLI sources and the host
+ *  HAL shims, with -DHOSTTEST and -lpthread. It checks the quoting rules and
+ *  tokenizes from several threads at once, as the session threads do. It
+ *  returns 0 if all checks pass.
+ *
+ *-------------------------------------------------------------------------
+ */
+/*
+** Include Files
+*/
+
+#include <pthread.h>
+#include "cliCore.c"
+
+#define CLI_TEST_THREADS        (8)
+#define CLI_TEST_THREAD_LINES   (200000)
+
+typedef struct
+{
+    const char  *PtrLine;
+    CLI_STATUS  Status;
+    U32         TokenCount;
+    const char  *PtrTokens[4];
+} CLI_TEST_TOKEN_CASE;
+
+static const CLI_TEST_TOKEN_CASE sCliTestTokenCases[] =
+{
+    { "echo a b",             CLI_STATUS_SUCCESS,   3, { "echo", "a", "b" } },
+    { "  echo\ta  ",          CLI_STATUS_SUCCESS,   2, { "echo", "a" } },
+    { "echo \"a b\" c",       CLI_STATUS_SUCCESS,   3, { "echo", "a b", "c" } },
+    { "echo \"abc\"",         CLI_STATUS_SUCCESS,   2, { "echo", "abc" } },
+    { "echo \"\"",            CLI_STATUS_SUCCESS,   2, { "echo", "" } },
+    { "echo a\"b\"c",         CLI_STATUS_SUCCESS,   2, { "echo", "a\"b\"c" } },
+    { "echo \"abc\"def",      CLI_STATUS_NO_QUOTES, 1, { "echo" } },
+    { "echo \"a\"\"b\"",      CLI_STATUS_NO_QUOTES, 1, { "echo" } },
+    { "echo \"abc",           CLI_STATUS_NO_QUOTES, 1, { "echo" } },
+};
+
+static U32 sCliTestThreadErrors[CLI_TEST_THREADS];
+
+/**
+ * @Name:   cliTestTokenCases()
+ *
+ * @Description: This function tokenizes each line of sCliTestTokenCases and
+ *               compares the status and the tokens.
+ *
+ * @return - Number of failed cases.
+ *
+ *****************************************************************************/
+static U32 cliTestTokenCases(void)
+{
+    CLI_SESSION_INFO sessionInfo;
+    U8          line[CLI_MAX_CMD_LINE_LENGTH];
+    CLI_STATUS  status;
+    U32         tkCount;
+    U32         caseIdx;
+    U32         tkIdx;
+    U32         errors = 0;
+
+    for (caseIdx = 0; caseIdx < sizeof(sCliTestTokenCases) / sizeof(sCliTestTokenCases[0]); caseIdx++)
+    {
+        const CLI_TEST_TOKEN_CASE *ptrCase = &sCliTestTokenCases[caseIdx];
+
+        memset(&sessionInfo, 0, sizeof(sessionInfo));
+        strcpy((char *)line, ptrCase->PtrLine);
+        status = cliTokenizeCmdLine(line, &sessionInfo, &tkCount);
+
+        if ((status != ptrCase->Status) || (tkCount != ptrCase->TokenCount))
+        {
+            printf("FAIL [%s]: status %u count %u, expected %u %u\n",
+                   ptrCase->PtrLine, status, tkCount,
+                   ptrCase->Status, ptrCase->TokenCount);
+            errors++;
+            continue;
+        }
+
+        for (tkIdx = 0; tkIdx < tkCount; tkIdx++)
+        {
+            if (strcmp((const char *)sessionInfo.PtrCmdParams[tkIdx], ptrCase->PtrTokens[tkIdx]) != 0)
+            {
+                printf("FAIL [%s]: token %u is [%s], expected [%s]\n",
+                       ptrCase->PtrLine, tkIdx,
+                       sessionInfo.PtrCmdParams[tkIdx], ptrCase->PtrTokens[tkIdx]);
+                errors++;
+                break;
+            }
+        }
+    }
+
+    return errors;
+}
+
+/**
+ * @Name:   cliTestTokenThread()
+ *
+ * @Description: This thread tokenizes lines of its own and checks the
+ *               tokens. Any state shared by the threads would mix their
+ *               tokens.
+ *
+ * @param PtrArg - Thread number.
+ *
+ *****************************************************************************/
+static void *cliTestTokenThread(void *PtrArg)
+{
+    U32         threadIdx = (U32)(size_t)PtrArg;
+    CLI_SESSION_INFO sessionInfo;
+    U8          line[CLI_MAX_CMD_LINE_LENGTH];
+    char        expected[CLI_MAX_TOKEN_LENGTH];
+    U32         tkCount;
+    U32         loopCount;
+
+    memset(&sessionInfo, 0, sizeof(sessionInfo));
+
+    for (loopCount = 0; loopCount < CLI_TEST_THREAD_LINES; loopCount++)
+    {
+        snprintf((char *)line, sizeof(line), "cmd%u \"a %u\" b%u %u",
+                 threadIdx, threadIdx, loopCount, threadIdx);
+        snprintf(expected, sizeof(expected), "b%u", loopCount);
+
+        if ((cliTokenizeCmdLine(line, &sessionInfo, &tkCount) != CLI_STATUS_SUCCESS) ||
+            (tkCount != 4) ||
+            (strcmp((const char *)sessionInfo.PtrCmdParams[2], expected) != 0) ||
+            ((U32)atoi((const char *)sessionInfo.PtrCmdParams[3]) != threadIdx))
+        {
+            sCliTestThreadErrors[threadIdx]++;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   cliTestTokenThreads()
+ *
+ * @Description: This function runs CLI_TEST_THREADS tokenizer threads.
+ *
+ * @return - Number of wrong token sets.
+ *
+ *****************************************************************************/
+static U32 cliTestTokenThreads(void)
+{
+    pthread_t   threads[CLI_TEST_THREADS];
+    U32         threadIdx;
+    U32         errors = 0;
+
+    for (threadIdx = 0; threadIdx < CLI_TEST_THREADS; threadIdx++)
+    {
+        pthread_create(&threads[threadIdx], NULL, cliTestTokenThread, (void *)(size_t)threadIdx);
+    }
+
+    for (threadIdx = 0; threadIdx < CLI_TEST_THREADS; threadIdx++)
+    {
+        pthread_join(threads[threadIdx], NULL);
+        errors += sCliTestThreadErrors[threadIdx];
+    }
+
+    if (errors != 0)
+    {
+        printf("FAIL threads: %u wrong token sets\n", errors);
+    }
+
+    return errors;
+}
+
+int main(void)
+{
+    U32 errors;
+
+    errors = cliTestTokenCases();
+    errors += cliTestTokenThreads();
+
+    printf("%s\n", (errors == 0) ? "PASS" : "FAIL");
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -14,6 +14,51 @@
  *
  *  Date      Who   Description
  *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW     The watch option -n <ms> and its range are declared in
+ *                   the watch argument schema instead of parsed by the
+ *                   handler.
+ *  10/18/26  AW     Register the read-only handlers, the only ones watch
+ *                   runs.
+ *  10/18/26  AW     Only the IEC commands of sPtrIecCliCaptureList are
+ *                   registered as capture safe. The job control, session
+ *                   setting and test commands are not.
+ *  10/18/26  AW     The IEC commands are registered as capture safe, they
+ *                   can run as a job and through cliExecToBuffer().
+ *  10/18/26  AW     iecSasAddr and iecIstwi return CLI_STATUS_INVALID_PARAMETER
+ *                   for a wrong number of arguments again. The ISTWI channel
+ *                   range comes from the HAL.
+ *  10/18/26  AW     iecSession shows the sessions closed and terminated
+ *                   and the close time.
+ *  10/18/26  AW     iecSession also shows the session slot pool, the
+ *                   sessions created and refused and the connect time.
+ *  10/18/26  AW     Added the watch command.
+ *  10/18/26  AW     iecIstwi scan, iecFwInfo cmp and the iecSgpio table
+ *                   stop on Ctrl-C with CLI_STATUS_CANCELLED.
+ *  10/18/26  AW     Added the jobs, fg, wait and kill commands for the
+ *                   background jobs (cmd &).
+ *  10/18/26  AW     Added the iecBatch command to select whether a ';'
+ *                   command batch stops at the first failing command.
+ *  10/18/26  AW     Added the TAB completion callbacks of the logical
+ *                   phys with a drive, the GPIO pins and the flash
+ *                   regions. Removed iecCliSearchCommand(), the cli core
+ *                   completes the command names from its sorted index.
+ *  10/18/26  AW     Removed iecCliArrowHandle(), replaced by the line
+ *                   editor (iecCliEditor.c).
+ *  10/18/26  AW     iecCliRawDataPrintf() uses iecCliHexDump(), one call per
+ *                   line instead of one per byte. The title goes to the
+ *                   session instead of the console.
+ *  10/18/26  AW     Added the iecOutMode command. iecSasPort, iecSmartRead
+ *                   and iecGPIO emit TLV records in TLV output mode.
+ *  10/18/26  AW     Print through the session output buffer. Added the
+ *                   iecSession command to show the output counters.
+ *  10/18/26  AW     Moved iecDebug, iecGPIO and iecSgpio to subcommand
+ *                   trees, one handler per subcommand.
+ *  10/18/26  AW     Added argument schemas for the iec commands, so the
+ *                   arguments are checked and converted by the cli core.
+ *                   Replaced sscanf() with cliParseU32(). Fixed the GPIO
+ *                   and SGPIO range checks.
+ *  10/18/26  AW     Register the iec command table with
+ *                   cliRegisterCommandTable().
  *  7 /01/19  AW     add iecdisplaysmartwarrantythreshold() to test threshold
  *  06/01/19  AW     Added  slot driver id to send read warranty threshold 
  *                   for special ata in iecSmartReadWaTh()
@@ -42,6 +87,13 @@
 #include "xmodem.h"
 #include "cliUart.h"
 #include "cliTelnet.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliJob.h"
+#include "iecCliWatch.h"
+#include "iecCliCore.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
 /** @addtogroup  iecCli CLI API
  *  @{ */
 
@@ -49,6 +101,18 @@
 #define IEC_CLI_PRINT_HEADER  "========================================"\
                               "=============================================="
 
+/* Highest ISTWI channel number, from the channel count of the HAL. Without
+ * it the channel is left to haliIstwiRead(), as before the argument schema.
+ */
+#ifdef HALI_ISTWI_NUM_CHANNELS
+#define IEC_CLI_ISTWI_MAX_CHANNEL   (HALI_ISTWI_NUM_CHANNELS - 1)
+#else
+#define IEC_CLI_ISTWI_MAX_CHANNEL   (0xFFFFFFFF)
+#endif
+
+/* Value of the "toggle" keyword of iecGPIO <gpio> set val */
+#define IEC_CLI_GPIO_VAL_TOGGLE     (0xFF)
+
 #define IEC_CLI_SGPIO_LED_EXT_INT_PAT_HEADER_1    "LOGICAL    PHYSICAL    EXTRN_LED_GRP_1         EXTRN_LED_GRP_2         EXTRN_LED_GRP_3"
 #define IEC_CLI_SGPIO_LED_EXT_INT_PAT_HEADER_2    "PHY        PHY         PATTERN     INV         PATTERN     INV         PATTERN     INV"
 #define IEC_CLI_SGPIO_LED_EXT_INT_PAT_HEADER_3    "ID         ID          SELECT      Y/N         SELECT      Y/N         SELECT      Y/N"
@@ -99,6 +163,46 @@ CLI_STATUS iecCliSgpio(PTR_CLI_SESSION_INFO PtrSessionInfo);
 
 CLI_STATUS iecCliEnclosure(PTR_CLI_SESSION_INFO PtrSessionInfo);
 
+CLI_STATUS iecCliSession(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliOutMode(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliBatch(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliJobs(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliFg(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliWait(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliKill(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliWatch(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+/*
+** CLI Subcommand Handler Function Prototypes
+*/
+
+static CLI_STATUS iecCliDebugLevel(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+static CLI_STATUS iecCliDebugModule(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+static CLI_STATUS iecCliGpioSetDir(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+static CLI_STATUS iecCliGpioSetVal(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+static CLI_STATUS iecCliSgpioSet(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+/*
+** CLI Argument Completer Prototypes
+*/
+
+static BOOL iecCliCompleteDrivePhy(U32 *PtrCursor, char *PtrCandidate, U32 Size);
+
+static BOOL iecCliCompleteGpio(U32 *PtrCursor, char *PtrCandidate, U32 Size);
+
+static BOOL iecCliCompleteFlashRegion(U32 *PtrCursor, char *PtrCandidate, U32 Size);
+
 /*
 ** CLI Info structures
 */
@@ -188,6 +292,61 @@ const CLI_CMD_INFO gCliCmdIecEncl= {
                                 iecCliEnclosure
                     };
 
+const CLI_CMD_INFO gCliCmdIecSession = {
+                                "iecSession",
+                                "    show cli session output      iecSession [clear]\r\n"
+                                "                             - also shows the session slot pool\r\n"
+                                "                             - clear resets the counters\r\n",
+                                iecCliSession
+                    };
+
+const CLI_CMD_INFO gCliCmdIecOutMode = {
+                                "iecOutMode",
+                                "    show/set output mode         iecOutMode [text|tlv]\r\n"
+                                "                             - tlv sends binary records, for in-band tools\r\n",
+                                iecCliOutMode
+                    };
+
+const CLI_CMD_INFO gCliCmdIecBatch = {
+                                "iecBatch",
+                                "    show/set batch error mode    iecBatch [continue|stop]\r\n"
+                                "                             - stop ends a cmd1; cmd2 batch at the first error\r\n",
+                                iecCliBatch
+                    };
+
+const CLI_CMD_INFO gCliCmdJobs = {
+                                "jobs",
+                                "    list background jobs         jobs\r\n"
+                                "                             - cmd & runs cmd in the background\r\n",
+                                iecCliJobs
+                    };
+
+const CLI_CMD_INFO gCliCmdFg = {
+                                "fg",
+                                "    show background job output   fg <id>\r\n",
+                                iecCliFg
+                    };
+
+const CLI_CMD_INFO gCliCmdWait = {
+                                "wait",
+                                "    wait for background jobs     wait [id]\r\n",
+                                iecCliWait
+                    };
+
+const CLI_CMD_INFO gCliCmdKill = {
+                                "kill",
+                                "    stop background job          kill <id>\r\n",
+                                iecCliKill
+                    };
+
+const CLI_CMD_INFO gCliCmdWatch = {
+                                "watch",
+                                "    repeat a command in place    watch [-n <ms>] <command>\r\n"
+                                "                             - ms 100 to 60000, default 1000, Ctrl-C stops\r\n"
+                                "                             - only commands that do not set anything\r\n",
+                                iecCliWatch
+                    };
+
 
 #ifndef PRODUCTION_RELEASE
 const CLI_CMD_INFO gCliCmdIecTest= {
@@ -205,6 +364,226 @@ const CLI_CMD_INFO gCliCmdSmartReadData={
                            };
 #endif
 
+/*
+** CLI argument schemas
+*/
+
+static const char * const sIecCliKwScan[]      = { "scan", NULL };
+static const char * const sIecCliKwShow[]      = { "show", NULL };
+static const char * const sIecCliKwCmp[]       = { "cmp", NULL };
+static const char * const sIecCliKwClear[]     = { "clear", NULL };
+/* Indexed by IEC_CLI_OUT_MODE */
+static const char * const sIecCliKwOutMode[]   = { "text", "tlv", NULL };
+/* Indexed by the BatchStopOnError value of the session context */
+static const char * const sIecCliKwBatch[]     = { "continue", "stop", NULL };
+
+static const CLI_ARG_SPEC sIecCliArgLogicalPhy[] = {
+    { CLI_ARG_TYPE_DEC,     0, HALI_EXP_NUM_PHYS - 1,       NULL, iecCliCompleteDrivePhy }
+};
+
+static const CLI_ARG_SPEC sIecCliArgSasPort[] = {
+    /* The port number is checked by the handler */
+    { CLI_ARG_TYPE_DEC,     0, 0xFF,                        NULL, NULL },
+    { CLI_ARG_TYPE_DEC,     0, HALI_PHY_OP_POWER_UP,        NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgSasAddr[] = {
+    { CLI_ARG_TYPE_HEX,     0, 0xFFFFFFFF,                  NULL, NULL },
+    { CLI_ARG_TYPE_HEX,     0, 0xFFFFFFFF,                  NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgLog[] = {
+    { CLI_ARG_TYPE_STRING,  0, HALI_LOG_ENTRY_STRING_ARG_LEN, NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgIstwi[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwScan, NULL },
+    { CLI_ARG_TYPE_DEC,     0, IEC_CLI_ISTWI_MAX_CHANNEL,   NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgFwInfo[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwCmp, NULL },
+    { CLI_ARG_TYPE_DEC,     0, HALI_FLASH_MANUFACTURING,    NULL, iecCliCompleteFlashRegion },
+    { CLI_ARG_TYPE_DEC,     0, HALI_FLASH_MANUFACTURING,    NULL, iecCliCompleteFlashRegion },
+    { CLI_ARG_TYPE_NUM,     0, 0xFFFFFFFF,                  NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgAtaDevTemp[] = {
+    { CLI_ARG_TYPE_DEC,     0, 0xFF,                        NULL, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgEncl[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwShow, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgSession[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwClear, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgOutMode[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwOutMode, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgBatch[] = {
+    { CLI_ARG_TYPE_KEYWORD, 0, 0,                           sIecCliKwBatch, NULL }
+};
+
+static const CLI_ARG_SPEC sIecCliArgJobId[] = {
+    { CLI_ARG_TYPE_DEC,     1, 0xFFFFFFFF,                  NULL, NULL }
+};
+
+/* watch -n <ms> */
+static const CLI_ARG_OPTION sIecCliOptWatch[] = {
+    { "-n", { CLI_ARG_TYPE_DEC, IEC_CLI_WATCH_INTERVAL_MIN, IEC_CLI_WATCH_INTERVAL_MAX, NULL, NULL } }
+};
+
+const CLI_ARG_SCHEMA gCliArgIecSasPort     = { &gCLiCmdIecSasPort,       0, 2, sIecCliArgSasPort, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecSasAddr     = { &gCLiCmdIecSasAddr,       0, 2, sIecCliArgSasAddr, NULL, CLI_STATUS_INVALID_PARAMETER, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecLog         = { &gCLiCmdIecLog,           1, 1, sIecCliArgLog, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecIstwi       = { &gCLiCmdIecIstwi,         2, 2, sIecCliArgIstwi, NULL, CLI_STATUS_INVALID_PARAMETER, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecFwInfo      = { &gCliCmdIecFwInfo,        0, 4, sIecCliArgFwInfo, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecSmartRead   = { &gCliCmdIecSmartReadData, 1, 1, sIecCliArgLogicalPhy, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecAtaDevTemp  = { &gCliCmdIecAtaDevTemp,    1, 1, sIecCliArgAtaDevTemp, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecEncl        = { &gCliCmdIecEncl,          1, 1, sIecCliArgEncl, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecSession     = { &gCliCmdIecSession,       0, 1, sIecCliArgSession, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecOutMode     = { &gCliCmdIecOutMode,       0, 1, sIecCliArgOutMode, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecBatch       = { &gCliCmdIecBatch,         0, 1, sIecCliArgBatch, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgFg             = { &gCliCmdFg,               1, 1, sIecCliArgJobId, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgWait           = { &gCliCmdWait,             0, 1, sIecCliArgJobId, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgKill           = { &gCliCmdKill,             1, 1, sIecCliArgJobId, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+/* The command to watch is any tokens */
+const CLI_ARG_SCHEMA gCliArgWatch          = { &gCliCmdWatch,            1, CLI_MAX_NUM_OF_TOKENS - 1, NULL, NULL, CLI_STATUS_INVALID_SYNTAX,
+                                               CLI_ARG_OPTIONS(sIecCliOptWatch) };
+#ifndef PRODUCTION_RELEASE
+const CLI_ARG_SCHEMA gCliArgIecTest        = { &gCliCmdIecTest,          1, 1, sIecCliArgLogicalPhy, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+#endif
+#ifdef ATA_ENABLE_THRESHOLD
+const CLI_ARG_SCHEMA gCliArgIecSmartReadWaTh = { &gCliCmdSmartReadData,  1, 1, sIecCliArgLogicalPhy, NULL, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+#endif
+
+/*
+** CLI subcommand trees
+*/
+
+static const CLI_ARG_SPEC sIecCliArgMid = {
+    CLI_ARG_TYPE_DEC, 0, IEC_MID_MAX - 1, NULL, NULL
+};
+
+static const CLI_ARG_SPEC sIecCliArgGpio = {
+    CLI_ARG_TYPE_DEC, 0, HALI_GPIO_NUMBER - 1, NULL, iecCliCompleteGpio
+};
+
+static const CLI_ARG_SPEC sIecCliArgSgpioPhy = {
+    CLI_ARG_TYPE_DEC, 0, HALI_EXP_NUM_PHYS - 1, NULL, iecCliCompleteDrivePhy
+};
+
+/* iecDebug level <critical|info|warning> */
+static const CLI_SUBCMD_NODE sIecCliDebugLevelNodes[] = {
+    { "critical", IEC_CRITICAL, NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliDebugLevel },
+    { "info",     IEC_INFO,     NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliDebugLevel },
+    { "warning",  IEC_WARNING,  NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliDebugLevel }
+};
+
+/* iecDebug module <mid> <disable|enable> */
+static const CLI_SUBCMD_NODE sIecCliDebugModuleNodes[] = {
+    { "disable",  FALSE,        NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliDebugModule },
+    { "enable",   TRUE,         NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliDebugModule }
+};
+
+static const CLI_SUBCMD_NODE sIecCliDebugMidNode = {
+    "<mid>", 0, &sIecCliArgMid, CLI_SUBCMD_CHILDREN(sIecCliDebugModuleNodes), NULL, NULL
+};
+
+static const CLI_SUBCMD_NODE sIecCliDebugNodes[] = {
+    { "level",    0,            NULL, CLI_SUBCMD_CHILDREN(sIecCliDebugLevelNodes), NULL, NULL },
+    { "module",   0,            NULL, CLI_SUBCMD_NO_CHILDREN, &sIecCliDebugMidNode, NULL }
+};
+
+static const CLI_SUBCMD_NODE sIecCliDebugTree = {
+    "iecDebug", 0, NULL, CLI_SUBCMD_CHILDREN(sIecCliDebugNodes), NULL, iecCliDebug
+};
+
+/* iecGPIO <gpio> set dir <in|out> */
+static const CLI_SUBCMD_NODE sIecCliGpioDirNodes[] = {
+    { "in",       IEC_GPIO_DIRECTION_INPUT,  NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliGpioSetDir },
+    { "out",      IEC_GPIO_DIRECTION_OUTPUT, NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliGpioSetDir }
+};
+
+/* iecGPIO <gpio> set val <0|1|toggle> */
+static const CLI_SUBCMD_NODE sIecCliGpioValNodes[] = {
+    { "0",        HALI_GPIO_BIT_CLEAR,     NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliGpioSetVal },
+    { "1",        HALI_GPIO_BIT_SET,       NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliGpioSetVal },
+    { "toggle",   IEC_CLI_GPIO_VAL_TOGGLE, NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliGpioSetVal }
+};
+
+static const CLI_SUBCMD_NODE sIecCliGpioSetNodes[] = {
+    { "dir",      0,            NULL, CLI_SUBCMD_CHILDREN(sIecCliGpioDirNodes), NULL, NULL },
+    { "val",      0,            NULL, CLI_SUBCMD_CHILDREN(sIecCliGpioValNodes), NULL, NULL }
+};
+
+static const CLI_SUBCMD_NODE sIecCliGpioPinNodes[] = {
+    { "set",      0,            NULL, CLI_SUBCMD_CHILDREN(sIecCliGpioSetNodes), NULL, NULL }
+};
+
+static const CLI_SUBCMD_NODE sIecCliGpioPinNode = {
+    "<gpio>", 0, &sIecCliArgGpio, CLI_SUBCMD_CHILDREN(sIecCliGpioPinNodes), NULL, NULL
+};
+
+static const CLI_SUBCMD_NODE sIecCliGpioTree = {
+    "iecGPIO", 0, NULL, CLI_SUBCMD_NO_CHILDREN, &sIecCliGpioPinNode, iecCliGPIO
+};
+
+/* iecSgpio <log_phy> <err|loc> <blink|off|on> */
+static const CLI_SUBCMD_NODE sIecCliSgpioDoutNodes[] = {
+    { "blink",    IEC_SGPIO_DOUT_BLINK, NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliSgpioSet },
+    { "off",      IEC_SGPIO_DOUT_LOW,   NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliSgpioSet },
+    { "on",       IEC_SGPIO_DOUT_HIGH,  NULL, CLI_SUBCMD_NO_CHILDREN, NULL, iecCliSgpioSet }
+};
+
+static const CLI_SUBCMD_NODE sIecCliSgpioBitNodes[] = {
+    { "err",      IEC_SGPIO_DOUT_BIT_ERR, NULL, CLI_SUBCMD_CHILDREN(sIecCliSgpioDoutNodes), NULL, NULL },
+    { "loc",      IEC_SGPIO_DOUT_BIT_LOC, NULL, CLI_SUBCMD_CHILDREN(sIecCliSgpioDoutNodes), NULL, NULL }
+};
+
+static const CLI_SUBCMD_NODE sIecCliSgpioPhyNode = {
+    "<log_phy>", 0, &sIecCliArgSgpioPhy, CLI_SUBCMD_CHILDREN(sIecCliSgpioBitNodes), NULL, NULL
+};
+
+static const CLI_SUBCMD_NODE sIecCliSgpioTree = {
+    "iecSgpio", 0, NULL, CLI_SUBCMD_NO_CHILDREN, &sIecCliSgpioPhyNode, iecCliSgpio
+};
+
+const CLI_ARG_SCHEMA gCliArgIecDebug       = { &gCliCmdIecDebug,         0, 0, NULL, &sIecCliDebugTree, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecGpio        = { &gCLiCmdIecGpio,          0, 0, NULL, &sIecCliGpioTree, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+const CLI_ARG_SCHEMA gCliArgIecSgpio       = { &gCLiCmdIecSgpio,         0, 0, NULL, &sIecCliSgpioTree, CLI_STATUS_SUCCESS, CLI_ARG_NO_OPTIONS };
+
+static const CLI_ARG_SCHEMA *sPtrIecCliArgSchemaList[] = {
+                                                        &gCliArgIecDebug,
+                                                        &gCliArgIecGpio,
+                                                        &gCliArgIecSasPort,
+                                                        &gCliArgIecSasAddr,
+                                                        &gCliArgIecLog,
+                                                        &gCliArgIecIstwi,
+                                                        &gCliArgIecFwInfo,
+                                                        &gCliArgIecSmartRead,
+                                                        &gCliArgIecAtaDevTemp,
+                                                        &gCliArgIecSgpio,
+                                                        &gCliArgIecEncl,
+                                                        &gCliArgIecSession,
+                                                        &gCliArgIecOutMode,
+                                                        &gCliArgIecBatch,
+                                                        &gCliArgFg,
+                                                        &gCliArgWait,
+                                                        &gCliArgKill,
+                                                        &gCliArgWatch,
+                                                        #ifndef PRODUCTION_RELEASE
+                                                        &gCliArgIecTest,
+                                                        #endif
+                                                        #ifdef ATA_ENABLE_THRESHOLD
+                                                        &gCliArgIecSmartReadWaTh
+                                                        #endif
+                                                    };
+
 /*
 ** IEC CLI command list
 */
@@ -222,6 +601,14 @@ static const CLI_CMD_INFO *sPtrIecCliCmdList[] =	{
                                                         &gCliCmdIecAtaDevTemp,
                                                         &gCLiCmdIecSgpio,
                                                         &gCliCmdIecEncl,
+                                                        &gCliCmdIecSession,
+                                                        &gCliCmdIecOutMode,
+                                                        &gCliCmdIecBatch,
+                                                        &gCliCmdJobs,
+                                                        &gCliCmdFg,
+                                                        &gCliCmdWait,
+                                                        &gCliCmdKill,
+                                                        &gCliCmdWatch,
                                                         #ifndef PRODUCTION_RELEASE
                                                         &gCliCmdIecTest,
                                                         #endif
@@ -230,13 +617,51 @@ static const CLI_CMD_INFO *sPtrIecCliCmdList[] =	{
 														#endif
                                                     };
 
+/* Commands that can run with their output captured, as a job or through
+ * cliExecToBuffer(). Their handlers print only through CLI_PRINTF() and
+ * iecCliOut, and do not use the session state: the job control commands,
+ * iecSession, iecOutMode, iecBatch, watch and iecTest are not listed.
+ */
+static const CLI_CMD_INFO *sPtrIecCliCaptureList[] = {
+                                                        &gCliCmdIecDebug,
+                                                        &gCLiCmdIecGpio,
+                                                        &gCLiCmdIecSasAddr,
+                                                        &gCLiCmdIecSasPort,
+                                                        &gCLiCmdIecLog,
+                                                        &gCLiCmdIecIstwi,
+                                                        &gCliCmdIecTemp,
+                                                        &gCliCmdIecFwInfo,
+                                                        &gCliCmdIecSmartReadData,
+                                                        &gCliCmdIecAtaDevTemp,
+                                                        &gCLiCmdIecSgpio,
+                                                        &gCliCmdIecEncl
+                                                    };
+
+/* Handlers that only read the device state whatever their arguments, the
+ * only ones watch runs. The show handlers of iecDebug, iecGPIO and iecSgpio
+ * are listed, not their set subcommands. iecSasPort, iecSasAddr, iecLog and
+ * iecFwInfo set with arguments, iecIstwi scan addresses every device of the
+ * bus.
+ */
+static const PTR_CLI_SUBCMD_HANDLER sIecCliReadOnlyList[] = {
+                                                        iecCliDebug,
+                                                        iecCliGPIO,
+                                                        iecCliSgpio,
+                                                        iecCliTemperatureSensor,
+                                                        iecCliSmartReadData,
+                                                        iecCliAtaDevTemperature,
+                                                        iecCliEnclosure,
+                                                        iecCliJobs
+                                                    };
+
 
 /**
  *
  * @Name:   iecCliDebug()
  *
- * @Description: This command change the debug level and enable modules for
- *               debug printf.
+ * @Description: This command shows the debug level and the modules enabled
+ *               for debug printf. It is the root of the iecDebug subcommand
+ *               tree.
  *
  * @param PtrSessionInfo - Pointer to the CLI session information structure.
  *
@@ -245,116 +670,91 @@ static const CLI_CMD_INFO *sPtrIecCliCmdList[] =	{
  *****************************************************************************/
 CLI_STATUS iecCliDebug( PTR_CLI_SESSION_INFO PtrSessionInfo )
 {
-    S32 retVal;
-    U8 invalidChar;
-    U32 midNum;
-    
-    if( PtrSessionInfo->TokenInCmdRcd == 1 )
-    {
-        U8 midNum;
-        
-        /* By default, show current debug level and enabled modules. */
-        CLI_PRINTF("\r\nCurrent debug level:  ");
-
-        switch (gDebugLevel)
-        {
-            case IEC_INFO:
-                CLI_PRINTF("info-3\r\n");
-                break;
-            case IEC_WARNING:
-                CLI_PRINTF("warning-2\r\n");
-                break;
-            case IEC_CRITICAL:
-                CLI_PRINTF("critical-1\r\n");
-                break;
-            default:
-                CLI_PRINTF("Unknown-%d", gDebugLevel);
-                break;
-        }
-        
-        CLI_PRINTF("Current enabled modules: \r\n");
+    U8 midNum;
 
-        for( midNum = 0; midNum < IEC_MID_MAX; midNum++ )
-        {
-            CLI_PRINTF("%d-%s: ", midNum, iecModulesName[midNum]);
-            if( CHECK_MID_DEBUG(midNum) )
-            {
-                CLI_PRINTF("enabled.\r\n");
-            }
-            else
-            {
-                CLI_PRINTF("disabled.\r\n");
-            }
-        }
+    /* Show current debug level and enabled modules. */
+    CLI_PRINTF("\r\nCurrent debug level:  ");
 
-        return CLI_STATUS_SUCCESS;
-    }
-    else if( PtrSessionInfo->TokenInCmdRcd == 3 )
+    switch (gDebugLevel)
     {
-        if( strcmp((const char *)PtrSessionInfo->PtrCmdParams[1], "level") == 0 )
-        {
-            /* Get the Debug level info/warning/critical and set the global var.*/
-            if (CLI_PARAM_STRCMP(2, "info") == 0)
-            {
-                gDebugLevel = IEC_INFO;
-            }
-            else if (CLI_PARAM_STRCMP(2, "warning") == 0)
-            {
-                gDebugLevel = IEC_WARNING;
-            }
-            else if ((CLI_PARAM_STRCMP(2, "critical") == 0))
-            {
-                gDebugLevel = IEC_CRITICAL;
-            }
-            else
-            {
-                return CLI_STATUS_INVALID_PARAMETER;
-            }
-
-            return CLI_STATUS_SUCCESS;
-        }
+        case IEC_INFO:
+            CLI_PRINTF("info-3\r\n");
+            break;
+        case IEC_WARNING:
+            CLI_PRINTF("warning-2\r\n");
+            break;
+        case IEC_CRITICAL:
+            CLI_PRINTF("critical-1\r\n");
+            break;
+        default:
+            CLI_PRINTF("Unknown-%d", gDebugLevel);
+            break;
     }
-    else if( PtrSessionInfo->TokenInCmdRcd == 4 )
-    {
-        if( strcmp((const char *)PtrSessionInfo->PtrCmdParams[1], "module") == 0 )
-        {
-            /* Get the module id.*/
-            retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[2], "%d%c",
-                            &midNum, &invalidChar);
 
-            if( (retVal == 1) && 
-                (midNum < IEC_MID_MAX) )
-            {
-                /* Disable or enable? */
-                if( strcmp((const char *)PtrSessionInfo->PtrCmdParams[3], "enable") == 0 )
-                {
-                    ENABLE_MID_DEBUG(midNum);
-                }
-                else if( strcmp((const char *)PtrSessionInfo->PtrCmdParams[3], "disable") == 0 ) 
-                {
-                    DISABLE_MID_DEBUG(midNum);
-                }
-                else
-                {
-                    return CLI_STATUS_INVALID_PARAMETER;
-                }
-                
-                return CLI_STATUS_SUCCESS;
-            }
-            else
-            {
-                return CLI_STATUS_INVALID_PARAMETER;
-            }
+    CLI_PRINTF("Current enabled modules: \r\n");
 
+    for( midNum = 0; midNum < IEC_MID_MAX; midNum++ )
+    {
+        CLI_PRINTF("%d-%s: ", midNum, iecModulesName[midNum]);
+        if( CHECK_MID_DEBUG(midNum) )
+        {
+            CLI_PRINTF("enabled.\r\n");
         }
         else
         {
-            return CLI_STATUS_INVALID_PARAMETER;
+            CLI_PRINTF("disabled.\r\n");
         }
     }
 
-    return CLI_STATUS_INVALID_PARAM_NUM;
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ *
+ * @Name:   iecCliDebugLevel()
+ *
+ * @Description: iecDebug level <critical|info|warning>. This subcommand sets
+ *               the debug level.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+static CLI_STATUS iecCliDebugLevel( PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    /* The level keyword carries the debug level */
+    gDebugLevel = CLI_ARG_VALUE(2);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ *
+ * @Name:   iecCliDebugModule()
+ *
+ * @Description: iecDebug module <mid> <disable|enable>. This subcommand
+ *               enables or disables debug printf of a module.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+static CLI_STATUS iecCliDebugModule( PTR_CLI_SESSION_INFO PtrSessionInfo )
+{
+    U32 midNum = CLI_ARG_VALUE(2);
+
+    if( CLI_ARG_VALUE(3) == TRUE )
+    {
+        ENABLE_MID_DEBUG(midNum);
+    }
+    else
+    {
+        DISABLE_MID_DEBUG(midNum);
+    }
 
+    return CLI_STATUS_SUCCESS;
 }
 
 /**
@@ -372,8 +772,6 @@ CLI_STATUS iecCliDebug( PTR_CLI_SESSION_INFO PtrSessionInfo )
 CLI_STATUS iecCliSasPort(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 portIndex;
-    S32 retVal;
-    U8 invalidChar;
     U32 portOp;
     U8 portNum = iecSasPortGetPortNum();
     IEC_SAS_PORT_STATUS portStatus;
@@ -381,7 +779,12 @@ CLI_STATUS iecCliSasPort(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
     if (PtrSessionInfo->TokenInCmdRcd == 1)
     {
-        CLI_PRINTF("\r\nPort    PHY     Link    Rate\r\n");
+        BOOL tlvMode = CLI_OUT_TLV_MODE();
+
+        if (!tlvMode)
+        {
+            CLI_PRINTF("\r\nPort    PHY     Link    Rate\r\n");
+        }
         for (portIndex = 0; portIndex < portNum; portIndex ++)
         {
             U8 phyIndex;
@@ -390,7 +793,18 @@ CLI_STATUS iecCliSasPort(PTR_CLI_SESSION_INFO PtrSessionInfo)
             iecSasPortReadStatus(portIndex, &portStatus);
             for (phyIndex = 0; phyIndex < IEC_SAS_PORT_PHY_CNT; phyIndex++)
             {
-                if (portStatus.PortPhyLinkRate[phyIndex]
+                if (tlvMode)
+                {
+                    IEC_CLI_TLV_SAS_PHY_REC phyRec;
+
+                    phyRec.Port       = (U8)portIndex;
+                    phyRec.Phy        = ptrPortCfg->PortPhyNum[phyIndex];
+                    phyRec.LinkStatus = portStatus.PortPhyLinkStatus[phyIndex];
+                    phyRec.LinkRate   = portStatus.PortPhyLinkRate[phyIndex];
+
+                    CLI_OUT_TLV(IEC_CLI_TLV_SAS_PHY, phyRec);
+                }
+                else if (portStatus.PortPhyLinkRate[phyIndex]
                     != IEC_PHY_SPEED_DISABLED)
                 {
                     CLI_PRINTF("%-8d%-8d%-8d%-8d\r\n", portIndex,
@@ -412,20 +826,15 @@ CLI_STATUS iecCliSasPort(PTR_CLI_SESSION_INFO PtrSessionInfo)
     }
     else if (PtrSessionInfo->TokenInCmdRcd == 3)
     {
-        retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[1], "%d%c",
-                        &portIndex, &invalidChar);
-        if ( (retVal == 1) 
-            && (portIndex < portNum))
+        /* Port operation range is checked by the argument schema */
+        portIndex = CLI_ARG_VALUE(1);
+        portOp = CLI_ARG_VALUE(2);
+
+        if (portIndex < portNum)
         {
-            retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[2], "%d%c",
-                            &portOp, &invalidChar);
-            if ((retVal == 1)
-                && portOp <= HALI_PHY_OP_POWER_UP)
-            {
-                iecSasPortOperate(portIndex, portOp);
+            iecSasPortOperate(portIndex, portOp);
 
-                return CLI_STATUS_SUCCESS;
-            }
+            return CLI_STATUS_SUCCESS;
         }
 
        return CLI_STATUS_INVALID_PARAMETER;
@@ -615,7 +1024,7 @@ static void iecCliSgpioPrintPattern( PTR_CLI_SESSION_INFO PtrSessionInfo,
                 break;
             }
         }
-        fprintf(&(PtrSessionInfo->OutFileHandle), "%-13s", str);
+        CLI_PRINTF("%-13s", str);
     }
 }
         
@@ -628,9 +1037,11 @@ static void iecCliSgpioPrintPattern( PTR_CLI_SESSION_INFO PtrSessionInfo,
  *
  * @param PtrSessionInfo - Pointer to the CLI session input parameters.
  *
+ * @return CLI_STATUS_SUCCESS, CLI_STATUS_CANCELLED if stopped by Ctrl-C.
+ *
  *****************************************************************************/
 
-static void iecCliSgpioPrintGrpPattern( PTR_CLI_SESSION_INFO PtrSessionInfo )
+static CLI_STATUS iecCliSgpioPrintGrpPattern( PTR_CLI_SESSION_INFO PtrSessionInfo )
 {
     U32 logicalPhyId = 0;
     U32 physicalPhyId = 0;
@@ -653,6 +1064,11 @@ static void iecCliSgpioPrintGrpPattern( PTR_CLI_SESSION_INFO PtrSessionInfo )
          logicalPhyId < HALI_EXP_NUM_PHYS;
          logicalPhyId++ )
     {
+        if( CLI_CANCELLED() )
+        {
+            return CLI_STATUS_CANCELLED;
+        }
+
         physicalPhyId = haliPhyRemapLogicalToPhysical(logicalPhyId);
         CLI_PRINTF("\r\n%02d         %02d          ", logicalPhyId, physicalPhyId);
 
@@ -682,12 +1098,15 @@ static void iecCliSgpioPrintGrpPattern( PTR_CLI_SESSION_INFO PtrSessionInfo )
     }
 
     CLI_PRINTF("\r\n%s\r\n", IEC_CLI_PRINT_HEADER);
+
+    return CLI_STATUS_SUCCESS;
 }  
 /** 
  *
  * @Name:   iecCliSgpio()
  *
- * @Description: This command toggles sgpio dout output.
+ * @Description: This command shows the sgpio led patterns. It is the root of
+ *               the iecSgpio subcommand tree.
  *
  * @param PtrSessionInfo - Pointer to the CLI session information structure.
  *
@@ -697,68 +1116,29 @@ static void iecCliSgpioPrintGrpPattern( PTR_CLI_SESSION_INFO PtrSessionInfo )
 
 CLI_STATUS iecCliSgpio(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
-    U32 logicalPhyNum;
-    U8 invalidChar;
-    IEC_SGPIO_DOUT_BIT doutBit;
-
-    if (PtrSessionInfo->TokenInCmdRcd == 1)
-    {
-        iecCliSgpioPrintGrpPattern(PtrSessionInfo);
-
-        return CLI_STATUS_SUCCESS; 
-    }
-    else if (PtrSessionInfo->TokenInCmdRcd != 4)
-    {
-        return CLI_STATUS_INVALID_PARAM_NUM;
-    }
-    
-    CLI_PARAM_PARSE_U32(1,
-                    &logicalPhyNum,
-                    &invalidChar);
-
-    if (logicalPhyNum > HALI_EXP_NUM_PHYS)
-    {
-        return CLI_STATUS_INVALID_PARAMETER;
-    }
+    return iecCliSgpioPrintGrpPattern(PtrSessionInfo);
+}
 
-    if (CLI_PARAM_STRCMP(2, "loc") == 0)
-    {
-        doutBit = IEC_SGPIO_DOUT_BIT_LOC;
-    }
-    else if (CLI_PARAM_STRCMP(2, "err") == 0)
-    {
-        doutBit = IEC_SGPIO_DOUT_BIT_ERR;
-    }
-    else
-    {
-        return CLI_STATUS_INVALID_PARAMETER;
-    }
+/**
+ *
+ * @Name:   iecCliSgpioSet()
+ *
+ * @Description: iecSgpio <log_phy> <err|loc> <blink|off|on>. This subcommand
+ *               toggles sgpio dout output.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
 
-    if (CLI_PARAM_STRCMP(3, "on") == 0)
-    {
-        iecSgpioSetDoutSingleLogicalPhy(logicalPhyNum,
-                                  IEC_SGPIO_DOUT_HIGH,
-                                  doutBit,
-                                  FALSE);
-    }
-    else if (CLI_PARAM_STRCMP(3, "off") == 0)
-    {
-        iecSgpioSetDoutSingleLogicalPhy(logicalPhyNum,
-                                  IEC_SGPIO_DOUT_LOW,
-                                  doutBit,
-                                  FALSE);
-    }
-    else if (CLI_PARAM_STRCMP(3, "blink") == 0)
-    {
-        iecSgpioSetDoutSingleLogicalPhy(logicalPhyNum,
-                                  IEC_SGPIO_DOUT_BLINK,
-                                  doutBit,
-                                  FALSE);
-    }
-    else
-    {
-        return CLI_STATUS_INVALID_PARAMETER;
-    }
+static CLI_STATUS iecCliSgpioSet(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    /* The keywords carry the dout bit and the dout value */
+    iecSgpioSetDoutSingleLogicalPhy(CLI_ARG_VALUE(1),
+                              CLI_ARG_VALUE(3),
+                              (IEC_SGPIO_DOUT_BIT)CLI_ARG_VALUE(2),
+                              FALSE);
 
     return CLI_STATUS_SUCCESS;
 }
@@ -767,7 +1147,8 @@ CLI_STATUS iecCliSgpio(PTR_CLI_SESSION_INFO PtrSessionInfo)
  *
  * @Name:   iecCliGPIO()
  *
- * @Description: This command shows and sets GPIO registers.
+ * @Description: This command shows the GPIO registers. It is the root of the
+ *               iecGPIO subcommand tree.
  *
  * @param PtrSessionInfo - Pointer to the CLI session information structure.
  *
@@ -777,112 +1158,99 @@ CLI_STATUS iecCliSgpio(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
 CLI_STATUS iecCliGPIO(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
-    if (PtrSessionInfo->TokenInCmdRcd == 1)
-    {
-        HALI_GPIO_PIN gpioPin;
-        U8 gpioValue;
-        IEC_GPIO_DIRECTION gpioMode;
+    HALI_GPIO_PIN gpioPin;
+    U8 gpioValue;
+    IEC_GPIO_DIRECTION gpioMode;
+    BOOL tlvMode = CLI_OUT_TLV_MODE();
 
+    if (!tlvMode)
+    {
         CLI_PRINTF("\r\nGPIO      MODE      Value\r\n");
+    }
+
+    for (gpioPin = HALI_GPIO_0; gpioPin < HALI_GPIO_NUMBER; gpioPin++)
+    {
+        gpioMode = iecGpioGetDirection(gpioPin);
 
-        for (gpioPin = HALI_GPIO_0; gpioPin < HALI_GPIO_NUMBER; gpioPin++)
+        gpioValue = iecGpioGetPinValue(gpioPin);
+
+        if (tlvMode)
         {
-            gpioMode = iecGpioGetDirection(gpioPin);
+            IEC_CLI_TLV_GPIO_REC gpioRec;
 
-            gpioValue = iecGpioGetPinValue(gpioPin);
+            gpioRec.Pin       = (U8)gpioPin;
+            gpioRec.Direction = (U8)gpioMode;
+            gpioRec.Value     = gpioValue;
 
-            CLI_PRINTF("%-4d      %-10s%-10s\r\n", gpioPin,
-                      gpioMode == IEC_GPIO_DIRECTION_INPUT? "Input" : "output",
-                      gpioValue == 1? "High": "Low" );
+            CLI_OUT_TLV(IEC_CLI_TLV_GPIO, gpioRec);
+            continue;
         }
 
-        return CLI_STATUS_SUCCESS;
+        CLI_PRINTF("%-4d      %-10s%-10s\r\n", gpioPin,
+                  gpioMode == IEC_GPIO_DIRECTION_INPUT? "Input" : "output",
+                  gpioValue == 1? "High": "Low" );
     }
-    else if (PtrSessionInfo->TokenInCmdRcd == 5)
-    {
-        U32 gpioPin;
-        U8 invalidChar;
-        S32 retVal;
-
-        retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[1], "%d%c",
-                            &gpioPin, &invalidChar);
-        if ((retVal != 1)
-            || (gpioPin > HALI_GPIO_NUMBER))
-        {
-            return CLI_STATUS_INVALID_PARAMETER;
-        }
 
-        if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[2], "set") == 0)
-        {
-            if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[3],
-                "dir") == 0)
-            {
-                if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[4],
-                    "in") == 0)
-                {
-                    iecGpioSetDirection((HALI_GPIO_PIN)gpioPin,
-                        IEC_GPIO_DIRECTION_INPUT);
+    return CLI_STATUS_SUCCESS;
+}
 
-                    return CLI_STATUS_SUCCESS;
-                }
-                else if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[4],
-                    "out") == 0)
-                {
-                    iecGpioSetDirection((HALI_GPIO_PIN)gpioPin,
-                        IEC_GPIO_DIRECTION_OUTPUT);
+/**
+ *
+ * @Name:   iecCliGpioSetDir()
+ *
+ * @Description: iecGPIO <gpio> set dir <in|out>. This subcommand sets the
+ *               GPIO direction.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
 
-                    return CLI_STATUS_SUCCESS;
-                }
+static CLI_STATUS iecCliGpioSetDir(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    iecGpioSetDirection((HALI_GPIO_PIN)CLI_ARG_VALUE(1),
+        (IEC_GPIO_DIRECTION)CLI_ARG_VALUE(4));
 
-                return CLI_STATUS_INVALID_PARAMETER;
-            }
-            else if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[3],
-                "val") == 0)
-            {
-                /* Check whether the GPIO has been set as output. */
-                if (iecGpioGetDirection((HALI_GPIO_PIN)gpioPin)
-                    != IEC_GPIO_DIRECTION_OUTPUT)
-                {
-                    CLI_PRINTF("Warning: GPIO %d has not been set as output!\r\n",
-                        gpioPin);
+    return CLI_STATUS_SUCCESS;
+}
 
-                     return CLI_STATUS_INVALID_PARAMETER;
-                }
-            
-                if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[4],
-                    "0") == 0)
-                {
-                    iecGpioSetPinOutput((HALI_GPIO_PIN)gpioPin,
-                        HALI_GPIO_BIT_CLEAR);
-
-                    return CLI_STATUS_SUCCESS;
-                }
-                else if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[4],
-                    "1") == 0)
-                {
-                    iecGpioSetPinOutput((HALI_GPIO_PIN)gpioPin,
-                        HALI_GPIO_BIT_SET);
-
-                    return CLI_STATUS_SUCCESS;
-                }
-                else if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[4],
-                    "toggle") == 0)
-                {
-                    iecGpioTogglePinOutput((HALI_GPIO_PIN)gpioPin);
+/**
+ *
+ * @Name:   iecCliGpioSetVal()
+ *
+ * @Description: iecGPIO <gpio> set val <0|1|toggle>. This subcommand sets
+ *               the value of an output GPIO.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
 
-                    return CLI_STATUS_SUCCESS;
-                }
+static CLI_STATUS iecCliGpioSetVal(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    HALI_GPIO_PIN gpioPin = (HALI_GPIO_PIN)CLI_ARG_VALUE(1);
 
-               return CLI_STATUS_INVALID_PARAMETER;
+    /* Check whether the GPIO has been set as output. */
+    if (iecGpioGetDirection(gpioPin) != IEC_GPIO_DIRECTION_OUTPUT)
+    {
+        CLI_PRINTF("Warning: GPIO %d has not been set as output!\r\n",
+            gpioPin);
 
-            }
-        }
+         return CLI_STATUS_INVALID_PARAMETER;
+    }
 
-        
-        return CLI_STATUS_INVALID_PARAMETER;
+    if (CLI_ARG_VALUE(4) == IEC_CLI_GPIO_VAL_TOGGLE)
+    {
+        iecGpioTogglePinOutput(gpioPin);
     }
-    
-    return CLI_STATUS_INVALID_PARAM_NUM;
+    else
+    {
+        iecGpioSetPinOutput(gpioPin, CLI_ARG_VALUE(4));
+    }
+
+    return CLI_STATUS_SUCCESS;
 }
 
 /**
@@ -961,31 +1329,21 @@ CLI_STATUS iecCliSasAddr(PTR_CLI_SESSION_INFO PtrSessionInfo)
     }
     else if (PtrSessionInfo->TokenInCmdRcd == 3)
     {
-        U8 invalidChar;
-        S32 retVal;
         BOOL setResult;
-        
-        retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[1], "%lx%c",
-                            &sasAddr.Word.High, &invalidChar);
-        if (retVal == 1)
-        {
-            retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[2], "%lx%c",
-                            &sasAddr.Word.Low, &invalidChar);
-            if (retVal == 1)
-            {
-                            
-                setResult = iecSetSasAddrToFlash(&sasAddr,
-                                    HALI_FLASH_OEM_1);
 
-                if (setResult == TRUE)
-                {
-                    return CLI_STATUS_SUCCESS;
-                }
-                else
-                {
-                    return CLI_STATUS_FAILED;
-                }
-            }
+        sasAddr.Word.High = CLI_ARG_VALUE(1);
+        sasAddr.Word.Low = CLI_ARG_VALUE(2);
+
+        setResult = iecSetSasAddrToFlash(&sasAddr,
+                            HALI_FLASH_OEM_1);
+
+        if (setResult == TRUE)
+        {
+            return CLI_STATUS_SUCCESS;
+        }
+        else
+        {
+            return CLI_STATUS_FAILED;
         }
     }
 
@@ -1006,24 +1364,12 @@ CLI_STATUS iecCliSasAddr(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
 CLI_STATUS iecCliLog(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
-    if (PtrSessionInfo->TokenInCmdRcd == 2)
-    {
-        if (strlen((const char*)PtrSessionInfo->PtrCmdParams[1]) 
-            < HALI_LOG_ENTRY_STRING_ARG_LEN)
-        {
-            iecAddLog((char*)PtrSessionInfo->PtrCmdParams[1],
-                HALI_LOG_CLASS_INFO,
-                IEC_LOG_CATEGORY_INIT);
+    /* The log string length is checked by the argument schema */
+    iecAddLog((char*)PtrSessionInfo->PtrCmdParams[1],
+        HALI_LOG_CLASS_INFO,
+        IEC_LOG_CATEGORY_INIT);
 
-             return CLI_STATUS_SUCCESS;
-        }
-        else
-        {
-            return CLI_STATUS_INVALID_PARAMETER;
-        }
-    }
-    
-    return CLI_STATUS_INVALID_PARAM_NUM;    
+    return CLI_STATUS_SUCCESS;
 }
 
 
@@ -1041,8 +1387,6 @@ CLI_STATUS iecCliLog(PTR_CLI_SESSION_INFO PtrSessionInfo)
 CLI_STATUS iecCliIstwi(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 channel;
-    U8 invalidChar;
-    S32 retVal;
     U8 addr7bits;
     HALI_ISTWI_STATUS istwiStauts;
     HALI_ISTWI_ADDRESS istwiAddress;
@@ -1051,56 +1395,49 @@ CLI_STATUS iecCliIstwi(PTR_CLI_SESSION_INFO PtrSessionInfo)
     U32 timeout = 5000;
     U32 hwTimeout = 2000000 / haliOsGetMicrosecPerTick();
 
-    if (strcmp((const char *)PtrSessionInfo->PtrCmdParams[1], "scan") == 0)
-    {
-        retVal = sscanf((const char *)PtrSessionInfo->PtrCmdParams[2], "%d%c",
-                        &channel, &invalidChar);
+    /* "scan" and the channel are checked by the argument schema */
+    channel = CLI_ARG_VALUE(2);
+
+    CLI_PRINTF("\r\n");
 
-        if (retVal == 1)
+    for (addr7bits = 0; addr7bits < 0x80; addr7bits++)
+    {
+        if (CLI_CANCELLED())
         {
-            CLI_PRINTF("\r\n");
-            
-            for (addr7bits = 0; addr7bits < 0x80; addr7bits++)
-            {
-                istwiAddress.Addr1.Bits.Address = addr7bits;
-                
-                istwiStauts = haliIstwiRead((HALI_ISTWI_CHANNEL)channel,
-                                            istwiAddress,
-                                            ptrBlock,
-                                            count,
-                                            timeout,
-                                            hwTimeout);
-                if (istwiStauts != HALI_ISTWI_ERROR_NAK_RX_DURING_ADDR_PHASE
-                    && istwiStauts != HALI_ISTWI_ERROR_LOST_ARB)
-                {
-                    CLI_PRINTF("ACKed addr 7bits: %X, 8bits: %X, rv: %X\r\n",
-                        addr7bits,
-                        (addr7bits << 1),
-                        istwiStauts);
-                }
-                    
-                haliOsThreadSleep(100);
-            }
+            return CLI_STATUS_CANCELLED;
+        }
 
-            return CLI_STATUS_SUCCESS;
+        istwiAddress.Addr1.Bits.Address = addr7bits;
+
+        istwiStauts = haliIstwiRead((HALI_ISTWI_CHANNEL)channel,
+                                    istwiAddress,
+                                    ptrBlock,
+                                    count,
+                                    timeout,
+                                    hwTimeout);
+        if (istwiStauts != HALI_ISTWI_ERROR_NAK_RX_DURING_ADDR_PHASE
+            && istwiStauts != HALI_ISTWI_ERROR_LOST_ARB)
+        {
+            CLI_PRINTF("ACKed addr 7bits: %X, 8bits: %X, rv: %X\r\n",
+                addr7bits,
+                (addr7bits << 1),
+                istwiStauts);
         }
+
+        haliOsThreadSleep(100);
     }
 
-    return CLI_STATUS_INVALID_PARAMETER;
+    return CLI_STATUS_SUCCESS;
 }
 
 #ifndef PRODUCTION_RELEASE
 CLI_STATUS iecCliTest(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 phy;
-    U8 invalidChar;
     IEC_FWERR retVal;
     U8 powerMode;
 
-    if (CLI_ARGC != 2)
-        return CLI_STATUS_INVALID_PARAM_NUM;
-
-    CLI_PARAM_PARSE_U32(1, &phy, &invalidChar);
+    phy = CLI_ARG_VALUE(1);
 
     retVal = iecAtaCheckPowerMode(haliPhyRemapLogicalToPhysical(phy),
                     &powerMode);
@@ -1335,6 +1672,13 @@ CLI_STATUS iecCliFlashRegionDiff(PTR_CLI_SESSION_INFO PtrSessionInfo,
 
         /* avoid cpu hogging */
         haliOsThreadSleep(2);
+
+        /* The buffers are freed below */
+        if (CLI_CANCELLED())
+        {
+            status = CLI_STATUS_CANCELLED;
+            break;
+        }
         
         if (haliFlashRegionRead(ptrRegion1,
                 HALI_FLASH_FIRMWARE_COPY_1,
@@ -1385,7 +1729,6 @@ CLI_STATUS iecCliFwInfo(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     HALI_FLASH_REGION_TYPE regionId, secRegionId;
     U32 length;
-    U8 invalid;
     CLI_STATUS status = CLI_STATUS_SUCCESS;
 
     if (CLI_ARGC == 1)
@@ -1395,24 +1738,21 @@ CLI_STATUS iecCliFwInfo(PTR_CLI_SESSION_INFO PtrSessionInfo)
     }
     else if (CLI_ARGC == 5)
     {
-        if (CLI_PARAM_STRCMP(1, "cmp") == 0)
-        {
-            CLI_PARAM_PARSE_U32(2, (U32*)&regionId, &invalid);
-            CLI_PARAM_PARSE_U32(3, (U32*)&secRegionId, &invalid);
-            CLI_PARAM_PARSE_U32(4, &length, &invalid);
+        /* "cmp" and the region ids are checked by the argument schema */
+        regionId = (HALI_FLASH_REGION_TYPE)CLI_ARG_VALUE(2);
+        secRegionId = (HALI_FLASH_REGION_TYPE)CLI_ARG_VALUE(3);
+        length = CLI_ARG_VALUE(4);
 
-            if (regionId > HALI_FLASH_MANUFACTURING
-                || secRegionId > HALI_FLASH_MANUFACTURING)
-               return CLI_STATUS_INVALID_PARAMETER;
+        //todo: check length
 
-            //todo: check length
-
-            status = iecCliFlashRegionDiff(PtrSessionInfo,
-                                        regionId, 
-                                        secRegionId, 
-                                        length);
-               
-        }
+        status = iecCliFlashRegionDiff(PtrSessionInfo,
+                                    regionId,
+                                    secRegionId,
+                                    length);
+    }
+    else
+    {
+        status = CLI_STATUS_INVALID_PARAM_NUM;
     }
 
     return status;
@@ -1438,6 +1778,39 @@ static void iecCliDisplaySmartData(PTR_CLI_SESSION_INFO PtrSessionInfo,
     PTR_ATA_SMART_DATA ptrSmartData = (PTR_ATA_SMART_DATA)PtrData;
 
     PTR_ATA_SMART_ATTRS ptrAttrs = ptrSmartData->VendorAttributes; 
+
+    if (CLI_OUT_TLV_MODE())
+    {
+        IEC_CLI_TLV_SMART_ATTR_REC attrRec;
+        IEC_CLI_TLV_SMART_TIME_REC timeRec;
+
+        for (index = 0; index < 30; index++)
+        {
+            if (ptrAttrs->AttrId == IEC_SMART_INVLAID_ATTR_ID)
+                break;
+
+            attrRec.AttrId       = ptrAttrs->AttrId;
+            attrRec.Flags[0]     = (U8)(ptrAttrs->Flags & 0xFF);
+            attrRec.Flags[1]     = (U8)(ptrAttrs->Flags >> 8);
+            attrRec.CurrentValue = ptrAttrs->CurrentValue;
+            attrRec.Worst        = ptrAttrs->Worst;
+            memcpy(attrRec.Raw, ptrAttrs->Raw, sizeof(attrRec.Raw));
+            attrRec.Threshold    = ptrAttrs->Reserved;
+
+            CLI_OUT_TLV(IEC_CLI_TLV_SMART_ATTR, attrRec);
+
+            ptrAttrs++;
+        }
+
+        timeRec.ShortTest      = ptrSmartData->ShortTestCompletionTime;
+        timeRec.ExtendTestB    = ptrSmartData->ExtendTestCompletionTimeB;
+        timeRec.ExtendTestW[0] = (U8)(ptrSmartData->ExtendTestCompletionTimeW & 0xFF);
+        timeRec.ExtendTestW[1] = (U8)(ptrSmartData->ExtendTestCompletionTimeW >> 8);
+
+        CLI_OUT_TLV(IEC_CLI_TLV_SMART_TIME, timeRec);
+
+        return;
+    }
     
     CLI_PRINTF("\r\nID#     FLAG     VALUE WORST RAW_VALUE[0]   THRESHOLD\r\n");
     
@@ -1534,17 +1907,13 @@ static void iecCliDisplayWarrantyThreshold(PTR_CLI_SESSION_INFO PtrSessionInfo,
 CLI_STATUS iecCliSmartReadData(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 logicalPhyID, physicalPhyID;
-    U8 invalid;
     HALI_STPI_CMD_DATA_RESPONSE cmdRsp;
     BOOL retVal;
     PU8 ptrSmartData;
     HALI_PHY_INFO phyInfo;
     CLI_STATUS status;
 
-    if (CLI_ARGC != 2)
-        return CLI_STATUS_INVALID_PARAM_NUM;
-
-    CLI_PARAM_PARSE_U32(1, &logicalPhyID, &invalid);
+    logicalPhyID = CLI_ARG_VALUE(1);
 
     physicalPhyID = haliPhyRemapLogicalToPhysical(logicalPhyID);
 
@@ -1603,18 +1972,13 @@ CLI_STATUS iecCliSmartReadData(PTR_CLI_SESSION_INFO PtrSessionInfo)
 CLI_STATUS iecCliSmartReadWaTh(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 logicalPhyID, physicalPhyID;
-    U8 invalid;
     HALI_STPI_CMD_DATA_RESPONSE cmdRsp;
     BOOL retVal;
     PU8 ptrSmartData;
     HALI_PHY_INFO phyInfo;
     CLI_STATUS status;
 
-    if (CLI_ARGC != 2)
-        return CLI_STATUS_INVALID_PARAM_NUM;
-	//fill the argv[0] with logicalphyid  
-
-    CLI_PARAM_PARSE_U32(1, &logicalPhyID, &invalid);
+    logicalPhyID = CLI_ARG_VALUE(1);
 
     physicalPhyID = haliPhyRemapLogicalToPhysical(logicalPhyID);
 
@@ -1663,7 +2027,8 @@ CLI_STATUS iecCliSmartReadWaTh(PTR_CLI_SESSION_INFO PtrSessionInfo)
 /**
  * @Name:   iecCliRawDataPrintf()
  *
- * @Description: This function print input raw data in hex.
+ * @Description: This function print input raw data in hex, with the
+ *               printable characters, and collapses repeated lines to "*".
  *
  * @param String - msg to printf before data
  * @param PtrData   - point to data to be printf
@@ -1673,38 +2038,23 @@ CLI_STATUS iecCliSmartReadWaTh(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
 void iecCliRawDataPrintf(PTR_CLI_SESSION_INFO PtrSessionInfo,
                             char *String,
-							void const * PtrData, 
-							U16 DataSize)
+                            void const * PtrData, 
+                            U16 DataSize)
 {
-	U16 idx;
-	U8  *ptr = (PU8)PtrData;
-
-	if (ptr != NULL && DataSize > 0)
-	{
-		if (String)
-		{
-			printf("%s\r\n", String);
-		}
+    if (PtrData != NULL && DataSize > 0)
+    {
+        if (String)
+        {
+            CLI_PRINTF("%s\r\n", String);
+        }
 
-        CLI_PRINTF("00000000: ");
-        
-		for (idx = 0; idx < DataSize; idx++)
-		{
-			/* print 16 bytes each line. */
-			if (idx && (idx % 16 == 0))
-			{
-				CLI_PRINTF("\r\n");
-                CLI_PRINTF("%08X: ", idx);
-			}
-
-			CLI_PRINTF("%02X ", ptr[idx]);
-		}
-	}
-	else
-	{
-		CLI_PRINTF("No data to print!\r\n");
-	}
-	CLI_PRINTF("\r\n");
+        iecCliHexDump(&(PtrSessionInfo->OutFileHandle), PtrData, DataSize,
+                      IEC_CLI_HEXDUMP_ASCII | IEC_CLI_HEXDUMP_COLLAPSE);
+    }
+    else
+    {
+        CLI_PRINTF("No data to print!\r\n\r\n");
+    }
 }
 
 
@@ -1722,34 +2072,21 @@ void iecCliRawDataPrintf(PTR_CLI_SESSION_INFO PtrSessionInfo,
 
 CLI_STATUS iecCliEnclosure(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
-    if (CLI_ARGC == 2)
+    /* "show" is checked by the argument schema */
+    if (iecLockSavedEnclData(HALI_OS_WAIT_FOREVER) == HALI_OS_SUCCESS)
     {
-        if (CLI_PARAM_STRCMP(1, "show") == 0)
-        {
-            if (iecLockSavedEnclData(HALI_OS_WAIT_FOREVER) == HALI_OS_SUCCESS)
-            {
-                PTR_IEC_ENCL_DATA ptrData = iecGetSavedEnclDataPtr();
+        PTR_IEC_ENCL_DATA ptrData = iecGetSavedEnclDataPtr();
 
-                CLI_PRINTF("\r\n");
+        CLI_PRINTF("\r\n");
 
-                iecCliRawDataPrintf(PtrSessionInfo,
-                                "ENCL Data",
-                                ptrData,
-                                sizeof(IEC_ENCL_DATA));
+        iecCliRawDataPrintf(PtrSessionInfo,
+                        "ENCL Data",
+                        ptrData,
+                        sizeof(IEC_ENCL_DATA));
 
-                iecUnLockSavedEnclData();
-            }
-        }
-        else
-        {
-            return CLI_STATUS_INVALID_PARAMETER;
-        }
-    }
-    else
-    {
-        return CLI_STATUS_INVALID_PARAM_NUM;
+        iecUnLockSavedEnclData();
     }
-    
+
     return CLI_STATUS_SUCCESS;
 }
 
@@ -1769,7 +2106,6 @@ CLI_STATUS iecCliEnclosure(PTR_CLI_SESSION_INFO PtrSessionInfo)
 CLI_STATUS iecCliAtaDevTemperature(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
     U32 driveId;
-    U8 invalidChar;
     U8 phyId;
     HALI_PHY_INFO phyInfo;
     CLI_STATUS status = CLI_STATUS_SUCCESS;
@@ -1777,7 +2113,7 @@ CLI_STATUS iecCliAtaDevTemperature(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
     if (CLI_ARGC == 2)
     {
-        CLI_PARAM_PARSE_U32(1, &driveId, &invalidChar);
+        driveId = CLI_ARG_VALUE(1);
         
         phyId = arbokDriveIdToPhysicalPhyId(driveId);
 
@@ -1840,116 +2176,441 @@ CLI_STATUS iecCliAtaDevTemperature(PTR_CLI_SESSION_INFO PtrSessionInfo)
 
 
 /**
- * @Name:   iecCliInit()
  *
- * @Description: This function registers IEC specific CLI commands.
+ * @Name:   iecCliSession()
  *
- * @param PtrCliCmdList - Pointer to the CLI Command List
- *               structure.
+ * @Description: This command shows the output channel counters of the cli
+ *               sessions, or clears them. The current session is marked
+ *               with '*'. The blocked time is the time spent writing the
+ *               output buffer to the session file handle. The session slot
+ *               pool line shows the free slots, the sessions created and
+ *               refused for want of a slot, and the time the last and the
+ *               slowest session took to be created. The close line shows
+ *               the sessions closed, those whose thread had to be
+ *               terminated, and the time the last and the slowest close
+ *               took.
  *
- * @note This function should be called at cliCoreInit().
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
  *
  *****************************************************************************/
- 
-void iecCliInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+
+CLI_STATUS iecCliSession(PTR_CLI_SESSION_INFO PtrSessionInfo)
 {
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    IEC_CLI_OUT_STATS stats;
+    CLI_SESSION_POOL_STATS poolStats;
+    U32 usPerTick = haliOsGetMicrosecPerTick();
+    U32 index;
 
-    U16 cmdCount;
-	U16 inx;
-	
+    if (CLI_ARGC == 2)
+    {
+        /* "clear" is checked by the argument schema */
+        for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+        {
+            ptrCtx = iecCliSessionCtxAt(index);
+            if (ptrCtx != NULL)
+            {
+                memset(&ptrCtx->OutStats, 0, sizeof(ptrCtx->OutStats));
+            }
+        }
+        cliSessionPoolStats(&poolStats, TRUE);
 
-	/* No. of entries in sPtrIecCliCmdList */
-	cmdCount = sizeof(sPtrIecCliCmdList)/sizeof(sPtrIecCliCmdList[0]);
-
-	/* Traverse through the list and register all commands with CLI core */
-	for( inx = 0; inx < cmdCount; inx++ )
-	{
-		cliRegisterCommand(sPtrIecCliCmdList[inx]->PtrCmdName,
-							sPtrIecCliCmdList[inx]->PtrOneLineHelp,
-							sPtrIecCliCmdList[inx]->PtrToFunCall,
-							PtrCliCmdList);
-	}
-	
+        return CLI_STATUS_SUCCESS;
+    }
+
+    CLI_PRINTF("\r\nID   Bytes       Writes      Flushes     Blocked(us) Max(us)\r\n");
+    CLI_PRINTF(IEC_CLI_PRINT_HEADER "\r\n");
+
+    for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+    {
+        ptrCtx = iecCliSessionCtxAt(index);
+        if (ptrCtx == NULL)
+        {
+            continue;
+        }
+
+        /* Copy first, the counters of the other sessions keep changing */
+        stats = ptrCtx->OutStats;
+
+        CLI_PRINTF("%c%-3d %-11u %-11u %-11u %-11u %-11u\r\n",
+                   (ptrCtx->PtrSessionInfo == PtrSessionInfo) ? '*' : ' ',
+                   index,
+                   stats.Bytes,
+                   stats.Writes,
+                   stats.Flushes,
+                   stats.BlockedTicks * usPerTick,
+                   stats.MaxBlockedTicks * usPerTick);
+    }
+
+    cliSessionPoolStats(&poolStats, FALSE);
+    CLI_PRINTF("\r\nSlots: %u of %u free, %u created, %u refused\r\n",
+               poolStats.FreeSlots,
+               poolStats.Slots,
+               poolStats.Connects,
+               poolStats.NoSlot);
+    CLI_PRINTF("Connect(us): last %u, max %u\r\n",
+               poolStats.LastConnectTicks * usPerTick,
+               poolStats.MaxConnectTicks * usPerTick);
+    CLI_PRINTF("Closed: %u, %u terminated, close(us): last %u, max %u\r\n",
+               poolStats.Closes,
+               poolStats.Terminated,
+               poolStats.LastCloseTicks * usPerTick,
+               poolStats.MaxCloseTicks * usPerTick);
+
+    return CLI_STATUS_SUCCESS;
 }
 
+
 /**
- * @Name:   __inline U8  cliArrowHandle(U8 InputChar)
- *
- * @Description: This function will detect arrow key pressed and return corresponding
- *               key value.
- *
- * @param  InputChar denote getchar every one time
- *
- * @return  UP_KEY  value 2
-            DOWN_KEY  value 4;
- *
- *****************************************************************************/ 
-__inline U8  iecCliArrowHandle(U8 InputChar)
-{     
-      static U8   sum = 0;
-      if(InputChar == 0x00)
-        return 0;   
-      switch(InputChar)
-      {
-            case 0X5b:  //represent for '['
-                sum += 1;
-                break;
-                
-            case 0X41:  //represent for 'A'
-                sum += 1;
-                break;
-             case 0X42:
-                sum += 3; //avoid press single 'B'
-                break;
-            /*initial press arrow key again*/
-            default:
-                sum = 0;
-                break;
+ *
+ * @Name:   iecCliOutMode()
+ *
+ * @Description: This command shows or selects the output mode of the
+ *               session. In tlv mode the commands send binary TLV records
+ *               (see iecCliOut.h) instead of formatted text, for in-band
+ *               tools.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliOutMode(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    if (CLI_ARGC == 2)
+    {
+        /* The mode keyword is checked by the argument schema */
+        iecCliOutSetMode(&(PtrSessionInfo->OutFileHandle),
+                         (IEC_CLI_OUT_MODE)CLI_ARG_VALUE(1));
+
+        return CLI_STATUS_SUCCESS;
+    }
+
+    CLI_PRINTF("\r\nOutput mode: %s\r\n",
+               sIecCliKwOutMode[CLI_OUT_TLV_MODE() ?
+                                IEC_CLI_OUT_MODE_TLV : IEC_CLI_OUT_MODE_TEXT]);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ *
+ * @Name:   iecCliBatch()
+ *
+ * @Description: This command shows or selects what a command batch
+ *               (cmd1; cmd2; ...) of the session does when a command fails:
+ *               continue with the next command, or stop the batch.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliBatch(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+
+    if (ptrCtx == NULL)
+    {
+        return CLI_STATUS_FAILED;
+    }
+
+    if (CLI_ARGC == 2)
+    {
+        /* The keyword is checked by the argument schema */
+        ptrCtx->BatchStopOnError = (CLI_ARG_VALUE(1) != 0) ? TRUE : FALSE;
+
+        return CLI_STATUS_SUCCESS;
+    }
+
+    CLI_PRINTF("\r\nBatch error mode: %s\r\n",
+               sIecCliKwBatch[(ptrCtx->BatchStopOnError == TRUE) ? 1 : 0]);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ *
+ * @Name:   iecCliJobs()
+ *
+ * @Description: This command lists the background jobs of the session, with
+ *               their state, status and the number of output bytes not
+ *               shown yet.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliJobs(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    iecCliJobList(PtrSessionInfo);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+
+/**
+ *
+ * @Name:   iecCliFg()
+ *
+ * @Description: This command shows the output of a background job of the
+ *               session until the job is done.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliFg(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    /* The job id is checked by the argument schema */
+    return iecCliJobForeground(PtrSessionInfo, CLI_ARG_VALUE(1));
+}
+
+
+/**
+ *
+ * @Name:   iecCliWait()
+ *
+ * @Description: This command waits for a background job of the session, or
+ *               for all of them, and shows their output.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliWait(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    if (CLI_ARGC == 2)
+    {
+        return iecCliJobForeground(PtrSessionInfo, CLI_ARG_VALUE(1));
+    }
+
+    return iecCliJobWaitAll(PtrSessionInfo);
+}
+
+
+/**
+ *
+ * @Name:   iecCliKill()
+ *
+ * @Description: This command stops a background job of the session. Its
+ *               output is discarded.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliKill(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    return iecCliJobKill(PtrSessionInfo, CLI_ARG_VALUE(1));
+}
+
+
+/**
+ *
+ * @Name:   iecCliWatch()
+ *
+ * @Description: This command runs a command again and again, and shows its
+ *               output in place until Ctrl-C is typed. The tokens after the
+ *               options are joined with spaces into the command line, so a
+ *               quoted command may be a batch. The options are checked by
+ *               the watch argument schema.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return result of command execution.
+ *
+ *****************************************************************************/
+
+CLI_STATUS iecCliWatch(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    U8 command[CLI_MAX_CMD_LINE_LENGTH];
+    U32 intervalMs = IEC_CLI_WATCH_INTERVAL_DEFAULT;
+    U32 index = 1;
+    U32 length = 0;
+    U32 tokenLength;
+
+    /* An option name has a value other than 0, -n is the only option */
+    while ((index < CLI_ARGC) && (CLI_ARG_VALUE(index) != 0))
+    {
+        intervalMs = CLI_ARG_VALUE(index + 1);
+        index += 2;
+    }
+
+    for ( ; index < CLI_ARGC; index++)
+    {
+        tokenLength = strlen((const char *)PtrSessionInfo->PtrCmdParams[index]);
+
+        /* Room for the space before the token and the terminator */
+        if (length + tokenLength + 2 > sizeof(command))
+        {
+            return CLI_STATUS_CMD_LEN;
+        }
+
+        if (length > 0)
+        {
+            command[length++] = ' ';
         }
-        return sum;
+
+        memcpy(&command[length], PtrSessionInfo->PtrCmdParams[index], tokenLength);
+        length += tokenLength;
+    }
+
+    command[length] = '\0';
+
+    return iecCliWatchRun(PtrSessionInfo, command, intervalMs);
 }
 
+
 /**
- * @Name:   iecCliSearchCommand()
+ * @Name:   iecCliCompleteDrivePhy()
  *
- * @Description: This function search the command set by the partial string inputed
- *               by user.
+ * @Description: TAB completion callback of the logical phy arguments. Only
+ *               the phys with an attached SAS or SATA drive are offered.
  *
- * @param  ptrName - pointer to  user input string
+ * @param PtrCursor - Next logical phy to check, advanced past the candidate.
  *
- * @param len - the length of user input string
+ * @param PtrCandidate - Returns the logical phy number.
  *
- * @param pptrResult - pointer to pointer to the last command in the set that is matched.
+ * @param Size - Size of the candidate buffer.
  *
- * @return count of commands that are matched.
+ * @return TRUE if a candidate is returned, FALSE if there are no more.
  *
- * @author Xie.Qian-jun 20180119
  *****************************************************************************/
-U8 iecCliSearchCommand(const char *ptrName, 
-                                          U8 len, 
-                                          char**pptrResult, 
-                                          CLI_CMD_LIST sCliCmdList)
+static BOOL iecCliCompleteDrivePhy(U32 *PtrCursor, char *PtrCandidate, U32 Size)
 {
-    U8 count = 0;
+    HALI_PHY_INFO phyInfo;
+    U32 logicalPhyId;
 
-    PTR_CLI_CMD_NODE PtrCmdNode  = sCliCmdList.PtrCliCmdListHead;
-    *pptrResult = NULL;
-    
-    for (; PtrCmdNode; PtrCmdNode = PtrCmdNode->PtrNext)
+    for (logicalPhyId = *PtrCursor; logicalPhyId < HALI_EXP_NUM_PHYS; logicalPhyId++)
     {
-        if( strncmp((char *)(PtrCmdNode->Command),
-                    ptrName,
-                    len) == 0 )
+        if ((haliGetPhyInformation(&phyInfo,
+                haliPhyRemapLogicalToPhysical(logicalPhyId)) == HALI_PHY_INFO_SUCCESS) &&
+            (phyInfo.IsSATATgtAttached || phyInfo.IsSSPTgtAttached))
         {
-            count++;
-            *pptrResult = (char *)PtrCmdNode->Command;
+            *PtrCursor = logicalPhyId + 1;
+            snprintf(PtrCandidate, Size, "%d", (int)logicalPhyId);
+
+            return TRUE;
         }
-    
     }
 
-    return count;
+    *PtrCursor = logicalPhyId;
+
+    return FALSE;
 }
 
+/**
+ * @Name:   iecCliCompleteGpio()
+ *
+ * @Description: TAB completion callback of the GPIO pin argument.
+ *
+ * @param PtrCursor - Next GPIO pin, advanced past the candidate.
+ *
+ * @param PtrCandidate - Returns the GPIO pin number.
+ *
+ * @param Size - Size of the candidate buffer.
+ *
+ * @return TRUE if a candidate is returned, FALSE if there are no more.
+ *
+ *****************************************************************************/
+static BOOL iecCliCompleteGpio(U32 *PtrCursor, char *PtrCandidate, U32 Size)
+{
+    if (*PtrCursor >= HALI_GPIO_NUMBER)
+    {
+        return FALSE;
+    }
+
+    snprintf(PtrCandidate, Size, "%d", (int)(*PtrCursor)++);
+
+    return TRUE;
+}
+
+/**
+ * @Name:   iecCliCompleteFlashRegion()
+ *
+ * @Description: TAB completion callback of the flash region arguments of
+ *               iecFwInfo cmp. Regions of size 0 are not present on the
+ *               board and are not offered.
+ *
+ * @param PtrCursor - Next region id, advanced past the candidate.
+ *
+ * @param PtrCandidate - Returns the region id.
+ *
+ * @param Size - Size of the candidate buffer.
+ *
+ * @return TRUE if a candidate is returned, FALSE if there are no more.
+ *
+ *****************************************************************************/
+static BOOL iecCliCompleteFlashRegion(U32 *PtrCursor, char *PtrCandidate, U32 Size)
+{
+    U32 regionId;
+
+    for (regionId = *PtrCursor; regionId <= HALI_FLASH_MANUFACTURING; regionId++)
+    {
+        if (haliFlashGetRegionSize((HALI_FLASH_REGION_TYPE)regionId) != 0)
+        {
+            *PtrCursor = regionId + 1;
+            snprintf(PtrCandidate, Size, "%d", (int)regionId);
+
+            return TRUE;
+        }
+    }
+
+    *PtrCursor = regionId;
+
+    return FALSE;
+}
+
+
+/**
+ * @Name:   iecCliInit()
+ *
+ * @Description: This function registers IEC specific CLI commands.
+ *
+ * @param PtrCliCmdList - Pointer to the CLI Command List
+ *               structure.
+ *
+ * @note This function should be called at cliCoreInit().
+ *
+ *****************************************************************************/
+ 
+void iecCliInit( PTR_CLI_CMD_LIST PtrCliCmdList )
+{
+    U16 cmdCount;
+
+    /* No. of entries in sPtrIecCliCmdList */
+    cmdCount = sizeof(sPtrIecCliCmdList)/sizeof(sPtrIecCliCmdList[0]);
+
+    /* Register the whole table with CLI core */
+    cliRegisterCommandTable(sPtrIecCliCmdList, cmdCount, PtrCliCmdList);
+
+    /* Register the argument schemas of the commands */
+    cliRegisterArgSchemaTable(sPtrIecCliArgSchemaList,
+        sizeof(sPtrIecCliArgSchemaList)/sizeof(sPtrIecCliArgSchemaList[0]));
+
+    /* The commands that can run as a job or through cliExecToBuffer() */
+    cliRegisterCaptureTable(sPtrIecCliCaptureList,
+        sizeof(sPtrIecCliCaptureList)/sizeof(sPtrIecCliCaptureList[0]));
+
+    /* The handlers watch runs */
+    cliRegisterReadOnlyTable(sIecCliReadOnlyList,
+        sizeof(sIecCliReadOnlyList)/sizeof(sIecCliReadOnlyList[0]));
+}
 
 /** @} */
 
@@ -0,0 +1,307 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliCore.h
+ *          Title:  iec CLI Core Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added command options to the argument schema, and a
+ *                  schema without argument descriptions.
+ *  10/18/26  AW    Added CLI_CMD_INDEX_SIZE_MAX.
+ *  10/18/26  AW    CLI_SESSION_POOL_SIZE is a platform setting, 4 by default.
+ *  10/18/26  AW    Added cliRegisterReadOnlyTable() and cliHandlerReadOnly().
+ *  10/18/26  AW    Added CLI_EXEC_SESSION_MAX.
+ *  10/18/26  AW    Added cliRegisterCaptureTable() and cliCmdCaptureSafe().
+ *  10/18/26  AW    Added ArgCountStatus to the argument schema. CLI_ARG_VALUE()
+ *                  also works for a session without a session context.
+ *  10/18/26  AW    Replaced the command node pool by the command table
+ *                  slots, the command tables are not copied.
+ *  10/18/26  AW    Added the session close counters and times.
+ *  10/18/26  AW    Added the session slot pool statistics.
+ *  10/18/26  AW    Added cliExecToBuffer().
+ *  10/18/26  AW    Added CLI_STATUS_CANCELLED.
+ *  10/18/26  AW    Added the argument completion callback.
+ *  10/18/26  AW    Added subcommand trees.
+ *  10/18/26  AW    Added the command argument schema.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the iec extensions of the cli core
+ *  (cliCore.c). It contains the command table registration interface, the
+ *  command argument schema, the subcommand trees and cliExecToBuffer(),
+ *  which runs a command line for firmware code and returns its output.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_CORE_H
+#define _IEC_CLI_CORE_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Maximum number of command tables registered with the core command list.
+ * The tables registered beyond it get a command node per command.
+ */
+#define CLI_CMD_TABLE_MAX           (8)
+
+/* Maximum number of buckets of the command dispatch index, a power of two
+ * up to 65536. The index is sized at init for the registered commands; if
+ * they need more buckets, no index is built and the commands are searched
+ * one by one.
+ */
+#ifndef CLI_CMD_INDEX_SIZE_MAX
+#define CLI_CMD_INDEX_SIZE_MAX      (512)
+#endif
+
+/* Maximum number of commands with a registered argument schema */
+#define CLI_ARG_SCHEMA_MAX          (32)
+
+/* Maximum number of capture tables, see cliRegisterCaptureTable() */
+#define CLI_CAPTURE_TABLE_MAX       (8)
+
+/* Maximum number of read-only handler tables, see cliRegisterReadOnlyTable() */
+#define CLI_READ_ONLY_TABLE_MAX     (8)
+
+/* Number of cliExecToBuffer() calls that can run at the same time. Each one
+ * uses a static session and a session context. At most 32.
+ */
+#define CLI_EXEC_SESSION_MAX        (2)
+
+/* Number of session slots (thread object and stack) reserved at init, i.e.
+ * the telnet, SSH and in-band sessions served at the same time. Each slot
+ * holds a CLI_THREAD_STACK_SIZE stack for good, so a platform sets it to
+ * the sessions it expects; the sessions beyond it are refused. From 1 to
+ * 32, and at most IEC_CLI_MAX_SESSIONS. The background jobs do not use it.
+ */
+#ifndef CLI_SESSION_POOL_SIZE
+#define CLI_SESSION_POOL_SIZE       (4)
+#endif
+
+/* Status of a command stopped by Ctrl-C, see CLI_CANCELLED(). It follows
+ * the last CLI_STATUS of cliCore.h, and is the last entry of the error table
+ * of cliCore.c.
+ */
+#define CLI_STATUS_CANCELLED        ((CLI_STATUS)(CLI_STATUS_ERROR_PRINTED + 1))
+
+/*
+** Macros
+*/
+
+/* Converted value of the argument at token index Index of a command with an
+ * argument schema. For a keyword argument it is the index of the keyword in
+ * the keyword table. Only valid for arguments present on the command line.
+ */
+#define CLI_ARG_VALUE(Index) \
+    cliArgValue(PtrSessionInfo, (Index))
+
+/* Child table and child count of a subcommand node */
+#define CLI_SUBCMD_CHILDREN(Table) \
+    (Table), (U8)(sizeof(Table)/sizeof((Table)[0]))
+
+/* No keyword children */
+#define CLI_SUBCMD_NO_CHILDREN      NULL, 0
+
+/* Option table and option count of an argument schema */
+#define CLI_ARG_OPTIONS(Table) \
+    (Table), (U8)(sizeof(Table)/sizeof((Table)[0]))
+
+/* No options */
+#define CLI_ARG_NO_OPTIONS          NULL, 0
+
+/*
+** Enumerated types
+*/
+
+typedef enum _CLI_ARG_TYPE
+{
+    /* Decimal number in the range Min to Max */
+    CLI_ARG_TYPE_DEC = 0,
+    /* Hexadecimal number, with or without 0x, in the range Min to Max */
+    CLI_ARG_TYPE_HEX,
+    /* Hexadecimal number with 0x, otherwise decimal, in the range Min to Max */
+    CLI_ARG_TYPE_NUM,
+    /* One of the strings of PtrKeywords */
+    CLI_ARG_TYPE_KEYWORD,
+    /* Any string shorter than Max characters, Max 0 is no limit */
+    CLI_ARG_TYPE_STRING
+} CLI_ARG_TYPE;
+
+/*
+** Typedefs
+*/
+
+/* Completion callback of an argument, used by the TAB key. Returns in
+ * PtrCandidate (Size bytes with the NUL) the first candidate at or after
+ * *PtrCursor and advances *PtrCursor past it. *PtrCursor is 0 on the first
+ * call. Returns FALSE when there are no more candidates.
+ */
+typedef BOOL (*PTR_CLI_ARG_COMPLETER)( U32 *PtrCursor,
+                                       char *PtrCandidate,
+                                       U32 Size );
+
+/* Argument description */
+typedef struct _CLI_ARG_SPEC
+{
+    CLI_ARG_TYPE        Type;
+    U32                 Min;
+    U32                 Max;
+    /* NULL terminated keyword table for CLI_ARG_TYPE_KEYWORD */
+    const char * const *PtrKeywords;
+    /* Completion candidates, NULL if none. The keywords of a keyword
+     * argument are completed without it.
+     */
+    PTR_CLI_ARG_COMPLETER PtrCompleter;
+} CLI_ARG_SPEC, *PTR_CLI_ARG_SPEC;
+
+/* Option of a command, a name followed by a value, e.g. "-n <ms>" */
+typedef struct _CLI_ARG_OPTION
+{
+    const char         *PtrName;
+    CLI_ARG_SPEC        ValueSpec;
+} CLI_ARG_OPTION, *PTR_CLI_ARG_OPTION;
+
+/* Handler of a subcommand */
+typedef CLI_STATUS (*PTR_CLI_SUBCMD_HANDLER)( PTR_CLI_SESSION_INFO PtrSessionInfo );
+
+typedef struct _CLI_SUBCMD_NODE CLI_SUBCMD_NODE, *PTR_CLI_SUBCMD_NODE;
+
+/* Node of a subcommand tree. Each token of the command line selects a child
+ * of the current node: first the keyword children are searched (binary
+ * search, so they must be sorted in strcmp() order), then the value child
+ * is tried. The handler of the node where the command line ends is called.
+ */
+struct _CLI_SUBCMD_NODE
+{
+    /* Keyword, or the name shown by help for a value node, e.g. "<gpio>" */
+    const char             *PtrKeyword;
+    /* Stored in CLI_ARG_VALUE() when the keyword is matched */
+    U32                     Value;
+    /* Description of the value of a value node, NULL for a keyword node */
+    const CLI_ARG_SPEC     *PtrValueSpec;
+    /* Keyword children, sorted */
+    const CLI_SUBCMD_NODE  *PtrChildren;
+    U8                      ChildCount;
+    /* Value child, NULL if none */
+    const CLI_SUBCMD_NODE  *PtrValueChild;
+    /* Handler called when the command line ends at this node, NULL if the
+     * command is not complete at this node.
+     */
+    PTR_CLI_SUBCMD_HANDLER  PtrToFunCall;
+};
+
+/* Argument schema of a command. The core checks and converts the arguments
+ * before the handler is called, so the handler only gets valid arguments.
+ * Arguments beyond MinArgs are optional, but when present they are checked
+ * against their position in PtrArgSpec.
+ * The options come first, in any order. The value of an option is stored in
+ * CLI_ARG_VALUE() at the token index of the value, and the option name gets
+ * the index of the option in PtrOptions plus one. MinArgs, MaxArgs and
+ * PtrArgSpec describe the arguments after the options.
+ * A command with a subcommand tree is dispatched through the tree instead,
+ * MinArgs, MaxArgs and PtrArgSpec are not used.
+ */
+typedef struct _CLI_ARG_SCHEMA
+{
+    /* Command the schema belongs to */
+    const CLI_CMD_INFO *PtrCmdInfo;
+    /* Number of arguments, without the command name */
+    U8                  MinArgs;
+    U8                  MaxArgs;
+    /* MaxArgs argument descriptions, NULL if the arguments are any string */
+    const CLI_ARG_SPEC *PtrArgSpec;
+    /* Root of the subcommand tree, NULL if the command has none */
+    const CLI_SUBCMD_NODE *PtrSubCmdTree;
+    /* Status of a wrong number of arguments, CLI_STATUS_SUCCESS for
+     * CLI_STATUS_INVALID_PARAM_NUM. Keeps the status the handler returned
+     * before it had a schema. Not used for a subcommand tree.
+     */
+    CLI_STATUS          ArgCountStatus;
+    /* Options, NULL if the command has none. An option without its value
+     * is a wrong number of arguments.
+     */
+    const CLI_ARG_OPTION *PtrOptions;
+    U8                  OptionCount;
+} CLI_ARG_SCHEMA, *PTR_CLI_ARG_SCHEMA;
+
+/* Statistics of the session slot pool and of the session connects and
+ * closes. The thread object and the stack of the sessions are reserved once
+ * by cliCoreInit(), cliCreateSessionEx() takes a slot and cliCloseSession()
+ * gives it back.
+ */
+typedef struct _CLI_SESSION_POOL_STATS
+{
+    /* Slots reserved at init, and slots free now */
+    U32                 Slots;
+    U32                 FreeSlots;
+    /* Sessions created, and sessions refused because no slot was free */
+    U32                 Connects;
+    U32                 NoSlot;
+    /* Time cliCreateSessionEx() took for the last session and at most,
+     * in OS ticks
+     */
+    U32                 LastConnectTicks;
+    U32                 MaxConnectTicks;
+    /* Sessions closed, and sessions whose thread did not return in time
+     * and was terminated
+     */
+    U32                 Closes;
+    U32                 Terminated;
+    /* Time cliCloseSession() took for the last session and at most, in OS
+     * ticks
+     */
+    U32                 LastCloseTicks;
+    U32                 MaxCloseTicks;
+} CLI_SESSION_POOL_STATS, *PTR_CLI_SESSION_POOL_STATS;
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+CLI_STATUS cliRegisterCommandTable(const CLI_CMD_INFO * const *PtrCmdTable,
+                                   U16 CmdCount,
+                                   PTR_CLI_CMD_LIST PtrCliCmdList);
+
+CLI_STATUS cliRegisterArgSchemaTable(const CLI_ARG_SCHEMA * const *PtrSchemaTable,
+                                     U16 SchemaCount);
+
+CLI_STATUS cliRegisterCaptureTable(const CLI_CMD_INFO * const *PtrCmdTable,
+                                   U16 CmdCount);
+
+BOOL cliCmdCaptureSafe(PTR_CLI_CMD_NODE PtrCmdNode);
+
+CLI_STATUS cliRegisterReadOnlyTable(const PTR_CLI_SUBCMD_HANDLER *PtrHandlerTable,
+                                    U16 HandlerCount);
+
+BOOL cliHandlerReadOnly(PTR_CLI_SUBCMD_HANDLER FptrHandler);
+
+BOOL cliParseU32(const U8 *PtrString, U32 Radix, U32 *PtrValue);
+
+U32 cliArgValue(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Index);
+
+CLI_STATUS cliExecToBuffer(const U8 *PtrCmdLine,
+                           PU8 PtrBuffer,
+                           U32 Size,
+                           U32 *PtrLength);
+
+void cliSessionPoolStats(PTR_CLI_SESSION_POOL_STATS PtrStats, BOOL Clear);
+
+
+#endif
@@ -0,0 +1,494 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliEditor.c
+ *          Title:  IEC CLI Line Editor Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    iecCliEditorStart() resets the persistent history
+ *                  cursor.
+ *  10/18/26  AW    Decode Ctrl-R and Ctrl-G.
+ *  10/18/26  AW    iecCliEditorStart() resets the history cursor.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli line editor.
+ *  The decoder understands the CSI (ESC [) and SS3 (ESC O) forms of the
+ *  cursor keys, the VT220 ESC [ n ~ form of Home, End and Delete, and the
+ *  emacs style control keys. The edit functions keep the line NUL
+ *  terminated and redraw only the part of the terminal line that changed:
+ *  the cursor is moved with backspaces or by re-sending the characters it
+ *  moves over when that is shorter than the escape sequence, and the end
+ *  of the line is erased with ESC [ K only when it is shorter than spaces.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "iecCliOut.h"
+#include "iecCliEditor.h"
+
+
+/* Cursor moves up to this many columns are sent as backspaces or re-sent
+ * characters, longer moves as ESC [ n D / ESC [ n C.
+ */
+#define IEC_CLI_EDITOR_SHORT_MOVE   (4)
+
+
+/**
+ * @Name:   iecCliEditorMoveLeft()
+ *
+ * @Description: This function moves the terminal cursor left.
+ *
+ * @param Count - Number of columns.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliEditorMoveLeft(U16 Count, FILE *PtrOutFileHandle)
+{
+    if (Count > IEC_CLI_EDITOR_SHORT_MOVE)
+    {
+        iecCliOutPrintf(PtrOutFileHandle, "\x1b[%uD", Count);
+        return;
+    }
+
+    while (Count--)
+    {
+        iecCliOutPutc(CLI_BACKSPACE, PtrOutFileHandle);
+    }
+}
+
+/**
+ * @Name:   iecCliEditorMoveRight()
+ *
+ * @Description: This function moves the terminal cursor right over the
+ *               given characters of the line.
+ *
+ * @param PtrChars - Characters the cursor moves over.
+ *
+ * @param Count - Number of columns.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliEditorMoveRight(const U8 *PtrChars,
+                                  U16 Count,
+                                  FILE *PtrOutFileHandle)
+{
+    if (Count > IEC_CLI_EDITOR_SHORT_MOVE)
+    {
+        iecCliOutPrintf(PtrOutFileHandle, "\x1b[%uC", Count);
+        return;
+    }
+
+    /* Re-sending the characters is shorter than the escape sequence */
+    iecCliOutWrite(PtrOutFileHandle, PtrChars, Count);
+}
+
+/**
+ * @Name:   iecCliEditorEraseTail()
+ *
+ * @Description: This function erases the given number of characters right
+ *               of the cursor, the cursor does not move.
+ *
+ * @param Count - Number of characters to erase.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliEditorEraseTail(U16 Count, FILE *PtrOutFileHandle)
+{
+    if (Count == 0)
+    {
+        return;
+    }
+
+    if (Count == 1)
+    {
+        iecCliOutPutc(CLI_SPACE, PtrOutFileHandle);
+        iecCliOutPutc(CLI_BACKSPACE, PtrOutFileHandle);
+        return;
+    }
+
+    /* Erase to end of line */
+    iecCliOutPuts("\x1b[K", PtrOutFileHandle);
+}
+
+/**
+ * @Name:   iecCliEditorStart()
+ *
+ * @Description: This function starts editing a new, empty, line. The escape
+ *               sequence decoder state is kept.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ *****************************************************************************/
+void iecCliEditorStart(PTR_IEC_CLI_EDITOR PtrEditor)
+{
+    PtrEditor->Length = 0;
+    PtrEditor->Cursor = 0;
+    PtrEditor->HistorySeq = 0;
+    PtrEditor->FlashSeq = 0;
+}
+
+/**
+ * @Name:   iecCliEditorDecode()
+ *
+ * @Description: This function feeds one input character to the escape
+ *               sequence decoder of the session.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param Char - Character read from the session.
+ *
+ * @return key decoded, IEC_CLI_KEY_NONE inside a sequence or for ignored
+ *         characters. For IEC_CLI_KEY_CHAR the key is Char.
+ *
+ *****************************************************************************/
+IEC_CLI_KEY iecCliEditorDecode(PTR_IEC_CLI_EDITOR PtrEditor, U8 Char)
+{
+    switch (PtrEditor->VtState)
+    {
+        case IEC_CLI_VT_STATE_ESC:
+            if (Char == '[')
+            {
+                PtrEditor->VtState = IEC_CLI_VT_STATE_CSI;
+                PtrEditor->VtParam = 0;
+            }
+            else if (Char == 'O')
+            {
+                PtrEditor->VtState = IEC_CLI_VT_STATE_SS3;
+            }
+            else
+            {
+                /* Unsupported sequence, drop it */
+                PtrEditor->VtState = IEC_CLI_VT_STATE_GROUND;
+            }
+            return IEC_CLI_KEY_NONE;
+
+        case IEC_CLI_VT_STATE_CSI:
+            if ((Char >= '0') && (Char <= '9'))
+            {
+                if (PtrEditor->VtParam < 100)
+                {
+                    PtrEditor->VtParam = (PtrEditor->VtParam * 10) + (Char - '0');
+                }
+                return IEC_CLI_KEY_NONE;
+            }
+
+            if ((Char < 0x40) || (Char > 0x7E))
+            {
+                /* Parameter separator or intermediate byte */
+                return IEC_CLI_KEY_NONE;
+            }
+
+            /* Final byte */
+            PtrEditor->VtState = IEC_CLI_VT_STATE_GROUND;
+
+            if (Char == '~')
+            {
+                switch (PtrEditor->VtParam)
+                {
+                    case 1:
+                    case 7:
+                        return IEC_CLI_KEY_HOME;
+                    case 3:
+                        return IEC_CLI_KEY_DELETE;
+                    case 4:
+                    case 8:
+                        return IEC_CLI_KEY_END;
+                    default:
+                        return IEC_CLI_KEY_NONE;
+                }
+            }
+            break;
+
+        case IEC_CLI_VT_STATE_SS3:
+            PtrEditor->VtState = IEC_CLI_VT_STATE_GROUND;
+            break;
+
+        default:
+            switch (Char)
+            {
+                case IEC_CLI_CHAR_ESC:
+                    PtrEditor->VtState = IEC_CLI_VT_STATE_ESC;
+                    return IEC_CLI_KEY_NONE;
+                case CLI_CR:
+                    return IEC_CLI_KEY_ENTER;
+                case CLI_BACKSPACE:
+                case IEC_CLI_CHAR_DEL:
+                    return IEC_CLI_KEY_BACKSPACE;
+                case CLI_TAB:
+                    return IEC_CLI_KEY_TAB;
+                case IEC_CLI_CHAR_CTRL_A:
+                    return IEC_CLI_KEY_HOME;
+                case IEC_CLI_CHAR_CTRL_E:
+                    return IEC_CLI_KEY_END;
+                case IEC_CLI_CHAR_CTRL_B:
+                    return IEC_CLI_KEY_LEFT;
+                case IEC_CLI_CHAR_CTRL_F:
+                    return IEC_CLI_KEY_RIGHT;
+                case IEC_CLI_CHAR_CTRL_D:
+                    return IEC_CLI_KEY_DELETE;
+                case IEC_CLI_CHAR_CTRL_P:
+                    return IEC_CLI_KEY_UP;
+                case IEC_CLI_CHAR_CTRL_N:
+                    return IEC_CLI_KEY_DOWN;
+                case IEC_CLI_CHAR_CTRL_R:
+                    return IEC_CLI_KEY_SEARCH;
+                case IEC_CLI_CHAR_CTRL_G:
+                    return IEC_CLI_KEY_CANCEL;
+                default:
+                    /* Other control characters, like the LF or NUL a
+                     * telnet client sends after CR, are ignored.
+                     */
+                    return ((Char < 0x20) || (Char > 0x7E)) ?
+                           IEC_CLI_KEY_NONE : IEC_CLI_KEY_CHAR;
+            }
+    }
+
+    /* Final byte of a CSI or SS3 sequence */
+    switch (Char)
+    {
+        case 'A':
+            return IEC_CLI_KEY_UP;
+        case 'B':
+            return IEC_CLI_KEY_DOWN;
+        case 'C':
+            return IEC_CLI_KEY_RIGHT;
+        case 'D':
+            return IEC_CLI_KEY_LEFT;
+        case 'H':
+            return IEC_CLI_KEY_HOME;
+        case 'F':
+            return IEC_CLI_KEY_END;
+        default:
+            return IEC_CLI_KEY_NONE;
+    }
+}
+
+/**
+ * @Name:   iecCliEditorInsert()
+ *
+ * @Description: This function inserts a character at the cursor.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param PtrLine - Line buffer, CLI_MAX_CMD_LINE_LENGTH bytes.
+ *
+ * @param Char - Character to insert.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @return FALSE if the line is full, the character is not inserted.
+ *
+ *****************************************************************************/
+BOOL iecCliEditorInsert(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        U8 Char,
+                        FILE *PtrOutFileHandle)
+{
+    U16 cursor = PtrEditor->Cursor;
+
+    /* Keep room for the NUL */
+    if (PtrEditor->Length + 1 >= CLI_MAX_CMD_LINE_LENGTH)
+    {
+        return FALSE;
+    }
+
+    memmove(&PtrLine[cursor + 1], &PtrLine[cursor],
+            PtrEditor->Length - cursor + 1);
+    PtrLine[cursor] = Char;
+    PtrEditor->Length++;
+    PtrEditor->Cursor++;
+
+    /* The inserted character and the characters it pushed right */
+    iecCliOutWrite(PtrOutFileHandle, &PtrLine[cursor],
+                   PtrEditor->Length - cursor);
+    iecCliEditorMoveLeft(PtrEditor->Length - PtrEditor->Cursor,
+                         PtrOutFileHandle);
+
+    return TRUE;
+}
+
+/**
+ * @Name:   iecCliEditorBackspace()
+ *
+ * @Description: This function deletes the character left of the cursor.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param PtrLine - Line buffer.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliEditorBackspace(PTR_IEC_CLI_EDITOR PtrEditor,
+                           PU8 PtrLine,
+                           FILE *PtrOutFileHandle)
+{
+    if (PtrEditor->Cursor == 0)
+    {
+        return;
+    }
+
+    PtrEditor->Cursor--;
+    iecCliOutPutc(CLI_BACKSPACE, PtrOutFileHandle);
+
+    iecCliEditorDelete(PtrEditor, PtrLine, PtrOutFileHandle);
+}
+
+/**
+ * @Name:   iecCliEditorDelete()
+ *
+ * @Description: This function deletes the character under the cursor.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param PtrLine - Line buffer.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliEditorDelete(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        FILE *PtrOutFileHandle)
+{
+    U16 cursor = PtrEditor->Cursor;
+    U16 tail;
+
+    if (cursor == PtrEditor->Length)
+    {
+        return;
+    }
+
+    memmove(&PtrLine[cursor], &PtrLine[cursor + 1],
+            PtrEditor->Length - cursor);
+    PtrEditor->Length--;
+    tail = PtrEditor->Length - cursor;
+
+    /* Shift the rest of the line left and blank its old last column */
+    iecCliOutWrite(PtrOutFileHandle, &PtrLine[cursor], tail);
+    iecCliOutPutc(CLI_SPACE, PtrOutFileHandle);
+    iecCliEditorMoveLeft(tail + 1, PtrOutFileHandle);
+}
+
+/**
+ * @Name:   iecCliEditorMoveTo()
+ *
+ * @Description: This function moves the cursor.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param PtrLine - Line buffer.
+ *
+ * @param Cursor - New cursor position, limited to the line length.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliEditorMoveTo(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        U16 Cursor,
+                        FILE *PtrOutFileHandle)
+{
+    if (Cursor > PtrEditor->Length)
+    {
+        Cursor = PtrEditor->Length;
+    }
+
+    if (Cursor < PtrEditor->Cursor)
+    {
+        iecCliEditorMoveLeft(PtrEditor->Cursor - Cursor, PtrOutFileHandle);
+    }
+    else if (Cursor > PtrEditor->Cursor)
+    {
+        iecCliEditorMoveRight(&PtrLine[PtrEditor->Cursor],
+                              Cursor - PtrEditor->Cursor,
+                              PtrOutFileHandle);
+    }
+
+    PtrEditor->Cursor = Cursor;
+}
+
+/**
+ * @Name:   iecCliEditorReplace()
+ *
+ * @Description: This function replaces the whole line, e.g. with a history
+ *               entry or a completed command, and puts the cursor at its
+ *               end. Only the part after the common prefix of the old and
+ *               new line is redrawn.
+ *
+ * @param PtrEditor - Line editor of the session.
+ *
+ * @param PtrLine - Line buffer, CLI_MAX_CMD_LINE_LENGTH bytes.
+ *
+ * @param PtrNewLine - New line, does not need to be NUL terminated.
+ *
+ * @param NewLength - Length of the new line, truncated to fit the buffer.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliEditorReplace(PTR_IEC_CLI_EDITOR PtrEditor,
+                         PU8 PtrLine,
+                         const U8 *PtrNewLine,
+                         U16 NewLength,
+                         FILE *PtrOutFileHandle)
+{
+    U16 oldLength = PtrEditor->Length;
+    U16 prefix = 0;
+
+    if (NewLength >= CLI_MAX_CMD_LINE_LENGTH)
+    {
+        NewLength = CLI_MAX_CMD_LINE_LENGTH - 1;
+    }
+
+    while ((prefix < oldLength) && (prefix < NewLength)
+           && (PtrLine[prefix] == PtrNewLine[prefix]))
+    {
+        prefix++;
+    }
+
+    /* Move to the first difference, over characters that stay the same */
+    if (PtrEditor->Cursor > prefix)
+    {
+        iecCliEditorMoveLeft(PtrEditor->Cursor - prefix, PtrOutFileHandle);
+    }
+    else if (PtrEditor->Cursor < prefix)
+    {
+        iecCliEditorMoveRight(&PtrLine[PtrEditor->Cursor],
+                              prefix - PtrEditor->Cursor,
+                              PtrOutFileHandle);
+    }
+
+    memmove(&PtrLine[prefix], &PtrNewLine[prefix], NewLength - prefix);
+    PtrLine[NewLength] = '\0';
+
+    iecCliOutWrite(PtrOutFileHandle, &PtrLine[prefix], NewLength - prefix);
+
+    if (oldLength > NewLength)
+    {
+        iecCliEditorEraseTail(oldLength - NewLength, PtrOutFileHandle);
+    }
+
+    PtrEditor->Length = NewLength;
+    PtrEditor->Cursor = NewLength;
+}
+
@@ -0,0 +1,164 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliEditor.h
+ *          Title:  iec CLI Line Editor Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added Ctrl-C.
+ *  10/18/26  AW    Added the persistent history cursor.
+ *  10/18/26  AW    Added the search and cancel keys.
+ *  10/18/26  AW    Added the history cursor.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli line editor. The editor decodes
+ *  the VT100 key sequences of a session into keys and edits the command
+ *  line with cursor movement, mid-line insert and delete. The terminal is
+ *  redrawn with the fewest bytes that give the right result, the session
+ *  may be a slow UART.
+ *  Include this file before iecCliSession.h, the session context holds the
+ *  editor state.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_EDITOR_H
+#define _IEC_CLI_EDITOR_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Control characters */
+#define IEC_CLI_CHAR_CTRL_A         (0x01)
+#define IEC_CLI_CHAR_CTRL_B         (0x02)
+#define IEC_CLI_CHAR_CTRL_C         (0x03)
+#define IEC_CLI_CHAR_CTRL_D         (0x04)
+#define IEC_CLI_CHAR_CTRL_E         (0x05)
+#define IEC_CLI_CHAR_CTRL_F         (0x06)
+#define IEC_CLI_CHAR_CTRL_G         (0x07)
+#define IEC_CLI_CHAR_CTRL_N         (0x0E)
+#define IEC_CLI_CHAR_CTRL_P         (0x10)
+#define IEC_CLI_CHAR_CTRL_R         (0x12)
+#define IEC_CLI_CHAR_ESC            (0x1B)
+#define IEC_CLI_CHAR_DEL            (0x7F)
+
+/*
+** Macros
+*/
+
+/*
+** Enumerated types
+*/
+
+/* Key decoded from the session input */
+typedef enum _IEC_CLI_KEY
+{
+    /* Nothing to do, e.g. inside an escape sequence */
+    IEC_CLI_KEY_NONE = 0,
+    /* Printable character */
+    IEC_CLI_KEY_CHAR,
+    IEC_CLI_KEY_ENTER,
+    IEC_CLI_KEY_BACKSPACE,
+    IEC_CLI_KEY_DELETE,
+    IEC_CLI_KEY_TAB,
+    IEC_CLI_KEY_UP,
+    IEC_CLI_KEY_DOWN,
+    IEC_CLI_KEY_LEFT,
+    IEC_CLI_KEY_RIGHT,
+    IEC_CLI_KEY_HOME,
+    IEC_CLI_KEY_END,
+    /* Reverse history search, Ctrl-R */
+    IEC_CLI_KEY_SEARCH,
+    /* Abort the history search, Ctrl-G */
+    IEC_CLI_KEY_CANCEL
+} IEC_CLI_KEY;
+
+/* Escape sequence decoder state */
+typedef enum _IEC_CLI_VT_STATE
+{
+    IEC_CLI_VT_STATE_GROUND = 0,
+    /* ESC received */
+    IEC_CLI_VT_STATE_ESC,
+    /* ESC [ received, collecting the parameter */
+    IEC_CLI_VT_STATE_CSI,
+    /* ESC O received */
+    IEC_CLI_VT_STATE_SS3
+} IEC_CLI_VT_STATE;
+
+/*
+** Typedefs
+*/
+
+typedef struct _IEC_CLI_EDITOR
+{
+    /* IEC_CLI_VT_STATE */
+    U8  VtState;
+    /* Numeric parameter of the CSI sequence being decoded */
+    U8  VtParam;
+    /* Number of characters in the line */
+    U16 Length;
+    /* Cursor position in the line, 0 to Length */
+    U16 Cursor;
+    /* Sequence number of the history command in the line, 0 if the line
+     * is not recalled from the history. See CLI_CMD_HISTORY.
+     */
+    U32 HistorySeq;
+    /* Sequence number of the persistent history command in the line, 0 if
+     * the line is not recalled from the persistent history. HistorySeq then
+     * keeps the oldest session command recalled.
+     */
+    U32 FlashSeq;
+} IEC_CLI_EDITOR, *PTR_IEC_CLI_EDITOR;
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+void iecCliEditorStart(PTR_IEC_CLI_EDITOR PtrEditor);
+
+IEC_CLI_KEY iecCliEditorDecode(PTR_IEC_CLI_EDITOR PtrEditor, U8 Char);
+
+BOOL iecCliEditorInsert(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        U8 Char,
+                        FILE *PtrOutFileHandle);
+
+void iecCliEditorBackspace(PTR_IEC_CLI_EDITOR PtrEditor,
+                           PU8 PtrLine,
+                           FILE *PtrOutFileHandle);
+
+void iecCliEditorDelete(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        FILE *PtrOutFileHandle);
+
+void iecCliEditorMoveTo(PTR_IEC_CLI_EDITOR PtrEditor,
+                        PU8 PtrLine,
+                        U16 Cursor,
+                        FILE *PtrOutFileHandle);
+
+void iecCliEditorReplace(PTR_IEC_CLI_EDITOR PtrEditor,
+                         PU8 PtrLine,
+                         const U8 *PtrNewLine,
+                         U16 NewLength,
+                         FILE *PtrOutFileHandle);
+
+
+#endif
@@ -14,6 +14,22 @@
   *
   *  Date      Who   Description
   *  --------  ---   -------------------------------------------------------
+  *  10/18/26  AW    The flash erase and write results are checked. After a
+  *                  failure the log is scanned again by the next write, the
+  *                  batched commands are dropped.
+  *  10/18/26  AW    Added the persistent history: a log of batched
+  *                  command records in flash, loaded on first recall.
+  *  10/18/26  AW    Added cliHistorySearch(). Each command has a trigram
+  *                  signature, only commands matching the signature of
+  *                  the query are compared.
+  *  10/18/26  AW    Added the lock-free shared history, built with
+  *                  IEC_CLI_HISTORY_SHARED. cliHistoryGet() copies the
+  *                  command, the shared history can change meanwhile.
+  *  10/18/26  AW    cliHistoryGet() takes the sequence number of the
+  *                  command instead of its distance from the last one.
+  *  10/18/26  AW    Replaced the malloc'ed command list, which overflowed
+  *                  Command[18] and was never bounded, with a ring of
+  *                  entries in a fixed byte arena.
   *  25/02/19  AW    Initial version.
   *
   *
@@ -29,163 +45,1171 @@
 
 #include "iec.h"
 
- 
-/**
- * @Name:   void cliGetSearchString(FILE *PtrOutFileHandle)
- *
- * @Description: This function will read string from history heap. and then check
- *               return corresonding value from last input string.
- *
- * @param  RepeatTime  show times of up_key or down_key, real value is disparity 
- *         maxLength: the max of 
- *         ptrCmdList: point to command list.
- *
- * @return last string of history
- * @Note   if get string is "reset", it need to free corresonding heap.
- *
- *****************************************************************************/
-char* cliSearchString(U8 RepeatTime, U8 maxLength, PTR_CLI_CMD_HIS_NODE ptrCmdList, FILE* PtrOutFileHandle)
-{   
-    int i = 1;
-    PTR_CLI_CMD_HIS_NODE head = NULL;
-    U8 cur = 0;
-
-    if(ptrCmdList == NULL)
-    {   fputs("hahah\r\n", PtrOutFileHandle);
-        return NULL;
+/**
+ * @Name:   cliHistorySignature()
+ *
+ * @Description: This function computes the trigram signature of a string:
+ *               one bit is set for each three character substring. A string
+ *               can only contain a query if its signature has all the bits of
+ *               the query signature.
+ *
+ * @param  PtrString - String.
+ *
+ * @param  Length - Length of the string.
+ *
+ * @param  PtrSignature - CLI_HISTORY_SIG_WORDS words for the signature.
+ *
+ *****************************************************************************/
+static void cliHistorySignature(const U8 *PtrString, U16 Length, U32 *PtrSignature)
+{
+    U32 bit;
+    U16 index;
+
+    memset(PtrSignature, 0, CLI_HISTORY_SIG_WORDS * sizeof(U32));
+
+    for (index = 2; index < Length; index++)
+    {
+        /* Multiplicative hash of the trigram to a bit number */
+        bit = ((U32)PtrString[index - 2] << 16)
+              | ((U32)PtrString[index - 1] << 8)
+              | PtrString[index];
+        bit = (bit * 0x9E3779B1) >> 26;
+
+        PtrSignature[(bit >> 5) % CLI_HISTORY_SIG_WORDS] |= (1u << (bit & 31));
+    }
+}
+
+/**
+ * @Name:   cliHistorySignatureMatch()
+ *
+ * @Description: This function checks the signature of a command against the
+ *               signature of a query.
+ *
+ * @param  PtrSignature - Signature of the command.
+ *
+ * @param  PtrQuerySignature - Signature of the query.
+ *
+ * @return TRUE if the command may contain the query.
+ *
+ *****************************************************************************/
+static BOOL cliHistorySignatureMatch(const U32 *PtrSignature, const U32 *PtrQuerySignature)
+{
+    U32 word;
+
+    for (word = 0; word < CLI_HISTORY_SIG_WORDS; word++)
+    {
+        if ((PtrSignature[word] & PtrQuerySignature[word]) != PtrQuerySignature[word])
+        {
+            return FALSE;
+        }
     }
-    head = ptrCmdList;
-    for( ;ptrCmdList; ptrCmdList = ptrCmdList->PtrNext, i++)
-    {  
-        if(i == RepeatTime)
-        {     
-              cur = strlen((char*)ptrCmdList->Command);
-              if((cur-maxLength) > 0)
-              {
-                 cliEchoSpace(cur - maxLength, PtrOutFileHandle);
-              }else
-              {
-                 cliEchoSpace(maxLength - cur, PtrOutFileHandle);
-              }
-              fputc('\r', PtrOutFileHandle);
-              fputs(" cmd>", PtrOutFileHandle);
-              fputs(ptrCmdList->Command, PtrOutFileHandle);
-              break;
-        }
-        if(i > head->IndexCounter)
-        {
-           return NULL;
-        }
-     }
-    return (char*)ptrCmdList->Command;;
-}
-
- /**
- * @Name:   cliEchoSpace(PTR_CLI_CMD_HIS_NODE ptrCmdList, FILE* PtrOutFileHandle)
- *
- * @Description: This function will delete extra string, thereby echo normal
- *               
- * @Param parity: the  parity between max length of command and minimal length of 
- *                command.
- *        PtrOutFileHandle: point to file handle.
- * @return - void
- *
- *****************************************************************************/
- 
-void cliEchoSpace(U8 parity, FILE* PtrOutFileHandle)
-{
-     U8 copy = parity + 1;
-     
-      while(copy--)
-       {
-            fputc('\b', PtrOutFileHandle);
-       }
-      
-       copy = parity + 1;
-       while(copy--)
-       {
-            //override extra character.
-            fputc(' ', PtrOutFileHandle);
-       }
-  
-     return;
-}
-/**
-* @Name:   cliInsertNode(void)
-*
-* @Description: This function insert command from input string. this list use 
-*               tail insert, so it output according to reverse input.
-*               
-*
-* @return - TRUE OR FALSE
-* @Note     beacuse this pList is not re-malloc ,so second pointer shouln't be passed.
-*****************************************************************************/
-void cliInsertNode(U8 index, PU8 inputCommand, PTR_CLI_CMD_HISTORY* ppList)
-{
-    PTR_CLI_CMD_HIS_NODE ptrCmdNode;
-    /* Allocate memory for new CLI command node */
-    if( (ptrCmdNode = (PTR_CLI_CMD_HIS_NODE)malloc(sizeof(CLI_CMD_HIS_NODE))) == NULL )
+
+    return TRUE;
+}
+
+/**
+ * @Name:   cliHistoryContains()
+ *
+ * @Description: This function checks if a command contains a query.
+ *
+ * @param  PtrCommand - Command.
+ *
+ * @param  Length - Length of the command.
+ *
+ * @param  PtrQuery - Query.
+ *
+ * @param  QueryLength - Length of the query, not 0.
+ *
+ * @return TRUE if the query is a substring of the command.
+ *
+ *****************************************************************************/
+static BOOL cliHistoryContains(const U8 *PtrCommand,
+                               U16 Length,
+                               const U8 *PtrQuery,
+                               U16 QueryLength)
+{
+    U16 index;
+
+    for (index = 0; index + QueryLength <= Length; index++)
+    {
+        if ((PtrCommand[index] == PtrQuery[0])
+            && (memcmp(&PtrCommand[index], PtrQuery, QueryLength) == 0))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+#ifdef IEC_CLI_HISTORY_SHARED
+
+/**
+ * @Name:   cliHistoryAdd()
+ *
+ * @Description: This function adds a command to the shared history. It can
+ *               be called by several sessions at the same time. If a newer
+ *               command claimed the slot first, the command is dropped.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  PtrCommand - NUL terminated command line.
+ *
+ *****************************************************************************/
+void cliHistoryAdd(PTR_CLI_CMD_HISTORY PtrHistory, const U8 *PtrCommand)
+{
+    PTR_CLI_CMD_HIS_SLOT ptrSlot;
+    U16 length = strlen((const char *)PtrCommand);
+    U32 sequence;
+    U32 slotSequence;
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    if (length >= CLI_MAX_CMD_LINE_LENGTH)
+    {
+        length = CLI_MAX_CMD_LINE_LENGTH - 1;
+    }
+
+    sequence = __sync_add_and_fetch(&PtrHistory->Sequence, 1);
+    ptrSlot = &PtrHistory->Slot[sequence % CLI_HISTORY_MAX_ENTRIES];
+
+    /* Claim the slot, unless it is being written or holds a newer command */
+    slotSequence = ptrSlot->Sequence;
+    if ((slotSequence == CLI_HISTORY_SLOT_WRITING)
+        || (slotSequence > sequence)
+        || !__sync_bool_compare_and_swap(&ptrSlot->Sequence,
+                                         slotSequence,
+                                         CLI_HISTORY_SLOT_WRITING))
+    {
+        return;
+    }
+
+    memcpy(ptrSlot->Command, PtrCommand, length);
+    ptrSlot->Command[length] = '\0';
+    cliHistorySignature(PtrCommand, length, ptrSlot->Signature);
+
+    /* Publish the command after it is complete */
+    __sync_synchronize();
+    ptrSlot->Sequence = sequence;
+}
+
+/**
+ * @Name:   cliHistoryGet()
+ *
+ * @Description: This function copies a command of the shared history. It
+ *               can be called while other sessions add commands.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  Sequence - Sequence number of the command, PtrHistory->Sequence
+ *                    for the last command added.
+ *
+ * @param  PtrCommand - Buffer of CLI_MAX_CMD_LINE_LENGTH bytes for the NUL
+ *                      terminated command.
+ *
+ * @return length of the command, 0 if the command is not, or no longer,
+ *         in the history.
+ *
+ *****************************************************************************/
+U16 cliHistoryGet(PTR_CLI_CMD_HISTORY PtrHistory, U32 Sequence, PU8 PtrCommand)
+{
+    PTR_CLI_CMD_HIS_SLOT ptrSlot;
+    U16 length = 0;
+
+    if (Sequence == 0)
+    {
+        return 0;
+    }
+
+    ptrSlot = &PtrHistory->Slot[Sequence % CLI_HISTORY_MAX_ENTRIES];
+    if (ptrSlot->Sequence != Sequence)
+    {
+        return 0;
+    }
+    __sync_synchronize();
+
+    /* The slot may be overwritten while it is copied, the copy is bounded
+     * and only used if the slot still holds the command afterwards.
+     */
+    while ((length < CLI_MAX_CMD_LINE_LENGTH - 1)
+           && (ptrSlot->Command[length] != '\0'))
+    {
+        PtrCommand[length] = ptrSlot->Command[length];
+        length++;
+    }
+    PtrCommand[length] = '\0';
+
+    __sync_synchronize();
+    if (ptrSlot->Sequence != Sequence)
+    {
+        PtrCommand[0] = '\0';
+        return 0;
+    }
+
+    return length;
+}
+
+/**
+ * @Name:   cliHistorySearch()
+ *
+ * @Description: This function searches the shared history, from the given
+ *               command to older ones, for a command containing the query.
+ *               Only the commands whose trigram signature matches the query
+ *               are compared, so the search is bounded by the number of
+ *               history slots.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  PtrQuery - Query.
+ *
+ * @param  QueryLength - Length of the query.
+ *
+ * @param  Sequence - Sequence number of the newest command to search.
+ *
+ * @param  PtrCommand - Buffer of CLI_MAX_CMD_LINE_LENGTH bytes for the NUL
+ *                      terminated command found.
+ *
+ * @return sequence number of the command found, 0 if none.
+ *
+ *****************************************************************************/
+U32 cliHistorySearch(PTR_CLI_CMD_HISTORY PtrHistory,
+                     const U8 *PtrQuery,
+                     U16 QueryLength,
+                     U32 Sequence,
+                     PU8 PtrCommand)
+{
+    U32 querySignature[CLI_HISTORY_SIG_WORDS];
+    PTR_CLI_CMD_HIS_SLOT ptrSlot;
+    U32 last = PtrHistory->Sequence;
+    U32 oldest;
+    U16 length;
+
+    if ((QueryLength == 0) || (QueryLength >= CLI_MAX_CMD_LINE_LENGTH))
+    {
+        return 0;
+    }
+
+    if (Sequence > last)
+    {
+        Sequence = last;
+    }
+    oldest = (last > CLI_HISTORY_MAX_ENTRIES) ? last - CLI_HISTORY_MAX_ENTRIES + 1 : 1;
+
+    cliHistorySignature(PtrQuery, QueryLength, querySignature);
+
+    for (; (Sequence >= oldest) && (Sequence > 0); Sequence--)
+    {
+        ptrSlot = &PtrHistory->Slot[Sequence % CLI_HISTORY_MAX_ENTRIES];
+
+        /* A signature read while the slot is written is checked again by
+         * cliHistoryGet().
+         */
+        if ((ptrSlot->Sequence != Sequence)
+            || !cliHistorySignatureMatch(ptrSlot->Signature, querySignature))
+        {
+            continue;
+        }
+
+        length = cliHistoryGet(PtrHistory, Sequence, PtrCommand);
+        if ((length != 0)
+            && cliHistoryContains(PtrCommand, length, PtrQuery, QueryLength))
+        {
+            return Sequence;
+        }
+    }
+
+    return 0;
+}
+
+#else
+
+/* The longest command line must fit in the arena */
+typedef char CLI_HISTORY_ARENA_SIZE_CHECK[(CLI_HISTORY_ARENA_SIZE >= CLI_MAX_CMD_LINE_LENGTH) ? 1 : -1];
+
+
+
+/**
+ * @Name:   cliHistoryOverlaps()
+ *
+ * @Description: This function checks if a history entry uses arena bytes of
+ *               the given range.
+ *
+ * @param  PtrEntry - History entry.
+ *
+ * @param  Offset - Start of the range.
+ *
+ * @param  Size - Size of the range.
+ *
+ * @return TRUE if the entry overlaps the range.
+ *
+ *****************************************************************************/
+static BOOL cliHistoryOverlaps(const CLI_CMD_HIS_ENTRY *PtrEntry, U16 Offset, U16 Size)
+{
+    return ((PtrEntry->Offset < Offset + Size)
+            && (Offset < PtrEntry->Offset + PtrEntry->Length + 1)) ? TRUE : FALSE;
+}
+
+/**
+ * @Name:   cliHistoryAdd()
+ *
+ * @Description: This function adds a command to the history. The oldest
+ *               commands are evicted to make room for it, no memory is
+ *               allocated.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  PtrCommand - NUL terminated command line.
+ *
+ *****************************************************************************/
+void cliHistoryAdd(PTR_CLI_CMD_HISTORY PtrHistory, const U8 *PtrCommand)
+{
+    PTR_CLI_CMD_HIS_ENTRY ptrEntry;
+    U16 length = strlen((const char *)PtrCommand);
+    U16 offset = PtrHistory->ArenaHead;
+
+    if (length == 0)
+    {
         return;
-
-    /* initialize CLI command node */
-    memset(ptrCmdNode, 0 ,sizeof(CLI_CMD_HIS_NODE));
-    memcpy(ptrCmdNode->Command, (char *)inputCommand, strlen((char*)inputCommand));
-    ptrCmdNode->IndexCounter = index;
-    /* Add new CLI command node at the head of the list */
-    ptrCmdNode->PtrNext = (*ppList)->PtrCliCmdListHead;
-    (*ppList)->PtrCliCmdListHead = ptrCmdNode;
-
-    /* Increment CLI command count */
-    (*ppList)->CliCommandCount++;
-    //cliPrintCmd(*ppList);
+    }
+
+    if (length >= CLI_MAX_CMD_LINE_LENGTH)
+    {
+        length = CLI_MAX_CMD_LINE_LENGTH - 1;
+    }
+
+    /* Commands are not split, wrap to the start of the arena instead. The
+     * commands still in the skipped end of the arena are the oldest ones,
+     * they are evicted first, otherwise the kept commands would no longer
+     * be in the order they were added.
+     */
+    if (offset + length + 1 > CLI_HISTORY_ARENA_SIZE)
+    {
+        while ((PtrHistory->CliCommandCount > 0)
+               && cliHistoryOverlaps(&PtrHistory->Entry[PtrHistory->First],
+                                     offset, CLI_HISTORY_ARENA_SIZE - offset))
+        {
+            PtrHistory->First = (PtrHistory->First + 1) % CLI_HISTORY_MAX_ENTRIES;
+            PtrHistory->CliCommandCount--;
+        }
+
+        offset = 0;
+    }
+
+    /* Evict the oldest commands until there is a free entry and the new
+     * command does not overwrite a kept one. The commands are stored in the
+     * order they were added, so only the oldest ones can be in the way.
+     */
+    while ((PtrHistory->CliCommandCount == CLI_HISTORY_MAX_ENTRIES)
+           || ((PtrHistory->CliCommandCount > 0)
+               && cliHistoryOverlaps(&PtrHistory->Entry[PtrHistory->First],
+                                     offset, length + 1)))
+    {
+        PtrHistory->First = (PtrHistory->First + 1) % CLI_HISTORY_MAX_ENTRIES;
+        PtrHistory->CliCommandCount--;
+    }
+
+    ptrEntry = &PtrHistory->Entry[(PtrHistory->First + PtrHistory->CliCommandCount)
+                                  % CLI_HISTORY_MAX_ENTRIES];
+    ptrEntry->Offset = offset;
+    ptrEntry->Length = length;
+    cliHistorySignature(PtrCommand, length, ptrEntry->Signature);
+
+    memcpy(&PtrHistory->Arena[offset], PtrCommand, length);
+    PtrHistory->Arena[offset + length] = '\0';
+
+    PtrHistory->ArenaHead = offset + length + 1;
+    PtrHistory->CliCommandCount++;
+    PtrHistory->Sequence++;
 }
+
 /**
-* @Name:   void cliFreeList(void)
-*
-* @Description: This function free momery of history command.
-*               
-* @return -  void 
-*
-*****************************************************************************/
-void cliFreeList(PTR_CLI_CMD_HISTORY pCmdList)
+ * @Name:   cliHistoryGet()
+ *
+ * @Description: This function copies a command of the history. The lookup
+ *               does not depend on the number of commands in the history.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  Sequence - Sequence number of the command, PtrHistory->Sequence
+ *                    for the last command added.
+ *
+ * @param  PtrCommand - Buffer of CLI_MAX_CMD_LINE_LENGTH bytes for the NUL
+ *                      terminated command.
+ *
+ * @return length of the command, 0 if the command is not, or no longer,
+ *         in the history.
+ *
+ *****************************************************************************/
+U16 cliHistoryGet(PTR_CLI_CMD_HISTORY PtrHistory, U32 Sequence, PU8 PtrCommand)
 {
-       PTR_CLI_CMD_HIS_NODE head = NULL;
-       PTR_CLI_CMD_HIS_NODE p = NULL;
+    PTR_CLI_CMD_HIS_ENTRY ptrEntry;
+    /* Distance from the last command added, 1 for the last command */
+    U32 index = PtrHistory->Sequence - Sequence + 1;
+
+    if ((Sequence == 0) || (Sequence > PtrHistory->Sequence)
+        || (index > PtrHistory->CliCommandCount))
+    {
+        return 0;
+    }
+
+    ptrEntry = &PtrHistory->Entry[(PtrHistory->First
+                                   + PtrHistory->CliCommandCount
+                                   - index)
+                                  % CLI_HISTORY_MAX_ENTRIES];
 
-       if(pCmdList == NULL)
-          return;
-       head = pCmdList->PtrCliCmdListHead->PtrNext;
-       p = NULL;
-       while(head)
-       {
-           p = head;
-           head = head->PtrNext;
-           free(p);
-       }
-       printf("free all of history!");
-       return;
+    memcpy(PtrCommand, &PtrHistory->Arena[ptrEntry->Offset], ptrEntry->Length + 1);
+
+    return ptrEntry->Length;
 }
 
 /**
-* @Name:   void cliPrintCmd(PTR_CLI_CMD_HISTORY ptrCmdList)
-*
-* @Description: This function only just test a list if is  normal.
-*               
-* @return -  void 
-*
-*****************************************************************************/
+ * @Name:   cliHistorySearch()
+ *
+ * @Description: This function searches the history, from the given command
+ *               to older ones, for a command containing the query. Only the
+ *               commands whose trigram signature matches the query are
+ *               compared, so the search is bounded by the number of history
+ *               entries.
+ *
+ * @param  PtrHistory - Command history.
+ *
+ * @param  PtrQuery - Query.
+ *
+ * @param  QueryLength - Length of the query.
+ *
+ * @param  Sequence - Sequence number of the newest command to search.
+ *
+ * @param  PtrCommand - Buffer of CLI_MAX_CMD_LINE_LENGTH bytes for the NUL
+ *                      terminated command found.
+ *
+ * @return sequence number of the command found, 0 if none.
+ *
+ *****************************************************************************/
+U32 cliHistorySearch(PTR_CLI_CMD_HISTORY PtrHistory,
+                     const U8 *PtrQuery,
+                     U16 QueryLength,
+                     U32 Sequence,
+                     PU8 PtrCommand)
+{
+    U32 querySignature[CLI_HISTORY_SIG_WORDS];
+    PTR_CLI_CMD_HIS_ENTRY ptrEntry;
+    U32 index;
+
+    if ((QueryLength == 0) || (Sequence == 0))
+    {
+        return 0;
+    }
+
+    if (Sequence > PtrHistory->Sequence)
+    {
+        Sequence = PtrHistory->Sequence;
+    }
+
+    cliHistorySignature(PtrQuery, QueryLength, querySignature);
+
+    /* index is the distance from the last command added, 1 for the last */
+    for (index = PtrHistory->Sequence - Sequence + 1;
+         index <= PtrHistory->CliCommandCount;
+         index++, Sequence--)
+    {
+        ptrEntry = &PtrHistory->Entry[(PtrHistory->First
+                                       + PtrHistory->CliCommandCount
+                                       - index)
+                                      % CLI_HISTORY_MAX_ENTRIES];
+
+        if (cliHistorySignatureMatch(ptrEntry->Signature, querySignature)
+            && cliHistoryContains((const U8 *)&PtrHistory->Arena[ptrEntry->Offset],
+                                  ptrEntry->Length, PtrQuery, QueryLength))
+        {
+            memcpy(PtrCommand, &PtrHistory->Arena[ptrEntry->Offset],
+                   ptrEntry->Length + 1);
+            return Sequence;
+        }
+    }
+
+    return 0;
+}
+
+#endif
+
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+
+/* Sector header, written after the sector is erased */
+#define CLI_HISTORY_FLASH_MAGIC         (0x48494C43)
+/* Marker of a complete record, written after the rest of the record */
+#define CLI_HISTORY_FLASH_VALID         (0x5A)
+/* Records start on this alignment */
+#define CLI_HISTORY_FLASH_ALIGN         (4)
+
+#define CLI_HISTORY_FLASH_ALIGN_UP(Size) \
+    (((Size) + CLI_HISTORY_FLASH_ALIGN - 1) & ~(CLI_HISTORY_FLASH_ALIGN - 1))
+
+typedef struct _CLI_HISTORY_FLASH_SECTOR_HDR
+{
+    U32 Magic;
+    /* Incremented each time a sector is started, orders the sectors */
+    U32 Sequence;
+} CLI_HISTORY_FLASH_SECTOR_HDR;
+
+/* Record header, followed by Length bytes of NUL terminated commands */
+typedef struct _CLI_HISTORY_FLASH_RECORD_HDR
+{
+    U8  Marker;
+    U8  Count;
+    U16 Length;
+    /* Fletcher-16 of the commands */
+    U16 Check;
+    U16 Reserved;
+} CLI_HISTORY_FLASH_RECORD_HDR;
+
+typedef char CLI_HISTORY_FLASH_SIZE_CHECK[((IEC_CLI_HISTORY_FLASH_SECTORS >= 2)
+    && (sizeof(CLI_HISTORY_FLASH_SECTOR_HDR) + sizeof(CLI_HISTORY_FLASH_RECORD_HDR)
+        + IEC_CLI_HISTORY_FLASH_BATCH_SIZE <= IEC_CLI_HISTORY_FLASH_SECTOR_SIZE)) ? 1 : -1];
+
+/* Serializes the flash log between the sessions */
+static volatile U32 sCliHistoryFlashLock;
+
+/* Write position, found by the first append or load, not at boot. Found
+ * again after a failed erase or write.
+ */
+static BOOL sCliHistoryFlashOpen;
+static U32  sCliHistoryFlashSector;
+static U32  sCliHistoryFlashOffset;
+static U32  sCliHistoryFlashSequence;
+
+/* Write position at boot, the load stops there. Lost if this boot wrapped
+ * around the log.
+ */
+static BOOL sCliHistoryFlashBootFound;
+static U32  sCliHistoryFlashBootSector;
+static U32  sCliHistoryFlashBootOffset;
+static BOOL sCliHistoryFlashBootLost;
 
-void cliPrintCmd(PTR_CLI_CMD_HISTORY ptrCmdList)
+/* Commands not written yet */
+static U8   sCliHistoryFlashBatch[IEC_CLI_HISTORY_FLASH_BATCH_SIZE];
+static U16  sCliHistoryFlashBatchLength;
+static U8   sCliHistoryFlashBatchCount;
+
+/* Commands of the previous boots: 0 not loaded, 1 loading, 2 loaded */
+static CLI_CMD_HISTORY sCliHistoryFlash;
+static volatile U32 sCliHistoryFlashLoaded;
+
+#ifdef IEC_CLI_HISTORY_FLASH_FILE
+
+/**
+ * @Name:   cliHistoryFlashFile()
+ *
+ * @Description: This function opens the file used instead of the flash in
+ *               the host build, an erased flash is created if it is missing.
+ *
+ * @return file, NULL if it cannot be opened.
+ *
+ *****************************************************************************/
+static FILE *cliHistoryFlashFile(void)
 {
+    static FILE *sPtrFile;
+    U32 index;
 
-    PTR_CLI_CMD_HIS_NODE ptrCliCmdNode = ptrCmdList->PtrCliCmdListHead;
-    
-    for( ;ptrCliCmdNode;ptrCliCmdNode = ptrCliCmdNode->PtrNext)
+    if (sPtrFile == NULL)
     {
+        sPtrFile = fopen(IEC_CLI_HISTORY_FLASH_FILE, "r+b");
+        if (sPtrFile == NULL)
+        {
+            sPtrFile = fopen(IEC_CLI_HISTORY_FLASH_FILE, "w+b");
+            for (index = 0; (sPtrFile != NULL)
+                 && (index < IEC_CLI_HISTORY_FLASH_SECTORS * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE);
+                 index++)
+            {
+                fputc(0xFF, sPtrFile);
+            }
+        }
+    }
+
+    return sPtrFile;
+}
+
+BOOL iecCliHistoryFlashRead(U32 Offset, PU8 PtrData, U32 Size)
+{
+    FILE *ptrFile = cliHistoryFlashFile();
 
-       printf("\r\n%d-- :%s\r\n", ptrCliCmdNode->IndexCounter, ptrCliCmdNode->Command);
+    return ((ptrFile != NULL)
+            && (fseek(ptrFile, Offset, SEEK_SET) == 0)
+            && (fread(PtrData, 1, Size, ptrFile) == Size)) ? TRUE : FALSE;
+}
 
+BOOL iecCliHistoryFlashWrite(U32 Offset, const U8 *PtrData, U32 Size)
+{
+    FILE *ptrFile = cliHistoryFlashFile();
+    U8 data;
+    U32 index;
+
+    /* Like NOR flash, a write can only clear bits */
+    for (index = 0; index < Size; index++)
+    {
+        if (!iecCliHistoryFlashRead(Offset + index, &data, 1)
+            || (fseek(ptrFile, Offset + index, SEEK_SET) != 0)
+            || (fputc(data & PtrData[index], ptrFile) == EOF))
+        {
+            return FALSE;
+        }
+    }
+
+    return (fflush(ptrFile) == 0) ? TRUE : FALSE;
+}
+
+BOOL iecCliHistoryFlashErase(U32 Offset, U32 Size)
+{
+    FILE *ptrFile = cliHistoryFlashFile();
+
+    if ((ptrFile == NULL) || (fseek(ptrFile, Offset, SEEK_SET) != 0))
+    {
+        return FALSE;
+    }
+
+    while (Size--)
+    {
+        fputc(0xFF, ptrFile);
     }
+
+    return (fflush(ptrFile) == 0) ? TRUE : FALSE;
+}
+
+#else
+
+/**
+ * @Name:   iecCliHistoryFlashRead()
+ *
+ * @Description: This function reads the history log. This WEAK function can
+ *               be overridden by the platform.
+ *
+ * @param  Offset - Offset in the history log.
+ *
+ * @param  PtrData - Buffer for the data.
+ *
+ * @param  Size - Number of bytes to read.
+ *
+ * @return TRUE on success.
+ *
+ *****************************************************************************/
+WEAK BOOL iecCliHistoryFlashRead(U32 Offset, PU8 PtrData, U32 Size)
+{
+    return (haliFlashRegionRead(PtrData,
+                                IEC_CLI_HISTORY_FLASH_REGION,
+                                IEC_CLI_HISTORY_FLASH_OFFSET + Offset,
+                                Size) == HALI_FLASH_SUCCESS) ? TRUE : FALSE;
+}
+
+/**
+ * @Name:   iecCliHistoryFlashWrite()
+ *
+ * @Description: This function writes the history log. The range was erased
+ *               before. This WEAK function can be overridden by the platform.
+ *
+ * @param  Offset - Offset in the history log.
+ *
+ * @param  PtrData - Data to write.
+ *
+ * @param  Size - Number of bytes to write.
+ *
+ * @return TRUE on success.
+ *
+ *****************************************************************************/
+WEAK BOOL iecCliHistoryFlashWrite(U32 Offset, const U8 *PtrData, U32 Size)
+{
+    return (haliFlashRegionWrite((PU8)PtrData,
+                                 IEC_CLI_HISTORY_FLASH_REGION,
+                                 IEC_CLI_HISTORY_FLASH_OFFSET + Offset,
+                                 Size) == HALI_FLASH_SUCCESS) ? TRUE : FALSE;
+}
+
+/**
+ * @Name:   iecCliHistoryFlashErase()
+ *
+ * @Description: This function erases sectors of the history log. This WEAK
+ *               function can be overridden by the platform.
+ *
+ * @param  Offset - Offset in the history log, sector aligned.
+ *
+ * @param  Size - Number of bytes to erase, a multiple of the sector size.
+ *
+ * @return TRUE on success.
+ *
+ *****************************************************************************/
+WEAK BOOL iecCliHistoryFlashErase(U32 Offset, U32 Size)
+{
+    return (haliFlashRegionErase(IEC_CLI_HISTORY_FLASH_REGION,
+                                 IEC_CLI_HISTORY_FLASH_OFFSET + Offset,
+                                 Size) == HALI_FLASH_SUCCESS) ? TRUE : FALSE;
+}
+
+#endif
+
+/**
+ * @Name:   cliHistoryFlashLock()
+ *
+ * @Description: This function takes the flash log lock, the flash is only
+ *               used when a command is entered or first recalled, so the
+ *               lock is hardly ever contended.
+ *
+ *****************************************************************************/
+static void cliHistoryFlashLock(void)
+{
+    while (__sync_lock_test_and_set(&sCliHistoryFlashLock, 1))
+    {
+        haliOsThreadRelinquish();
+    }
+}
+
+/**
+ * @Name:   cliHistoryFlashUnlock()
+ *
+ * @Description: This function releases the flash log lock.
+ *
+ *****************************************************************************/
+static void cliHistoryFlashUnlock(void)
+{
+    __sync_lock_release(&sCliHistoryFlashLock);
+}
+
+/**
+ * @Name:   cliHistoryFlashCheck()
+ *
+ * @Description: This function computes the Fletcher-16 checksum of a record.
+ *
+ * @param  PtrData - Commands of the record.
+ *
+ * @param  Length - Length of the commands.
+ *
+ * @return checksum.
+ *
+ *****************************************************************************/
+static U16 cliHistoryFlashCheck(const U8 *PtrData, U16 Length)
+{
+    U16 sum1 = 0;
+    U16 sum2 = 0;
+
+    while (Length--)
+    {
+        sum1 = (sum1 + *PtrData++) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+
+    return (sum2 << 8) | sum1;
+}
+
+/**
+ * @Name:   cliHistoryFlashRecord()
+ *
+ * @Description: This function reads the record header at the given offset
+ *               of a sector.
+ *
+ * @param  Sector - Sector number.
+ *
+ * @param  Offset - Offset in the sector.
+ *
+ * @param  PtrRecord - Record header read.
+ *
+ * @return size of the record, 0 at the end of the sector.
+ *
+ *****************************************************************************/
+static U32 cliHistoryFlashRecord(U32 Sector,
+                                 U32 Offset,
+                                 CLI_HISTORY_FLASH_RECORD_HDR *PtrRecord)
+{
+    U32 size;
+
+    if ((Offset + sizeof(*PtrRecord) > IEC_CLI_HISTORY_FLASH_SECTOR_SIZE)
+        || !iecCliHistoryFlashRead(Sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE + Offset,
+                                   (PU8)PtrRecord, sizeof(*PtrRecord)))
+    {
+        return 0;
+    }
+
+    /* Erased flash, or a header too damaged to find the next record */
+    size = CLI_HISTORY_FLASH_ALIGN_UP(sizeof(*PtrRecord) + PtrRecord->Length);
+    if ((PtrRecord->Length == 0xFFFF)
+        || (PtrRecord->Length > IEC_CLI_HISTORY_FLASH_BATCH_SIZE)
+        || (Offset + size > IEC_CLI_HISTORY_FLASH_SECTOR_SIZE))
+    {
+        return 0;
+    }
+
+    return size;
+}
+
+/**
+ * @Name:   cliHistoryFlashStartSector()
+ *
+ * @Description: This function erases a sector and starts writing it.
+ *
+ * @param  Sector - Sector number.
+ *
+ * @return FALSE if the erase or the write of the sector header failed.
+ *
+ *****************************************************************************/
+static BOOL cliHistoryFlashStartSector(U32 Sector)
+{
+    CLI_HISTORY_FLASH_SECTOR_HDR header;
+
+    header.Magic = CLI_HISTORY_FLASH_MAGIC;
+    header.Sequence = ++sCliHistoryFlashSequence;
+
+    if (!iecCliHistoryFlashErase(Sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE,
+                                 IEC_CLI_HISTORY_FLASH_SECTOR_SIZE)
+        || !iecCliHistoryFlashWrite(Sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE,
+                                    (const U8 *)&header, sizeof(header)))
+    {
+        return FALSE;
+    }
+
+    sCliHistoryFlashSector = Sector;
+    sCliHistoryFlashOffset = sizeof(header);
+
+    return TRUE;
+}
+
+/**
+ * @Name:   cliHistoryFlashOpenLog()
+ *
+ * @Description: This function finds the write position of the log: the end
+ *               of the newest sector. Called with the lock taken.
+ *
+ * @return FALSE if the log is empty and its first sector cannot be started.
+ *
+ *****************************************************************************/
+static BOOL cliHistoryFlashOpenLog(void)
+{
+    CLI_HISTORY_FLASH_SECTOR_HDR header;
+    CLI_HISTORY_FLASH_RECORD_HDR record;
+    BOOL found = FALSE;
+    U32 sector;
+    U32 size;
+
+    if (sCliHistoryFlashOpen)
+    {
+        return TRUE;
+    }
+
+    for (sector = 0; sector < IEC_CLI_HISTORY_FLASH_SECTORS; sector++)
+    {
+        if (iecCliHistoryFlashRead(sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE,
+                                   (PU8)&header, sizeof(header))
+            && (header.Magic == CLI_HISTORY_FLASH_MAGIC)
+            && (!found || (header.Sequence > sCliHistoryFlashSequence)))
+        {
+            found = TRUE;
+            sCliHistoryFlashSector = sector;
+            sCliHistoryFlashSequence = header.Sequence;
+        }
+    }
+
+    if (!found)
+    {
+        /* Empty log, sector 0 is started below */
+        sCliHistoryFlashSequence = 0;
+        sCliHistoryFlashSector = 0;
+        sCliHistoryFlashOffset = sizeof(header);
+    }
+    else
+    {
+        record.Length = 0xFFFF;
+        sCliHistoryFlashOffset = sizeof(header);
+        while ((size = cliHistoryFlashRecord(sCliHistoryFlashSector,
+                                             sCliHistoryFlashOffset,
+                                             &record)) != 0)
+        {
+            sCliHistoryFlashOffset += size;
+        }
+
+        /* Skip whatever follows a damaged header */
+        if (record.Length != 0xFFFF)
+        {
+            sCliHistoryFlashOffset = IEC_CLI_HISTORY_FLASH_SECTOR_SIZE;
+        }
+    }
+
+    /* A scan after a failed write keeps the write position at boot */
+    if (!sCliHistoryFlashBootFound)
+    {
+        sCliHistoryFlashBootFound = TRUE;
+        sCliHistoryFlashBootSector = sCliHistoryFlashSector;
+        sCliHistoryFlashBootOffset = sCliHistoryFlashOffset;
+    }
+
+    if (!found && !cliHistoryFlashStartSector(0))
+    {
+        return FALSE;
+    }
+
+    sCliHistoryFlashOpen = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * @Name:   cliHistoryFlashWriteBatch()
+ *
+ * @Description: This function writes the batched commands as one record.
+ *               Called with the lock taken. If the flash fails, the batched
+ *               commands are dropped and the next write scans the log
+ *               again, which skips a partly written record.
+ *
+ *****************************************************************************/
+static void cliHistoryFlashWriteBatch(void)
+{
+    CLI_HISTORY_FLASH_RECORD_HDR record;
+    BOOL written = FALSE;
+    U32 sector;
+    U32 offset;
+    U32 size;
+
+    if (sCliHistoryFlashBatchCount == 0)
+    {
+        return;
+    }
+
+    if (!cliHistoryFlashOpenLog())
+    {
+        sCliHistoryFlashBatchLength = 0;
+        sCliHistoryFlashBatchCount = 0;
+        return;
+    }
+
+    size = CLI_HISTORY_FLASH_ALIGN_UP(sizeof(record) + sCliHistoryFlashBatchLength);
+    if (sCliHistoryFlashOffset + size > IEC_CLI_HISTORY_FLASH_SECTOR_SIZE)
+    {
+        /* Wear levelling: the sectors are used round robin */
+        sector = (sCliHistoryFlashSector + 1) % IEC_CLI_HISTORY_FLASH_SECTORS;
+
+        if ((sector == sCliHistoryFlashBootSector) && (sCliHistoryFlashLoaded != 2))
+        {
+            /* This boot overwrites the previous boots before they were
+             * loaded, the log no longer tells where they end.
+             */
+            sCliHistoryFlashBootLost = TRUE;
+        }
+
+        if (!cliHistoryFlashStartSector(sector))
+        {
+            sCliHistoryFlashOpen = FALSE;
+            sCliHistoryFlashBatchLength = 0;
+            sCliHistoryFlashBatchCount = 0;
+            return;
+        }
+    }
+
+    record.Marker = 0xFF;
+    record.Count = sCliHistoryFlashBatchCount;
+    record.Length = sCliHistoryFlashBatchLength;
+    record.Check = cliHistoryFlashCheck(sCliHistoryFlashBatch,
+                                        sCliHistoryFlashBatchLength);
+    record.Reserved = 0xFFFF;
+
+    offset = sCliHistoryFlashSector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE
+             + sCliHistoryFlashOffset;
+
+    /* The marker is written last, a record cut by a reset stays invalid */
+    if (iecCliHistoryFlashWrite(offset, (const U8 *)&record, sizeof(record))
+        && iecCliHistoryFlashWrite(offset + sizeof(record), sCliHistoryFlashBatch,
+                                   sCliHistoryFlashBatchLength))
+    {
+        record.Marker = CLI_HISTORY_FLASH_VALID;
+        written = iecCliHistoryFlashWrite(offset, &record.Marker, sizeof(record.Marker));
+    }
+
+    if (written)
+    {
+        sCliHistoryFlashOffset += size;
+    }
+    else
+    {
+        sCliHistoryFlashOpen = FALSE;
+    }
+
+    sCliHistoryFlashBatchLength = 0;
+    sCliHistoryFlashBatchCount = 0;
+}
+
+/**
+ * @Name:   cliHistoryFlashAppend()
+ *
+ * @Description: This function adds a command to the persistent history. The
+ *               commands are batched, a record is written every
+ *               IEC_CLI_HISTORY_FLASH_BATCH commands.
+ *
+ * @param  PtrCommand - NUL terminated command line.
+ *
+ *****************************************************************************/
+void cliHistoryFlashAppend(const U8 *PtrCommand)
+{
+    U16 length = strlen((const char *)PtrCommand);
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    if (length >= CLI_MAX_CMD_LINE_LENGTH)
+    {
+        length = CLI_MAX_CMD_LINE_LENGTH - 1;
+    }
+
+    cliHistoryFlashLock();
+
+    if (sCliHistoryFlashBatchLength + length + 1 > IEC_CLI_HISTORY_FLASH_BATCH_SIZE)
+    {
+        cliHistoryFlashWriteBatch();
+    }
+
+    memcpy(&sCliHistoryFlashBatch[sCliHistoryFlashBatchLength], PtrCommand, length);
+    sCliHistoryFlashBatch[sCliHistoryFlashBatchLength + length] = '\0';
+    sCliHistoryFlashBatchLength += length + 1;
+    sCliHistoryFlashBatchCount++;
+
+    if (sCliHistoryFlashBatchCount >= IEC_CLI_HISTORY_FLASH_BATCH)
+    {
+        cliHistoryFlashWriteBatch();
+    }
+
+    cliHistoryFlashUnlock();
+}
+
+/**
+ * @Name:   cliHistoryFlashSync()
+ *
+ * @Description: This function writes the batched commands, e.g. when a
+ *               session is closed.
+ *
+ *****************************************************************************/
+void cliHistoryFlashSync(void)
+{
+    cliHistoryFlashLock();
+    cliHistoryFlashWriteBatch();
+    cliHistoryFlashUnlock();
+}
+
+/**
+ * @Name:   cliHistoryFlashLoadSector()
+ *
+ * @Description: This function adds the commands of a sector of the log to
+ *               the persistent history. Called with the lock taken.
+ *
+ * @param  Sector - Sector number.
+ *
+ * @return FALSE if the write position at boot was reached.
+ *
+ *****************************************************************************/
+static BOOL cliHistoryFlashLoadSector(U32 Sector)
+{
+    CLI_HISTORY_FLASH_RECORD_HDR record;
+    U8  data[IEC_CLI_HISTORY_FLASH_BATCH_SIZE];
+    U32 offset = sizeof(CLI_HISTORY_FLASH_SECTOR_HDR);
+    U32 size;
+    U16 index;
+
+    while ((size = cliHistoryFlashRecord(Sector, offset, &record)) != 0)
+    {
+        if ((Sector == sCliHistoryFlashBootSector)
+            && (offset >= sCliHistoryFlashBootOffset))
+        {
+            return FALSE;
+        }
+
+        if ((record.Marker == CLI_HISTORY_FLASH_VALID)
+            && (record.Length > 0)
+            && iecCliHistoryFlashRead(Sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE
+                                      + offset + sizeof(record),
+                                      data, record.Length)
+            && (cliHistoryFlashCheck(data, record.Length) == record.Check)
+            && (data[record.Length - 1] == '\0'))
+        {
+            for (index = 0; index < record.Length;
+                 index += strlen((const char *)&data[index]) + 1)
+            {
+                cliHistoryAdd(&sCliHistoryFlash, &data[index]);
+            }
+        }
+
+        offset += size;
+    }
+
+    return (Sector != sCliHistoryFlashBootSector) ? TRUE : FALSE;
+}
+
+/**
+ * @Name:   cliHistoryFlashLoad()
+ *
+ * @Description: This function returns the persistent history: the newest
+ *               commands of the previous boots. The log is read by the first
+ *               call, not at boot.
+ *
+ * @return persistent history, NULL while another session loads it.
+ *
+ *****************************************************************************/
+PTR_CLI_CMD_HISTORY cliHistoryFlashLoad(void)
+{
+    CLI_HISTORY_FLASH_SECTOR_HDR header;
+    U32 sequence[IEC_CLI_HISTORY_FLASH_SECTORS];
+    U32 sector;
+    U32 oldest;
+    U32 last = 0;
+
+    if (sCliHistoryFlashLoaded == 2)
+    {
+        return &sCliHistoryFlash;
+    }
+
+    if (!__sync_bool_compare_and_swap(&sCliHistoryFlashLoaded, 0, 1))
+    {
+        return NULL;
+    }
+
+    cliHistoryFlashLock();
+    cliHistoryFlashOpenLog();
+
+    for (sector = 0; sector < IEC_CLI_HISTORY_FLASH_SECTORS; sector++)
+    {
+        sequence[sector] = 0;
+        if (iecCliHistoryFlashRead(sector * IEC_CLI_HISTORY_FLASH_SECTOR_SIZE,
+                                   (PU8)&header, sizeof(header))
+            && (header.Magic == CLI_HISTORY_FLASH_MAGIC))
+        {
+            sequence[sector] = header.Sequence;
+        }
+    }
+
+    /* Load the sectors from the oldest to the boot sector */
+    while (!sCliHistoryFlashBootLost)
+    {
+        oldest = IEC_CLI_HISTORY_FLASH_SECTORS;
+        for (sector = 0; sector < IEC_CLI_HISTORY_FLASH_SECTORS; sector++)
+        {
+            if ((sequence[sector] > last)
+                && ((oldest == IEC_CLI_HISTORY_FLASH_SECTORS)
+                    || (sequence[sector] < sequence[oldest])))
+            {
+                oldest = sector;
+            }
+        }
+
+        if ((oldest == IEC_CLI_HISTORY_FLASH_SECTORS)
+            || !cliHistoryFlashLoadSector(oldest))
+        {
+            break;
+        }
+        last = sequence[oldest];
+    }
+
+    cliHistoryFlashUnlock();
+
+    __sync_synchronize();
+    sCliHistoryFlashLoaded = 2;
+
+    return &sCliHistoryFlash;
 }
 
+#endif
 
@@ -14,13 +14,23 @@
  *
  *  Date      Who   Description
  *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added the persistent history in flash
+ *                  (IEC_CLI_HISTORY_FLASH_REGION).
+ *  10/18/26  AW    Added cliHistorySearch() and the trigram signature
+ *                  of the commands.
+ *  10/18/26  AW    Added the lock-free shared history
+ *                  (IEC_CLI_HISTORY_SHARED). cliHistoryGet() copies the
+ *                  command.
+ *  10/18/26  AW    Commands are looked up by sequence number.
+ *  10/18/26  AW    Replaced the malloc'ed command list with a ring of
+ *                  entries in a fixed byte arena.
  *  07/09/18  AW    Initial version.
  *
  *
  * Description
  * ------------
  *  This file is the header file for cli history module.
- *  it contains create, insert, search functions.
+ *  it contains insert and lookup functions.
  *
  *-------------------------------------------------------------------------
  */
@@ -34,6 +44,53 @@
 ** Preprocessor Constants
 */
 
+/* Define IEC_CLI_HISTORY_SHARED to share one history between all sessions.
+ * By default each session has its own history in its session context.
+ */
+
+/* Maximum number of commands kept in the history */
+#define CLI_HISTORY_MAX_ENTRIES         (32)
+
+/* Size of the byte arena holding the history commands. Each command takes
+ * its length plus a NUL. The oldest commands are evicted when either the
+ * entries or the arena run out.
+ */
+#define CLI_HISTORY_ARENA_SIZE          (1024)
+
+/* Number of U32 words of the trigram signature of a command */
+#define CLI_HISTORY_SIG_WORDS           (2)
+
+/* Sequence number of a shared history slot while a command is written to it */
+#define CLI_HISTORY_SLOT_WRITING        (0xFFFFFFFF)
+
+/* Define IEC_CLI_HISTORY_FLASH_REGION to the HALI_FLASH_REGION_TYPE holding
+ * the persistent history. The commands of all sessions are appended to a log
+ * in IEC_CLI_HISTORY_FLASH_SECTORS sectors of that region, which are erased
+ * round robin. The commands of the previous boots are loaded the first time
+ * a session recalls past its own history.
+ * The host build defines IEC_CLI_HISTORY_FLASH_FILE to the name of a file
+ * used instead of the flash.
+ */
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+
+/* Offset of the history log in the flash region */
+#ifndef IEC_CLI_HISTORY_FLASH_OFFSET
+#define IEC_CLI_HISTORY_FLASH_OFFSET    (0)
+#endif
+
+/* Erase sector size and number of sectors of the history log, at least 2 */
+#ifndef IEC_CLI_HISTORY_FLASH_SECTOR_SIZE
+#define IEC_CLI_HISTORY_FLASH_SECTOR_SIZE (4096)
+#endif
+#ifndef IEC_CLI_HISTORY_FLASH_SECTORS
+#define IEC_CLI_HISTORY_FLASH_SECTORS   (2)
+#endif
+
+/* Commands are written in batches of up to this many commands or bytes */
+#define IEC_CLI_HISTORY_FLASH_BATCH     (4)
+#define IEC_CLI_HISTORY_FLASH_BATCH_SIZE (256)
+
+#endif
 
 /*
 ** Macros
@@ -42,33 +99,76 @@
 /*
 ** Enumerated types
 */
-typedef struct _CMD_HIS_NODE CLI_CMD_HIS_NODE, *PTR_CLI_CMD_HIS_NODE, **PTR_PTR_CLI_CMD_HIS_NODE;
-
-struct _CMD_HIS_NODE
-{
-    /* Pointer to command string.*/
-    char  Command[18];
-
-    S32  IndexCounter;
-
-    /* Pointer to next node in the list*/
-    PTR_CLI_CMD_HIS_NODE    PtrNext;
-} __attribute__((packed));
-
 
 /*
 ** Typedefs
 */
+
 typedef  struct _CLI_CMD_HISTORY   CLI_CMD_HISTORY, *PTR_CLI_CMD_HISTORY;
 
+#ifdef IEC_CLI_HISTORY_SHARED
 
+/* Slot of the shared history */
+typedef struct _CLI_CMD_HIS_SLOT
+{
+    /* Sequence number of the command in the slot, 0 if the slot is empty,
+     * CLI_HISTORY_SLOT_WRITING while the command is written.
+     */
+    volatile U32 Sequence;
+    /* Trigram signature of the command, see cliHistorySearch() */
+    U32 Signature[CLI_HISTORY_SIG_WORDS];
+    char Command[CLI_MAX_CMD_LINE_LENGTH];
+} CLI_CMD_HIS_SLOT, *PTR_CLI_CMD_HIS_SLOT;
+
+/* Shared command history. Command n is stored in Slot[n % entries]. A
+ * command is added without a lock: the sequence number is claimed with an
+ * atomic increment and the slot with a compare and swap, readers check the
+ * slot sequence number before and after copying the command. A zeroed
+ * structure is an empty history.
+ */
+struct _CLI_CMD_HISTORY
+{
+    /* Sequence number of the last command added, the first command added
+     * is 1.
+     */
+    volatile U32 Sequence;
+    CLI_CMD_HIS_SLOT Slot[CLI_HISTORY_MAX_ENTRIES];
+};
+
+#else
+
+/* Location of a history command in the arena */
+typedef struct _CLI_CMD_HIS_ENTRY
+{
+    U16 Offset;
+    U16 Length;
+    /* Trigram signature of the command, see cliHistorySearch() */
+    U32 Signature[CLI_HISTORY_SIG_WORDS];
+} CLI_CMD_HIS_ENTRY, *PTR_CLI_CMD_HIS_ENTRY;
+
+/* Command history of a session. Entry is a ring of CLI_HISTORY_MAX_ENTRIES
+ * entries, the commands are stored in Arena in the order they are added and
+ * wrap to the start of the arena when the end is reached. A zeroed
+ * structure is an empty history. Only the session thread may use it.
+ */
 struct _CLI_CMD_HISTORY
 {
     /* No. of record commands */
     U16 CliCommandCount;
-    /* Command list head pointer */
-    PTR_CLI_CMD_HIS_NODE PtrCliCmdListHead;
-} ;
+    /* Ring index of the oldest command */
+    U16 First;
+    /* Arena offset where the next command is stored */
+    U16 ArenaHead;
+    /* Sequence number of the last command added, the first command added
+     * is 1. The sequence number of a command does not change when newer
+     * commands are added, so it can be kept as a history cursor.
+     */
+    U32 Sequence;
+    CLI_CMD_HIS_ENTRY Entry[CLI_HISTORY_MAX_ENTRIES];
+    char Arena[CLI_HISTORY_ARENA_SIZE];
+};
+
+#endif
 
 /*
 ** Variables
@@ -77,17 +177,29 @@ struct _CLI_CMD_HISTORY
 /*
 ** Function Prototypes
 */
-void cliPrintCmd(PTR_CLI_CMD_HISTORY ptrCmdList);
+void cliHistoryAdd(PTR_CLI_CMD_HISTORY PtrHistory, const U8 *PtrCommand);
+
+U16 cliHistoryGet(PTR_CLI_CMD_HISTORY PtrHistory, U32 Sequence, PU8 PtrCommand);
 
+U32 cliHistorySearch(PTR_CLI_CMD_HISTORY PtrHistory,
+                     const U8 *PtrQuery,
+                     U16 QueryLength,
+                     U32 Sequence,
+                     PU8 PtrCommand);
 
-char* cliSearchString(U8 RepeatTime,  U8 maxLength, PTR_CLI_CMD_HIS_NODE ptrCmdList, FILE* PtrOutFileHandle);
+#ifdef IEC_CLI_HISTORY_FLASH_REGION
+void cliHistoryFlashAppend(const U8 *PtrCommand);
 
+void cliHistoryFlashSync(void);
 
-void cliEchoSpace(U8 parity, FILE* PtrOutFileHandle);
+PTR_CLI_CMD_HISTORY cliHistoryFlashLoad(void);
 
-void cliInsertNode(U8 index, PU8 inputCommand, PTR_CLI_CMD_HISTORY* ppList);
+BOOL iecCliHistoryFlashRead(U32 Offset, PU8 PtrData, U32 Size);
 
-void cliFreeList(PTR_CLI_CMD_HISTORY pCmdList);
+BOOL iecCliHistoryFlashWrite(U32 Offset, const U8 *PtrData, U32 Size);
+
+BOOL iecCliHistoryFlashErase(U32 Offset, U32 Size);
+#endif
 
 
 #endif
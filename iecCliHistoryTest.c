@@ -0,0 +1,413 @@
+ /***************************************************************************
+  *                                                                         *
+  *  Copyright 2019- Inventec.  All rights reserved.                        *
+  *                                                                         *
+  ***************************************************************************
+  *
+  *           Name:  iecCliHistoryTest.c
+  *          Title:  IEC Arbok Host Test File
+  *     Programmer:  Albert Wang
+  *  Creation Date:  Oct 18, 2026
+  *
+  *  Version History
+  *  ---------------
+  *
+  *  Date      Who   Description
+  *  --------  ---   -------------------------------------------------------
+  *  10/18/26  AW    Added the stress test of the shared history.
+  *  10/18/26  AW    Initial version.
+  *
+  *
+  * Description
+  * ------------
+  *  Host test of the command history (iecCliHistory.c). It is linked with
+  *  iecCliHistory.c and the host HAL shims and built with -DHOSTTEST and
+  *  -lpthread. Built with IEC_CLI_HISTORY_SHARED it tests the shared history
+  *  from several threads, otherwise the history of a session. It returns 0
+  *  if all checks pass.
+  *
+  *-------------------------------------------------------------------------
+  */
+ /*
+ ** Include Files
+ */
+
+#include "iec.h"
+#ifdef IEC_CLI_HISTORY_SHARED
+#include <pthread.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+/* Number of commands added by the test */
+#define CLI_HISTORY_TEST_COMMANDS       (100000)
+
+/* Threads adding commands to and reading the shared history */
+#define CLI_HISTORY_TEST_WRITERS        (4)
+#define CLI_HISTORY_TEST_READERS        (4)
+
+/* Every CLI_HISTORY_TEST_CHECK_ALL commands all the kept commands are checked */
+#define CLI_HISTORY_TEST_CHECK_ALL      (997)
+
+/* Runs of this many short commands fill the entries before the arena */
+#define CLI_HISTORY_TEST_SHORT_RUN      (64)
+
+static CLI_CMD_HISTORY sCliHistoryTest;
+
+#ifdef IEC_CLI_HISTORY_SHARED
+static volatile BOOL sCliHistoryTestDone;
+static U32 sCliHistoryTestErrors[CLI_HISTORY_TEST_WRITERS + CLI_HISTORY_TEST_READERS];
+static U32 sCliHistoryTestReads[CLI_HISTORY_TEST_READERS];
+#endif
+
+/**
+ * @Name:   cliHistoryTestCommand()
+ *
+ * @Description: This function builds the command with the given sequence
+ *               number. The length is 1 to CLI_MAX_CMD_LINE_LENGTH - 1,
+ *               with runs of commands of up to 8 characters. The command
+ *               starts with the sequence number.
+ *
+ * @param  Sequence - Sequence number of the command.
+ *
+ * @param  PtrCommand - Buffer of CLI_MAX_CMD_LINE_LENGTH bytes.
+ *
+ *****************************************************************************/
+static void cliHistoryTestCommand(U32 Sequence, char *PtrCommand)
+{
+    U32 length;
+    U32 prefix;
+
+    if (((Sequence / CLI_HISTORY_TEST_SHORT_RUN) % 2) != 0)
+    {
+        length = 1 + Sequence % 8;
+    }
+    else
+    {
+        length = 1 + (Sequence * 7919) % (CLI_MAX_CMD_LINE_LENGTH - 1);
+    }
+
+    memset(PtrCommand, 'a' + Sequence % 26, length);
+    PtrCommand[length] = '\0';
+
+    prefix = snprintf(PtrCommand, length + 1, "%u", Sequence);
+    if (prefix < length)
+    {
+        PtrCommand[prefix] = ' ';
+    }
+}
+
+#ifdef IEC_CLI_HISTORY_SHARED
+
+/**
+ * @Name:   cliHistoryTestWriter()
+ *
+ * @Description: This thread adds CLI_HISTORY_TEST_COMMANDS commands to the
+ *               shared history. Command n of writer w is the test command
+ *               of sequence n * CLI_HISTORY_TEST_WRITERS + w.
+ *
+ * @param  PtrArg - Writer number.
+ *
+ *****************************************************************************/
+static void *cliHistoryTestWriter(void *PtrArg)
+{
+    U32 writer = (U32)(size_t)PtrArg;
+    char command[CLI_MAX_CMD_LINE_LENGTH];
+    U32 loopCount;
+
+    for (loopCount = 1; loopCount <= CLI_HISTORY_TEST_COMMANDS; loopCount++)
+    {
+        cliHistoryTestCommand(loopCount * CLI_HISTORY_TEST_WRITERS + writer, command);
+        cliHistoryAdd(&sCliHistoryTest, (const U8 *)command);
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   cliHistoryTestReader()
+ *
+ * @Description: This thread reads the commands of the shared history while
+ *               the writers add commands. Every command read must be
+ *               a complete test command: a command torn by a writer, or
+ *               mixed from two commands, does not match the command of its
+ *               own number.
+ *
+ * @param  PtrArg - Reader number.
+ *
+ *****************************************************************************/
+static void *cliHistoryTestReader(void *PtrArg)
+{
+    U32 reader = (U32)(size_t)PtrArg;
+    U8 readBack[CLI_MAX_CMD_LINE_LENGTH];
+    char expected[CLI_MAX_CMD_LINE_LENGTH];
+    U32 sequence;
+    U32 index;
+    U16 length;
+
+    while (!sCliHistoryTestDone)
+    {
+        sequence = sCliHistoryTest.Sequence;
+
+        /* From the oldest command, its slot is the next one overwritten */
+        for (index = CLI_HISTORY_MAX_ENTRIES; index > 0; index--)
+        {
+            if (index > sequence)
+            {
+                continue;
+            }
+
+            length = cliHistoryGet(&sCliHistoryTest, sequence - index + 1, readBack);
+            if (length == 0)
+            {
+                continue;
+            }
+
+            sCliHistoryTestReads[reader]++;
+
+            /* A command shorter than 8 characters may not hold its whole
+             * number, only the longer ones are compared
+             */
+            cliHistoryTestCommand(strtoul((const char *)readBack, NULL, 10), expected);
+            if ((length != strlen((const char *)readBack))
+                || ((length >= 8) && (strcmp((const char *)readBack, expected) != 0)))
+            {
+                printf("FAIL reader %u: torn command [%s]\n", reader, readBack);
+                sCliHistoryTestErrors[CLI_HISTORY_TEST_WRITERS + reader]++;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   cliHistoryTestShared()
+ *
+ * @Description: This function runs CLI_HISTORY_TEST_WRITERS writers and
+ *               CLI_HISTORY_TEST_READERS readers on the shared history,
+ *               then checks the sequence number and that the commands kept
+ *               read back.
+ *
+ * @return number of failed checks.
+ *
+ *****************************************************************************/
+static U32 cliHistoryTestShared(void)
+{
+    pthread_t writers[CLI_HISTORY_TEST_WRITERS];
+    pthread_t readers[CLI_HISTORY_TEST_READERS];
+    U8 readBack[CLI_MAX_CMD_LINE_LENGTH];
+    U32 reads = 0;
+    U32 kept = 0;
+    U32 errors = 0;
+    U32 index;
+
+    memset(&sCliHistoryTest, 0, sizeof(sCliHistoryTest));
+
+    for (index = 0; index < CLI_HISTORY_TEST_READERS; index++)
+    {
+        pthread_create(&readers[index], NULL, cliHistoryTestReader, (void *)(size_t)index);
+    }
+    for (index = 0; index < CLI_HISTORY_TEST_WRITERS; index++)
+    {
+        pthread_create(&writers[index], NULL, cliHistoryTestWriter, (void *)(size_t)index);
+    }
+
+    for (index = 0; index < CLI_HISTORY_TEST_WRITERS; index++)
+    {
+        pthread_join(writers[index], NULL);
+    }
+    sCliHistoryTestDone = TRUE;
+    for (index = 0; index < CLI_HISTORY_TEST_READERS; index++)
+    {
+        pthread_join(readers[index], NULL);
+        reads += sCliHistoryTestReads[index];
+    }
+
+    for (index = 0; index < CLI_HISTORY_TEST_WRITERS + CLI_HISTORY_TEST_READERS; index++)
+    {
+        errors += sCliHistoryTestErrors[index];
+    }
+
+    if (sCliHistoryTest.Sequence != CLI_HISTORY_TEST_WRITERS * CLI_HISTORY_TEST_COMMANDS)
+    {
+        printf("FAIL: sequence %u\n", sCliHistoryTest.Sequence);
+        errors++;
+    }
+
+    /* A slot holds no command only if its add lost the race for the slot */
+    for (index = 0; index < CLI_HISTORY_MAX_ENTRIES; index++)
+    {
+        if (cliHistoryGet(&sCliHistoryTest, sCliHistoryTest.Sequence - index, readBack) != 0)
+        {
+            kept++;
+        }
+    }
+
+    if ((reads == 0) || (kept == 0))
+    {
+        printf("FAIL: %u commands read, %u kept\n", reads, kept);
+        errors++;
+    }
+
+    printf("shared: %u writers x %u commands, %u commands read, %u of %u kept\n",
+           CLI_HISTORY_TEST_WRITERS, CLI_HISTORY_TEST_COMMANDS, reads, kept,
+           CLI_HISTORY_MAX_ENTRIES);
+
+    return errors;
+}
+
+#else
+
+/**
+ * @Name:   cliHistoryTestHeapInUse()
+ *
+ * @Description: This function returns the heap in use, 0 where the C
+ *               library cannot tell.
+ *
+ *****************************************************************************/
+static size_t cliHistoryTestHeapInUse(void)
+{
+#ifdef __GLIBC__
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @Name:   cliHistoryTestRing()
+ *
+ * @Description: This function adds CLI_HISTORY_TEST_COMMANDS commands to a
+ *               history. It checks that the last command can be read back,
+ *               that the kept commands stay within the entries and the
+ *               arena and are intact, that evicted commands are gone, and
+ *               that no heap is used. Both the entries and the arena must
+ *               have run out during the test.
+ *
+ * @return number of failed checks.
+ *
+ *****************************************************************************/
+static U32 cliHistoryTestRing(void)
+{
+    PTR_CLI_CMD_HISTORY ptrHistory = &sCliHistoryTest;
+    char command[CLI_MAX_CMD_LINE_LENGTH];
+    char expected[CLI_MAX_CMD_LINE_LENGTH];
+    U8 readBack[CLI_MAX_CMD_LINE_LENGTH];
+    size_t heapBefore = cliHistoryTestHeapInUse();
+    U32 fullEntries = 0;
+    U32 arenaWraps = 0;
+    U32 errors = 0;
+    U32 sequence;
+    U32 index;
+    U16 arenaHead;
+    U16 kept;
+
+    memset(ptrHistory, 0, sizeof(*ptrHistory));
+
+    for (sequence = 1; sequence <= CLI_HISTORY_TEST_COMMANDS; sequence++)
+    {
+        cliHistoryTestCommand(sequence, command);
+        arenaHead = ptrHistory->ArenaHead;
+
+        cliHistoryAdd(ptrHistory, (const U8 *)command);
+
+        if (ptrHistory->ArenaHead < arenaHead)
+        {
+            arenaWraps++;
+        }
+        if (ptrHistory->CliCommandCount == CLI_HISTORY_MAX_ENTRIES)
+        {
+            fullEntries++;
+        }
+
+        if ((ptrHistory->Sequence != sequence)
+            || (ptrHistory->CliCommandCount == 0)
+            || (ptrHistory->CliCommandCount > CLI_HISTORY_MAX_ENTRIES)
+            || (ptrHistory->ArenaHead > CLI_HISTORY_ARENA_SIZE))
+        {
+            printf("FAIL %u: count %u head %u\n", sequence,
+                   ptrHistory->CliCommandCount, ptrHistory->ArenaHead);
+            return errors + 1;
+        }
+
+        if ((cliHistoryGet(ptrHistory, sequence, readBack) != strlen(command))
+            || (strcmp((const char *)readBack, command) != 0))
+        {
+            printf("FAIL %u: last command not read back\n", sequence);
+            errors++;
+        }
+
+        kept = ptrHistory->CliCommandCount;
+
+        /* The command before the oldest kept one is evicted */
+        if ((sequence > kept) && (cliHistoryGet(ptrHistory, sequence - kept, readBack) != 0))
+        {
+            printf("FAIL %u: evicted command %u still read\n", sequence, sequence - kept);
+            errors++;
+        }
+
+        if ((sequence % CLI_HISTORY_TEST_CHECK_ALL) != 0)
+        {
+            continue;
+        }
+
+        for (index = 0; index < kept; index++)
+        {
+            const CLI_CMD_HIS_ENTRY *ptrEntry =
+                &ptrHistory->Entry[(ptrHistory->First + index) % CLI_HISTORY_MAX_ENTRIES];
+
+            if (ptrEntry->Offset + ptrEntry->Length + 1 > CLI_HISTORY_ARENA_SIZE)
+            {
+                printf("FAIL %u: entry %u outside the arena\n", sequence, index);
+                errors++;
+            }
+
+            cliHistoryTestCommand(sequence - kept + 1 + index, expected);
+            if ((cliHistoryGet(ptrHistory, sequence - kept + 1 + index, readBack) == 0)
+                || (strcmp((const char *)readBack, expected) != 0))
+            {
+                printf("FAIL %u: command %u is not intact\n", sequence,
+                       sequence - kept + 1 + index);
+                errors++;
+            }
+        }
+    }
+
+    if ((fullEntries == 0) || (arenaWraps == 0))
+    {
+        printf("FAIL: entries full %u times, arena wrapped %u times\n",
+               fullEntries, arenaWraps);
+        errors++;
+    }
+
+    if (cliHistoryTestHeapInUse() != heapBefore)
+    {
+        printf("FAIL: heap in use changed from %lu to %lu bytes\n",
+               (unsigned long)heapBefore, (unsigned long)cliHistoryTestHeapInUse());
+        errors++;
+    }
+
+    printf("ring: %u commands, %u bytes, entries full %u times, arena wrapped %u times\n",
+           CLI_HISTORY_TEST_COMMANDS, (U32)sizeof(*ptrHistory), fullEntries, arenaWraps);
+
+    return errors;
+}
+
+#endif
+
+int main(void)
+{
+    U32 errors;
+
+#ifdef IEC_CLI_HISTORY_SHARED
+    errors = cliHistoryTestShared();
+#else
+    errors = cliHistoryTestRing();
+#endif
+
+    printf("%s\n", (errors == 0) ? "PASS" : "FAIL");
+
+    return (errors == 0) ? 0 : 1;
+}
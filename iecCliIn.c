@@ -0,0 +1,463 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliIn.c
+ *          Title:  IEC CLI Input Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    iecCliInClose() waits for the reader thread to return
+ *                  with the end of input before it terminates it.
+ *  10/18/26  AW    Ctrl-C is seen without a platform hook: the default
+ *                  iecCliInAvailable() has a reader thread wait for the input
+ *                  while a command runs.
+ *  10/18/26  AW    Sessions without input are marked NoInput, not only the
+ *                  jobs.
+ *  10/18/26  AW    Added the Ctrl-C cancellation of the running command.
+ *  10/18/26  AW    A background job has no input.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli session input queue.
+ *  The queue is refilled with iecCliInRead() only when it is empty. The
+ *  output buffer of the session is flushed just before, so the echo of a
+ *  whole block of input goes out in one write instead of one write per
+ *  character.
+ *  A file handle without a session context is read one character at a
+ *  time.
+ *  While a command runs nobody waits for input. iecCliInCancelled() reads
+ *  the input already received, without blocking, and looks for Ctrl-C in
+ *  it. The other characters stay queued for the next command line. A
+ *  platform can also report Ctrl-C from its receive path with
+ *  iecCliInCancel().
+ *  fgetc() is the only read of the file layer, and it waits. So the first
+ *  time a running command checks for Ctrl-C, the default
+ *  iecCliInAvailable() starts a reader thread that waits for one character
+ *  in fgetc() instead of the session. Until the session has taken that
+ *  character, the reader thread owns the file handle, and the default
+ *  iecCliInRead() waits for the reader instead of calling fgetc().
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "cliCore.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
+
+
+/**
+ * @Name:   iecCliInReaderThread()
+ *
+ * @Description: This function is the entry function of the input reader
+ *               threads. It waits for one character on the session file
+ *               handle, hands it to the session and returns.
+ *
+ * @param ThreadInput - Session context.
+ *
+ *****************************************************************************/
+static void iecCliInReaderThread(U32 ThreadInput)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = (PTR_IEC_CLI_SESSION_CTX)ThreadInput;
+
+    ptrCtx->ReaderChar = fgetc(&(ptrCtx->PtrSessionInfo->OutFileHandle));
+
+    __sync_synchronize();
+    ptrCtx->ReaderState = IEC_CLI_IN_READER_READY;
+    haliOsSemaphorePut(ptrCtx->ReaderSemHandle);
+}
+
+/**
+ * @Name:   iecCliInReaderStart()
+ *
+ * @Description: This function starts the input reader thread of the
+ *               session. The thread object, the semaphore and the stack are
+ *               reserved on first use and kept by the context. If they
+ *               cannot be reserved, no reader runs and Ctrl-C is only seen
+ *               through iecCliInCancel().
+ *
+ * @param PtrCtx - Session context.
+ *
+ *****************************************************************************/
+static void iecCliInReaderStart(PTR_IEC_CLI_SESSION_CTX PtrCtx)
+{
+    HALI_OS_HANDLE handle;
+
+    if (PtrCtx->ReaderThreadHandle == HALI_OS_INVALID_HANDLE)
+    {
+        PtrCtx->ReaderThreadHandle = haliOSAllocateObject(HALI_MEMORY_ID_IMEM,
+                                                          HALI_OS_THREAD);
+        if (PtrCtx->ReaderThreadHandle == HALI_OS_INVALID_HANDLE)
+        {
+            return;
+        }
+    }
+
+    if (PtrCtx->ReaderSemHandle == HALI_OS_INVALID_HANDLE)
+    {
+        handle = haliOSAllocateObject(HALI_MEMORY_ID_IMEM, HALI_OS_SEMAPHORE);
+        if (handle == HALI_OS_INVALID_HANDLE)
+        {
+            return;
+        }
+        if (haliOsSemaphoreCreate(handle, (U8 *)"CLI Input", 0) != HALI_OS_SUCCESS)
+        {
+            haliOsReleaseObject(handle);
+            return;
+        }
+        PtrCtx->ReaderSemHandle = handle;
+    }
+
+    if (PtrCtx->PtrReaderStack == NULL)
+    {
+        PtrCtx->PtrReaderStack = malloc(IEC_CLI_IN_READER_STACK_SIZE);
+        if (PtrCtx->PtrReaderStack == NULL)
+        {
+            return;
+        }
+    }
+
+    PtrCtx->ReaderState = IEC_CLI_IN_READER_READING;
+
+    if (haliOsThreadCreate(PtrCtx->ReaderThreadHandle,
+                           (U8 *)"CLI Input",
+                           iecCliInReaderThread,
+                           (U32)PtrCtx,
+                           PtrCtx->PtrReaderStack,
+                           IEC_CLI_IN_READER_STACK_SIZE,
+                           CLI_THREAD_PRIORITY,
+                           CLI_THREAD_PREEMPT_THRESH,
+                           0,
+                           HALI_OS_AUTO_START_ENABLE) != HALI_OS_SUCCESS)
+    {
+        PtrCtx->ReaderState = IEC_CLI_IN_READER_IDLE;
+    }
+}
+
+/**
+ * @Name:   iecCliInReaderStop()
+ *
+ * @Description: This function deletes the input reader thread of the
+ *               session, done or not, and drops the wake up it may have
+ *               given.
+ *
+ * @param PtrCtx - Session context.
+ *
+ *****************************************************************************/
+static void iecCliInReaderStop(PTR_IEC_CLI_SESSION_CTX PtrCtx)
+{
+    haliOsThreadTerminate(PtrCtx->ReaderThreadHandle);
+    haliOsThreadDelete(PtrCtx->ReaderThreadHandle);
+
+    while (haliOsSemaphoreGet(PtrCtx->ReaderSemHandle, HALI_OS_NO_WAIT)
+           == HALI_OS_SUCCESS)
+    {
+    }
+
+    PtrCtx->ReaderState = IEC_CLI_IN_READER_IDLE;
+}
+
+/**
+ * @Name:   iecCliInRead()
+ *
+ * @Description: This function is exported weakly. It waits for input on the
+ *               session file handle and reads all the bytes received so
+ *               far, at most Size. The default implementation reads one
+ *               character with fgetc(), or takes the character of the input
+ *               reader thread if one was started. Platforms override it,
+ *               together with iecCliInAvailable(), to drain the UART
+ *               receive buffer or the telnet socket in one call.
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ * @param PtrBuffer - Returns the bytes read.
+ *
+ * @param Size - Size of the buffer, at least 1.
+ *
+ * @return number of bytes read, 0 at the end of the input.
+ *
+ *****************************************************************************/
+WEAK S32 iecCliInRead(FILE *PtrInFileHandle, PU8 PtrBuffer, U32 Size)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+    S32 userInput;
+
+    if ((ptrCtx != NULL) && (ptrCtx->ReaderState != IEC_CLI_IN_READER_IDLE))
+    {
+        /* The reader thread owns the file handle until it has a character */
+        haliOsSemaphoreGet(ptrCtx->ReaderSemHandle, HALI_OS_WAIT_FOREVER);
+        userInput = ptrCtx->ReaderChar;
+        iecCliInReaderStop(ptrCtx);
+    }
+    else
+    {
+        userInput = fgetc(PtrInFileHandle);
+    }
+    if (userInput == HALI_EOF)
+    {
+        return 0;
+    }
+
+    PtrBuffer[0] = (U8)userInput;
+
+    return 1;
+}
+
+/**
+ * @Name:   iecCliInGetc()
+ *
+ * @Description: This function returns the next input character of the
+ *               session. When the input queue is empty the output is
+ *               flushed and the queue is refilled with iecCliInRead().
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ * @return the character, HALI_EOF at the end of the input and for a
+ *         session without input, e.g. a background job.
+ *
+ *****************************************************************************/
+int iecCliInGetc(FILE *PtrInFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+    S32 count;
+
+    if (ptrCtx == NULL)
+    {
+        iecCliOutFlush(PtrInFileHandle);
+
+        return fgetc(PtrInFileHandle);
+    }
+
+    /* The input of the session belongs to the session, not to its jobs or
+     * to cliExecToBuffer()
+     */
+    if (ptrCtx->NoInput == TRUE)
+    {
+        return HALI_EOF;
+    }
+
+    if (ptrCtx->InCount == 0)
+    {
+        /* Show the echo before waiting for more input */
+        iecCliOutFlush(PtrInFileHandle);
+
+        count = iecCliInRead(PtrInFileHandle, ptrCtx->InBuf, sizeof(ptrCtx->InBuf));
+        if (count <= 0)
+        {
+            return HALI_EOF;
+        }
+
+        ptrCtx->InHead = 0;
+        ptrCtx->InCount = (U16)count;
+    }
+
+    ptrCtx->InCount--;
+
+    return ptrCtx->InBuf[ptrCtx->InHead++];
+}
+
+/**
+ * @Name:   iecCliInPending()
+ *
+ * @Description: This function returns the number of input characters of
+ *               the session already queued, e.g. the rest of a pasted block.
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ * @return number of queued characters.
+ *
+ *****************************************************************************/
+U32 iecCliInPending(FILE *PtrInFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+
+    return (ptrCtx != NULL) ? ptrCtx->InCount : 0;
+}
+
+/**
+ * @Name:   iecCliInAvailable()
+ *
+ * @Description: This function is exported weakly. It returns the number of
+ *               bytes received on the session file handle that
+ *               iecCliInRead() can return without waiting. The default
+ *               implementation starts the input reader thread of the
+ *               session if it has none, and returns 1 once the reader has
+ *               a character. The end of the input is left to the next
+ *               command line.
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ * @return number of bytes ready to be read.
+ *
+ *****************************************************************************/
+WEAK U32 iecCliInAvailable(FILE *PtrInFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+
+    if (ptrCtx == NULL)
+    {
+        return 0;
+    }
+
+    if (ptrCtx->ReaderState == IEC_CLI_IN_READER_IDLE)
+    {
+        iecCliInReaderStart(ptrCtx);
+
+        return 0;
+    }
+
+    return ((ptrCtx->ReaderState == IEC_CLI_IN_READER_READY)
+            && (ptrCtx->ReaderChar != HALI_EOF)) ? 1 : 0;
+}
+
+/**
+ * @Name:   iecCliInCancel()
+ *
+ * @Description: This function asks the command running on the session to
+ *               stop. It is called by the platform receive path when it
+ *               gets Ctrl-C, and only sets a flag.
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliInCancel(FILE *PtrInFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+
+    if (ptrCtx != NULL)
+    {
+        ptrCtx->CancelRequest = TRUE;
+    }
+}
+
+/**
+ * @Name:   iecCliInClose()
+ *
+ * @Description: This function deletes the input reader thread of the
+ *               session, if it has one. It is called when the session is
+ *               closed, before its context is released. A reader still
+ *               waiting in fgetc() is woken like the session thread, by the
+ *               end of input (HALI_EOF) the server puts in the receive
+ *               buffer on a disconnect. It is given IEC_CLI_IN_READER_CLOSE_MS
+ *               to return before it is terminated.
+ *
+ * @param PtrInFileHandle - Input file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliInClose(FILE *PtrInFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrInFileHandle);
+
+    if ((ptrCtx == NULL) || (ptrCtx->ReaderState == IEC_CLI_IN_READER_IDLE))
+    {
+        return;
+    }
+
+    if (ptrCtx->ReaderState == IEC_CLI_IN_READER_READING)
+    {
+        /* The reader signals once it has its character, or HALI_EOF. The
+         * signal is dropped by iecCliInReaderStop().
+         */
+        if (haliOsSemaphoreGet(ptrCtx->ReaderSemHandle,
+                               (IEC_CLI_IN_READER_CLOSE_MS * 1000)
+                               / haliOsGetMicrosecPerTick()) == HALI_OS_SUCCESS)
+        {
+            haliOsSemaphorePut(ptrCtx->ReaderSemHandle);
+        }
+    }
+
+    iecCliInReaderStop(ptrCtx);
+}
+
+/**
+ * @Name:   iecCliInCancelled()
+ *
+ * @Description: This function tells whether the running command is to
+ *               stop, see CLI_CANCELLED(). The input received so far is
+ *               queued and searched for Ctrl-C; the input before the
+ *               Ctrl-C is dropped with it. The thread yields, so a command
+ *               loop calling this function does not hog the CPU.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return TRUE if Ctrl-C was received since the command started or the
+ *         session is being closed.
+ *
+ *****************************************************************************/
+BOOL iecCliInCancelled(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    FILE *ptrInFileHandle = &(PtrSessionInfo->OutFileHandle);
+    S32 count;
+    U16 index;
+
+    haliOsThreadRelinquish();
+
+    if (PtrSessionInfo->SessionActive == FALSE)
+    {
+        return TRUE;
+    }
+
+    if (ptrCtx == NULL)
+    {
+        return FALSE;
+    }
+
+    if (ptrCtx->CancelRequest == TRUE)
+    {
+        return TRUE;
+    }
+
+    /* A job has no input, it is stopped with kill or by a pipe */
+    if (ptrCtx->NoInput == TRUE)
+    {
+        return FALSE;
+    }
+
+    /* Queue the new input behind the input still queued, e.g. the rest of
+     * a pasted block.
+     */
+    if ((ptrCtx->InCount < sizeof(ptrCtx->InBuf))
+        && (iecCliInAvailable(ptrInFileHandle) != 0))
+    {
+        memmove(ptrCtx->InBuf, &ptrCtx->InBuf[ptrCtx->InHead], ptrCtx->InCount);
+        ptrCtx->InHead = 0;
+
+        count = iecCliInRead(ptrInFileHandle, &ptrCtx->InBuf[ptrCtx->InCount],
+                             sizeof(ptrCtx->InBuf) - ptrCtx->InCount);
+        if (count > 0)
+        {
+            ptrCtx->InCount += (U16)count;
+        }
+    }
+
+    for (index = 0; index < ptrCtx->InCount; index++)
+    {
+        if (ptrCtx->InBuf[ptrCtx->InHead + index] == IEC_CLI_CHAR_CTRL_C)
+        {
+            ptrCtx->InHead += index + 1;
+            ptrCtx->InCount -= index + 1;
+            ptrCtx->CancelRequest = TRUE;
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliIn.h
+ *          Title:  iec CLI Input Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added IEC_CLI_IN_READER_CLOSE_MS.
+ *  10/18/26  AW    Added the input reader thread and iecCliInClose().
+ *  10/18/26  AW    Added the Ctrl-C cancellation of the running command.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli session input queue. The input
+ *  of a session is read in blocks, as many bytes as the session has
+ *  received, into the input buffer of the session context and handed to
+ *  the line editor one character at a time. A pasted block of commands is
+ *  read at once and the commands after the first stay queued for the next
+ *  command lines.
+ *  While a command runs, Ctrl-C asks it to stop. Long command loops call
+ *  CLI_CANCELLED() once per iteration and return CLI_STATUS_CANCELLED when
+ *  it is TRUE. The file layer has no read that does not wait, so by default
+ *  a reader thread waits for the input while the command runs, see
+ *  iecCliInAvailable().
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_IN_H
+#define _IEC_CLI_IN_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Stack size of the input reader thread of a session */
+#define IEC_CLI_IN_READER_STACK_SIZE    (1024)
+
+/* Time iecCliInClose() waits for the input reader thread to return with the
+ * end of input before it terminates the thread, in ms
+ */
+#define IEC_CLI_IN_READER_CLOSE_MS      (200)
+
+/*
+** Macros
+*/
+
+/* TRUE if the running command is to stop: Ctrl-C was received or the
+ * session is being closed. Also yields to the other threads.
+ */
+#define CLI_CANCELLED() \
+    iecCliInCancelled(PtrSessionInfo)
+
+/*
+** Enumerated types
+*/
+
+typedef enum _IEC_CLI_IN_READER_STATE
+{
+    /* No reader thread, the session reads its file handle itself */
+    IEC_CLI_IN_READER_IDLE = 0,
+    /* The reader thread waits for a character */
+    IEC_CLI_IN_READER_READING,
+    /* The reader thread is done, the character waits for the session */
+    IEC_CLI_IN_READER_READY
+} IEC_CLI_IN_READER_STATE;
+
+/*
+** Typedefs
+*/
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+S32 iecCliInRead(FILE *PtrInFileHandle, PU8 PtrBuffer, U32 Size);
+
+int iecCliInGetc(FILE *PtrInFileHandle);
+
+U32 iecCliInPending(FILE *PtrInFileHandle);
+
+U32 iecCliInAvailable(FILE *PtrInFileHandle);
+
+void iecCliInCancel(FILE *PtrInFileHandle);
+
+void iecCliInClose(FILE *PtrInFileHandle);
+
+BOOL iecCliInCancelled(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+
+#endif
@@ -0,0 +1,612 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliJob.c
+ *          Title:  IEC CLI Background Job Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    A job has a file handle of its own, not registered with the
+ *                  file layer, and only runs the commands whose output can be
+ *                  captured.
+ *  10/18/26  AW    A job session is marked NoInput.
+ *  10/18/26  AW    The output ring is filled through the output sink.
+ *  10/18/26  AW    Ctrl-C returns from fg and wait, the job keeps running.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli background jobs.
+ *  The jobs are kept in a static table of IEC_CLI_MAX_JOBS slots, so the
+ *  memory used by the jobs is bounded: one output ring per slot, plus the
+ *  thread stack and session context of each running job. A slot is claimed
+ *  with an atomic compare and swap on its state. A job is only seen and
+ *  collected by the session that started it; it is created and closed like
+ *  a session, with cliCreateSessionEx() and cliCloseSession().
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "cliCore.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliJob.h"
+#include "iecCliCore.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
+
+
+/* Bytes of the output ring written to the session at a time */
+#define IEC_CLI_JOB_CHUNK_SIZE          (128)
+
+/* Job table */
+static IEC_CLI_JOB sIecCliJob[IEC_CLI_MAX_JOBS];
+
+/* Id of the last job started */
+static U32 sIecCliJobLastId = 0;
+
+static const char * const sIecCliJobStateName[] =
+{
+    "Free", "Starting", "Running", "Done"
+};
+
+
+/**
+ * @Name:   iecCliJobLock()
+ *
+ * @Description: This function takes the output ring lock of the job. The
+ *               lock is only held to copy bytes, so it spins, yielding to
+ *               the other threads.
+ *
+ * @param PtrJob - Job.
+ *
+ *****************************************************************************/
+static void iecCliJobLock(PTR_IEC_CLI_JOB PtrJob)
+{
+    while (__sync_lock_test_and_set(&PtrJob->OutLock, 1) != 0)
+    {
+        haliOsThreadRelinquish();
+    }
+}
+
+/**
+ * @Name:   iecCliJobUnlock()
+ *
+ * @Description: This function releases the output ring lock of the job.
+ *
+ * @param PtrJob - Job.
+ *
+ *****************************************************************************/
+static void iecCliJobUnlock(PTR_IEC_CLI_JOB PtrJob)
+{
+    __sync_lock_release(&PtrJob->OutLock);
+}
+
+/**
+ * @Name:   iecCliJobFind()
+ *
+ * @Description: This function returns a job of the session.
+ *
+ * @param PtrSessionInfo - Session that started the job.
+ *
+ * @param Id - Job id, 0 for the job of the session with the lowest id.
+ *
+ * @return pointer to the job, NULL if the session has no such job.
+ *
+ *****************************************************************************/
+static PTR_IEC_CLI_JOB iecCliJobFind(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Id)
+{
+    PTR_IEC_CLI_JOB ptrFound = NULL;
+    PTR_IEC_CLI_JOB ptrJob;
+    U32 index;
+
+    for (index = 0; index < IEC_CLI_MAX_JOBS; index++)
+    {
+        ptrJob = &sIecCliJob[index];
+
+        if ((ptrJob->State == IEC_CLI_JOB_STATE_FREE)
+            || (ptrJob->PtrOwner != PtrSessionInfo))
+        {
+            continue;
+        }
+
+        if (Id == 0)
+        {
+            if ((ptrFound == NULL) || (ptrJob->Id < ptrFound->Id))
+            {
+                ptrFound = ptrJob;
+            }
+        }
+        else if (ptrJob->Id == Id)
+        {
+            return ptrJob;
+        }
+    }
+
+    return ptrFound;
+}
+
+/**
+ * @Name:   iecCliJobCapture()
+ *
+ * @Description: This function adds output of the job to its output ring.
+ *               It is the output sink of the job session. When the ring
+ *               is full the oldest bytes are dropped.
+ *
+ * @param PtrArg - Job.
+ *
+ * @param PtrData - Output of the job.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void iecCliJobCapture(void *PtrArg, const U8 *PtrData, U32 Length)
+{
+    PTR_IEC_CLI_JOB ptrJob = (PTR_IEC_CLI_JOB)PtrArg;
+    U32 end;
+    U32 chunk;
+
+    iecCliJobLock(ptrJob);
+
+    /* Only the last IEC_CLI_JOB_OUT_SIZE bytes can be kept */
+    if (Length > IEC_CLI_JOB_OUT_SIZE)
+    {
+        ptrJob->OutDropped += Length - IEC_CLI_JOB_OUT_SIZE;
+        PtrData += Length - IEC_CLI_JOB_OUT_SIZE;
+        Length = IEC_CLI_JOB_OUT_SIZE;
+    }
+
+    if (ptrJob->OutCount + Length > IEC_CLI_JOB_OUT_SIZE)
+    {
+        chunk = ptrJob->OutCount + Length - IEC_CLI_JOB_OUT_SIZE;
+        ptrJob->OutStart = (U16)((ptrJob->OutStart + chunk) % IEC_CLI_JOB_OUT_SIZE);
+        ptrJob->OutCount -= (U16)chunk;
+        ptrJob->OutDropped += chunk;
+    }
+
+    end = (ptrJob->OutStart + ptrJob->OutCount) % IEC_CLI_JOB_OUT_SIZE;
+    ptrJob->OutCount += (U16)Length;
+
+    while (Length > 0)
+    {
+        chunk = IEC_CLI_JOB_OUT_SIZE - end;
+        if (chunk > Length)
+        {
+            chunk = Length;
+        }
+
+        memcpy(&ptrJob->OutBuf[end], PtrData, chunk);
+
+        end = (end + chunk) % IEC_CLI_JOB_OUT_SIZE;
+        PtrData += chunk;
+        Length -= chunk;
+    }
+
+    iecCliJobUnlock(ptrJob);
+}
+
+/**
+ * @Name:   iecCliJobThread()
+ *
+ * @Description: This function is the entry function of the job threads. It
+ *               runs the command of the job like cliCommandPrompt() runs a
+ *               command line, and marks the job done.
+ *
+ * @param ThreadInput - Session information structure of the job.
+ *
+ *****************************************************************************/
+static void iecCliJobThread(U32 ThreadInput)
+{
+    PTR_CLI_SESSION_INFO ptrSessionInfo = (PTR_CLI_SESSION_INFO)ThreadInput;
+    PTR_IEC_CLI_JOB ptrJob = NULL;
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    PTR_IEC_CLI_SESSION_CTX ptrOwnerCtx;
+    U32 index;
+
+    for (index = 0; index < IEC_CLI_MAX_JOBS; index++)
+    {
+        if (&sIecCliJob[index].SessionInfo == ptrSessionInfo)
+        {
+            ptrJob = &sIecCliJob[index];
+        }
+    }
+
+    ptrCtx = iecCliSessionCtxGet(ptrSessionInfo);
+    if ((ptrJob == NULL) || (ptrCtx == NULL))
+    {
+        return;
+    }
+
+    /* From here on the output goes to the output ring of the job. The
+     * context is only set up here, the thread may run before
+     * cliCreateSessionEx() returns to iecCliJobStart().
+     */
+    ptrCtx->PtrJob = ptrJob;
+    ptrCtx->NoInput = TRUE;
+    ptrCtx->NoFile = TRUE;
+    iecCliOutSetSink(&ptrSessionInfo->OutFileHandle, iecCliJobCapture, ptrJob);
+    ptrOwnerCtx = iecCliSessionCtxGet(ptrJob->PtrOwner);
+    if (ptrOwnerCtx != NULL)
+    {
+        ptrCtx->OutMode = ptrOwnerCtx->OutMode;
+    }
+
+    memcpy(ptrSessionInfo->inputString, ptrJob->Command, CLI_MAX_CMD_LINE_LENGTH);
+
+    /* The command was found when the job was started */
+    ptrCtx->LastStatus = CLI_STATUS_FAILED;
+    cliParseCmd(ptrSessionInfo->inputString, ptrSessionInfo);
+
+    ptrJob->Status = ptrCtx->LastStatus;
+    ptrJob->State = IEC_CLI_JOB_STATE_DONE;
+}
+
+/**
+ * @Name:   iecCliJobStart()
+ *
+ * @Description: This function starts a command line in a job thread. The
+ *               command is run as a copy of the session, with the same
+ *               command list and output mode. The caller checks that the
+ *               command can run with its output captured, see
+ *               cliCmdCaptureSafe().
+ *
+ * @param PtrSessionInfo - Session starting the job.
+ *
+ * @param PtrCommand - Command line, without the '&'.
+ *
+ * @return CLI_STATUS_SUCCESS if the job is started.
+ *         CLI_STATUS_INVALID_SYNTAX if the session is itself a job.
+ *         CLI_STATUS_INSUFF_MEM if IEC_CLI_MAX_JOBS jobs are in use.
+ *         CLI_STATUS_CREATE_THRD_FAILED if the job thread was not created.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliJobStart(PTR_CLI_SESSION_INFO PtrSessionInfo, const U8 *PtrCommand)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    PTR_IEC_CLI_JOB ptrJob = NULL;
+    U32 index;
+
+    /* A job does not start jobs, e.g. for "cmd & &", and the output of a
+     * session that goes to a sink, e.g. watch, is not shared with a job
+     */
+    if ((ptrCtx != NULL)
+        && ((ptrCtx->PtrJob != NULL) || (ptrCtx->FptrOutSink != NULL)))
+    {
+        return CLI_STATUS_INVALID_SYNTAX;
+    }
+
+    for (index = 0; index < IEC_CLI_MAX_JOBS; index++)
+    {
+        if (__sync_bool_compare_and_swap(&sIecCliJob[index].State,
+                                         IEC_CLI_JOB_STATE_FREE,
+                                         IEC_CLI_JOB_STATE_STARTING))
+        {
+            ptrJob = &sIecCliJob[index];
+            break;
+        }
+    }
+
+    if (ptrJob == NULL)
+    {
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    ptrJob->Id = __sync_add_and_fetch(&sIecCliJobLastId, 1);
+    ptrJob->PtrOwner = PtrSessionInfo;
+    ptrJob->Status = CLI_STATUS_SUCCESS;
+    ptrJob->OutLock = 0;
+    ptrJob->OutStart = 0;
+    ptrJob->OutCount = 0;
+    ptrJob->OutDropped = 0;
+    strncpy((char *)ptrJob->Command, (const char *)PtrCommand,
+            CLI_MAX_CMD_LINE_LENGTH - 1);
+    ptrJob->Command[CLI_MAX_CMD_LINE_LENGTH - 1] = '\0';
+
+    /* The job uses the command list of the session. The file record of the
+     * session is not shared with the job thread: the job gets a file handle
+     * of its own, which is only used to find its session context.
+     */
+    memcpy(&ptrJob->SessionInfo, PtrSessionInfo, sizeof(ptrJob->SessionInfo));
+    memset(&ptrJob->SessionInfo.OutFileHandle, 0,
+           sizeof(ptrJob->SessionInfo.OutFileHandle));
+
+    /* The thread may be done before cliCreateSessionEx() returns */
+    ptrJob->State = IEC_CLI_JOB_STATE_RUNNING;
+
+    if (cliCreateSessionEx(&ptrJob->SessionInfo,
+                           (const U8 *)"CLI Job",
+                           iecCliJobThread,
+                           NULL,
+                           NULL) == FALSE)
+    {
+        ptrJob->State = IEC_CLI_JOB_STATE_FREE;
+
+        return CLI_STATUS_CREATE_THRD_FAILED;
+    }
+
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle), "\r\n[%u] %s\r\n",
+                    ptrJob->Id, ptrJob->Command);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   iecCliJobDrain()
+ *
+ * @Description: This function writes the output captured so far by the job
+ *               to the session and empties the output ring. The ring lock
+ *               is not held while the session is written, the job keeps
+ *               running meanwhile.
+ *
+ * @param PtrJob - Job.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliJobDrain(PTR_IEC_CLI_JOB PtrJob, FILE *PtrOutFileHandle)
+{
+    U8  chunkBuf[IEC_CLI_JOB_CHUNK_SIZE];
+    U32 dropped;
+    U32 chunk;
+
+    for ( ; ; )
+    {
+        iecCliJobLock(PtrJob);
+
+        dropped = PtrJob->OutDropped;
+        PtrJob->OutDropped = 0;
+
+        chunk = IEC_CLI_JOB_OUT_SIZE - PtrJob->OutStart;
+        if (chunk > PtrJob->OutCount)
+        {
+            chunk = PtrJob->OutCount;
+        }
+        if (chunk > sizeof(chunkBuf))
+        {
+            chunk = sizeof(chunkBuf);
+        }
+
+        memcpy(chunkBuf, &PtrJob->OutBuf[PtrJob->OutStart], chunk);
+        PtrJob->OutStart = (U16)((PtrJob->OutStart + chunk) % IEC_CLI_JOB_OUT_SIZE);
+        PtrJob->OutCount -= (U16)chunk;
+
+        iecCliJobUnlock(PtrJob);
+
+        if (dropped != 0)
+        {
+            iecCliOutPrintf(PtrOutFileHandle, "\r\n[%u bytes dropped]\r\n", dropped);
+        }
+
+        if (chunk == 0)
+        {
+            break;
+        }
+
+        iecCliOutWrite(PtrOutFileHandle, chunkBuf, chunk);
+    }
+
+    iecCliOutFlush(PtrOutFileHandle);
+}
+
+/**
+ * @Name:   iecCliJobRelease()
+ *
+ * @Description: This function closes the job session, which deletes the
+ *               job thread, and frees the job slot.
+ *
+ * @param PtrJob - Job.
+ *
+ *****************************************************************************/
+static void iecCliJobRelease(PTR_IEC_CLI_JOB PtrJob)
+{
+    cliCloseSession(&PtrJob->SessionInfo);
+
+    PtrJob->PtrOwner = NULL;
+    PtrJob->State = IEC_CLI_JOB_STATE_FREE;
+}
+
+/**
+ * @Name:   iecCliJobList()
+ *
+ * @Description: This function lists the jobs of the session.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ *****************************************************************************/
+void iecCliJobList(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_JOB ptrJob;
+    U32 state;
+    U32 index;
+
+    iecCliOutPuts("\r\n  Id  State     Status  Output  Command\r\n",
+                  &(PtrSessionInfo->OutFileHandle));
+
+    for (index = 0; index < IEC_CLI_MAX_JOBS; index++)
+    {
+        ptrJob = &sIecCliJob[index];
+        state = ptrJob->State;
+
+        if ((state == IEC_CLI_JOB_STATE_FREE)
+            || (ptrJob->PtrOwner != PtrSessionInfo))
+        {
+            continue;
+        }
+
+        if (state == IEC_CLI_JOB_STATE_DONE)
+        {
+            iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle),
+                            "%4u  %-8s  %6u  %6u  %s\r\n",
+                            ptrJob->Id, sIecCliJobStateName[state],
+                            ptrJob->Status, ptrJob->OutCount, ptrJob->Command);
+        }
+        else
+        {
+            iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle),
+                            "%4u  %-8s  %6s  %6u  %s\r\n",
+                            ptrJob->Id, sIecCliJobStateName[state],
+                            "-", ptrJob->OutCount, ptrJob->Command);
+        }
+    }
+}
+
+/**
+ * @Name:   iecCliJobForeground()
+ *
+ * @Description: This function shows the output of a job of the session as
+ *               it is produced, until the job is done, then frees the job.
+ *               It returns early, leaving the job running, on Ctrl-C or if
+ *               the session is closed.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @param Id - Job id, 0 for the oldest job of the session.
+ *
+ * @return CLI_STATUS_SUCCESS if the job is done.
+ *         CLI_STATUS_INVALID_PARAMETER if the session has no such job.
+ *         CLI_STATUS_CANCELLED if the job is left running.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliJobForeground(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Id)
+{
+    PTR_IEC_CLI_JOB ptrJob = iecCliJobFind(PtrSessionInfo, Id);
+    U32 state;
+
+    if (ptrJob == NULL)
+    {
+        return CLI_STATUS_INVALID_PARAMETER;
+    }
+
+    for ( ; ; )
+    {
+        /* Read the state first, all the output is in the ring once done */
+        state = ptrJob->State;
+
+        iecCliJobDrain(ptrJob, &(PtrSessionInfo->OutFileHandle));
+
+        if (state == IEC_CLI_JOB_STATE_DONE)
+        {
+            break;
+        }
+
+        if (iecCliInCancelled(PtrSessionInfo) == TRUE)
+        {
+            return CLI_STATUS_CANCELLED;
+        }
+
+        haliOsThreadSleep(IEC_CLI_JOB_POLL_MS);
+    }
+
+    if (ptrJob->Status == CLI_STATUS_SUCCESS)
+    {
+        iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle), "\r\n[%u] Done  %s\r\n",
+                        ptrJob->Id, ptrJob->Command);
+    }
+    else
+    {
+        iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle), "\r\n[%u] Exit %u  %s\r\n",
+                        ptrJob->Id, ptrJob->Status, ptrJob->Command);
+    }
+
+    iecCliJobRelease(ptrJob);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   iecCliJobWaitAll()
+ *
+ * @Description: This function brings the jobs of the session to the
+ *               foreground one after the other, oldest first, until the
+ *               session has no job left.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return CLI_STATUS_SUCCESS, CLI_STATUS_CANCELLED if the jobs are left
+ *         running.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliJobWaitAll(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    CLI_STATUS status = CLI_STATUS_SUCCESS;
+
+    while ((status == CLI_STATUS_SUCCESS)
+           && (iecCliJobFind(PtrSessionInfo, 0) != NULL))
+    {
+        status = iecCliJobForeground(PtrSessionInfo, 0);
+    }
+
+    return status;
+}
+
+/**
+ * @Name:   iecCliJobKill()
+ *
+ * @Description: This function stops a job of the session and frees it. The
+ *               job is asked to stop like a closed session, through
+ *               SessionActive, and its thread is terminated if it does not
+ *               stop in time. Its output is discarded.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @param Id - Job id.
+ *
+ * @return CLI_STATUS_SUCCESS if the job is stopped.
+ *         CLI_STATUS_INVALID_PARAMETER if the session has no such job.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliJobKill(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Id)
+{
+    PTR_IEC_CLI_JOB ptrJob = iecCliJobFind(PtrSessionInfo, Id);
+
+    if ((Id == 0) || (ptrJob == NULL))
+    {
+        return CLI_STATUS_INVALID_PARAMETER;
+    }
+
+    iecCliJobRelease(ptrJob);
+
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle), "\r\n[%u] Killed\r\n", Id);
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   iecCliJobKillAll()
+ *
+ * @Description: This function stops and frees all the jobs of the session.
+ *               It is called when the session is closed.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ *****************************************************************************/
+void iecCliJobKillAll(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_JOB ptrJob;
+    U32 index;
+
+    for (index = 0; index < IEC_CLI_MAX_JOBS; index++)
+    {
+        ptrJob = &sIecCliJob[index];
+
+        if ((ptrJob->State != IEC_CLI_JOB_STATE_FREE)
+            && (ptrJob->PtrOwner == PtrSessionInfo))
+        {
+            iecCliJobRelease(ptrJob);
+        }
+    }
+}
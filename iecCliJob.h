@@ -0,0 +1,125 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliJob.h
+ *          Title:  iec CLI Background Job Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Only the commands whose output can be captured run as a
+ *                  job.
+ *  10/18/26  AW    The output ring is filled through the output sink.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli background jobs. A command line
+ *  ending with '&' is run by a job thread and the session gets its prompt
+ *  back at once. The job runs as a session of its own, a copy of the
+ *  session that started it, so the command handlers need no change. Its
+ *  output is captured in the output ring of the job instead of being
+ *  written to the session, and is shown by the fg and wait commands. The
+ *  job has no file handle of the file layer, so only the commands
+ *  registered with cliRegisterCaptureTable() run as a job.
+ *  A job has no input, reading it returns HALI_EOF.
+ *  Include this file after iecCliSession.h.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_JOB_H
+#define _IEC_CLI_JOB_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Size of the output ring of a job. The newest output is kept, the oldest
+ * is dropped once the ring is full.
+ */
+#define IEC_CLI_JOB_OUT_SIZE            (2048)
+
+/* Period the fg and wait commands poll a running job at, in ms */
+#define IEC_CLI_JOB_POLL_MS             (20)
+
+/*
+** Macros
+*/
+
+/*
+** Enumerated types
+*/
+
+typedef enum _IEC_CLI_JOB_STATE
+{
+    /* Slot not in use */
+    IEC_CLI_JOB_STATE_FREE = 0,
+    /* Slot claimed, the job thread is being created */
+    IEC_CLI_JOB_STATE_STARTING,
+    IEC_CLI_JOB_STATE_RUNNING,
+    /* Command done, the output and status wait for fg or wait */
+    IEC_CLI_JOB_STATE_DONE
+} IEC_CLI_JOB_STATE;
+
+/*
+** Typedefs
+*/
+
+struct _IEC_CLI_JOB
+{
+    /* IEC_CLI_JOB_STATE */
+    volatile U32            State;
+    /* Job number shown to the user, unique while the system runs */
+    U32                     Id;
+    /* Session that started the job, the only one that can see it */
+    PTR_CLI_SESSION_INFO    PtrOwner;
+    /* Session the job runs as, a copy of the owner session */
+    CLI_SESSION_INFO        SessionInfo;
+    /* Command line without the '&' */
+    U8                      Command[CLI_MAX_CMD_LINE_LENGTH];
+    /* CLI_STATUS returned by the command, valid once the job is done */
+    CLI_STATUS              Status;
+
+    /* Protects the output ring, taken by the job thread and the owner */
+    volatile U32            OutLock;
+    /* Offset of the oldest byte of the output ring */
+    U16                     OutStart;
+    /* Number of bytes in the output ring */
+    U16                     OutCount;
+    /* Bytes dropped since the owner last read the ring */
+    U32                     OutDropped;
+    U8                      OutBuf[IEC_CLI_JOB_OUT_SIZE];
+};
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+CLI_STATUS iecCliJobStart(PTR_CLI_SESSION_INFO PtrSessionInfo, const U8 *PtrCommand);
+
+void iecCliJobList(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliJobForeground(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Id);
+
+CLI_STATUS iecCliJobWaitAll(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+CLI_STATUS iecCliJobKill(PTR_CLI_SESSION_INFO PtrSessionInfo, U32 Id);
+
+void iecCliJobKillAll(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+
+#endif
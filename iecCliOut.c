@@ -0,0 +1,754 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliOut.c
+ *          Title:  IEC CLI Output Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    iecCliOutGetTicks() reads the HAL tick counter, so the
+ *                  blocked time counters are kept without an override.
+ *  10/18/26  AW    Added the output sink, iecCliOutSetSink(). The output of
+ *                  a background job goes to the output ring of the job
+ *                  instead of the session file handle.
+ *  10/18/26  AW    Added iecCliHexDump().
+ *  10/18/26  AW    Added the TLV output mode. Text is sent in TEXT records
+ *                  in TLV mode.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli session output channel.
+ *  The output is collected in the output buffer of the session context and
+ *  written to the session file handle when the buffer is full, when it
+ *  holds IEC_CLI_OUT_FLUSH_LINES lines, or when iecCliOutFlush() is called
+ *  (prompt display, end of command, before waiting for input).
+ *  A file handle without a session context is written directly.
+ *  In TLV mode the text output functions wrap their output in
+ *  IEC_CLI_TLV_TEXT records, and iecCliOutTlv() adds typed records.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include <stdarg.h>
+#include "iec.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliOut.h"
+
+
+/* Bytes shown on one iecCliHexDump() line */
+#define IEC_CLI_HEXDUMP_BYTES_PER_LINE  (16)
+
+/* Longest iecCliHexDump() line: "OOOOOOOO: " + 16 "XX " + " |" + 16 + "|\r\n" */
+#define IEC_CLI_HEXDUMP_LINE_SIZE       (10 + (3 * IEC_CLI_HEXDUMP_BYTES_PER_LINE) \
+                                         + 2 + IEC_CLI_HEXDUMP_BYTES_PER_LINE + 3)
+
+static const char sIecCliHexDigits[] = "0123456789ABCDEF";
+
+
+/**
+ * @Name:   iecCliOutGetTicks()
+ *
+ * @Description: This function is exported weakly. It returns the OS tick
+ *               counter used to measure the time the session thread is
+ *               blocked writing its output, and the session connect and
+ *               close times. The default implementation reads the HAL tick
+ *               counter.
+ *
+ * @return current OS tick count.
+ *
+ *****************************************************************************/
+WEAK U32 iecCliOutGetTicks(void)
+{
+    return haliOsGetTickCount();
+}
+
+/**
+ * @Name:   iecCliOutFlushCtx()
+ *
+ * @Description: This function writes the output buffer of the session
+ *               context to the session file handle, or to the output sink
+ *               of the session if it has one.
+ *
+ * @param PtrCtx - Session context.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliOutFlushCtx(PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                              FILE *PtrOutFileHandle)
+{
+    U32 startTicks;
+    U32 blockedTicks;
+
+    if (PtrCtx->OutCount == 0)
+    {
+        return;
+    }
+
+    startTicks = iecCliOutGetTicks();
+
+    if (PtrCtx->FptrOutSink != NULL)
+    {
+        PtrCtx->FptrOutSink(PtrCtx->PtrOutSinkArg, PtrCtx->OutBuf, PtrCtx->OutCount);
+    }
+    else
+    {
+        fwrite(PtrCtx->OutBuf, 1, PtrCtx->OutCount, PtrOutFileHandle);
+        fflush(PtrOutFileHandle);
+    }
+
+    blockedTicks = iecCliOutGetTicks() - startTicks;
+
+    PtrCtx->OutStats.Flushes++;
+    PtrCtx->OutStats.BlockedTicks += blockedTicks;
+    if (blockedTicks > PtrCtx->OutStats.MaxBlockedTicks)
+    {
+        PtrCtx->OutStats.MaxBlockedTicks = blockedTicks;
+    }
+
+    PtrCtx->OutCount = 0;
+    PtrCtx->OutLines = 0;
+}
+
+/**
+ * @Name:   iecCliOutCommit()
+ *
+ * @Description: This function accounts Length bytes just added at the end
+ *               of the output buffer, and flushes the buffer if it holds
+ *               IEC_CLI_OUT_FLUSH_LINES lines.
+ *
+ * @param PtrCtx - Session context.
+ *
+ * @param Length - Number of bytes added.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliOutCommit(PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                            U32 Length,
+                            FILE *PtrOutFileHandle)
+{
+    const U8 *ptrData = &PtrCtx->OutBuf[PtrCtx->OutCount];
+    U32 index;
+
+    /* TLV output is only read at the end of the command, lines do not
+     * matter.
+     */
+    if (PtrCtx->OutMode == IEC_CLI_OUT_MODE_TEXT)
+    {
+        for (index = 0; index < Length; index++)
+        {
+            if (ptrData[index] == '\n')
+            {
+                PtrCtx->OutLines++;
+            }
+        }
+    }
+
+    PtrCtx->OutCount += Length;
+    PtrCtx->OutStats.Bytes += Length;
+
+    if (PtrCtx->OutLines >= IEC_CLI_OUT_FLUSH_LINES)
+    {
+        iecCliOutFlushCtx(PtrCtx, PtrOutFileHandle);
+    }
+}
+
+/**
+ * @Name:   iecCliOutWriteCtx()
+ *
+ * @Description: This function copies a block of data to the output buffer
+ *               of the session context, flushing the buffer when it is full.
+ *
+ * @param PtrCtx - Session context.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param PtrData - Data to write.
+ *
+ * @param Length - Number of bytes to write.
+ *
+ *****************************************************************************/
+static void iecCliOutWriteCtx(PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                              FILE *PtrOutFileHandle,
+                              const U8 *PtrData,
+                              U32 Length)
+{
+    U32 chunk;
+
+    while (Length > 0)
+    {
+        if (PtrCtx->OutCount == IEC_CLI_OUT_BUF_SIZE)
+        {
+            iecCliOutFlushCtx(PtrCtx, PtrOutFileHandle);
+        }
+
+        chunk = IEC_CLI_OUT_BUF_SIZE - PtrCtx->OutCount;
+        if (chunk > Length)
+        {
+            chunk = Length;
+        }
+
+        memcpy(&PtrCtx->OutBuf[PtrCtx->OutCount], PtrData, chunk);
+        iecCliOutCommit(PtrCtx, chunk, PtrOutFileHandle);
+
+        PtrData += chunk;
+        Length -= chunk;
+    }
+}
+
+/**
+ * @Name:   iecCliOutTlvHeader()
+ *
+ * @Description: This function fills a TLV record header.
+ *
+ * @param PtrHeader - IEC_CLI_TLV_HDR_SIZE bytes to fill.
+ *
+ * @param Type - Record type, IEC_CLI_TLV_TYPE.
+ *
+ * @param Length - Length of the record value.
+ *
+ *****************************************************************************/
+static void iecCliOutTlvHeader(U8 *PtrHeader, U8 Type, U16 Length)
+{
+    PtrHeader[0] = Type;
+    PtrHeader[1] = (U8)(Length & 0xFF);
+    PtrHeader[2] = (U8)(Length >> 8);
+}
+
+/**
+ * @Name:   iecCliOutText()
+ *
+ * @Description: This function writes text to the output buffer of the
+ *               session context. In TLV mode the text is sent in
+ *               IEC_CLI_TLV_TEXT records.
+ *
+ * @param PtrCtx - Session context.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param PtrText - Text to write.
+ *
+ * @param Length - Number of characters to write.
+ *
+ *****************************************************************************/
+static void iecCliOutText(PTR_IEC_CLI_SESSION_CTX PtrCtx,
+                          FILE *PtrOutFileHandle,
+                          const U8 *PtrText,
+                          U32 Length)
+{
+    U8 header[IEC_CLI_TLV_HDR_SIZE];
+    U32 chunk;
+
+    if (PtrCtx->OutMode == IEC_CLI_OUT_MODE_TEXT)
+    {
+        iecCliOutWriteCtx(PtrCtx, PtrOutFileHandle, PtrText, Length);
+        return;
+    }
+
+    while (Length > 0)
+    {
+        chunk = (Length > 0xFFFF) ? 0xFFFF : Length;
+
+        iecCliOutTlvHeader(header, IEC_CLI_TLV_TEXT, (U16)chunk);
+        iecCliOutWriteCtx(PtrCtx, PtrOutFileHandle, header, sizeof(header));
+        iecCliOutWriteCtx(PtrCtx, PtrOutFileHandle, PtrText, chunk);
+
+        PtrText += chunk;
+        Length -= chunk;
+    }
+}
+
+/**
+ * @Name:   iecCliOutWrite()
+ *
+ * @Description: This function writes a block of raw data to the output
+ *               channel of the session. The data is not wrapped in a TLV
+ *               record in TLV mode.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param PtrData - Data to write.
+ *
+ * @param Length - Number of bytes to write.
+ *
+ *****************************************************************************/
+void iecCliOutWrite(FILE *PtrOutFileHandle, const U8 *PtrData, U32 Length)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    if (ptrCtx == NULL)
+    {
+        fwrite(PtrData, 1, Length, PtrOutFileHandle);
+        return;
+    }
+
+    ptrCtx->OutStats.Writes++;
+
+    iecCliOutWriteCtx(ptrCtx, PtrOutFileHandle, PtrData, Length);
+}
+
+/**
+ * @Name:   iecCliOutPutc()
+ *
+ * @Description: This function writes one character to the output channel
+ *               of the session, like fputc().
+ *
+ * @param Char - Character to write.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @return the character written.
+ *
+ *****************************************************************************/
+int iecCliOutPutc(int Char, FILE *PtrOutFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+    U8 data = (U8)Char;
+
+    if (ptrCtx == NULL)
+    {
+        return fputc(Char, PtrOutFileHandle);
+    }
+
+    ptrCtx->OutStats.Writes++;
+
+    iecCliOutText(ptrCtx, PtrOutFileHandle, &data, 1);
+
+    return Char;
+}
+
+/**
+ * @Name:   iecCliOutPuts()
+ *
+ * @Description: This function writes a string to the output channel of the
+ *               session, like fputs().
+ *
+ * @param PtrString - NUL terminated string to write.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliOutPuts(const char *PtrString, FILE *PtrOutFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    if (ptrCtx == NULL)
+    {
+        fputs(PtrString, PtrOutFileHandle);
+        return;
+    }
+
+    ptrCtx->OutStats.Writes++;
+
+    iecCliOutText(ptrCtx, PtrOutFileHandle,
+                  (const U8 *)PtrString, strlen(PtrString));
+}
+
+/**
+ * @Name:   iecCliOutPrintf()
+ *
+ * @Description: This function prints formatted output to the output channel
+ *               of the session, like fprintf(). The output is formatted in
+ *               place in the output buffer. Output longer than the whole
+ *               buffer is written directly after flushing the buffer.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param PtrFormat - printf() format string.
+ *
+ * @return number of characters printed.
+ *
+ *****************************************************************************/
+int iecCliOutPrintf(FILE *PtrOutFileHandle, const char *PtrFormat, ...)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+    va_list argList;
+    U8 header[IEC_CLI_TLV_HDR_SIZE];
+    U32 headerSize;
+    U32 space;
+    int length;
+
+    if (ptrCtx == NULL)
+    {
+        va_start(argList, PtrFormat);
+        length = vfprintf(PtrOutFileHandle, PtrFormat, argList);
+        va_end(argList);
+
+        return length;
+    }
+
+    ptrCtx->OutStats.Writes++;
+
+    /* In TLV mode the text is formatted behind room for its record header */
+    headerSize = (ptrCtx->OutMode == IEC_CLI_OUT_MODE_TLV) ?
+                 IEC_CLI_TLV_HDR_SIZE : 0;
+
+    if ((IEC_CLI_OUT_BUF_SIZE - ptrCtx->OutCount) <= headerSize)
+    {
+        iecCliOutFlushCtx(ptrCtx, PtrOutFileHandle);
+    }
+
+    /* vsnprintf() also writes the NUL, so the output fits if it is shorter
+     * than the free space.
+     */
+    space = IEC_CLI_OUT_BUF_SIZE - ptrCtx->OutCount - headerSize;
+
+    va_start(argList, PtrFormat);
+    length = vsnprintf((char *)&ptrCtx->OutBuf[ptrCtx->OutCount + headerSize],
+                       space, PtrFormat, argList);
+    va_end(argList);
+
+    if (length < 0)
+    {
+        return length;
+    }
+
+    if ((U32)length >= space)
+    {
+        /* Does not fit behind the buffered output, flush and retry */
+        iecCliOutFlushCtx(ptrCtx, PtrOutFileHandle);
+
+        if (((U32)length + headerSize >= IEC_CLI_OUT_BUF_SIZE)
+            && (ptrCtx->FptrOutSink == NULL))
+        {
+            if (headerSize != 0)
+            {
+                iecCliOutTlvHeader(header, IEC_CLI_TLV_TEXT, (U16)length);
+                fwrite(header, 1, sizeof(header), PtrOutFileHandle);
+            }
+
+            va_start(argList, PtrFormat);
+            vfprintf(PtrOutFileHandle, PtrFormat, argList);
+            va_end(argList);
+
+            ptrCtx->OutStats.Bytes += length + headerSize;
+
+            return length;
+        }
+
+        va_start(argList, PtrFormat);
+        vsnprintf((char *)&ptrCtx->OutBuf[headerSize],
+                  IEC_CLI_OUT_BUF_SIZE - headerSize, PtrFormat, argList);
+        va_end(argList);
+
+        /* A sink only gets whole buffers, a longer text is cut */
+        if ((U32)length + headerSize >= IEC_CLI_OUT_BUF_SIZE)
+        {
+            length = IEC_CLI_OUT_BUF_SIZE - headerSize - 1;
+        }
+    }
+
+    if (headerSize != 0)
+    {
+        iecCliOutTlvHeader(&ptrCtx->OutBuf[ptrCtx->OutCount],
+                           IEC_CLI_TLV_TEXT, (U16)length);
+    }
+
+    iecCliOutCommit(ptrCtx, length + headerSize, PtrOutFileHandle);
+
+    return length;
+}
+
+/**
+ * @Name:   iecCliOutFlush()
+ *
+ * @Description: This function writes the buffered output of the session to
+ *               the session file handle and flushes the file handle.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+void iecCliOutFlush(FILE *PtrOutFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    /* The file handle is not flushed while the output goes to a sink */
+    if ((ptrCtx != NULL)
+        && ((ptrCtx->OutCount != 0) || (ptrCtx->FptrOutSink != NULL)))
+    {
+        /* Also flushes the file handle */
+        iecCliOutFlushCtx(ptrCtx, PtrOutFileHandle);
+        return;
+    }
+
+    fflush(PtrOutFileHandle);
+}
+
+/**
+ * @Name:   iecCliOutSetMode()
+ *
+ * @Description: This function selects the output mode of the session. The
+ *               output buffered so far is flushed first, so it is sent in
+ *               the mode it was written in.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param Mode - IEC_CLI_OUT_MODE_TEXT or IEC_CLI_OUT_MODE_TLV.
+ *
+ *****************************************************************************/
+void iecCliOutSetMode(FILE *PtrOutFileHandle, IEC_CLI_OUT_MODE Mode)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    if (ptrCtx != NULL)
+    {
+        iecCliOutFlushCtx(ptrCtx, PtrOutFileHandle);
+        ptrCtx->OutMode = (U8)Mode;
+        ptrCtx->OutLines = 0;
+    }
+}
+
+/**
+ * @Name:   iecCliOutSetSink()
+ *
+ * @Description: This function sends the output of the session to a sink
+ *               function instead of the session file handle, or back to the
+ *               file handle. The output buffered so far is flushed first,
+ *               to where it was meant to go. The sink gets the output in
+ *               blocks, at the same points the file handle would have.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param FptrSink - Sink function, NULL for the session file handle.
+ *
+ * @param PtrArg - Argument passed to the sink function.
+ *
+ *****************************************************************************/
+void iecCliOutSetSink(FILE *PtrOutFileHandle,
+                      PTR_IEC_CLI_OUT_SINK FptrSink,
+                      void *PtrArg)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    if (ptrCtx != NULL)
+    {
+        iecCliOutFlushCtx(ptrCtx, PtrOutFileHandle);
+        ptrCtx->FptrOutSink = FptrSink;
+        ptrCtx->PtrOutSinkArg = PtrArg;
+    }
+}
+
+/**
+ * @Name:   iecCliOutTlvMode()
+ *
+ * @Description: This function tells whether the session is in TLV output
+ *               mode.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @return TRUE in TLV mode, FALSE in text mode or without session context.
+ *
+ *****************************************************************************/
+BOOL iecCliOutTlvMode(FILE *PtrOutFileHandle)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+
+    return ((ptrCtx != NULL) && (ptrCtx->OutMode == IEC_CLI_OUT_MODE_TLV));
+}
+
+/**
+ * @Name:   iecCliOutTlv()
+ *
+ * @Description: This function emits a TLV record. It is ignored in text
+ *               mode, the caller prints the text form instead.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param Type - Record type, IEC_CLI_TLV_TYPE.
+ *
+ * @param PtrValue - Record value.
+ *
+ * @param Length - Length of the record value.
+ *
+ *****************************************************************************/
+void iecCliOutTlv(FILE *PtrOutFileHandle,
+                  U8 Type,
+                  const void *PtrValue,
+                  U16 Length)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+    U8 header[IEC_CLI_TLV_HDR_SIZE];
+
+    if ((ptrCtx == NULL) || (ptrCtx->OutMode != IEC_CLI_OUT_MODE_TLV))
+    {
+        return;
+    }
+
+    ptrCtx->OutStats.Writes++;
+
+    iecCliOutTlvHeader(header, Type, Length);
+    iecCliOutWriteCtx(ptrCtx, PtrOutFileHandle, header, sizeof(header));
+    iecCliOutWriteCtx(ptrCtx, PtrOutFileHandle, (const U8 *)PtrValue, Length);
+}
+
+/**
+ * @Name:   iecCliHexDumpLine()
+ *
+ * @Description: This function formats one iecCliHexDump() line: the offset,
+ *               the hex bytes and, with IEC_CLI_HEXDUMP_ASCII, the printable
+ *               characters. A short last line is padded so the ASCII column
+ *               stays aligned.
+ *
+ * @param PtrLine - IEC_CLI_HEXDUMP_LINE_SIZE bytes to fill.
+ *
+ * @param Offset - Offset of the first byte of the line.
+ *
+ * @param PtrData - Bytes of the line.
+ *
+ * @param Count - Number of bytes of the line, 1 to 16.
+ *
+ * @param Flags - IEC_CLI_HEXDUMP_xxx.
+ *
+ * @return length of the line.
+ *
+ *****************************************************************************/
+static U32 iecCliHexDumpLine(U8 *PtrLine,
+                             U32 Offset,
+                             const U8 *PtrData,
+                             U32 Count,
+                             U32 Flags)
+{
+    U8 *ptrOut = PtrLine;
+    U32 index;
+    S32 shift;
+
+    for (shift = 28; shift >= 0; shift -= 4)
+    {
+        *ptrOut++ = sIecCliHexDigits[(Offset >> shift) & 0xF];
+    }
+    *ptrOut++ = ':';
+    *ptrOut++ = ' ';
+
+    for (index = 0; index < IEC_CLI_HEXDUMP_BYTES_PER_LINE; index++)
+    {
+        if (index < Count)
+        {
+            *ptrOut++ = sIecCliHexDigits[PtrData[index] >> 4];
+            *ptrOut++ = sIecCliHexDigits[PtrData[index] & 0xF];
+        }
+        else if ((Flags & IEC_CLI_HEXDUMP_ASCII) != 0)
+        {
+            *ptrOut++ = ' ';
+            *ptrOut++ = ' ';
+        }
+        else
+        {
+            break;
+        }
+        *ptrOut++ = ' ';
+    }
+
+    if ((Flags & IEC_CLI_HEXDUMP_ASCII) != 0)
+    {
+        *ptrOut++ = ' ';
+        *ptrOut++ = '|';
+        for (index = 0; index < Count; index++)
+        {
+            *ptrOut++ = ((PtrData[index] >= 0x20) && (PtrData[index] < 0x7F)) ?
+                        PtrData[index] : '.';
+        }
+        *ptrOut++ = '|';
+    }
+
+    *ptrOut++ = '\r';
+    *ptrOut++ = '\n';
+
+    return (U32)(ptrOut - PtrLine);
+}
+
+/**
+ * @Name:   iecCliHexDump()
+ *
+ * @Description: This function prints a block of data in hex, 16 bytes per
+ *               line, each line written in one call. With
+ *               IEC_CLI_HEXDUMP_COLLAPSE a run of lines identical to the
+ *               line before is printed as a single "*" line, like hexdump.
+ *               The last line is always printed, so the end of the data
+ *               is visible.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param PtrData - Data to print.
+ *
+ * @param Size - Number of bytes to print.
+ *
+ * @param Flags - IEC_CLI_HEXDUMP_xxx.
+ *
+ *****************************************************************************/
+void iecCliHexDump(FILE *PtrOutFileHandle,
+                   const void *PtrData,
+                   U32 Size,
+                   U32 Flags)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxFromFile(PtrOutFileHandle);
+    const U8 *ptrData = (const U8 *)PtrData;
+    const U8 *ptrPrevLine = NULL;
+    U8 line[IEC_CLI_HEXDUMP_LINE_SIZE];
+    BOOL collapsed = FALSE;
+    U32 offset;
+    U32 count;
+    U32 length;
+
+    for (offset = 0; offset < Size; offset += IEC_CLI_HEXDUMP_BYTES_PER_LINE)
+    {
+        count = Size - offset;
+        if (count > IEC_CLI_HEXDUMP_BYTES_PER_LINE)
+        {
+            count = IEC_CLI_HEXDUMP_BYTES_PER_LINE;
+        }
+
+        if (((Flags & IEC_CLI_HEXDUMP_COLLAPSE) != 0)
+            && (ptrPrevLine != NULL)
+            && (offset + IEC_CLI_HEXDUMP_BYTES_PER_LINE < Size)
+            && (memcmp(ptrPrevLine, &ptrData[offset],
+                       IEC_CLI_HEXDUMP_BYTES_PER_LINE) == 0))
+        {
+            if (!collapsed)
+            {
+                line[0] = '*';
+                line[1] = '\r';
+                line[2] = '\n';
+                length = 3;
+                collapsed = TRUE;
+            }
+            else
+            {
+                continue;
+            }
+        }
+        else
+        {
+            length = iecCliHexDumpLine(line, offset, &ptrData[offset],
+                                       count, Flags);
+            ptrPrevLine = &ptrData[offset];
+            collapsed = FALSE;
+        }
+
+        if (ptrCtx == NULL)
+        {
+            fwrite(line, 1, length, PtrOutFileHandle);
+        }
+        else
+        {
+            ptrCtx->OutStats.Writes++;
+            iecCliOutText(ptrCtx, PtrOutFileHandle, line, length);
+        }
+    }
+}
+
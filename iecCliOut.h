@@ -0,0 +1,200 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliOut.h
+ *          Title:  iec CLI Output Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added iecCliOutSetSink().
+ *  10/18/26  AW    Added iecCliHexDump().
+ *  10/18/26  AW    Added the TLV output mode.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli session output channel. Output
+ *  written through it is collected in the session context and written to
+ *  the session file handle in one block, instead of one write per character
+ *  or per printf.
+ *  In TLV mode (opt-in per session, meant for the in-band cli) the output
+ *  is a stream of records: Type (1 byte), Length (2 bytes, little endian)
+ *  and Length bytes of value. Commands that support it emit typed records,
+ *  text of the other commands is sent in IEC_CLI_TLV_TEXT records, and
+ *  every command ends with an IEC_CLI_TLV_STATUS record.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_OUT_H
+#define _IEC_CLI_OUT_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* The output buffer is flushed once it holds this many lines, so a long
+ * table is shown while it is being printed and not only at its end.
+ */
+#define IEC_CLI_OUT_FLUSH_LINES     (8)
+
+/* Size of the TLV record header */
+#define IEC_CLI_TLV_HDR_SIZE        (3)
+
+/* iecCliHexDump() flags */
+/* Add the printable characters of the line after the hex bytes */
+#define IEC_CLI_HEXDUMP_ASCII       (0x0001)
+/* Print a run of lines identical to the previous line as a single "*" */
+#define IEC_CLI_HEXDUMP_COLLAPSE    (0x0002)
+
+/*
+** Macros
+*/
+
+/* Command handlers including this file print through the output buffer of
+ * the session.
+ */
+#undef  CLI_PRINTF
+#define CLI_PRINTF(...) \
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle), __VA_ARGS__)
+
+/* TRUE if the session is in TLV output mode */
+#define CLI_OUT_TLV_MODE() \
+    iecCliOutTlvMode(&(PtrSessionInfo->OutFileHandle))
+
+/* Emit a TLV record of the given type from a record structure */
+#define CLI_OUT_TLV(Type, Record) \
+    iecCliOutTlv(&(PtrSessionInfo->OutFileHandle), (Type), \
+                 &(Record), (U16)sizeof(Record))
+
+/*
+** Enumerated types
+*/
+
+typedef enum _IEC_CLI_OUT_MODE
+{
+    /* Formatted text, the default */
+    IEC_CLI_OUT_MODE_TEXT = 0,
+    /* Binary TLV records */
+    IEC_CLI_OUT_MODE_TLV
+} IEC_CLI_OUT_MODE;
+
+/* TLV record types. The values are part of the in-band protocol, do not
+ * renumber them.
+ */
+typedef enum _IEC_CLI_TLV_TYPE
+{
+    /* Text printed by a command, not NUL terminated */
+    IEC_CLI_TLV_TEXT        = 0x01,
+    /* IEC_CLI_TLV_STATUS_REC, last record of each command */
+    IEC_CLI_TLV_STATUS      = 0x02,
+    /* IEC_CLI_TLV_SAS_PHY_REC, one per phy of iecSasPort */
+    IEC_CLI_TLV_SAS_PHY     = 0x10,
+    /* IEC_CLI_TLV_SMART_ATTR_REC, one per attribute of iecSmartRead */
+    IEC_CLI_TLV_SMART_ATTR  = 0x11,
+    /* IEC_CLI_TLV_SMART_TIME_REC, self test times of iecSmartRead */
+    IEC_CLI_TLV_SMART_TIME  = 0x12,
+    /* IEC_CLI_TLV_GPIO_REC, one per pin of iecGPIO */
+    IEC_CLI_TLV_GPIO        = 0x13
+} IEC_CLI_TLV_TYPE;
+
+/*
+** Typedefs
+*/
+
+/* TLV record values. Only byte fields, so there is no padding, multi byte
+ * values are little endian.
+ */
+typedef struct _IEC_CLI_TLV_STATUS_REC
+{
+    /* CLI_STATUS returned by the command */
+    U8  Status;
+    /* Severity of the status: 0 none, 1 usage error, 2 failure */
+    U8  Severity;
+} IEC_CLI_TLV_STATUS_REC;
+
+typedef struct _IEC_CLI_TLV_SAS_PHY_REC
+{
+    U8  Port;
+    U8  Phy;
+    U8  LinkStatus;
+    /* Link rate, IEC_PHY_SPEED_DISABLED if the phy is disabled */
+    U8  LinkRate;
+} IEC_CLI_TLV_SAS_PHY_REC;
+
+typedef struct _IEC_CLI_TLV_SMART_ATTR_REC
+{
+    U8  AttrId;
+    U8  Flags[2];
+    U8  CurrentValue;
+    U8  Worst;
+    U8  Raw[6];
+    U8  Threshold;
+} IEC_CLI_TLV_SMART_ATTR_REC;
+
+typedef struct _IEC_CLI_TLV_SMART_TIME_REC
+{
+    /* Recommended polling times in minutes */
+    U8  ShortTest;
+    U8  ExtendTestB;
+    U8  ExtendTestW[2];
+} IEC_CLI_TLV_SMART_TIME_REC;
+
+typedef struct _IEC_CLI_TLV_GPIO_REC
+{
+    U8  Pin;
+    /* IEC_GPIO_DIRECTION */
+    U8  Direction;
+    U8  Value;
+} IEC_CLI_TLV_GPIO_REC;
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+void iecCliOutWrite(FILE *PtrOutFileHandle, const U8 *PtrData, U32 Length);
+
+int iecCliOutPutc(int Char, FILE *PtrOutFileHandle);
+
+void iecCliOutPuts(const char *PtrString, FILE *PtrOutFileHandle);
+
+int iecCliOutPrintf(FILE *PtrOutFileHandle, const char *PtrFormat, ...);
+
+void iecCliOutFlush(FILE *PtrOutFileHandle);
+
+void iecCliOutSetMode(FILE *PtrOutFileHandle, IEC_CLI_OUT_MODE Mode);
+
+void iecCliOutSetSink(FILE *PtrOutFileHandle,
+                      PTR_IEC_CLI_OUT_SINK FptrSink,
+                      void *PtrArg);
+
+BOOL iecCliOutTlvMode(FILE *PtrOutFileHandle);
+
+void iecCliOutTlv(FILE *PtrOutFileHandle,
+                  U8 Type,
+                  const void *PtrValue,
+                  U16 Length);
+
+void iecCliHexDump(FILE *PtrOutFileHandle,
+                   const void *PtrData,
+                   U32 Size,
+                   U32 Flags);
+
+U32 iecCliOutGetTicks(void);
+
+
+#endif
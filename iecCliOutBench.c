@@ -0,0 +1,213 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliOutBench.c
+ *          Title:  Host benchmark of the iecCliOut.c hex dump
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  Host benchmark of iecCliHexDump(). It is linked with the CLI sources and
+ *  the host HAL shims, with -DHOSTTEST and -lpthread. Build it with
+ *  -O2 and without sanitizers for figures that mean something. The output
+ *  goes through the session output buffer to a sink that counts the bytes,
+ *  so the figures are the formatting cost alone. It prints the bytes of
+ *  data dumped per second and returns 0 unless a dump printed nothing.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include <time.h>
+#include "iec.h"
+#include "iecCliSession.h"
+#include "iecCliOut.h"
+
+#define IEC_CLI_BENCH_DATA_SIZE     (4096)
+#define IEC_CLI_BENCH_LOOPS         (2000)
+
+static U8  sIecCliBenchData[IEC_CLI_BENCH_DATA_SIZE];
+static U32 sIecCliBenchSinkBytes;
+
+/**
+ * @Name:   iecCliBenchNow()
+ *
+ * @Description: This function reads the monotonic clock.
+ *
+ * @return - Time in seconds.
+ *
+ *****************************************************************************/
+static double iecCliBenchNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+/**
+ * @Name:   iecCliBenchSink()
+ *
+ * @Description: This function is the output sink of the benchmark session.
+ *               It counts the bytes and drops them.
+ *
+ * @param PtrArg - Not used.
+ *
+ * @param PtrData - Output data.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void iecCliBenchSink(void *PtrArg, const U8 *PtrData, U32 Length)
+{
+    sIecCliBenchSinkBytes += Length;
+}
+
+/**
+ * @Name:   iecCliBenchByteDump()
+ *
+ * @Description: This function is the per byte CLI_PRINTF() dump of
+ *               iecCliRawDataPrintf() before iecCliHexDump() replaced it,
+ *               kept as the baseline.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information
+ *                structure.
+ *
+ * @param PtrData - Data to print.
+ *
+ * @param DataSize - Number of bytes to print.
+ *
+ *****************************************************************************/
+static void iecCliBenchByteDump(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                                const U8 *PtrData,
+                                U16 DataSize)
+{
+    U16 idx;
+
+    CLI_PRINTF("00000000: ");
+
+    for (idx = 0; idx < DataSize; idx++)
+    {
+        /* print 16 bytes each line. */
+        if (idx && (idx % 16 == 0))
+        {
+            CLI_PRINTF("\r\n");
+            CLI_PRINTF("%08X: ", idx);
+        }
+
+        CLI_PRINTF("%02X ", PtrData[idx]);
+    }
+
+    CLI_PRINTF("\r\n");
+}
+
+/**
+ * @Name:   iecCliBenchReport()
+ *
+ * @Description: This function prints the rate of one dump variant.
+ *
+ * @param PtrName - Name of the variant.
+ *
+ * @param StartTime - Time the IEC_CLI_BENCH_LOOPS dumps started.
+ *
+ * @return - 1 if the dumps printed nothing, else 0.
+ *
+ *****************************************************************************/
+static U32 iecCliBenchReport(const char *PtrName, double StartTime)
+{
+    double elapsed = iecCliBenchNow() - StartTime;
+
+    printf("hexdump: %-28s %6.1f MB/s of data, %u output bytes per dump\n",
+           PtrName,
+           ((double)IEC_CLI_BENCH_DATA_SIZE * IEC_CLI_BENCH_LOOPS) / elapsed / 1e6,
+           sIecCliBenchSinkBytes / IEC_CLI_BENCH_LOOPS);
+
+    if (sIecCliBenchSinkBytes == 0)
+    {
+        return 1;
+    }
+
+    sIecCliBenchSinkBytes = 0;
+    return 0;
+}
+
+int main(void)
+{
+    CLI_SESSION_INFO sessionInfo;
+    PTR_CLI_SESSION_INFO PtrSessionInfo = &sessionInfo;
+    FILE       *ptrOut = &sessionInfo.OutFileHandle;
+    double      startTime;
+    U32         loopCount;
+    U32         index;
+    U32         errors = 0;
+
+    /* Mixed data with a 1 KiB run of zeros, as a cleared buffer has */
+    for (index = 0; index < IEC_CLI_BENCH_DATA_SIZE; index++)
+    {
+        sIecCliBenchData[index] = (U8)((index * 7) ^ (index >> 3));
+    }
+    memset(&sIecCliBenchData[1024], 0, 1024);
+
+    memset(&sessionInfo, 0, sizeof(sessionInfo));
+    if (iecCliSessionCtxAlloc(&sessionInfo) == NULL)
+    {
+        printf("hexdump: no session context\n");
+        return 1;
+    }
+    iecCliOutSetSink(ptrOut, iecCliBenchSink, NULL);
+
+    startTime = iecCliBenchNow();
+    for (loopCount = 0; loopCount < IEC_CLI_BENCH_LOOPS; loopCount++)
+    {
+        iecCliBenchByteDump(PtrSessionInfo, sIecCliBenchData, IEC_CLI_BENCH_DATA_SIZE);
+        iecCliOutFlush(ptrOut);
+    }
+    errors += iecCliBenchReport("per byte CLI_PRINTF", startTime);
+
+    startTime = iecCliBenchNow();
+    for (loopCount = 0; loopCount < IEC_CLI_BENCH_LOOPS; loopCount++)
+    {
+        iecCliHexDump(ptrOut, sIecCliBenchData, IEC_CLI_BENCH_DATA_SIZE, 0);
+        iecCliOutFlush(ptrOut);
+    }
+    errors += iecCliBenchReport("iecCliHexDump", startTime);
+
+    startTime = iecCliBenchNow();
+    for (loopCount = 0; loopCount < IEC_CLI_BENCH_LOOPS; loopCount++)
+    {
+        iecCliHexDump(ptrOut, sIecCliBenchData, IEC_CLI_BENCH_DATA_SIZE,
+                      IEC_CLI_HEXDUMP_ASCII);
+        iecCliOutFlush(ptrOut);
+    }
+    errors += iecCliBenchReport("iecCliHexDump ASCII", startTime);
+
+    startTime = iecCliBenchNow();
+    for (loopCount = 0; loopCount < IEC_CLI_BENCH_LOOPS; loopCount++)
+    {
+        iecCliHexDump(ptrOut, sIecCliBenchData, IEC_CLI_BENCH_DATA_SIZE,
+                      IEC_CLI_HEXDUMP_ASCII | IEC_CLI_HEXDUMP_COLLAPSE);
+        iecCliOutFlush(ptrOut);
+    }
+    errors += iecCliBenchReport("iecCliHexDump ASCII+COLLAPSE", startTime);
+
+    iecCliOutSetSink(ptrOut, NULL, NULL);
+    iecCliSessionCtxFree(&sessionInfo);
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,441 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliPipe.c
+ *          Title:  IEC CLI Output Pipe Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Each session context has a static pipe, the pipe is no
+ *                  longer allocated per command. Blank lines are counted.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli output pipes.
+ *  Each session context has one pipe, in a static table, used while a
+ *  command with filter stages runs; a session runs one pipe at a time.
+ *  While the command runs the pipe is the output sink of the session. The output blocks are
+ *  cut into lines, each line goes through the stages in order, and the
+ *  lines that pass all of them are collected and written out once per
+ *  block, to the sink the session had before or to its file handle.
+ *  When head has all its lines the command is asked to stop like on
+ *  Ctrl-C, through CLI_CANCELLED(). A command that does not check it runs
+ *  to its end, its output is dropped.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "cliCore.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliPipe.h"
+#include "iecCliCore.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
+
+
+/* Pipe of each session context */
+static IEC_CLI_PIPE sIecCliPipe[IEC_CLI_MAX_SESSIONS];
+
+
+/**
+ * @Name:   iecCliPipeParse()
+ *
+ * @Description: This function parses the stage text of the pipe into its
+ *               stages. The text is split in place. A grep text with
+ *               delimiters or '|' is given in double quotes.
+ *
+ * @param PtrPipe - Pipe, with the stage text.
+ *
+ * @return CLI_STATUS_SUCCESS,
+ *         CLI_STATUS_INVALID_SYNTAX for an unknown or incomplete stage,
+ *         CLI_STATUS_INVALID_PARAMETER for a bad head line number,
+ *         CLI_STATUS_INVALID_PARAM_NUM if there are too many stages.
+ *
+ *****************************************************************************/
+static CLI_STATUS iecCliPipeParse(PTR_IEC_CLI_PIPE PtrPipe)
+{
+    PTR_IEC_CLI_PIPE_STAGE ptrStage;
+    char *ptrName = (char *)PtrPipe->Text;
+    char *ptrNext;
+    char *ptrArg;
+    char *ptrEnd;
+    BOOL quoted;
+
+    while (ptrName != NULL)
+    {
+        /* Split at the next separator outside double quotes */
+        ptrNext = NULL;
+        quoted = FALSE;
+        for (ptrEnd = ptrName; *ptrEnd != '\0'; ptrEnd++)
+        {
+            if (*ptrEnd == '"')
+            {
+                quoted = !quoted;
+            }
+            else if ((*ptrEnd == IEC_CLI_PIPE_SEPARATOR) && (quoted == FALSE))
+            {
+                *ptrEnd = '\0';
+                ptrNext = ptrEnd + 1;
+                break;
+            }
+        }
+
+        if (PtrPipe->StageCount == IEC_CLI_PIPE_MAX_STAGES)
+        {
+            return CLI_STATUS_INVALID_PARAM_NUM;
+        }
+
+        /* Stage name, then the argument without the delimiters around it */
+        ptrName += strspn(ptrName, CLI_CMD_DELIMS);
+        ptrArg = ptrName + strcspn(ptrName, CLI_CMD_DELIMS);
+        if (*ptrArg != '\0')
+        {
+            *ptrArg++ = '\0';
+            ptrArg += strspn(ptrArg, CLI_CMD_DELIMS);
+        }
+
+        ptrEnd = ptrArg + strlen(ptrArg);
+        while ((ptrEnd > ptrArg) && (strchr(CLI_CMD_DELIMS, ptrEnd[-1]) != NULL))
+        {
+            *--ptrEnd = '\0';
+        }
+
+        if ((ptrEnd - ptrArg >= 2) && (*ptrArg == '"') && (ptrEnd[-1] == '"'))
+        {
+            ptrEnd[-1] = '\0';
+            ptrArg++;
+        }
+
+        ptrStage = &PtrPipe->Stage[PtrPipe->StageCount];
+        ptrStage->Lines = 0;
+
+        if ((strcmp(ptrName, "grep") == 0) && (*ptrArg != '\0'))
+        {
+            ptrStage->Type = IEC_CLI_PIPE_STAGE_GREP;
+            ptrStage->PtrPattern = ptrArg;
+        }
+        else if (strcmp(ptrName, "head") == 0)
+        {
+            ptrStage->Type = IEC_CLI_PIPE_STAGE_HEAD;
+            ptrStage->Limit = IEC_CLI_PIPE_HEAD_DEFAULT;
+            if ((*ptrArg != '\0')
+                && ((cliParseU32((const U8 *)ptrArg, 10, &ptrStage->Limit) == FALSE)
+                    || (ptrStage->Limit == 0)))
+            {
+                return CLI_STATUS_INVALID_PARAMETER;
+            }
+        }
+        else if ((strcmp(ptrName, "count") == 0) && (*ptrArg == '\0')
+                 && (ptrNext == NULL))
+        {
+            ptrStage->Type = IEC_CLI_PIPE_STAGE_COUNT;
+        }
+        else
+        {
+            return CLI_STATUS_INVALID_SYNTAX;
+        }
+
+        PtrPipe->StageCount++;
+        ptrName = ptrNext;
+    }
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   iecCliPipeWrite()
+ *
+ * @Description: This function writes the lines kept by the pipe to the
+ *               next sink, or to the session file handle.
+ *
+ * @param PtrPipe - Pipe.
+ *
+ *****************************************************************************/
+static void iecCliPipeWrite(PTR_IEC_CLI_PIPE PtrPipe)
+{
+    FILE *ptrOutFileHandle = &(PtrPipe->PtrSessionInfo->OutFileHandle);
+
+    if (PtrPipe->OutCount == 0)
+    {
+        return;
+    }
+
+    if (PtrPipe->FptrNextSink != NULL)
+    {
+        PtrPipe->FptrNextSink(PtrPipe->PtrNextSinkArg, PtrPipe->OutBuf, PtrPipe->OutCount);
+    }
+    else
+    {
+        fwrite(PtrPipe->OutBuf, 1, PtrPipe->OutCount, ptrOutFileHandle);
+        fflush(ptrOutFileHandle);
+    }
+
+    PtrPipe->OutCount = 0;
+}
+
+/**
+ * @Name:   iecCliPipeKeep()
+ *
+ * @Description: This function adds bytes to the output of the pipe.
+ *
+ * @param PtrPipe - Pipe.
+ *
+ * @param PtrData - Bytes.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void iecCliPipeKeep(PTR_IEC_CLI_PIPE PtrPipe, const U8 *PtrData, U32 Length)
+{
+    U32 chunk;
+
+    while (Length > 0)
+    {
+        if (PtrPipe->OutCount == IEC_CLI_PIPE_OUT_SIZE)
+        {
+            iecCliPipeWrite(PtrPipe);
+        }
+
+        chunk = IEC_CLI_PIPE_OUT_SIZE - PtrPipe->OutCount;
+        if (chunk > Length)
+        {
+            chunk = Length;
+        }
+
+        memcpy(&PtrPipe->OutBuf[PtrPipe->OutCount], PtrData, chunk);
+        PtrPipe->OutCount += chunk;
+        PtrData += chunk;
+        Length -= chunk;
+    }
+}
+
+/**
+ * @Name:   iecCliPipeLine()
+ *
+ * @Description: This function passes the collected line through the stages
+ *               and keeps it if none of them drops it.
+ *
+ * @param PtrPipe - Pipe.
+ *
+ *****************************************************************************/
+static void iecCliPipeLine(PTR_IEC_CLI_PIPE PtrPipe)
+{
+    PTR_IEC_CLI_PIPE_STAGE ptrStage;
+    U32 length = PtrPipe->LineLength;
+    U32 index;
+
+    PtrPipe->LineLength = 0;
+
+    /* The text of the line, without its line end */
+    while ((length > 0)
+           && ((PtrPipe->Line[length - 1] == '\r') || (PtrPipe->Line[length - 1] == '\n')))
+    {
+        length--;
+    }
+
+    for (index = 0; index < PtrPipe->StageCount; index++)
+    {
+        ptrStage = &PtrPipe->Stage[index];
+
+        switch (ptrStage->Type)
+        {
+            case IEC_CLI_PIPE_STAGE_GREP:
+                PtrPipe->Line[length] = '\0';
+                if (strstr((const char *)PtrPipe->Line, ptrStage->PtrPattern) == NULL)
+                {
+                    return;
+                }
+                break;
+
+            case IEC_CLI_PIPE_STAGE_HEAD:
+                ptrStage->Lines++;
+                if (ptrStage->Lines == ptrStage->Limit)
+                {
+                    /* The output after this line is not needed */
+                    PtrPipe->Stopped = TRUE;
+                    iecCliInCancel(&(PtrPipe->PtrSessionInfo->OutFileHandle));
+                }
+                break;
+
+            case IEC_CLI_PIPE_STAGE_COUNT:
+                ptrStage->Lines++;
+                return;
+
+            default:
+                return;
+        }
+    }
+
+    iecCliPipeKeep(PtrPipe, PtrPipe->Line, length);
+    iecCliPipeKeep(PtrPipe, (const U8 *)"\r\n", 2);
+}
+
+/**
+ * @Name:   iecCliPipeFilter()
+ *
+ * @Description: This function cuts the output of the command into lines
+ *               and filters them. It is the output sink of the session
+ *               while the command runs.
+ *
+ * @param PtrArg - Pipe.
+ *
+ * @param PtrData - Output of the command.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void iecCliPipeFilter(void *PtrArg, const U8 *PtrData, U32 Length)
+{
+    PTR_IEC_CLI_PIPE ptrPipe = (PTR_IEC_CLI_PIPE)PtrArg;
+    U8 ch;
+
+    for ( ; (Length > 0) && (ptrPipe->Stopped == FALSE); Length--)
+    {
+        ch = *PtrData++;
+
+        ptrPipe->Line[ptrPipe->LineLength++] = ch;
+        if ((ch == '\n') || (ptrPipe->LineLength == IEC_CLI_PIPE_LINE_SIZE))
+        {
+            iecCliPipeLine(ptrPipe);
+        }
+    }
+
+    iecCliPipeWrite(ptrPipe);
+}
+
+/**
+ * @Name:   iecCliPipeStart()
+ *
+ * @Description: This function sets up the filter stages of a command. The
+ *               output of the session goes through them until
+ *               iecCliPipeEnd() is called.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @param PtrStages - Stage text, the command line after the first '|'.
+ *
+ * @param PtrPtrPipe - Returns the pipe.
+ *
+ * @return CLI_STATUS_SUCCESS,
+ *         CLI_STATUS_INVALID_MODE if the session output is not text,
+ *         CLI_STATUS_INSUFF_MEM if the pipe of the session is in use,
+ *         or the error of iecCliPipeParse().
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliPipeStart(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                           const U8 *PtrStages,
+                           PTR_IEC_CLI_PIPE *PtrPtrPipe)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    PTR_IEC_CLI_PIPE ptrPipe;
+    CLI_STATUS status;
+
+    *PtrPtrPipe = NULL;
+
+    if ((ptrCtx == NULL)
+        || (iecCliOutTlvMode(&(PtrSessionInfo->OutFileHandle)) == TRUE))
+    {
+        return CLI_STATUS_INVALID_MODE;
+    }
+
+    /* The output already goes through the pipe, e.g. a batch run by a
+     * command of a pipe
+     */
+    ptrPipe = &sIecCliPipe[iecCliSessionCtxIndex(ptrCtx)];
+    if (ptrCtx->PtrOutSinkArg == ptrPipe)
+    {
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    memset(ptrPipe, 0, sizeof(*ptrPipe));
+    ptrPipe->PtrSessionInfo = PtrSessionInfo;
+    strncpy((char *)ptrPipe->Text, (const char *)PtrStages,
+            CLI_MAX_CMD_LINE_LENGTH - 1);
+
+    status = iecCliPipeParse(ptrPipe);
+    if (status != CLI_STATUS_SUCCESS)
+    {
+        return status;
+    }
+
+    /* A job or a watch still gets the lines kept */
+    ptrPipe->FptrNextSink = ptrCtx->FptrOutSink;
+    ptrPipe->PtrNextSinkArg = ptrCtx->PtrOutSinkArg;
+
+    /* The first kept line does not go on the prompt line */
+    iecCliPipeKeep(ptrPipe, (const U8 *)"\r\n", 2);
+
+    /* The output so far, e.g. the echo, does not go through the pipe */
+    iecCliOutSetSink(&(PtrSessionInfo->OutFileHandle), iecCliPipeFilter, ptrPipe);
+
+    *PtrPtrPipe = ptrPipe;
+
+    return CLI_STATUS_SUCCESS;
+}
+
+/**
+ * @Name:   iecCliPipeEnd()
+ *
+ * @Description: This function filters the rest of the output of the
+ *               command, writes the line count of a count stage and gives
+ *               the session output back to where it went before.
+ *
+ * @param PtrPipe - Pipe.
+ *
+ * @param Status - Status of the command.
+ *
+ * @return status of the command, CLI_STATUS_SUCCESS if it was stopped by
+ *         head.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliPipeEnd(PTR_IEC_CLI_PIPE PtrPipe, CLI_STATUS Status)
+{
+    PTR_IEC_CLI_PIPE_STAGE ptrLast = &PtrPipe->Stage[PtrPipe->StageCount - 1];
+    char count[16];
+
+    /* Also flushes the rest of the output into the pipe */
+    iecCliOutSetSink(&(PtrPipe->PtrSessionInfo->OutFileHandle),
+                     PtrPipe->FptrNextSink,
+                     PtrPipe->PtrNextSinkArg);
+
+    /* A last line without line end. An empty fragment, e.g. a CR alone,
+     * is not a line.
+     */
+    PtrPipe->Line[PtrPipe->LineLength] = '\0';
+    if ((strspn((const char *)PtrPipe->Line, "\r\n") < PtrPipe->LineLength)
+        && (PtrPipe->Stopped == FALSE))
+    {
+        iecCliPipeLine(PtrPipe);
+    }
+
+    if (ptrLast->Type == IEC_CLI_PIPE_STAGE_COUNT)
+    {
+        snprintf(count, sizeof(count), "%u\r\n", ptrLast->Lines);
+        iecCliPipeKeep(PtrPipe, (const U8 *)count, strlen(count));
+    }
+
+    iecCliPipeWrite(PtrPipe);
+
+    if ((PtrPipe->Stopped == TRUE) && (Status == CLI_STATUS_CANCELLED))
+    {
+        Status = CLI_STATUS_SUCCESS;
+    }
+
+    return Status;
+}
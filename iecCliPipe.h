@@ -0,0 +1,128 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliPipe.h
+ *          Title:  iec CLI Output Pipe Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Blank lines go through the stages like the other lines.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli output pipes. A command may be
+ *  followed by filter stages, e.g. "help | grep iec | head 3":
+ *      grep <text>     keeps the lines containing text
+ *      head [n]        keeps the first n lines, 10 by default, and stops
+ *                      the command once they are out
+ *      count           prints the number of lines instead, last stage only
+ *  The filters work on the output stream one line at a time through the
+ *  output sink of the session, the output is never held in full. Every
+ *  line goes through the stages, blank lines too; only an empty fragment
+ *  after the last line end is not a line. The error message of the
+ *  command is not filtered.
+ *  Include this file after iecCliSession.h.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_PIPE_H
+#define _IEC_CLI_PIPE_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Separates a command from its filter stages, and the stages */
+#define IEC_CLI_PIPE_SEPARATOR          '|'
+
+#define IEC_CLI_PIPE_MAX_STAGES         (4)
+
+/* Longer lines are filtered in pieces of this size */
+#define IEC_CLI_PIPE_LINE_SIZE          (160)
+
+/* Lines kept by the pipe are collected in a buffer of this size before
+ * they are written
+ */
+#define IEC_CLI_PIPE_OUT_SIZE           (256)
+
+/* Number of lines kept by head without a number */
+#define IEC_CLI_PIPE_HEAD_DEFAULT       (10)
+
+/*
+** Macros
+*/
+
+/*
+** Enumerated types
+*/
+
+typedef enum _IEC_CLI_PIPE_STAGE_TYPE
+{
+    IEC_CLI_PIPE_STAGE_GREP = 0,
+    IEC_CLI_PIPE_STAGE_HEAD,
+    IEC_CLI_PIPE_STAGE_COUNT
+} IEC_CLI_PIPE_STAGE_TYPE;
+
+/*
+** Typedefs
+*/
+
+typedef struct _IEC_CLI_PIPE_STAGE
+{
+    /* IEC_CLI_PIPE_STAGE_TYPE */
+    U32                     Type;
+    /* Text searched by grep, in the stage text of the pipe */
+    const char             *PtrPattern;
+    /* Number of lines kept by head */
+    U32                     Limit;
+    /* Lines kept by head, or counted by count */
+    U32                     Lines;
+} IEC_CLI_PIPE_STAGE, *PTR_IEC_CLI_PIPE_STAGE;
+
+typedef struct _IEC_CLI_PIPE
+{
+    PTR_CLI_SESSION_INFO    PtrSessionInfo;
+    /* Output sink the kept lines go to, NULL for the session file handle */
+    PTR_IEC_CLI_OUT_SINK    FptrNextSink;
+    void                   *PtrNextSinkArg;
+    /* TRUE once head has all its lines, the rest of the output is dropped */
+    BOOL                    Stopped;
+    U32                     StageCount;
+    IEC_CLI_PIPE_STAGE      Stage[IEC_CLI_PIPE_MAX_STAGES];
+    /* Copy of the stage text, the grep patterns point into it */
+    U8                      Text[CLI_MAX_CMD_LINE_LENGTH];
+    /* Line being collected, with room for a terminator */
+    U32                     LineLength;
+    U8                      Line[IEC_CLI_PIPE_LINE_SIZE + 1];
+    U32                     OutCount;
+    U8                      OutBuf[IEC_CLI_PIPE_OUT_SIZE];
+} IEC_CLI_PIPE, *PTR_IEC_CLI_PIPE;
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+CLI_STATUS iecCliPipeStart(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                           const U8 *PtrStages,
+                           PTR_IEC_CLI_PIPE *PtrPtrPipe);
+
+CLI_STATUS iecCliPipeEnd(PTR_IEC_CLI_PIPE PtrPipe, CLI_STATUS Status);
+
+
+#endif
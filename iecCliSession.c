@@ -0,0 +1,302 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliSession.c
+ *          Title:  IEC CLI Session Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added iecCliSessionInit(), the reader handles of the
+ *                  contexts start as HALI_OS_INVALID_HANDLE.
+ *  10/18/26  AW    Reset ReadOnly when a context is allocated.
+ *  10/18/26  AW    Removed the reset of the thread completion flag.
+ *  10/18/26  AW    Added iecCliSessionCtxIndex().
+ *  10/18/26  AW    Reset the input reader state when a context is allocated.
+ *  10/18/26  AW    Reset NoFile when a context is allocated.
+ *  10/18/26  AW    Reset the thread entry and its completion flag when a
+ *                  context is allocated.
+ *  10/18/26  AW    Reset NoInput when a context is allocated.
+ *  10/18/26  AW    Reset the output sink when a context is allocated.
+ *  10/18/26  AW    Reset the cancel request when a context is allocated.
+ *  10/18/26  AW    Reset the last command status and the job when a context
+ *                  is allocated.
+ *  10/18/26  AW    Reset the command batch option when a context is
+ *                  allocated.
+ *  10/18/26  AW    Empty the input queue when a context is allocated.
+ *  10/18/26  AW    Added iecCliSessionHistory(). The history of the
+ *                  session is cleared when its context is allocated.
+ *  10/18/26  AW    Reset the line editor when a context is allocated.
+ *  10/18/26  AW    Reset the output mode when a context is allocated.
+ *  10/18/26  AW    Clear the output buffer when a context is allocated.
+ *                  Added iecCliSessionCtxAt().
+ *  10/18/26  AW    Clear ArgValue when a context is allocated.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli session context module.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
+
+
+/* Session context table. A context is claimed with an atomic compare and
+ * swap on PtrSessionInfo, so session threads never need a lock to find
+ * their own context.
+ */
+static IEC_CLI_SESSION_CTX sIecCliSessionCtx[IEC_CLI_MAX_SESSIONS];
+
+#ifdef IEC_CLI_HISTORY_SHARED
+/* Command history shared by all sessions */
+static CLI_CMD_HISTORY sIecCliSharedHistory;
+#endif
+
+
+/**
+ * @Name:   iecCliSessionInit()
+ *
+ * @Description: This function initializes the session contexts. The input
+ *               reader objects are reserved on first use and kept by the
+ *               context across sessions, so they are marked as not reserved
+ *               once, here. Called by cliCoreInit() before any session is
+ *               created.
+ *
+ *****************************************************************************/
+void iecCliSessionInit(void)
+{
+    U32 index;
+
+    for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+    {
+        sIecCliSessionCtx[index].ReaderThreadHandle = HALI_OS_INVALID_HANDLE;
+        sIecCliSessionCtx[index].ReaderSemHandle = HALI_OS_INVALID_HANDLE;
+        sIecCliSessionCtx[index].PtrReaderStack = NULL;
+    }
+}
+
+/**
+ * @Name:   iecCliSessionCtxAlloc()
+ *
+ * @Description: This function allocates a session context for the session.
+ *               If the session already owns a context, that one is returned.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return pointer to the session context, NULL if all contexts are in use.
+ *
+ *****************************************************************************/
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxAlloc(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx;
+    U32 index;
+
+    ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    if (ptrCtx != NULL)
+    {
+        return ptrCtx;
+    }
+
+    for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+    {
+        ptrCtx = &sIecCliSessionCtx[index];
+
+        if (__sync_bool_compare_and_swap(&ptrCtx->PtrSessionInfo,
+                                         NULL,
+                                         PtrSessionInfo))
+        {
+            ptrCtx->TokenCount = 0;
+            memset(ptrCtx->TokenSpan, 0, sizeof(ptrCtx->TokenSpan));
+            memset(ptrCtx->ArgValue, 0, sizeof(ptrCtx->ArgValue));
+            ptrCtx->OutCount = 0;
+            ptrCtx->OutLines = 0;
+            ptrCtx->OutMode = IEC_CLI_OUT_MODE_TEXT;
+            memset(&ptrCtx->OutStats, 0, sizeof(ptrCtx->OutStats));
+            ptrCtx->FptrOutSink = NULL;
+            ptrCtx->PtrOutSinkArg = NULL;
+            ptrCtx->InHead = 0;
+            ptrCtx->InCount = 0;
+            memset(&ptrCtx->Editor, 0, sizeof(ptrCtx->Editor));
+            ptrCtx->BatchStopOnError = FALSE;
+            ptrCtx->LastStatus = CLI_STATUS_SUCCESS;
+            ptrCtx->CancelRequest = FALSE;
+            ptrCtx->ReaderState = IEC_CLI_IN_READER_IDLE;
+            ptrCtx->PtrJob = NULL;
+            ptrCtx->NoInput = FALSE;
+            ptrCtx->NoFile = FALSE;
+            ptrCtx->ReadOnly = FALSE;
+            ptrCtx->ReadOnlyRefused = FALSE;
+            ptrCtx->FptrThreadEntry = NULL;
+#ifndef IEC_CLI_HISTORY_SHARED
+            memset(&ptrCtx->History, 0, sizeof(ptrCtx->History));
+#endif
+
+            return ptrCtx;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   iecCliSessionCtxFree()
+ *
+ * @Description: This function releases the session context of the session.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ *****************************************************************************/
+void iecCliSessionCtxFree(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+
+    if (ptrCtx != NULL)
+    {
+        __sync_bool_compare_and_swap(&ptrCtx->PtrSessionInfo,
+                                     PtrSessionInfo,
+                                     NULL);
+    }
+}
+
+/**
+ * @Name:   iecCliSessionCtxGet()
+ *
+ * @Description: This function returns the session context of the session.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @return pointer to the session context, NULL if the session has none.
+ *
+ *****************************************************************************/
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxGet(PTR_CLI_SESSION_INFO PtrSessionInfo)
+{
+    U32 index;
+
+    if (PtrSessionInfo == NULL)
+    {
+        return NULL;
+    }
+
+    for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+    {
+        if (sIecCliSessionCtx[index].PtrSessionInfo == PtrSessionInfo)
+        {
+            return &sIecCliSessionCtx[index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   iecCliSessionCtxFromFile()
+ *
+ * @Description: This function returns the session context of the session
+ *               owning the given output file handle. It is used by the
+ *               functions that only get the session file handle, like
+ *               cliGetString().
+ *
+ * @param PtrFileHandle - Output file handle of the session.
+ *
+ * @return pointer to the session context, NULL if not found.
+ *
+ *****************************************************************************/
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxFromFile(FILE *PtrFileHandle)
+{
+    PTR_CLI_SESSION_INFO ptrSessionInfo;
+    U32 index;
+
+    for (index = 0; index < IEC_CLI_MAX_SESSIONS; index++)
+    {
+        ptrSessionInfo = sIecCliSessionCtx[index].PtrSessionInfo;
+
+        if ((ptrSessionInfo != NULL)
+            && (&(ptrSessionInfo->OutFileHandle) == PtrFileHandle))
+        {
+            return &sIecCliSessionCtx[index];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @Name:   iecCliSessionCtxAt()
+ *
+ * @Description: This function returns the session context at the given
+ *               index of the context table, if it is in use. It is used to
+ *               list the sessions.
+ *
+ * @param Index - Index in the context table, 0 to IEC_CLI_MAX_SESSIONS - 1.
+ *
+ * @return pointer to the session context, NULL if the index is out of range
+ *         or the context is free.
+ *
+ *****************************************************************************/
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxAt(U32 Index)
+{
+    if ((Index >= IEC_CLI_MAX_SESSIONS)
+        || (sIecCliSessionCtx[Index].PtrSessionInfo == NULL))
+    {
+        return NULL;
+    }
+
+    return &sIecCliSessionCtx[Index];
+}
+
+/**
+ * @Name:   iecCliSessionCtxIndex()
+ *
+ * @Description: This function returns the index of a session context in
+ *               the context table. It is used by the modules keeping a
+ *               static object per context, like the pipes.
+ *
+ * @param PtrCtx - Session context.
+ *
+ * @return index in the context table, 0 to IEC_CLI_MAX_SESSIONS - 1.
+ *
+ *****************************************************************************/
+U32 iecCliSessionCtxIndex(PTR_IEC_CLI_SESSION_CTX PtrCtx)
+{
+    return (U32)(PtrCtx - sIecCliSessionCtx);
+}
+
+/**
+ * @Name:   iecCliSessionHistory()
+ *
+ * @Description: This function returns the command history used by the
+ *               session, its own history or, with IEC_CLI_HISTORY_SHARED,
+ *               the history shared by all sessions.
+ *
+ * @param PtrCtx - Session context, may be NULL.
+ *
+ * @return pointer to the command history, NULL if the session has none.
+ *
+ *****************************************************************************/
+PTR_CLI_CMD_HISTORY iecCliSessionHistory(PTR_IEC_CLI_SESSION_CTX PtrCtx)
+{
+#ifdef IEC_CLI_HISTORY_SHARED
+    return &sIecCliSharedHistory;
+#else
+    return (PtrCtx != NULL) ? &PtrCtx->History : NULL;
+#endif
+}
+
@@ -0,0 +1,237 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliSession.h
+ *          Title:  iec CLI Session Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Added iecCliSessionInit().
+ *  10/18/26  AW    Added ReadOnly and ReadOnlyRefused.
+ *  10/18/26  AW    Removed ThreadDone, the cli core signals a semaphore.
+ *  10/18/26  AW    Added iecCliSessionCtxIndex().
+ *  10/18/26  AW    Added the input reader thread.
+ *  10/18/26  AW    Added NoFile.
+ *  10/18/26  AW    Added the command node of the table commands.
+ *  10/18/26  AW    Added the thread entry and its completion flag.
+ *  10/18/26  AW    Added NoInput.
+ *  10/18/26  AW    Added the output sink.
+ *  10/18/26  AW    Added the cancel request.
+ *  10/18/26  AW    Added the background job of a job session and the status
+ *                  of the last command. Room for the job sessions.
+ *  10/18/26  AW    Added the command batch option.
+ *  10/18/26  AW    Added the input queue.
+ *  10/18/26  AW    Added the command history.
+ *  10/18/26  AW    Added the line editor state.
+ *  10/18/26  AW    Added the output mode.
+ *  10/18/26  AW    Added the output buffer and its counters.
+ *  10/18/26  AW    Added ArgValue to the session context.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli session context module.
+ *  A session context holds the per session state of the cli core that
+ *  does not fit in CLI_SESSION_INFO. It is allocated when the session is
+ *  created and released when the session is closed.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_SESSION_H
+#define _IEC_CLI_SESSION_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Maximum number of background jobs running at the same time, see
+ * iecCliJob.h
+ */
+#define IEC_CLI_MAX_JOBS                (4)
+
+/* Maximum number of cli sessions (UART, telnet, SSH, in-band, fault console)
+ * that can have a session context at the same time. Each background job
+ * runs as a session too.
+ */
+#define IEC_CLI_MAX_SESSIONS            (8 + IEC_CLI_MAX_JOBS)
+
+/* Size of the output buffer of a session, see iecCliOut.h */
+#define IEC_CLI_OUT_BUF_SIZE            (512)
+
+/* Size of the input queue of a session, see iecCliIn.h */
+#define IEC_CLI_IN_BUF_SIZE             (512)
+
+/*
+** Macros
+*/
+
+/*
+** Enumerated types
+*/
+
+/*
+** Typedefs
+*/
+
+/* Position of a command line token in the session input string */
+typedef struct _IEC_CLI_TOKEN_SPAN
+{
+    /* Offset of the first token character from the start of the line */
+    U16 Offset;
+    /* Number of characters in the token, without quotes */
+    U16 Length;
+} IEC_CLI_TOKEN_SPAN, *PTR_IEC_CLI_TOKEN_SPAN;
+
+/* Output channel counters of a session */
+typedef struct _IEC_CLI_OUT_STATS
+{
+    /* Bytes written to the output channel */
+    U32 Bytes;
+    /* Write, putc and printf calls on the output channel */
+    U32 Writes;
+    /* Blocks written to the session file handle */
+    U32 Flushes;
+    /* OS ticks spent writing blocks to the session file handle */
+    U32 BlockedTicks;
+    /* Longest single block write, in OS ticks */
+    U32 MaxBlockedTicks;
+} IEC_CLI_OUT_STATS, *PTR_IEC_CLI_OUT_STATS;
+
+/* Receives the output of a session instead of its file handle, see
+ * iecCliOutSetSink(). PtrArg is the argument given with the sink.
+ */
+typedef void (*PTR_IEC_CLI_OUT_SINK)(void *PtrArg, const U8 *PtrData, U32 Length);
+
+typedef struct _IEC_CLI_SESSION_CTX IEC_CLI_SESSION_CTX, *PTR_IEC_CLI_SESSION_CTX;
+
+/* Background job, defined in iecCliJob.h */
+typedef struct _IEC_CLI_JOB IEC_CLI_JOB, *PTR_IEC_CLI_JOB;
+
+struct _IEC_CLI_SESSION_CTX
+{
+    /* Session owning this context, NULL if the context is free */
+    PTR_CLI_SESSION_INFO    PtrSessionInfo;
+
+    /* Number of tokens of the last parsed command line */
+    U32                     TokenCount;
+    /* Spans of the tokens of the last parsed command line */
+    IEC_CLI_TOKEN_SPAN      TokenSpan[CLI_MAX_NUM_OF_TOKENS];
+
+    /* Arguments converted by the command argument schema, indexed like
+     * PtrCmdParams. See CLI_ARG_VALUE().
+     */
+    U32                     ArgValue[CLI_MAX_NUM_OF_TOKENS];
+
+    /* Output not yet written to the session file handle */
+    U16                     OutCount;
+    /* Number of new lines in OutBuf */
+    U16                     OutLines;
+    /* IEC_CLI_OUT_MODE */
+    U8                      OutMode;
+    U8                      OutBuf[IEC_CLI_OUT_BUF_SIZE];
+    IEC_CLI_OUT_STATS       OutStats;
+    /* Output sink and its argument, NULL if the output goes to the
+     * session file handle
+     */
+    PTR_IEC_CLI_OUT_SINK    FptrOutSink;
+    void                   *PtrOutSinkArg;
+
+    /* Input read from the session file handle, not yet used */
+    U16                     InHead;
+    U16                     InCount;
+    U8                      InBuf[IEC_CLI_IN_BUF_SIZE];
+
+    /* Line editor and escape sequence decoder state */
+    IEC_CLI_EDITOR          Editor;
+
+    /* Stop a ';' command batch at the first failing command */
+    BOOL                    BatchStopOnError;
+    /* Status returned by the last command run */
+    CLI_STATUS              LastStatus;
+    /* Ctrl-C received while a command runs, see iecCliInCancelled() */
+    volatile BOOL           CancelRequest;
+    /* Input reader thread, which waits for the input of the session while
+     * a command runs, see iecCliInAvailable(). IEC_CLI_IN_READER_STATE.
+     * The thread object, the semaphore and the stack are reserved on first
+     * use and kept by the context.
+     */
+    volatile U32            ReaderState;
+    /* Character read by the reader thread, HALI_EOF at the end of input */
+    S32                     ReaderChar;
+    HALI_OS_HANDLE          ReaderThreadHandle;
+    HALI_OS_HANDLE          ReaderSemHandle;
+    void                   *PtrReaderStack;
+
+    /* Job run by this session, NULL if it is not a background job. The
+     * output of a job goes to its output ring through the output sink.
+     */
+    PTR_IEC_CLI_JOB         PtrJob;
+    /* The session has no input, e.g. a job or a cliExecToBuffer() session.
+     * Reading it returns HALI_EOF.
+     */
+    BOOL                    NoInput;
+    /* The session file handle is not a file of the file layer, e.g. a job
+     * or a cliExecToBuffer() session. Only the commands whose output can
+     * be captured are run, see cliCmdCaptureSafe().
+     */
+    BOOL                    NoFile;
+    /* Only the read-only handlers are called, see cliHandlerReadOnly().
+     * Set while watch runs its command line. ReadOnlyRefused is set when a
+     * handler is refused.
+     */
+    BOOL                    ReadOnly;
+    BOOL                    ReadOnlyRefused;
+
+    /* Command node of the command being run when it comes from a command
+     * table, which has no node of its own. PtrCurCommand points to it.
+     */
+    CLI_CMD_NODE            CmdNode;
+
+    /* Thread entry of the session, called by the session thread of the
+     * cli core.
+     */
+    PTR_CLI_CMD_PROMPT      FptrThreadEntry;
+
+#ifndef IEC_CLI_HISTORY_SHARED
+    /* Command history of the session, see iecCliSessionHistory() */
+    CLI_CMD_HISTORY         History;
+#endif
+};
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+void iecCliSessionInit(void);
+
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxAlloc(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+void iecCliSessionCtxFree(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxGet(PTR_CLI_SESSION_INFO PtrSessionInfo);
+
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxFromFile(FILE *PtrFileHandle);
+
+PTR_IEC_CLI_SESSION_CTX iecCliSessionCtxAt(U32 Index);
+
+U32 iecCliSessionCtxIndex(PTR_IEC_CLI_SESSION_CTX PtrCtx);
+
+PTR_CLI_CMD_HISTORY iecCliSessionHistory(PTR_IEC_CLI_SESSION_CTX PtrCtx);
+
+
+#endif
@@ -0,0 +1,467 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliWatch.c
+ *          Title:  IEC CLI Watch Source File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Run the command line in read only mode, a watch that
+ *                  would change the device state is refused.
+ *  10/18/26  AW    Restore the command node of the context after the runs.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the source file of the cli watch mode.
+ *  Two frames are kept, the one on the screen and the one being captured;
+ *  they are allocated when the watch starts and freed when it ends. The
+ *  captured output is laid out like a terminal would: CR returns to the
+ *  first column, LF goes to the next row, TAB goes to the next multiple of
+ *  8 columns and escape sequences written by the command are dropped.
+ *  A row of the new frame is compared with the same row of the old frame,
+ *  and each run of changed cells is sent with one cursor move. Changed
+ *  cells less than IEC_CLI_WATCH_GAP apart are sent as one run. A row that
+ *  got shorter is cut with ESC [ K.
+ *
+ *-------------------------------------------------------------------------
+ */
+
+/*
+** Include Files
+*/
+
+#include "iec.h"
+#include "cliCore.h"
+#include "iecCliEditor.h"
+#include "iecCliSession.h"
+#include "iecCliWatch.h"
+#include "iecCliCore.h"
+#include "iecCliOut.h"
+#include "iecCliIn.h"
+
+
+/* States of the escape sequence filter of the capture */
+#define IEC_CLI_WATCH_ESC_NONE          (0)
+#define IEC_CLI_WATCH_ESC_START         (1)
+#define IEC_CLI_WATCH_ESC_CSI           (2)
+
+typedef struct _IEC_CLI_WATCH_FRAME
+{
+    U8                      Cell[IEC_CLI_WATCH_ROWS][IEC_CLI_WATCH_COLS];
+    /* Number of cells written in each row */
+    U8                      Length[IEC_CLI_WATCH_ROWS];
+    /* Number of rows, up to the last row with a cell written */
+    U32                     Rows;
+} IEC_CLI_WATCH_FRAME, *PTR_IEC_CLI_WATCH_FRAME;
+
+typedef struct _IEC_CLI_WATCH
+{
+    /* Frame on the screen and frame being captured */
+    IEC_CLI_WATCH_FRAME     Frame[2];
+    /* Index of the frame being captured */
+    U32                     Next;
+    /* Position the next captured character goes to */
+    U32                     Row;
+    U32                     Col;
+    /* IEC_CLI_WATCH_ESC_xxx */
+    U32                     EscState;
+    /* Cursor position on the screen, in frame cells */
+    U32                     CursorRow;
+    U32                     CursorCol;
+    /* Command line, the tokenizer splits the copy it is given */
+    U8                      Command[CLI_MAX_CMD_LINE_LENGTH];
+    U8                      Line[CLI_MAX_CMD_LINE_LENGTH];
+} IEC_CLI_WATCH, *PTR_IEC_CLI_WATCH;
+
+
+/**
+ * @Name:   iecCliWatchPutCell()
+ *
+ * @Description: This function writes a character at the capture position
+ *               of the frame being captured, and moves to the next column.
+ *               A character outside the frame is dropped.
+ *
+ * @param PtrWatch - Watch.
+ *
+ * @param Char - Character.
+ *
+ *****************************************************************************/
+static void iecCliWatchPutCell(PTR_IEC_CLI_WATCH PtrWatch, U8 Char)
+{
+    PTR_IEC_CLI_WATCH_FRAME ptrFrame = &PtrWatch->Frame[PtrWatch->Next];
+
+    if ((PtrWatch->Row < IEC_CLI_WATCH_ROWS)
+        && (PtrWatch->Col < IEC_CLI_WATCH_COLS))
+    {
+        /* The cells skipped by a TAB or CR are already spaces */
+        ptrFrame->Cell[PtrWatch->Row][PtrWatch->Col] = Char;
+        if (ptrFrame->Length[PtrWatch->Row] <= PtrWatch->Col)
+        {
+            ptrFrame->Length[PtrWatch->Row] = (U8)(PtrWatch->Col + 1);
+        }
+        if (ptrFrame->Rows <= PtrWatch->Row)
+        {
+            ptrFrame->Rows = PtrWatch->Row + 1;
+        }
+    }
+
+    PtrWatch->Col++;
+}
+
+/**
+ * @Name:   iecCliWatchCapture()
+ *
+ * @Description: This function lays the output of the command out in the
+ *               frame being captured. It is the output sink of the session
+ *               while the command runs.
+ *
+ * @param PtrArg - Watch.
+ *
+ * @param PtrData - Output of the command.
+ *
+ * @param Length - Number of bytes.
+ *
+ *****************************************************************************/
+static void iecCliWatchCapture(void *PtrArg, const U8 *PtrData, U32 Length)
+{
+    PTR_IEC_CLI_WATCH ptrWatch = (PTR_IEC_CLI_WATCH)PtrArg;
+    U8 ch;
+
+    for ( ; Length > 0; Length--)
+    {
+        ch = *PtrData++;
+
+        if (ptrWatch->EscState == IEC_CLI_WATCH_ESC_START)
+        {
+            ptrWatch->EscState = (ch == '[') ? IEC_CLI_WATCH_ESC_CSI
+                                             : IEC_CLI_WATCH_ESC_NONE;
+            continue;
+        }
+
+        if (ptrWatch->EscState == IEC_CLI_WATCH_ESC_CSI)
+        {
+            /* A CSI sequence ends with its final byte */
+            if ((ch >= 0x40) && (ch <= 0x7E))
+            {
+                ptrWatch->EscState = IEC_CLI_WATCH_ESC_NONE;
+            }
+            continue;
+        }
+
+        switch (ch)
+        {
+            case '\n':
+                ptrWatch->Row++;
+                ptrWatch->Col = 0;
+                break;
+
+            case '\r':
+                ptrWatch->Col = 0;
+                break;
+
+            case '\t':
+                ptrWatch->Col = (ptrWatch->Col + 8) & ~7U;
+                break;
+
+            case '\b':
+                if (ptrWatch->Col > 0)
+                {
+                    ptrWatch->Col--;
+                }
+                break;
+
+            case IEC_CLI_CHAR_ESC:
+                ptrWatch->EscState = IEC_CLI_WATCH_ESC_START;
+                break;
+
+            default:
+                iecCliWatchPutCell(ptrWatch,
+                                   ((ch < ' ') || (ch == 0x7F)) ? '?' : ch);
+                break;
+        }
+    }
+}
+
+/**
+ * @Name:   iecCliWatchMove()
+ *
+ * @Description: This function moves the cursor to a cell of the frame,
+ *               unless it is already there.
+ *
+ * @param PtrWatch - Watch.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ * @param Row - Row of the cell.
+ *
+ * @param Col - Column of the cell.
+ *
+ *****************************************************************************/
+static void iecCliWatchMove(PTR_IEC_CLI_WATCH PtrWatch,
+                            FILE *PtrOutFileHandle,
+                            U32 Row,
+                            U32 Col)
+{
+    if ((PtrWatch->CursorRow != Row) || (PtrWatch->CursorCol != Col))
+    {
+        iecCliOutPrintf(PtrOutFileHandle, "\x1b[%u;%uH", Row + 1, Col + 1);
+        PtrWatch->CursorRow = Row;
+        PtrWatch->CursorCol = Col;
+    }
+}
+
+/**
+ * @Name:   iecCliWatchDraw()
+ *
+ * @Description: This function sends the cells of the captured frame that
+ *               differ from the frame on the screen, and leaves the cursor
+ *               below the frame. Nothing is sent if no cell changed.
+ *
+ * @param PtrWatch - Watch.
+ *
+ * @param PtrOutFileHandle - Output file handle of the session.
+ *
+ *****************************************************************************/
+static void iecCliWatchDraw(PTR_IEC_CLI_WATCH PtrWatch, FILE *PtrOutFileHandle)
+{
+    PTR_IEC_CLI_WATCH_FRAME ptrOld = &PtrWatch->Frame[PtrWatch->Next ^ 1];
+    PTR_IEC_CLI_WATCH_FRAME ptrNew = &PtrWatch->Frame[PtrWatch->Next];
+    U32 rows = (ptrOld->Rows > ptrNew->Rows) ? ptrOld->Rows : ptrNew->Rows;
+    BOOL changed = FALSE;
+    U32 oldLength;
+    U32 newLength;
+    U32 row;
+    U32 col;
+    U32 start;
+    U32 end;
+
+    for (row = 0; row < rows; row++)
+    {
+        oldLength = ptrOld->Length[row];
+        newLength = ptrNew->Length[row];
+        col = 0;
+
+        while (col < newLength)
+        {
+            if ((col < oldLength)
+                && (ptrOld->Cell[row][col] == ptrNew->Cell[row][col]))
+            {
+                col++;
+                continue;
+            }
+
+            /* Extend the run over the next changed cells close enough */
+            start = col;
+            end = col + 1;
+            for (col = end; (col < newLength) && (col - end < IEC_CLI_WATCH_GAP); col++)
+            {
+                if ((col >= oldLength)
+                    || (ptrOld->Cell[row][col] != ptrNew->Cell[row][col]))
+                {
+                    end = col + 1;
+                }
+            }
+
+            iecCliWatchMove(PtrWatch, PtrOutFileHandle, row, start);
+            iecCliOutWrite(PtrOutFileHandle, &ptrNew->Cell[row][start], end - start);
+            PtrWatch->CursorCol = end;
+            changed = TRUE;
+            col = end;
+        }
+
+        if (oldLength > newLength)
+        {
+            iecCliWatchMove(PtrWatch, PtrOutFileHandle, row, newLength);
+            iecCliOutPuts("\x1b[K", PtrOutFileHandle);
+            changed = TRUE;
+        }
+    }
+
+    if (changed == TRUE)
+    {
+        iecCliWatchMove(PtrWatch, PtrOutFileHandle, ptrNew->Rows, 0);
+        iecCliOutFlush(PtrOutFileHandle);
+    }
+}
+
+/**
+ * @Name:   iecCliWatchFrame()
+ *
+ * @Description: This function runs the command once and captures its output
+ *               in the next frame, below the header row. The command line
+ *               runs in read only mode, see cliHandlerReadOnly().
+ *
+ * @param PtrWatch - Watch.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @param IntervalMs - Interval shown in the header row, in ms.
+ *
+ * @return TRUE if the command was found.
+ *
+ *****************************************************************************/
+static BOOL iecCliWatchFrame(PTR_IEC_CLI_WATCH PtrWatch,
+                             PTR_CLI_SESSION_INFO PtrSessionInfo,
+                             U32 IntervalMs)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    PTR_IEC_CLI_WATCH_FRAME ptrFrame = &PtrWatch->Frame[PtrWatch->Next];
+    BOOL found;
+
+    memset(ptrFrame->Cell, ' ', sizeof(ptrFrame->Cell));
+    memset(ptrFrame->Length, 0, sizeof(ptrFrame->Length));
+    ptrFrame->Rows = 0;
+
+    PtrWatch->Row = 0;
+    PtrWatch->Col = 0;
+    PtrWatch->EscState = IEC_CLI_WATCH_ESC_NONE;
+
+    iecCliOutSetSink(&(PtrSessionInfo->OutFileHandle), iecCliWatchCapture, PtrWatch);
+
+    iecCliOutPrintf(&(PtrSessionInfo->OutFileHandle),
+                    "Every %u ms: %s    (Ctrl-C to stop)\n",
+                    IntervalMs, PtrWatch->Command);
+
+    /* Not set by a command line that is not found */
+    ptrCtx->LastStatus = CLI_STATUS_SUCCESS;
+
+    memcpy(PtrWatch->Line, PtrWatch->Command, sizeof(PtrWatch->Line));
+    ptrCtx->ReadOnly = TRUE;
+    found = cliParseCmd(PtrWatch->Line, PtrSessionInfo);
+    ptrCtx->ReadOnly = FALSE;
+
+    /* Also flushes the rest of the output to the frame */
+    iecCliOutSetSink(&(PtrSessionInfo->OutFileHandle), NULL, NULL);
+
+    return found;
+}
+
+/**
+ * @Name:   iecCliWatchRun()
+ *
+ * @Description: This function runs a command line every IntervalMs ms and
+ *               shows its output in place, until Ctrl-C is typed. The
+ *               interval is counted from the end of a run.
+ *
+ * @param PtrSessionInfo - Pointer to the CLI session information structure.
+ *
+ * @param PtrCommand - Command line.
+ *
+ * @param IntervalMs - Interval between two runs, in ms.
+ *
+ * @return CLI_STATUS_SUCCESS once stopped by Ctrl-C,
+ *         CLI_STATUS_INVALID_MODE if the session output is not text,
+ *         CLI_STATUS_INVALID_SYNTAX if the command is not found,
+ *         CLI_STATUS_INVALID_FUNC_REQ if a command of the line is not
+ *         read-only,
+ *         CLI_STATUS_INSUFF_MEM if the frames were not allocated.
+ *
+ *****************************************************************************/
+CLI_STATUS iecCliWatchRun(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                          const U8 *PtrCommand,
+                          U32 IntervalMs)
+{
+    PTR_IEC_CLI_SESSION_CTX ptrCtx = iecCliSessionCtxGet(PtrSessionInfo);
+    PTR_CLI_CMD_NODE ptrCurCommand = PtrSessionInfo->PtrCurCommand;
+    CLI_CMD_NODE curCmdNode;
+    PTR_IEC_CLI_WATCH ptrWatch;
+    CLI_STATUS status = CLI_STATUS_SUCCESS;
+    U32 waited;
+
+    /* The frames are text, and a job or a nested watch already captures
+     * the output of the session
+     */
+    if ((ptrCtx == NULL)
+        || (iecCliOutTlvMode(&(PtrSessionInfo->OutFileHandle)) == TRUE))
+    {
+        return CLI_STATUS_INVALID_MODE;
+    }
+
+    if (ptrCtx->FptrOutSink != NULL)
+    {
+        return CLI_STATUS_INVALID_SYNTAX;
+    }
+
+    /* The runs reuse the command node of the context */
+    curCmdNode = ptrCtx->CmdNode;
+
+    ptrWatch = malloc(sizeof(*ptrWatch));
+    if (ptrWatch == NULL)
+    {
+        return CLI_STATUS_INSUFF_MEM;
+    }
+
+    memset(ptrWatch, 0, sizeof(*ptrWatch));
+    strncpy((char *)ptrWatch->Command, (const char *)PtrCommand,
+            CLI_MAX_CMD_LINE_LENGTH - 1);
+
+    ptrCtx->ReadOnlyRefused = FALSE;
+
+    if (iecCliWatchFrame(ptrWatch, PtrSessionInfo, IntervalMs) == FALSE)
+    {
+        status = CLI_STATUS_INVALID_SYNTAX;
+    }
+    else if (ptrCtx->ReadOnlyRefused == TRUE)
+    {
+        /* The refused command was not run, the frame is not drawn */
+        status = CLI_STATUS_INVALID_FUNC_REQ;
+    }
+    else
+    {
+        /* The first frame is drawn over an empty screen */
+        iecCliOutPuts("\x1b[H\x1b[2J", &(PtrSessionInfo->OutFileHandle));
+
+        for ( ; ; )
+        {
+            iecCliWatchDraw(ptrWatch, &(PtrSessionInfo->OutFileHandle));
+            ptrWatch->Next ^= 1;
+
+            /* Ctrl-C may also have stopped the command itself */
+            if (ptrCtx->LastStatus == CLI_STATUS_CANCELLED)
+            {
+                break;
+            }
+
+            for (waited = 0; waited < IntervalMs; waited += IEC_CLI_WATCH_POLL_MS)
+            {
+                if (CLI_CANCELLED() == TRUE)
+                {
+                    break;
+                }
+
+                haliOsThreadSleep(IEC_CLI_WATCH_POLL_MS);
+            }
+
+            if ((waited < IntervalMs)
+                || (iecCliWatchFrame(ptrWatch, PtrSessionInfo, IntervalMs) == FALSE))
+            {
+                break;
+            }
+
+            /* A line whose commands depend on the device state */
+            if (ptrCtx->ReadOnlyRefused == TRUE)
+            {
+                status = CLI_STATUS_INVALID_FUNC_REQ;
+                break;
+            }
+        }
+    }
+
+    /* The command run last is not the one being executed */
+    ptrCtx->CmdNode = curCmdNode;
+    PtrSessionInfo->PtrCurCommand = ptrCurCommand;
+
+    free(ptrWatch);
+
+    return status;
+}
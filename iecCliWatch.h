@@ -0,0 +1,94 @@
+/***************************************************************************
+ *                                                                         *
+ *  Copyright 2018- Inventec.  All rights reserved.                        *
+ *                                                                         *
+ ***************************************************************************
+ *
+ *           Name:  iecCliWatch.h
+ *          Title:  iec CLI Watch Header File
+ *     Programmer:  Albert Wang
+ *  Creation Date:  Oct 18, 2026
+ *
+ *  Version History
+ *  ---------------
+ *
+ *  Date      Who   Description
+ *  --------  ---   -------------------------------------------------------
+ *  10/18/26  AW    Only read-only commands are watched.
+ *  10/18/26  AW    Initial version.
+ *
+ *
+ * Description
+ * ------------
+ *  This file is the header file for the cli watch mode. The watch command
+ *  runs a command again and again, like "watch -n 1000 iecTemp", and keeps
+ *  its output on the screen. The output of each run is captured through
+ *  the output sink of the session into a frame of character cells. Only the
+ *  cells that differ from the previous frame are sent to the terminal, as
+ *  VT100 cursor moves followed by the new characters, so an unchanged
+ *  screen costs no output at all.
+ *  The frame is IEC_CLI_WATCH_COLS columns by IEC_CLI_WATCH_ROWS rows, the
+ *  output beyond it is not shown.
+ *  The command line runs in read only mode: a command whose handler is not
+ *  registered with cliRegisterReadOnlyTable() stops the watch with
+ *  CLI_STATUS_INVALID_FUNC_REQ instead of changing the device state at
+ *  each run.
+ *  Include this file after iecCliSession.h.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef _IEC_CLI_WATCH_H
+#define _IEC_CLI_WATCH_H
+/*
+** Include Files
+*/
+
+/*
+** Preprocessor Constants
+*/
+
+/* Size of a frame. A frame line must not be wider than the terminal, the
+ * terminal would wrap it and the rows below would be drawn at the wrong
+ * place. The first row is the watch header.
+ */
+#define IEC_CLI_WATCH_ROWS              (48)
+#define IEC_CLI_WATCH_COLS              (80)
+
+/* Interval between two runs of the command, in ms */
+#define IEC_CLI_WATCH_INTERVAL_MIN      (100)
+#define IEC_CLI_WATCH_INTERVAL_MAX      (60000)
+#define IEC_CLI_WATCH_INTERVAL_DEFAULT  (1000)
+
+/* Period Ctrl-C is checked at between two runs, in ms */
+#define IEC_CLI_WATCH_POLL_MS           (50)
+
+/* Unchanged cells between two changed ones that are sent again instead of
+ * moving the cursor over them. A cursor move is up to 8 bytes.
+ */
+#define IEC_CLI_WATCH_GAP               (8)
+
+/*
+** Macros
+*/
+
+/*
+** Enumerated types
+*/
+
+/*
+** Typedefs
+*/
+
+/*
+** Variables
+*/
+
+/*
+** Function Prototypes
+*/
+CLI_STATUS iecCliWatchRun(PTR_CLI_SESSION_INFO PtrSessionInfo,
+                          const U8 *PtrCommand,
+                          U32 IntervalMs);
+
+
+#endif